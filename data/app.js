@@ -14,6 +14,7 @@ const CFG = {
     healthTimeout: 3000,      // Si pasan 3s sin datos, reiniciar socket
     sampleRate: { ECG: 200, EMG: 100, PPG: 100 },  // Hz según tipo (igual que Nextion)
     bufSize: 1200,
+    histSeconds: 30,          // Historial guardado sin visualizar (= WS_HISTORY_SECONDS)
     gridX: 10,
     gridY: 8,
     colors: {
@@ -31,6 +32,18 @@ const CFG = {
     timeWin: { ECG: 3.5, EMG: 7.0, PPG: 7.0 }
 };
 
+// Frame binario de muestras (ver WS_FRAME_* en wifi_server.h)
+const FRAME = {
+    magic: 0xB5,
+    version: 1,
+    headerSize: 16,
+    flagEnvelope: 0x01,
+    levelShift: 4,       // Bits 4-5 de flags: nivel de decimación por backpressure
+    levelMask: 0x30,
+    flagHistory: 0x04,   // Backfill del historial del dispositivo al conectar
+    signals: ["--", "ECG", "EMG", "PPG"]  // SignalType del firmware
+};
+
 const S = {
     ws: null,
     connected: false,
@@ -48,14 +61,19 @@ const S = {
     zoom: 100,
     hzoom: 100,
     lastMetrics: null,
-    windowSamples: 0
+    windowSamples: 0,
+    lastSeq: null,
+    framesLost: 0,
+    fs: 0,
+    level: 0,
+    hist: []             // Muestras recibidas sin visualizar: siembran startViewing()
 };
 
 function getWindowSamples() {
     const winSecBase = CFG.timeWin[S.sig] || CFG.timeWin.ECG;
     const hScale = S.hzoom / 100;
     const winSec = Math.max(1.5, winSecBase / hScale); // nunca menos de 1.5s
-    const rate = CFG.sampleRate[S.sig] || CFG.sampleRate.ECG;
+    const rate = S.fs || CFG.sampleRate[S.sig] || CFG.sampleRate.ECG;
     return Math.round(winSec * rate);
 }
 
@@ -140,6 +158,7 @@ function connect() {
     
     try {
         S.ws = new WebSocket(CFG.wsUrl);
+        S.ws.binaryType = "arraybuffer";
     } catch (e) {
         scheduleReconnect();
         return;
@@ -149,6 +168,7 @@ function connect() {
         S.connected = true;
         reconAttempts = 0;
         lastDataTime = Date.now();
+        S.lastSeq = null;  // La secuencia de frames se retoma en la conexión nueva
         if (statusTimer) { clearTimeout(statusTimer); statusTimer = null; }
         updConn(true, "Conectado");
         startPing();
@@ -182,7 +202,8 @@ function connect() {
     
     S.ws.onmessage = e => {
         try {
-            handleMsg(JSON.parse(e.data));
+            if (e.data instanceof ArrayBuffer) handleFrame(e.data);
+            else handleMsg(JSON.parse(e.data));
         } catch (err) {}
     };
 }
@@ -220,7 +241,7 @@ function stopPing() {
     if (pongTimer) { clearTimeout(pongTimer); pongTimer = null; }
 }
 
-function handleMsg(msg) {
+function markAlive() {
     // Cualquier mensaje recibido indica conexión activa
     lastDataTime = Date.now();
     
@@ -230,6 +251,10 @@ function handleMsg(msg) {
         if (statusTimer) { clearTimeout(statusTimer); statusTimer = null; }
         updConn(true, "Conectado");
     }
+}
+
+function handleMsg(msg) {
+    markAlive();
     
     switch (msg.type) {
         case "welcome": break;
@@ -237,55 +262,104 @@ function handleMsg(msg) {
             // Cancelar timeout de pong - conexión activa
             if (pongTimer) { clearTimeout(pongTimer); pongTimer = null; }
             break;
-        case "data": handleData(msg); break;
         case "metrics": handleMetrics(msg); break;
         case "state": handleState(msg); break;
     }
 }
 
-function handleData(msg) {
-    if (msg.signal && msg.signal !== S.sig) {
-        S.sig = msg.signal;
+function applyStreamInfo(sig, cond) {
+    if (sig && sig !== S.sig) {
+        S.sig = sig;
         S.buf1 = [];
         S.buf2 = [];
+        S.hist = [];
         updateSignalUI();
         // Actualizar título si estamos visualizando
         if (S.viewing) {
             $("plotTitle").textContent = "📡 " + S.sig + " - " + S.cond + " (En vivo)";
         }
     }
-    if (msg.condition && msg.condition !== S.cond) {
-        S.cond = msg.condition;
+    if (cond && cond !== S.cond) {
+        S.cond = cond;
         $("sigCond").textContent = S.cond;
         // Actualizar título si estamos visualizando
         if (S.viewing) {
             $("plotTitle").textContent = "📡 " + S.sig + " - " + S.cond + " (En vivo)";
         }
     }
-    if (msg.state) {
-        S.state = msg.state;
+}
+
+/**
+ * Frame binario: cabecera de 16 bytes + N int16 (valor) [+ N int16 (envolvente)]
+ */
+function handleFrame(buf) {
+    markAlive();
+    if (buf.byteLength < FRAME.headerSize) return;
+    
+    const dv = new DataView(buf);
+    if (dv.getUint8(0) !== FRAME.magic || dv.getUint8(1) !== FRAME.version) return;
+    
+    const sig = FRAME.signals[dv.getUint8(2)] || "--";
+    const seq = dv.getUint16(4, true);
+    const n = dv.getUint16(6, true);
+    const t0 = dv.getUint32(8, true);
+    const fs = dv.getUint16(12, true) || CFG.sampleRate[sig] || CFG.sampleRate.ECG;
+    const flags = dv.getUint8(14);
+    const hasEnv = (flags & FRAME.flagEnvelope) !== 0;
+    const mvPerLsb = dv.getUint8(15) / 1000;
+    
+    if (buf.byteLength < FRAME.headerSize + n * 2 * (hasEnv ? 2 : 1)) return;
+    
+    // Frames perdidos (secuencia u16 con wrap)
+    if (S.lastSeq !== null) S.framesLost += (seq - S.lastSeq - 1) & 0xFFFF;
+    S.lastSeq = seq;
+    
+    // El servidor baja la frecuencia (pares min/max) si nuestra cola se llena
+    S.level = (flags & FRAME.levelMask) >> FRAME.levelShift;
+    S.fs = fs;
+    
+    applyStreamInfo(sig, null);
+    if (S.state !== "RUNNING") {
+        S.state = "RUNNING";
         updateStateUI();
     }
     
-    if (!S.viewing) return;
+    // Cabecera de 16 bytes: offsets alineados para Int16Array (little-endian)
+    const vals = new Int16Array(buf, FRAME.headerSize, n);
+    const envs = hasEnv ? new Int16Array(buf, FRAME.headerSize + n * 2, n) : null;
+    const dt = 1000 / fs;
     
-    const val = msg.value;
-    const envVal = msg.env ?? 0;  // Envelope directo (0 si no existe)
+    // Sin visualizar: guardar las últimas histSeconds para cuando empiece
+    if (!S.viewing) {
+        for (let i = 0; i < n; i++) {
+            S.hist.push({
+                t: t0 + Math.round(i * dt),
+                sig: S.sig,
+                v: vals[i] * mvPerLsb,
+                env: envs ? envs[i] * mvPerLsb : 0
+            });
+        }
+        const histMax = CFG.histSeconds * fs;
+        if (S.hist.length > histMax) S.hist.splice(0, S.hist.length - histMax);
+        return;
+    }
     
-    if (val !== undefined) {
+    for (let i = 0; i < n; i++) {
+        const val = vals[i] * mvPerLsb;
+        const envVal = envs ? envs[i] * mvPerLsb : 0;
         S.buf1.push(val);
         S.buf2.push(envVal);  // SIEMPRE agregar envelope para mantener sincronización con buf1
         
         S.csvData.push({
-            t: msg.t || Date.now(),
+            t: t0 + Math.round(i * dt),
             sig: S.sig,
             v: val,
             env: envVal
         });
-        if (S.csvData.length > 50000) S.csvData.shift();
-        S.ptsTotal++;
-        S.ptsCounter++;
     }
+    if (S.csvData.length > 50000) S.csvData.splice(0, S.csvData.length - 50000);
+    S.ptsTotal += n;
+    if (!(flags & FRAME.flagHistory)) S.ptsCounter += n;  // pts/s solo en vivo
     
     applySlidingWindow();
     
@@ -327,9 +401,11 @@ function handleMetrics(msg) {
 }
 
 function handleState(msg) {
-    if (msg.signal) S.sig = msg.signal;
-    if (msg.condition) S.cond = msg.condition;
-    if (msg.state) S.state = msg.state;
+    applyStreamInfo(msg.signal, msg.condition);
+    if (msg.state) {
+        S.state = msg.state;
+        updateStateUI();
+    }
     updateSignalUI();
 }
 
@@ -339,10 +415,12 @@ function startViewing() {
         return;
     }
     
-    S.buf1 = [];
-    S.buf2 = [];
-    S.csvData = [];
-    S.ptsTotal = 0;
+    // Empezar con lo ya recibido (historial del dispositivo incluido)
+    S.buf1 = S.hist.map(p => p.v);
+    S.buf2 = S.hist.map(p => p.env);
+    S.csvData = S.hist;
+    S.hist = [];
+    S.ptsTotal = S.csvData.length;
     S.ptsCounter = 0;
     S.startTime = Date.now();
     S.viewing = true;
@@ -527,7 +605,9 @@ function updateStateUI() {
 
 function updateStats() {
     $("statPts").textContent = S.ptsTotal;
-    $("statRate").textContent = S.ptsCounter + " pts/s";
+    $("statRate").textContent = S.ptsCounter + " pts/s" +
+        (S.level ? ` @ ${S.fs} Hz (reducido)` : "") +
+        (S.framesLost ? ` (${S.framesLost} frames perdidos)` : "");
     $("statProg").textContent = S.state;
     S.ptsPerSec = S.ptsCounter;
     S.ptsCounter = 0;
@@ -105,6 +105,24 @@ struct DisplayMetrics {
     float amplitude;
 };
 
+// ============================================================================
+// ESTADO DE TRANSFERENCIA addt
+// ============================================================================
+enum class AddtState : uint8_t {
+    IDLE = 0,           // Sin transferencia en curso
+    WAIT_READY,         // Enviado "addt", esperando 0xFE
+    WAIT_DONE           // Datos enviados, esperando 0xFD
+};
+
+// Evento touch crudo (0x65 página componente evento)
+struct NextionTouch {
+    uint8_t page;
+    uint8_t component;
+    uint8_t event;
+};
+
+#define NEXTION_DEFERRED_EVENTS 4   // Toques recibidos durante el handshake addt
+
 // ============================================================================
 // CALLBACK PARA EVENTOS
 // ============================================================================
@@ -127,10 +145,41 @@ private:
     NextionPage currentPage;
     SignalType displayedSignal;
     
+    // Waveform por bloques (addt): puntos pendientes por canal
+    uint8_t waveBatch[NEXTION_WAVEFORM_CHANNELS][NEXTION_ADDT_BUFFER_SIZE];
+    uint16_t waveBatchCount[NEXTION_WAVEFORM_CHANNELS];
+    unsigned long waveBatchStartMs[NEXTION_WAVEFORM_CHANNELS];  // Llegada del primer punto
+    uint8_t waveComponentId;
+    
+    // Transferencia addt en curso (copia propia: clearWaveform no la altera)
+    AddtState addtState;
+    uint8_t addtData[NEXTION_ADDT_BUFFER_SIZE];
+    uint16_t addtDataCount;
+    unsigned long addtStateMs;
+    uint8_t addtNextChannel;    // Round-robin entre canales
+    uint8_t addtFailures;       // Timeouts consecutivos esperando 0xFE
+    bool addtEnabled;           // false → fallback a "add" por punto
+    bool addtLateReady;         // Timeout en WAIT_READY: un 0xFE tardío aún pide datos
+    
+    // Toques diferidos: waitWaveformIdle() no llama al callback de UI
+    NextionTouch deferredTouch[NEXTION_DEFERRED_EVENTS];
+    uint8_t deferredHead;
+    uint8_t deferredCount;
+    
     // Métodos privados
     void sendCommand(const char* cmd);
     void sendEndSequence();
-    void parseEvent();
+    bool receiveByte(uint8_t byte);
+    bool handleTransferResponse();
+    void readMessages(bool deferEvents);
+    bool parseEvent(NextionTouch& touch);
+    void dispatchEvent(const NextionTouch& touch);
+    void deferEvent(const NextionTouch& touch);
+    void dispatchDeferredEvents();
+    void startWaveformTransfer(uint8_t channel);
+    void checkWaveformTimeout();
+    void waitWaveformIdle();
+    void discardWaveformBatches();
     
 public:
     NextionDriver(HardwareSerial& serialPort);
@@ -165,6 +214,12 @@ public:
     // Waveform
     void addWaveformPoint(uint8_t componentId, uint8_t channel, uint8_t value);
     void clearWaveform(uint8_t componentId, uint8_t channel);
+    
+    // Waveform por bloques (addt)
+    bool queueWaveformPoint(uint8_t componentId, uint8_t channel, uint8_t value);
+    void flushWaveform();                       // Llamar en loop (no bloqueante)
+    uint16_t getWaveformQueueSpace() const;     // Puntos libres en el canal más lleno
+    bool isWaveformBatchingEnabled() const { return addtEnabled; }
     void setWaveformWritePosition(uint8_t componentId, uint8_t channel, uint16_t position);
     
     // Comando genérico (para casos especiales)
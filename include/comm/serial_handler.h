@@ -11,6 +11,8 @@
 
 #include <Arduino.h>
 #include "../data/signal_types.h"
+#include "../core/spsc_ring.h"
+#include "../core/trace_ring.h"
 
 // ============================================================================
 // COMANDOS DEL PROTOCOLO
@@ -37,6 +39,11 @@
 #define CMD_ACK             0xF0
 #define CMD_ERROR           0xFF
 
+// Streaming binario: [0xBB] [sample] [flags_high] [flags_low]
+#define STREAM_HEADER       0xBB
+#define STREAM_PACKET_SIZE  4
+#define STREAM_TX_RING_SIZE 512     // Potencia de 2 (128 paquetes)
+
 // ============================================================================
 // ESTRUCTURA DE PAQUETE
 // ============================================================================
@@ -70,6 +77,18 @@ private:
     uint8_t rxBuffer[280];
     uint16_t rxIndex;
     
+    // Buffer de transmisión del streaming: streamSample() encola y
+    // process() vacía sin bloquear según availableForWrite()
+    SPSCRing<uint8_t, STREAM_TX_RING_SIZE> txRing;
+    uint32_t streamDropped;
+    
+    void flushStream();
+    
+    // Volcado del ring de eventos (comando 't'): por trozos según el FIFO de
+    // la UART, como el streaming (que queda en pausa mientras dura)
+    TraceExporter* traceDump;
+    void flushTraceDump();
+    
     // Métodos privados
     void parsePacket();
     uint8_t calculateChecksum(const SerialPacket& packet);
@@ -90,6 +109,7 @@ public:
     void stopStreaming();
     bool isStreaming() const { return streamingEnabled; }
     void streamSample(uint8_t dacValue, uint16_t flags);
+    uint32_t getStreamDropped() const { return streamDropped; }
     
     // Enviar paquete
     void sendPacket(uint8_t cmd, const uint8_t* data, uint16_t len);
@@ -100,6 +120,7 @@ public:
     // Debug
     void printHelp();
     void printSystemInfo();
+    void printPerfReport();
     
     // Callback
     void setCommandCallback(SerialCommandCallback callback);
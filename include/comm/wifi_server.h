@@ -6,6 +6,10 @@
  * 
  * Permite que múltiples clientes visualicen las señales en tiempo real
  * conectándose al ESP32 como Access Point WiFi.
+ *
+ * El fan-out WebSocket corre en su propia tarea FreeRTOS (Core 0): consume
+ * el SPSCRing de muestras del motor con cadencia fija, independiente del
+ * loop Arduino (Nextion, serial), de modo que ninguno retrasa al otro.
  */
 
 #ifndef WIFI_SERVER_H
@@ -17,6 +21,9 @@
 #include <AsyncTCP.h>
 #include <SPIFFS.h>
 #include <ArduinoJson.h>
+#include "config.h"
+#include "core/param_mailbox.h"
+#include "models/playback_model.h"
 
 // ============================================================================
 // CONFIGURACIÓN WiFi AP
@@ -25,7 +32,7 @@
 #define WIFI_SSID           "BioSignalSimulator_Pro"
 #define WIFI_PASSWORD       "biosignal123"
 #define WIFI_CHANNEL        6       // Canal 6 menos saturado en 2.4GHz
-#define WIFI_MAX_CLIENTS    4       // Reducido a 4 para mayor estabilidad
+#define WIFI_MAX_CLIENTS    8       // Clientes lentos se decimatan sin afectar al resto
 
 // IP Configuration
 #define WIFI_LOCAL_IP       IPAddress(192, 168, 4, 1)
@@ -40,26 +47,136 @@
 // CONFIGURACIÓN STREAMING
 // ============================================================================
 
-#define WS_SEND_INTERVAL_MS     50      // 20 Hz base, evita saturación en colas
+#define WS_SEND_INTERVAL_MS     50      // Periodo de la tarea de streaming (20 frames/s)
 #define WS_METRICS_INTERVAL_MS  750     // ~1.3 Hz para métricas
 #define WS_MAX_QUEUE_SIZE       16      // Buffer más grande para evitar drops
 #define WS_CLEANUP_INTERVAL_MS  10000   // Cleanup cada 10 segundos (muy conservador)
 
+// ============================================================================
+// FRAME BINARIO DE MUESTRAS
+// ============================================================================
+// Un frame cada WS_SEND_INTERVAL_MS con todas las muestras acumuladas
+// (little-endian, cabecera de 16 bytes → Int16Array alineado en el cliente):
+//
+//   off  tipo   campo
+//   0    u8     magic (WS_FRAME_MAGIC)
+//   1    u8     versión (WS_FRAME_VERSION)
+//   2    u8     señal (SignalType: 1=ECG, 2=EMG, 3=PPG)
+//   3    u8     condición (índice del enum del modelo)
+//   4    u16    número de secuencia por cliente (detecta frames perdidos)
+//   6    u16    N muestras
+//   8    u32    timestamp de la primera muestra (ms de señal)
+//   12   u16    frecuencia de muestras (Hz): t_i = t0 + i*1000/fs
+//   14   u8     flags (WS_FRAME_FLAG_*, bits 4-5: nivel de decimación)
+//   15   u8     µV por LSB de las muestras
+//   16   i16[N] valor
+//   ..   i16[N] envolvente (solo si WS_FRAME_FLAG_ENVELOPE)
+//
+// Nombres de señal/condición viajan en el JSON "state", solo cuando cambian.
+#define WS_FRAME_MAGIC          0xB5
+#define WS_FRAME_VERSION        1
+#define WS_FRAME_HEADER_SIZE    16
+#define WS_FRAME_MAX_SAMPLES    64      // 320 ms @ 200 Hz (margen sobre 50 ms)
+#define WS_FRAME_FLAG_ENVELOPE  0x01
+#define WS_FRAME_FLAG_MINMAX    0x02    // Muestras en pares min/max (nivel > 0)
+#define WS_FRAME_FLAG_HISTORY   0x04    // Bloque de historial (backfill al conectar)
+#define WS_FRAME_LEVEL_SHIFT    4
+#define WS_FRAME_LEVEL_MASK     0x30
+#define WS_FRAME_UV_PER_LSB     1       // ECG/EMG: ±32.7 mV con 1 µV
+#define WS_FRAME_UV_PER_LSB_PPG 10      // PPG (AC hasta ~150 mV): ±327 mV con 10 µV
+
+// ============================================================================
+// BACKPRESSURE POR CLIENTE
+// ============================================================================
+// Cada cliente recibe el stream a su propio nivel de decimación según la
+// ocupación de su cola de envío (AsyncWebSocketClient::queueLen), muestreada
+// antes de cada frame. Un cliente lento baja de nivel sin afectar a los
+// demás; tras WS_CLIENT_RECOVER_FRAMES frames con la cola vacía sube uno.
+//
+// Nivel L: grupos de 2·2^L muestras → par (min, max) en orden temporal,
+// fs/2^L (ECG 200 → 100 → 50 Hz). Conserva picos (QRS) que un diezmado
+// simple perdería.
+#define WS_DECIMATION_LEVELS        3
+#define WS_MAX_TRACKED_CLIENTS      WIFI_MAX_CLIENTS
+#define WS_CLIENT_QUEUE_HIGH        4       // Mensajes en cola → bajar un nivel
+#define WS_CLIENT_QUEUE_LOW         1       // Cola a este nivel o menos → "en calma"
+#define WS_CLIENT_HOLD_FRAMES       10      // Mínimo entre dos bajadas (500 ms)
+#define WS_CLIENT_RECOVER_FRAMES    40      // Frames en calma para subir (2 s)
+
+// ============================================================================
+// HISTORIAL PARA CLIENTES QUE SE UNEN TARDE
+// ============================================================================
+// Las últimas WS_HISTORY_SECONDS de muestras del stream (ya codificadas int16,
+// a la frecuencia de streaming) quedan en un ring, haya o no clientes
+// conectados; un hueco en los timestamps lo reinicia. Un cliente nuevo recibe
+// primero ese historial en bloques WS_FRAME_FLAG_HISTORY (como mucho
+// WS_HISTORY_CHUNKS_PER_CYCLE por ciclo y solo con su cola vacía) y después
+// continúa con los frames en vivo sin hueco ni duplicados. Lo hace la tarea
+// de streaming, así que los demás clientes no esperan.
+#define WS_HISTORY_SECONDS          30
+#define WS_HISTORY_MAX_SAMPLES      (WS_HISTORY_SECONDS * FDS_ECG)     // 6000 (24 KB con envolvente)
+#define WS_HISTORY_CHUNK_SAMPLES    512
+#define WS_HISTORY_CHUNKS_PER_CYCLE 2
+
 // ============================================================================
 // ESTRUCTURAS DE DATOS
 // ============================================================================
 
 /**
- * @brief Datos de señal para transmitir via WebSocket
+ * @brief Identifica el stream de muestras (cambia → JSON "state" al cliente)
  */
-struct WSSignalData {
+struct WSStreamInfo {
     const char* signalType;     // "ECG", "EMG", "PPG"
     const char* condition;      // "NORMAL", "TACHYCARDIA", etc.
-    const char* state;          // "RUNNING", "PAUSED", "STOPPED"
-    float value;                // Valor actual de la señal (mV)
-    float envelope;             // Envelope EMG (mV) - solo para EMG
-    uint8_t dacValue;           // Valor DAC (0-255)
-    uint32_t timestamp;         // Timestamp en ms
+    uint8_t signalId;           // SignalType
+    uint8_t conditionId;        // Índice de condición del modelo
+    uint16_t sampleRateHz;      // Frecuencia de las muestras enviadas
+    uint8_t uvPerLsb;           // Escala int16 (WS_FRAME_UV_PER_LSB*)
+    bool hasEnvelope;           // EMG: envía también la envolvente
+};
+
+/**
+ * @brief Estadísticas de la tarea de streaming
+ */
+struct WSStreamStats {
+    uint32_t framesSent;        // Frames encolados (suma sobre clientes)
+    uint32_t framesDropped;     // Frames descartados (cola del cliente llena)
+    uint32_t samplesSent;       // Muestras de los frames encolados
+    uint16_t queueDepth;        // Muestras pendientes en el ring al inicio del último ciclo
+    uint16_t maxQueueDepth;     // Máximo observado desde el arranque de la tarea
+    uint32_t lastCycleUs;       // Duración del último ciclo de la tarea
+};
+
+/**
+ * @brief Orden de reproducción de la API (la ejecuta loop(), no async_tcp)
+ */
+struct PlaybackCommand {
+    uint32_t id;                    // Secuencia de la petición (respuesta 202)
+    bool start;                     // false = detener
+    char path[PLAYBACK_MAX_PATH];
+};
+
+enum class PlaybackCommandResult : uint8_t {
+    NONE = 0,       // Sin órdenes ejecutadas
+    STARTED,
+    STOPPED,
+    FAILED          // Archivo no encontrado, inválido o en grabación
+};
+
+/**
+ * @brief Estado de backpressure de un cliente WebSocket
+ */
+struct WSClientSlot {
+    uint32_t id;                // Id de AsyncWebSocketClient (0 = libre)
+    uint8_t level;              // Nivel de decimación actual
+    uint8_t maxQueue;           // Máxima ocupación de cola observada
+    uint16_t sequence;          // Secuencia de frames propia del cliente
+    uint16_t levelAge;          // Frames desde el último cambio de nivel
+    uint16_t calmFrames;        // Frames seguidos con cola <= LOW
+    uint32_t framesSent;
+    uint32_t framesDropped;
+    bool backfilling;           // Recibiendo historial (sin frames en vivo)
+    uint32_t historyPos;        // Próxima muestra absoluta del historial a enviar
 };
 
 /**
@@ -119,10 +236,25 @@ public:
     void loop();
     
     /**
-     * @brief Envía datos de señal a todos los clientes
-     * @param data Estructura con datos de la señal
+     * @brief Crea la tarea de streaming WebSocket (llamar tras begin())
+     * @param priority Prioridad FreeRTOS
+     * @param periodMs Cadencia de envío (un frame por periodo)
+     * @return true si la tarea se creó
+     */
+    bool startStreamingTask(UBaseType_t priority = TASK_PRIORITY_WS,
+                            uint32_t periodMs = WS_SEND_INTERVAL_MS);
+    
+    /**
+     * @brief Estadísticas de la tarea de streaming (copia)
+     */
+    WSStreamStats getStreamStats() const { return _stats; }
+    
+    /**
+     * @brief Copia el estado de backpressure de los clientes conectados
+     * @param out Destino (WS_MAX_TRACKED_CLIENTS entradas)
+     * @return Número de clientes copiados
      */
-    void sendSignalData(const WSSignalData& data);
+    uint8_t getClientSlots(WSClientSlot* out);
     
     /**
      * @brief Envía métricas a todos los clientes
@@ -159,20 +291,87 @@ private:
     AsyncWebServer* _server;
     AsyncWebSocket* _ws;
     
-    bool _isActive;
-    bool _streamingEnabled;
+    volatile bool _isActive;
+    volatile bool _streamingEnabled;    // Escrito por el loop, leído por la tarea
+    
+    // Tarea de streaming (Core 0)
+    TaskHandle_t _streamTaskHandle;
+    uint32_t _streamPeriodMs;
+    WSStreamStats _stats;
     
     uint32_t _lastSendTime;
     uint32_t _lastMetricsTime;
     uint32_t _lastCleanupTime;      // Para cleanup periódico
     
+    // Frame binario en construcción (buffers fijos, sin heap por muestra)
+    WSStreamInfo _frameInfo;
+    int16_t _frameValues[WS_FRAME_MAX_SAMPLES];
+    int16_t _frameEnvelope[WS_FRAME_MAX_SAMPLES];
+    uint16_t _frameCount;
+    uint32_t _frameTimestamp;       // Timestamp de la primera muestra
+    bool _streamInfoDirty;          // Reenviar JSON "state" antes del próximo frame
+    uint8_t _frameBuffer[WS_FRAME_HEADER_SIZE + 2 * WS_HISTORY_CHUNK_SAMPLES * sizeof(int16_t)];
+    
+    // Historial (solo lo toca la tarea de streaming)
+    int16_t _historyValues[WS_HISTORY_MAX_SAMPLES];
+    int16_t _historyEnvelope[WS_HISTORY_MAX_SAMPLES];
+    uint32_t _historyTotal;         // Muestras escritas desde el último reset
+    uint32_t _historyT0;            // Timestamp de la muestra absoluta 0
+    
+    // Decimación min/max por nivel (compartida por los clientes del nivel)
+    struct LevelFrame {
+        int16_t values[WS_FRAME_MAX_SAMPLES];
+        int16_t envelope[WS_FRAME_MAX_SAMPLES];
+        uint16_t count;
+        uint32_t timestamp;
+    };
+    struct Decimator {
+        uint8_t filled;             // Muestras en el grupo en curso
+        uint8_t vMinIdx, vMaxIdx;
+        uint8_t eMinIdx, eMaxIdx;
+        int16_t vMin, vMax;
+        int16_t eMin, eMax;
+        uint32_t groupTimestamp;
+    };
+    LevelFrame _levelFrames[WS_DECIMATION_LEVELS];
+    Decimator _decimators[WS_DECIMATION_LEVELS];
+    
+    // Clientes: alta/baja desde la tarea async_tcp, niveles desde la de
+    // streaming (acceso protegido por clientsMux en wifi_server.cpp)
+    WSClientSlot _clients[WS_MAX_TRACKED_CLIENTS];
+    
+    // Reproducción: los handlers publican y loop() ejecuta en el motor
+    // (abrir el archivo bloquea y beginSignal no debe correr en async_tcp)
+    ParamMailbox<PlaybackCommand> _playbackMailbox;
+    uint32_t _playbackRequestId;            // Solo async_tcp
+    volatile uint32_t _playbackDoneId;      // Escrito por loop()
+    volatile PlaybackCommandResult _playbackResult;
+    void processPlaybackCommand();
+    
+    // Tarea de streaming
+    static void streamingTask(void* parameter);
+    void streamCycle();
+    void pushSignalSample(const WSStreamInfo& info, float value, float envelope, uint32_t timestamp);
+    
     // Handlers
     void setupRoutes();
     void onWsEvent(AsyncWebSocket* server, AsyncWebSocketClient* client, 
                    AwsEventType type, void* arg, uint8_t* data, size_t len);
     
     // Helpers
-    String buildDataJson(const WSSignalData& data);
+    void sendSignalFrame();
+    void decimateFrame(uint16_t count);
+    void resetDecimators();
+    size_t encodeFrame(uint8_t level, uint16_t sequence);
+    size_t writeFrame(uint16_t sequence, uint16_t count, uint32_t timestamp, uint16_t fs,
+                      uint8_t flags, const int16_t* values, const int16_t* envelope);
+    void appendHistory(uint16_t count);
+    void resetHistory();
+    uint8_t sendHistoryChunks(AsyncWebSocketClient* client, WSClientSlot& slot);
+    static void updateClientLevel(WSClientSlot& slot, size_t queued);
+    void registerClient(uint32_t id);
+    void unregisterClient(uint32_t id);
+    static int16_t encodeSample(float mV, uint8_t uvPerLsb);
     String buildMetricsJson(const WSSignalMetrics& metrics);
     String buildStateJson(const char* signalType, const char* condition, const char* state);
 };
@@ -122,17 +122,34 @@ const float MODEL_DT_ECG = 1.0f / MODEL_SAMPLE_RATE_ECG;  // 3.333 ms
 const float MODEL_DT_EMG = 1.0f / MODEL_SAMPLE_RATE_EMG;  // 1.0 ms
 const float MODEL_DT_PPG = 1.0f / MODEL_SAMPLE_RATE_PPG;  // 10 ms
 
-// Intervalo de tick en microsegundos (para timing real)
+// Intervalo de tick en microsegundos (main_debug.cpp y benchmark nativo)
 const uint32_t MODEL_TICK_US_ECG = 1000000 / MODEL_SAMPLE_RATE_ECG;  // 3333 us
 const uint32_t MODEL_TICK_US_EMG = 1000000 / MODEL_SAMPLE_RATE_EMG;  // 1000 us
 const uint32_t MODEL_TICK_US_PPG = 1000000 / MODEL_SAMPLE_RATE_PPG;  // 10000 us
 
 // Ratios de upsampling: interpolación de Fs_modelo a Fs_timer
-// Ratio = Fs_timer / Fs_modelo
+// Ratio = Fs_timer / Fs_modelo (entero, truncado: solo main_debug.cpp).
+// SignalEngine usa PolyphaseResampler con L/M exacto (core/polyphase_resampler.h)
 const uint8_t UPSAMPLE_RATIO_ECG = FS_TIMER_HZ / MODEL_SAMPLE_RATE_ECG;  // 2000/300 ≈ 6
 const uint8_t UPSAMPLE_RATIO_EMG = FS_TIMER_HZ / MODEL_SAMPLE_RATE_EMG;  // 2000/1000 = 2
 const uint8_t UPSAMPLE_RATIO_PPG = FS_TIMER_HZ / MODEL_SAMPLE_RATE_PPG;  // 2000/100 = 20
 
+// Generación por bloques: el motor pide al modelo MODEL_BLOCK_SIZE muestras
+// de una vez (generateBlock) y las consume una por tick de modelo
+#define MODEL_BLOCK_SIZE        64      // Muestras de modelo por bloque
+
+// Rampas de parámetros Tipo A (core/param_ramp.h): amplitud, ruido, ganancia
+// de waveform, excitación EMG y DC del PPG pasan al nuevo valor sin escalón
+// en la salida BNC. Duración 0 = escalón (comportamiento anterior)
+#define PARAM_RAMP_DEFAULT_MS       250     // Duración de la rampa (ms)
+#define PARAM_RAMP_DEFAULT_SHAPE    0       // 0 = lineal, 1 = exponencial
+
+// Semillas de FastRandom por modelo (core/fast_random.h): reset() reinicia
+// la secuencia, misma condición → misma señal bit a bit (ESP32 y nativo)
+#define RNG_SEED_ECG            0x0EC60001UL
+#define RNG_SEED_EMG            0x0E3C0002UL
+#define RNG_SEED_PPG            0x0B960003UL
+
 // Frecuencias de salida a displays
 const uint16_t FDS_ECG = 200;                  // Hz - display ECG
 const uint16_t FDS_EMG = 100;                  // Hz - display EMG
@@ -159,6 +176,29 @@ const uint16_t SERIAL_PLOTTER_RATE_EMG = FDS_EMG;
 #define DAC_VOLTAGE_MAX         3.3f    // Voltios
 #define DAC_MV_PER_STEP         (DAC_VOLTAGE_MAX * 1000.0f / 256.0f)  // ~12.9 mV
 
+// Pipeline post-modelo (core/dac_pipeline.h): remuestreo, ganancia, recorte
+// y mapeo a código. 1 = Q15 (biquads Q31), 0 = float. El modelo entrega el
+// nivel DAC sin cuantizar; solo se redondea a 8 bits a la salida.
+#ifndef DAC_PIPELINE_FIXED_POINT
+#define DAC_PIPELINE_FIXED_POINT 1
+#endif
+
+// ============================================================================
+// CONFIGURACIÓN SALIDA DAC (OutputSink, ver hw/output_sink.h)
+// ============================================================================
+// I2S_DMA: I2S0 alimenta el DAC interno (GPIO25) por DMA. La tarea de
+// generación llena bloques completos; no hay interrupción por muestra,
+// lo que elimina el jitter y permite subir FS_TIMER_HZ.
+// TIMER_ISR: fallback, timer hardware + dacWrite() por muestra.
+#define OUTPUT_SINK_DEFAULT     1       // 0 = TIMER_ISR, 1 = I2S_DMA
+#define OUTPUT_BLOCK_SIZE       64      // Muestras por bloque escrito al sink
+
+// El I2S no baja de ~10 kHz: cada muestra se repite I2S_DAC_OVERSAMPLE veces
+// (retención de orden cero, idéntica a la salida del timer ISR)
+#define I2S_DAC_OVERSAMPLE      8       // Fs_I2S = 2000 × 8 = 16 kHz
+#define I2S_DMA_BUF_COUNT       8       // Descriptores DMA
+#define I2S_DMA_BUF_LEN         (OUTPUT_BLOCK_SIZE * I2S_DAC_OVERSAMPLE)  // Frames por descriptor
+
 // ============================================================================
 // CONFIGURACIÓN DE BUFFERS
 // ============================================================================
@@ -174,10 +214,20 @@ const uint16_t SERIAL_PLOTTER_RATE_EMG = FDS_EMG;
 #define STACK_SIZE_SIGNAL       4096
 #define STACK_SIZE_UI           4096
 #define STACK_SIZE_MONITOR      2048
+#define STACK_SIZE_WS           4096    // Tarea streaming WebSocket
+#define STACK_SIZE_RECORDER     4096    // Tarea escritora del grabador (SPIFFS)
+#define STACK_SIZE_PLAYBACK     3072    // Tarea lectora de reproducción (SPIFFS)
+
+#define CORE_WS_STREAMING       CORE_UI_COMMUNICATION   // Core 0, fuera del loop Arduino
+#define CORE_RECORDER           CORE_UI_COMMUNICATION
+#define CORE_PLAYBACK           CORE_UI_COMMUNICATION
 
 #define TASK_PRIORITY_SIGNAL    5       // Alta prioridad
 #define TASK_PRIORITY_UI        2       // Media prioridad
 #define TASK_PRIORITY_MONITOR   1       // Baja prioridad
+#define TASK_PRIORITY_WS        2       // Igual que UI: no compite con generación
+#define TASK_PRIORITY_RECORDER  1       // Baja: el flash puede tardar, nadie lo espera
+#define TASK_PRIORITY_PLAYBACK  1       // Baja: lee por adelantado, la generación no la espera
 
 // ============================================================================
 // CONFIGURACIÓN DE TIEMPOS (UI - basado en millis(), NO en timer)
@@ -197,6 +247,16 @@ const uint16_t SERIAL_PLOTTER_RATE_EMG = FDS_EMG;
 #define NEXTION_WAVEFORM_HEIGHT 380     // Altura del waveform en pixeles
 #define WAVEFORM_COMPONENT_ID   1       // ID del componente waveform
 #define WAVEFORM_CHANNEL        0       // Canal del waveform (solo usamos 1)
+#define NEXTION_WAVEFORM_CHANNELS 2     // Canales usados (EMG: cruda + envolvente)
+
+// Envío por bloques (addt): los puntos se acumulan por canal y se mandan
+// como datos binarios transparentes (1 byte/punto) en vez de "add id,ch,val"
+// (~14 bytes/punto). Handshake: addt → 0xFE (listo) → datos → 0xFD (fin)
+#define NEXTION_ADDT_BATCH_SIZE       20    // Puntos por transferencia (100 ms ECG)
+#define NEXTION_ADDT_BUFFER_SIZE      64    // Capacidad por canal (puntos)
+#define NEXTION_ADDT_MAX_LATENCY_MS   100   // Envía aunque no se llene el bloque
+#define NEXTION_ADDT_TIMEOUT_MS       50    // Espera máxima de 0xFE / 0xFD
+#define NEXTION_ADDT_MAX_FAILURES     3     // Timeouts seguidos → volver a add por punto
 
 // Tiempo visible en Nextion (depende de Fds):
 // - ECG @ 200 Hz: 700px / 200Hz = 3.5 segundos (~4 latidos @ 75 BPM)
@@ -219,4 +279,26 @@ const uint16_t SERIAL_PLOTTER_RATE_EMG = FDS_EMG;
 // Macro para verificar memoria
 #define CHECK_HEAP(min_kb) (ESP.getFreeHeap() >= ((min_kb) * 1024))
 
+// Contadores de ciclos por etapa (core/perf_counters.h): comando serie 'p',
+// GET /api/perf. A 0 las macros PERF_* no generan código (release)
+#ifndef PERF_COUNTERS_ENABLED
+#ifdef DEBUG_ENABLED
+#define PERF_COUNTERS_ENABLED   1
+#else
+#define PERF_COUNTERS_ENABLED   0
+#endif
+#endif
+
+// Ring de eventos con marca de tiempo (core/trace_ring.h): comando serie 't',
+// GET /api/trace en formato Chrome trace_event. A 0 las macros TRACE_* no
+// generan código y el ring no ocupa RAM
+#ifndef TRACE_ENABLED
+#ifdef DEBUG_ENABLED
+#define TRACE_ENABLED           1
+#else
+#define TRACE_ENABLED           0
+#endif
+#endif
+#define TRACE_RING_SIZE         512     // Eventos (potencia de 2, 16 bytes c/u)
+
 #endif // CONFIG_H
@@ -0,0 +1,198 @@
+/**
+ * @file dac_pipeline.h
+ * @brief Pipeline post-modelo hacia el DAC (float o punto fijo Q15/Q31)
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ *
+ *   nivel DAC continuo (Fs_modelo, float 0-255 sin cuantizar)
+ *     → PolyphaseResamplerT   (L/M a Fs_timer)
+ *     → BiquadCascadeT        (opcional, 0 secciones por defecto; en float es
+ *                              la misma BiquadCascade de los modelos)
+ *     → ganancia + recorte    (saturación del formato)
+ *     → código DAC 8 bits     (único punto de cuantización)
+ *
+ * Todas las etapas son plantillas sobre el formato (core/sample_format.h);
+ * DAC_PIPELINE_FIXED_POINT (config.h) elige la instancia que usa el motor.
+ * La variante float sirve de referencia: model_bench compara ambas por SNR.
+ */
+
+#ifndef DAC_PIPELINE_H
+#define DAC_PIPELINE_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "core/sample_format.h"
+#include "core/digital_filters.h"
+#include "core/polyphase_resampler.h"
+
+// ============================================================================
+// CONFIGURACIÓN
+// ============================================================================
+#define DAC_PIPELINE_MAX_SECTIONS   2       // Biquads de salida (Q31 en punto fijo)
+
+// ============================================================================
+// CLASE BiquadCascadeT - BIQUADS DIRECT FORM I SOBRE UN FORMATO
+// ============================================================================
+/**
+ * @brief Cascada de biquads en Direct Form I (formatos en punto fijo)
+ *
+ * DF-I porque en punto fijo el único redondeo por sección es el de la
+ * salida (el estado guarda entradas/salidas tal cual, en Q31). Mismo layout
+ * y signo de coeficientes que BiquadCascade, {b0, b1, b2, a1, a2} por
+ * sección: y = b0·x + b1·x1 + b2·x2 - a1·y1 - a2·y2. FloatFormat usa la
+ * especialización de abajo.
+ */
+template <typename Format>
+class BiquadCascadeT {
+public:
+    typedef typename Format::sample_t sample_t;
+    typedef typename Format::wide_t wide_t;
+    typedef typename Format::bqcoeff_t bqcoeff_t;
+    typedef typename Format::bqacc_t bqacc_t;
+
+    BiquadCascadeT() : numSections(0) { reset(); }
+
+    void setSection(uint8_t section, float b0, float b1, float b2, float a1, float a2) {
+        if (section >= DAC_PIPELINE_MAX_SECTIONS) return;
+        bqcoeff_t* c = &coeffs[section * BIQUAD_COEFFS_PER_SECTION];
+        c[0] = Format::bqCoeffFromFloat(b0);
+        c[1] = Format::bqCoeffFromFloat(b1);
+        c[2] = Format::bqCoeffFromFloat(b2);
+        c[3] = Format::bqCoeffFromFloat(a1);
+        c[4] = Format::bqCoeffFromFloat(a2);
+    }
+
+    void setNumSections(uint8_t n) {
+        if (n <= DAC_PIPELINE_MAX_SECTIONS) numSections = n;
+    }
+    uint8_t getNumSections() const { return numSections; }
+
+    void reset() {
+        for (uint8_t i = 0; i < DAC_PIPELINE_MAX_SECTIONS * 4; i++) {
+            state[i] = Format::toWide(Format::fromFloat(0.0f));
+        }
+    }
+
+    inline sample_t process(sample_t input) {
+        if (numSections == 0) return input;
+
+        wide_t x = Format::toWide(input);
+        for (uint8_t k = 0; k < numSections; k++) {
+            const bqcoeff_t* c = &coeffs[k * BIQUAD_COEFFS_PER_SECTION];
+            wide_t* s = &state[k * 4];      // {x1, x2, y1, y2}
+
+            bqacc_t acc = Format::bqMul(c[0], x) + Format::bqMul(c[1], s[0])
+                        + Format::bqMul(c[2], s[1]) - Format::bqMul(c[3], s[2])
+                        - Format::bqMul(c[4], s[3]);
+            wide_t y = Format::bqFromAcc(acc);
+
+            s[1] = s[0];
+            s[0] = x;
+            s[3] = s[2];
+            s[2] = y;
+            x = y;
+        }
+        return Format::fromWide(x);
+    }
+
+private:
+    bqcoeff_t coeffs[DAC_PIPELINE_MAX_SECTIONS * BIQUAD_COEFFS_PER_SECTION];
+    wide_t state[DAC_PIPELINE_MAX_SECTIONS * 4];
+    uint8_t numSections;
+};
+
+/**
+ * @brief Variante float: delega en BiquadCascade (digital_filters.h)
+ *
+ * Sin segunda implementación en coma flotante: la referencia del pipeline
+ * usa la misma cascada (y en el ESP32 el mismo kernel esp-dsp) que los
+ * filtros de los modelos. Misma interfaz y límite de secciones que la
+ * plantilla; la salida se satura como FloatFormat::fromFloat.
+ */
+template <>
+class BiquadCascadeT<FloatFormat> {
+public:
+    typedef FloatFormat::sample_t sample_t;
+
+    void setSection(uint8_t section, float b0, float b1, float b2, float a1, float a2) {
+        if (section >= DAC_PIPELINE_MAX_SECTIONS) return;
+        cascade.setSection(section, b0, b1, b2, a1, a2);
+    }
+
+    void setNumSections(uint8_t n) {
+        if (n <= DAC_PIPELINE_MAX_SECTIONS) cascade.setNumSections(n);
+    }
+    uint8_t getNumSections() const { return (uint8_t)cascade.getNumSections(); }
+
+    void reset() { cascade.reset(); }
+
+    inline sample_t process(sample_t input) {
+        if (cascade.getNumSections() == 0) return input;
+        return FloatFormat::fromFloat(cascade.process(input));
+    }
+
+private:
+    BiquadCascade cascade;
+};
+
+// ============================================================================
+// CLASE DACPipelineT
+// ============================================================================
+template <typename Format>
+class DACPipelineT {
+public:
+    typedef typename Format::sample_t sample_t;
+
+    DACPipelineT() : gain(Format::gainFromFloat(1.0f)) {}
+
+    /**
+     * @brief Configura el remuestreo Fs_modelo → Fs_out
+     */
+    bool configure(uint32_t fsIn, uint32_t fsOut) {
+        return resampler.configure(fsIn, fsOut);
+    }
+
+    /**
+     * @brief Llena el historial con un nivel constante y limpia los biquads
+     */
+    void reset(uint8_t fillValue) {
+        resampler.reset(fillValue);
+        outputFilter.reset();
+    }
+
+    /**
+     * @brief Ganancia de salida respecto al centro del DAC (1.0 = unidad)
+     */
+    void setGain(float g) { gain = Format::gainFromFloat(g); }
+
+    BiquadCascadeT<Format>& getOutputFilter() { return outputFilter; }
+
+    inline bool needsInput() const { return resampler.needsInput(); }
+    inline void pushLevel(float level) { resampler.pushLevel(level); }
+
+    /**
+     * @brief Siguiente muestra antes de cuantizar (fracción de fondo de escala)
+     */
+    inline sample_t nextSample() {
+        return Format::applyGain(outputFilter.process(resampler.nextSample()), gain);
+    }
+
+    inline uint8_t nextOutput() { return Format::toCode(nextSample()); }
+
+    uint16_t getInterpolation() const { return resampler.getInterpolation(); }
+    uint16_t getDecimation() const { return resampler.getDecimation(); }
+
+private:
+    PolyphaseResamplerT<Format> resampler;
+    BiquadCascadeT<Format> outputFilter;
+    typename Format::gain_t gain;
+};
+
+// Instancia del motor según DAC_PIPELINE_FIXED_POINT
+#if DAC_PIPELINE_FIXED_POINT
+typedef DACPipelineT<Q15Format> DACPipeline;
+#else
+typedef DACPipelineT<FloatFormat> DACPipeline;
+#endif
+
+#endif // DAC_PIPELINE_H
@@ -20,6 +20,8 @@
  * - Estructura biquad IIR Direct Form II Transposed (estabilidad numérica)
  * - Coeficientes precalculados para frecuencias de muestreo comunes
  * - Optimizado para ESP32 (punto flotante de precisión simple)
+ * - BiquadCascade: secciones en cascada con estado contiguo y procesamiento
+ *   por bloques (esp-dsp dsps_biquad_f32_ae32 en ESP32, bucle genérico en host)
  */
 
 #ifndef DIGITAL_FILTERS_H
@@ -27,6 +29,14 @@
 
 #include <Arduino.h>
 
+// Kernels ensamblador Xtensa de esp-dsp (si el componente está disponible)
+#if defined(ESP32) && __has_include(<dsps_biquad.h>)
+#include <dsps_biquad.h>
+#define BIQUAD_USE_ESP_DSP 1
+#else
+#define BIQUAD_USE_ESP_DSP 0
+#endif
+
 // ============================================================================
 // CONSTANTES DE FILTRADO
 // ============================================================================
@@ -47,6 +57,10 @@
 #define EMG_HIGHPASS_FC  20.0f     // Hz - elimina artefactos movimiento
 #define EMG_LOWPASS_FC   450.0f    // Hz - contenido EMG útil
 
+// Cascada de biquads
+#define BIQUAD_CASCADE_MAX_SECTIONS  4    // HP + LP + Notch (+1 libre)
+#define BIQUAD_COEFFS_PER_SECTION    5    // b0, b1, b2, a1, a2
+
 // ============================================================================
 // ESTRUCTURA BIQUAD (Second-Order Section)
 // ============================================================================
@@ -84,6 +98,76 @@ struct BiquadSection {
     }
 };
 
+// ============================================================================
+// CLASE BiquadCascade - SECCIONES EN CASCADA CON PROCESAMIENTO POR BLOQUES
+// ============================================================================
+/**
+ * @brief Cascada de hasta BIQUAD_CASCADE_MAX_SECTIONS secciones biquad
+ *
+ * Coeficientes y estados en arrays contiguos con el layout de esp-dsp:
+ *   coeffs[5*k .. 5*k+4] = {b0, b1, b2, a1, a2}   (a0 = 1, mismo signo que BiquadSection)
+ *   state [2*k .. 2*k+1] = {w1, w2}
+ *
+ * processBlock() recorre el bloque completo:
+ * - ESP32 con esp-dsp: sección por sección con dsps_biquad_f32_ae32
+ *   (Direct Form II, ensamblador Xtensa)
+ * - Host / sin esp-dsp: Direct Form II Transposed en C, muestra a muestra por
+ *   toda la cascada (nunca más lento que process() en bucle)
+ *
+ * process() usa la misma forma que processBlock() en cada plataforma, de modo
+ * que se pueden mezclar llamadas por muestra y por bloque sobre el mismo estado.
+ */
+class BiquadCascade {
+private:
+    float coeffs[BIQUAD_CASCADE_MAX_SECTIONS * BIQUAD_COEFFS_PER_SECTION];
+    float state[BIQUAD_CASCADE_MAX_SECTIONS * 2];
+    int numSections;
+
+    static inline float processSection(float input, const float* c, float* w) {
+#if BIQUAD_USE_ESP_DSP
+        // Direct Form II (misma forma y estado que dsps_biquad_f32)
+        float d0 = input - c[3] * w[0] - c[4] * w[1];
+        float output = c[0] * d0 + c[1] * w[0] + c[2] * w[1];
+        w[1] = w[0];
+        w[0] = d0;
+        return output;
+#else
+        // Direct Form II Transposed
+        float output = c[0] * input + w[0];
+        w[0] = c[1] * input - c[3] * output + w[1];
+        w[1] = c[2] * input - c[4] * output;
+        return output;
+#endif
+    }
+
+public:
+    BiquadCascade();
+
+    // Configuración
+    void setSection(int section, float b0, float b1, float b2, float a1, float a2);
+    void setSection(int section, const float* sectionCoeffs);   // {b0, b1, b2, a1, a2}
+    void setSection(int section, const BiquadSection& biquad);
+    void setNumSections(int n);
+    void clear() { numSections = 0; }
+    int getNumSections() const { return numSections; }
+
+    // Procesar una muestra
+    inline float process(float input) {
+        float output = input;
+        for (int k = 0; k < numSections; k++) {
+            output = processSection(output, &coeffs[k * BIQUAD_COEFFS_PER_SECTION], &state[k * 2]);
+        }
+        return output;
+    }
+
+    /**
+     * @brief Procesa n muestras; in y out pueden ser el mismo buffer
+     */
+    void processBlock(const float* in, float* out, size_t n);
+
+    void reset();
+};
+
 // ============================================================================
 // CLASE DigitalFilter - FILTRO BIQUAD GENÉRICO
 // ============================================================================
@@ -155,6 +239,7 @@ public:
     // Getters
     float getCenterFreq() const { return centerFreq; }
     float getQFactor() const { return qFactor; }
+    const BiquadSection& getSection() const { return biquad; }
 };
 
 // ============================================================================
@@ -191,6 +276,7 @@ public:
     
     // Getters
     float getCutoffFreq() const { return cutoffFreq; }
+    const BiquadSection& getSection() const { return biquad; }
 };
 
 // ============================================================================
@@ -227,6 +313,7 @@ public:
     
     // Getters
     float getCutoffFreq() const { return cutoffFreq; }
+    const BiquadSection& getSection() const { return biquad; }
 };
 
 // ============================================================================
@@ -278,6 +365,9 @@ public:
  *   Input → Highpass → Lowpass → Notch → Output
  * 
  * Configurable para ECG, PPG o EMG con presets.
+ *
+ * Las secciones habilitadas se copian a una BiquadCascade cada vez que cambia
+ * la configuración; process()/processBlock() solo recorren la cascada.
  */
 class SignalFilterChain {
 public:
@@ -291,6 +381,7 @@ private:
     HighpassFilter highpass;
     LowpassFilter lowpass;
     NotchFilter notch;
+    BiquadCascade cascade;              // Secciones habilitadas HP → LP → Notch
     
     SignalType signalType;
     float sampleRate;
@@ -318,8 +409,12 @@ public:
     
     // Procesamiento
     float process(float input);
+    void processBlock(const float* in, float* out, size_t n);
     void reset();
     
+    // Recalcula la cascada (llamar tras modificar filtros vía getHighpass() etc.)
+    void rebuildCascade();
+    
     // Estado
     bool isFilteringEnabled() const { return filteringEnabled; }
     void setFilteringEnabled(bool en) { filteringEnabled = en; }
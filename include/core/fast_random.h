@@ -0,0 +1,134 @@
+/**
+ * @file fast_random.h
+ * @brief Generador pseudoaleatorio determinista compartido por los modelos
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ *
+ * Sustituye a los Box-Muller propios de ECG/EMG/PPG (bucle de rechazo,
+ * logf/sqrtf y esp_random() hardware por cada muestra):
+ *
+ * - Uniforme: xoshiro128** (Blackman & Vigna 2018). Solo operaciones de
+ *   32 bits (sin multiplicación de 64 bits en el ESP32), periodo 2^128-1
+ * - Normal: ziggurat de Marsaglia & Tsang (2000), 128 capas con tablas
+ *   constantes. ~98.8% de las muestras salen con 1 entero, 1 comparación y
+ *   1 multiplicación; solo la cola y los bordes de capa llaman a expf/logf
+ * - Semilla explícita por instancia (splitmix32): misma semilla → misma
+ *   secuencia bit a bit en el ESP32 y en el build nativo
+ *
+ * USO:
+ *   FastRandom rng(RNG_SEED_EMG);
+ *   float n = rng.gaussian(0.0f, sigma);
+ *   rng.fillGaussian(buffer, 64, 0.0f, 1.0f);
+ *
+ * REFERENCIAS:
+ * [1] Marsaglia G, Tsang WW. "The Ziggurat Method for Generating Random
+ *     Variables." J Stat Softw. 2000;5(8).
+ * [2] Blackman D, Vigna S. "Scrambled Linear Pseudorandom Number
+ *     Generators." ACM Trans Math Softw. 2021;47(4).
+ */
+
+#ifndef FAST_RANDOM_H
+#define FAST_RANDOM_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// CONFIGURACIÓN
+// ============================================================================
+#define FAST_RANDOM_ZIGGURAT_LAYERS 128
+#define FAST_RANDOM_DEFAULT_SEED    0x2545F491UL
+
+// ============================================================================
+// CLASE FastRandom
+// ============================================================================
+class FastRandom {
+public:
+    explicit FastRandom(uint32_t initialSeed = FAST_RANDOM_DEFAULT_SEED);
+
+    /**
+     * @brief Reinicia la secuencia a partir de una semilla de 32 bits
+     */
+    void seed(uint32_t value);
+    uint32_t getSeed() const { return seedValue; }
+
+    // ========================================================================
+    // UNIFORME
+    // ========================================================================
+
+    /**
+     * @brief Siguiente entero de 32 bits (xoshiro128**)
+     */
+    inline uint32_t nextU32() {
+        const uint32_t result = rotl(s[1] * 5, 7) * 9;
+        const uint32_t t = s[1] << 9;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 11);
+        return result;
+    }
+
+    /**
+     * @brief Uniforme en [0, 1) con 24 bits de mantisa
+     */
+    inline float uniform() {
+        return (float)(nextU32() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    inline float uniform(float lo, float hi) {
+        return lo + (hi - lo) * uniform();
+    }
+
+    /**
+     * @brief Entero uniforme en [0, n) (multiplicación, sin módulo)
+     */
+    inline uint32_t below(uint32_t n) {
+        return (uint32_t)(((uint64_t)nextU32() * n) >> 32);
+    }
+
+    // ========================================================================
+    // NORMAL (ziggurat)
+    // ========================================================================
+
+    /**
+     * @brief Muestra N(0, 1)
+     */
+    inline float gaussian() {
+        int32_t hz = (int32_t)nextU32();
+        uint32_t iz = (uint32_t)hz & (FAST_RANDOM_ZIGGURAT_LAYERS - 1);
+        uint32_t ahz = (hz < 0) ? (uint32_t)(-(int64_t)hz) : (uint32_t)hz;
+        if (ahz < zigKn[iz]) {
+            return (float)hz * zigWn[iz];   // Dentro del rectángulo de la capa
+        }
+        return gaussianSlow(hz, iz);
+    }
+
+    inline float gaussian(float mean, float std) {
+        return mean + std * gaussian();
+    }
+
+    // ========================================================================
+    // BLOQUES
+    // ========================================================================
+    void fillUniform(float* out, size_t n);
+    void fillGaussian(float* out, size_t n, float mean, float std);
+
+private:
+    uint32_t s[4];
+    uint32_t seedValue;
+
+    static inline uint32_t rotl(uint32_t x, int k) {
+        return (x << k) | (x >> (32 - k));
+    }
+
+    float gaussianSlow(int32_t hz, uint32_t iz);   // Cola y bordes de capa
+
+    // Tablas del ziggurat: constantes precalculadas (idénticas en host y ESP32)
+    static const uint32_t zigKn[FAST_RANDOM_ZIGGURAT_LAYERS];
+    static const float zigWn[FAST_RANDOM_ZIGGURAT_LAYERS];
+    static const float zigFn[FAST_RANDOM_ZIGGURAT_LAYERS];
+};
+
+#endif // FAST_RANDOM_H
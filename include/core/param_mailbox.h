@@ -0,0 +1,99 @@
+/**
+ * @file param_mailbox.h
+ * @brief Buzón de parámetros entre cores (seqlock con doble buffer)
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ *
+ * La UI (loop, Core 0) publica instantáneas completas de ECGParameters /
+ * EMGParameters / PPGParameters; la tarea de generación (Core 1) las adopta
+ * en una frontera de bloque o de latido. Sustituye a escribir campos del
+ * modelo (noiseLevel, pendingParams, hasPendingParams...) desde otro core
+ * mientras se genera una muestra.
+ *
+ *   UI / WebServer (Core 0) ──► publish() ──► ParamMailbox ──► take() ──► modelo (Core 1)
+ *
+ * DISEÑO:
+ * - Contador de secuencia: impar mientras el escritor copia, par al terminar
+ *   (la publicación k queda en slots[k & 1] con seq = 2k)
+ * - Doble buffer: el escritor siempre escribe el slot que NO está publicado,
+ *   así una publicación durante la lectura no rompe la copia; solo se
+ *   reintenta si el escritor empezó una segunda (seq avanzó más de 2)
+ * - take() nunca bloquea ni espera: si la copia no es válida devuelve false
+ *   y se vuelve a intentar en la siguiente frontera
+ * - Sin lecturas repetidas: el lector recuerda la última secuencia adoptada
+ *
+ * RESTRICCIONES:
+ * - Un escritor a la vez (SignalEngine publica con signalMutex tomado)
+ * - Un solo lector (la tarea de generación)
+ * - T debe ser trivialmente copiable
+ */
+
+#ifndef PARAM_MAILBOX_H
+#define PARAM_MAILBOX_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <type_traits>
+
+// ============================================================================
+// PLANTILLA ParamMailbox
+// ============================================================================
+template <typename T>
+class ParamMailbox {
+    static_assert(std::is_trivially_copyable<T>::value, "ParamMailbox: T debe ser trivialmente copiable");
+
+public:
+    ParamMailbox() : seq(0), readSeq(0) {}
+
+    // ========================================================================
+    // ESCRITOR
+    // ========================================================================
+
+    /**
+     * @brief Publica una instantánea completa (sustituye a la anterior)
+     */
+    void publish(const T& value) {
+        uint32_t s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);            // Impar: escribiendo
+        std::atomic_thread_fence(std::memory_order_release);
+        slots[((s >> 1) + 1) & 1] = value;
+        seq.store(s + 2, std::memory_order_release);            // Par: publicada
+    }
+
+    // ========================================================================
+    // LECTOR
+    // ========================================================================
+
+    /**
+     * @brief Copia la última instantánea si es nueva y no está rota
+     * @return true si out contiene una instantánea nueva completa
+     */
+    bool take(T& out) {
+        uint32_t s1 = seq.load(std::memory_order_acquire) & ~1u;    // Última completa
+        if (s1 == readSeq) {
+            return false;
+        }
+        out = slots[(s1 >> 1) & 1];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint32_t s2 = seq.load(std::memory_order_relaxed);
+        if (s2 - s1 > 2) {
+            return false;   // El escritor volvió a este slot: siguiente frontera
+        }
+        readSeq = s1;
+        return true;
+    }
+
+    /**
+     * @brief Descarta lo publicado hasta ahora (lado lector, p.ej. tras reset)
+     */
+    void discard() {
+        readSeq = seq.load(std::memory_order_acquire) & ~1u;
+    }
+
+private:
+    std::atomic<uint32_t> seq;
+    uint32_t readSeq;           // Solo lector
+    T slots[2];
+};
+
+#endif // PARAM_MAILBOX_H
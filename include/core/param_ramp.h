@@ -0,0 +1,159 @@
+/**
+ * @file param_ramp.h
+ * @brief Rampas de parámetros Tipo A sin escalones en la salida
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ *
+ * Un cambio instantáneo de amplitud, ruido o ganancia pone un escalón en la
+ * salida BNC que el monitor bajo prueba marca como artefacto. ParamRamp lleva
+ * cada parámetro de su valor actual al objetivo con una rampa lineal o
+ * exponencial de duración configurable.
+ *
+ *   setTarget()  (frontera de bloque, al adoptar la instantánea de la UI)
+ *   beginBlock() (una vez por bloque: valor al final del bloque)
+ *   next()       (por muestra: una suma, interpolación lineal dentro del bloque)
+ *
+ * La ley de la rampa (pendiente o expf) se evalúa solo en beginBlock(); la
+ * exponencial queda aproximada por tramos rectos de un bloque, sin saltos.
+ *
+ * Todo el estado es del lado de la tarea de generación (Core 1).
+ */
+
+#ifndef PARAM_RAMP_H
+#define PARAM_RAMP_H
+
+#include <Arduino.h>
+#include <math.h>
+#include "config.h"
+
+// ============================================================================
+// CONFIGURACIÓN
+// ============================================================================
+#define PARAM_RAMP_EXP_TAUS         5.0f    // Exponencial: duración = 5τ (99.3%)
+#define PARAM_RAMP_SNAP_FRACTION    0.01f   // Exponencial: fija el objetivo al 1% del salto
+
+enum class RampShape : uint8_t {
+    LINEAR = 0,         // Pendiente constante: llega justo en la duración
+    EXPONENTIAL = 1     // Primer orden: rápido al inicio, cola suave
+};
+
+struct RampConfig {
+    RampShape shape;
+    float duration;     // s (0 = escalón en la siguiente frontera de bloque)
+
+    RampConfig()
+        : shape((RampShape)PARAM_RAMP_DEFAULT_SHAPE)
+        , duration(PARAM_RAMP_DEFAULT_MS / 1000.0f) {}
+};
+
+// ============================================================================
+// CLASE ParamRamp
+// ============================================================================
+class ParamRamp {
+public:
+    ParamRamp() : duration(0.0f), shape(RampShape::LINEAR) { reset(0.0f); }
+
+    /**
+     * @brief Fija el valor sin rampa (setParameters, reset)
+     */
+    void reset(float v) {
+        value = v;
+        target = v;
+        blockEnd = v;
+        step = 0.0f;
+        rate = 0.0f;
+        snap = 0.0f;
+        stepsLeft = 0;
+        active = false;
+    }
+
+    /**
+     * @brief Nuevo objetivo; la rampa arranca en el siguiente beginBlock()
+     */
+    void setTarget(float t, const RampConfig& config) {
+        if (t == target) return;
+        target = t;
+        shape = config.shape;
+        duration = config.duration;
+        float span = fabsf(target - value);
+        rate = (duration > 0.0f) ? span / duration : 0.0f;              // Lineal: unidades/s
+        snap = span * PARAM_RAMP_SNAP_FRACTION;
+        active = (span > 0.0f);
+    }
+
+    /**
+     * @brief Calcula el valor al final del bloque y el paso por muestra
+     * @param n Muestras del bloque
+     * @param blockTime Duración del bloque (s)
+     * @return true si la rampa estaba en curso (el modelo debe copiar getValue())
+     */
+    bool beginBlock(size_t n, float blockTime) {
+        bool wasActive = active || stepsLeft > 0;
+        settle();
+        if (!active || n == 0) {
+            step = 0.0f;
+            stepsLeft = 0;
+            return wasActive;
+        }
+
+        if (duration <= 0.0f) {
+            // Escalón: aplicado en la frontera, sin interpolar
+            reset(target);
+            return true;
+        }
+
+        float end;
+        if (shape == RampShape::EXPONENTIAL) {
+            float tau = duration / PARAM_RAMP_EXP_TAUS;
+            end = target + (value - target) * expf(-blockTime / tau);
+            if (fabsf(end - target) <= snap) end = target;
+        } else {
+            float delta = rate * blockTime;
+            end = (fabsf(target - value) <= delta) ? target
+                : value + ((target > value) ? delta : -delta);
+        }
+
+        blockEnd = end;
+        step = (end - value) / (float)n;
+        stepsLeft = (uint16_t)n;
+        return true;
+    }
+
+    /**
+     * @brief Valor para la siguiente muestra del bloque
+     */
+    inline float next() {
+        if (stepsLeft > 0) {
+            stepsLeft--;
+            value = (stepsLeft == 0) ? blockEnd : value + step;
+        }
+        return value;
+    }
+
+    float getValue() const { return value; }
+    float getTarget() const { return target; }
+    bool isActive() const { return active || stepsLeft > 0; }
+
+private:
+    float value;        // Valor de la última muestra
+    float target;
+    float blockEnd;     // Valor al final del bloque en curso
+    float step;         // Incremento por muestra dentro del bloque
+    float rate;         // Lineal: pendiente (unidades/s)
+    float snap;         // Exponencial: distancia a la que se fija el objetivo
+    float duration;
+    RampShape shape;
+    uint16_t stepsLeft;
+    bool active;        // Aún no alcanzó el objetivo
+
+    // Cierra el bloque anterior aunque no se hayan pedido todas sus muestras
+    void settle() {
+        if (stepsLeft > 0) {
+            value = blockEnd;
+            stepsLeft = 0;
+        }
+        if (value == target) active = false;
+    }
+};
+
+#endif // PARAM_RAMP_H
@@ -0,0 +1,202 @@
+/**
+ * @file perf_counters.h
+ * @brief Contadores de ciclos por etapa, histogramas y marcas de llenado
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ *
+ * Mide con CCOUNT (ESP.getCycleCount(), un registro del Xtensa) lo que cuesta
+ * cada etapa del camino de la señal:
+ *
+ *   MODEL_TICK     generateModelBlock()            (Core 1, por bloque de modelo)
+ *   INTERPOLATION  DACPipeline: remuestreo polifásico + ganancia + cuantizar
+ *                                                  (Core 1, por bloque de salida)
+ *   FILTER         filtros de los modelos: envolvente EMG por bloques
+ *                  (Core 1, por tramo filtrado; incluido en MODEL_TICK)
+ *   RING_PUSH      rings display/WS                (Core 1, por bloque de salida)
+ *   SINK_WRITE     outputSink->write(), incluye la espera de I2S_WRITE_TIMEOUT
+ *                                                  (Core 1, por bloque de salida)
+ *   NEXTION_SEND   addt / add por UART             (loop, por envío)
+ *   WS_SERIALIZE   frame binario y JSON de métricas (WSStream, por mensaje)
+ *
+ * Cada etapa guarda cuenta, total, mínimo, máximo y un histograma log2 de
+ * PERF_HIST_BUCKETS cubos. Los buffers (sink, ring display, ring WS) guardan
+ * su nivel mínimo y máximo desde el último reset.
+ *
+ * CONCURRENCIA:
+ * - Un solo escritor por etapa/buffer (la tarea indicada arriba, fija a su core:
+ *   CCOUNT es por core y no se compara entre cores)
+ * - Los lectores (serie, /api/perf) copian sin bloquear: una copia puede
+ *   mezclar dos registros consecutivos, aceptable para diagnóstico
+ * - requestReset() sube una época; cada escritor limpia su etapa al ver la
+ *   nueva época en su siguiente registro (nunca se escribe desde dos cores)
+ *
+ * Con PERF_COUNTERS_ENABLED = 0 (config.h) las macros PERF_* no generan código.
+ */
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+
+// ============================================================================
+// CONFIGURACIÓN
+// ============================================================================
+#define PERF_HIST_BUCKETS       20      // Cubos log2 del histograma
+#define PERF_HIST_MIN_SHIFT     5       // Cubo 0: < 32 ciclos; cubo k: [2^(k+4), 2^(k+5))
+
+enum class PerfStage : uint8_t {
+    MODEL_TICK = 0,
+    INTERPOLATION,
+    FILTER,
+    RING_PUSH,
+    SINK_WRITE,
+    NEXTION_SEND,
+    WS_SERIALIZE,
+    COUNT
+};
+
+enum class PerfBuffer : uint8_t {
+    OUTPUT_SINK = 0,    // Muestras en cola del DAC antes de rellenar
+    DISPLAY_RING,       // Puntos pendientes para la Nextion
+    WS_RING,            // Muestras pendientes para el WebSocket
+    COUNT
+};
+
+#define PERF_STAGE_COUNT    ((uint8_t)PerfStage::COUNT)
+#define PERF_BUFFER_COUNT   ((uint8_t)PerfBuffer::COUNT)
+
+struct PerfStageStats {
+    uint32_t count;
+    uint64_t totalCycles;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint32_t lastCycles;
+    uint32_t histogram[PERF_HIST_BUCKETS];
+};
+
+struct PerfWatermark {
+    uint32_t samples;       // Lecturas de nivel desde el reset
+    uint16_t minLevel;
+    uint16_t maxLevel;
+    uint16_t lastLevel;
+    uint16_t capacity;
+};
+
+/**
+ * @brief Ciclos de CPU del core actual (CCOUNT)
+ */
+static inline uint32_t perfCycles() {
+    return ESP.getCycleCount();
+}
+
+// ============================================================================
+// CLASE PerfCounters
+// ============================================================================
+class PerfCounters {
+public:
+    PerfCounters();
+
+    /**
+     * @brief Registra una medida de la etapa (solo su tarea escritora)
+     */
+    inline void record(PerfStage stage, uint32_t cycles) {
+        StageSlot& s = stages[(uint8_t)stage];
+        uint32_t epoch = resetEpoch.load(std::memory_order_relaxed);
+        if (s.epoch != epoch) clearStage(s, epoch);
+
+        s.stats.count++;
+        s.stats.totalCycles += cycles;
+        if (cycles < s.stats.minCycles) s.stats.minCycles = cycles;
+        if (cycles > s.stats.maxCycles) s.stats.maxCycles = cycles;
+        s.stats.lastCycles = cycles;
+        s.stats.histogram[bucketOf(cycles)]++;
+    }
+
+    /**
+     * @brief Registra el nivel actual de un buffer (solo su tarea escritora)
+     */
+    inline void watermark(PerfBuffer buffer, uint16_t level, uint16_t capacity) {
+        BufferSlot& b = buffers[(uint8_t)buffer];
+        uint32_t epoch = resetEpoch.load(std::memory_order_relaxed);
+        if (b.epoch != epoch) clearBuffer(b, epoch);
+
+        b.mark.samples++;
+        if (level < b.mark.minLevel) b.mark.minLevel = level;
+        if (level > b.mark.maxLevel) b.mark.maxLevel = level;
+        b.mark.lastLevel = level;
+        b.mark.capacity = capacity;
+    }
+
+    /**
+     * @brief Pide limpiar todo (cualquier tarea); lo aplica cada escritor
+     */
+    void requestReset();
+
+    /**
+     * @brief Copia de la etapa (vacía si su escritor aún no vio el reset)
+     */
+    PerfStageStats getStage(PerfStage stage) const;
+    PerfWatermark getWatermark(PerfBuffer buffer) const;
+
+    /**
+     * @brief Imprime la tabla de etapas, histogramas y marcas
+     * @param out Puerto de salida (el del comando serie que lo pide)
+     */
+    void printReport(HardwareSerial& out) const;
+
+    static const char* getStageName(PerfStage stage);
+    static const char* getBufferName(PerfBuffer buffer);
+
+    /**
+     * @brief Límite superior (exclusivo) del cubo en ciclos (0 = sin límite)
+     */
+    static uint32_t getBucketLimit(uint8_t bucket);
+
+    static inline uint8_t bucketOf(uint32_t cycles) {
+        if (cycles < (1u << PERF_HIST_MIN_SHIFT)) return 0;
+        uint8_t b = (uint8_t)(31 - __builtin_clz(cycles)) - (PERF_HIST_MIN_SHIFT - 1);
+        return b < PERF_HIST_BUCKETS ? b : PERF_HIST_BUCKETS - 1;
+    }
+
+private:
+    struct StageSlot {
+        PerfStageStats stats;
+        uint32_t epoch;
+    };
+    struct BufferSlot {
+        PerfWatermark mark;
+        uint32_t epoch;
+    };
+
+    StageSlot stages[PERF_STAGE_COUNT];
+    BufferSlot buffers[PERF_BUFFER_COUNT];
+    std::atomic<uint32_t> resetEpoch;
+
+    static void clearStage(StageSlot& s, uint32_t epoch);
+    static void clearBuffer(BufferSlot& b, uint32_t epoch);
+};
+
+extern PerfCounters perfCounters;
+
+// ============================================================================
+// MACROS DE INSTRUMENTACIÓN (sin código con PERF_COUNTERS_ENABLED = 0)
+// ============================================================================
+#if PERF_COUNTERS_ENABLED
+#define PERF_BEGIN(var)                     uint32_t var = perfCycles()
+#define PERF_END(stage, var)                perfCounters.record(PerfStage::stage, perfCycles() - (var))
+#define PERF_ACCUM_DECLARE(acc)             uint32_t acc = 0
+#define PERF_ACCUM(acc, var)                (acc) += perfCycles() - (var)
+#define PERF_RECORD(stage, cycles)          perfCounters.record(PerfStage::stage, (cycles))
+#define PERF_WATERMARK(buffer, level, cap)  perfCounters.watermark(PerfBuffer::buffer, (level), (cap))
+#else
+#define PERF_BEGIN(var)
+#define PERF_END(stage, var)
+#define PERF_ACCUM_DECLARE(acc)
+#define PERF_ACCUM(acc, var)
+#define PERF_RECORD(stage, cycles)
+#define PERF_WATERMARK(buffer, level, cap)
+#endif
+
+#endif // PERF_COUNTERS_H
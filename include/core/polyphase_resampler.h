@@ -0,0 +1,217 @@
+/**
+ * @file polyphase_resampler.h
+ * @brief Remuestreador polifásico racional L/M (modelo → Fs_timer)
+ * @version 1.1.0
+ * @date 20 Enero 2026
+ *
+ * Sustituye a la interpolación lineal con ratio entero (UPSAMPLE_RATIO_*):
+ * 2000/300 se truncaba a 6 y la salida del ECG quedaba estirada a 1800 Hz.
+ *
+ *   Fs_out / Fs_in = L / M   (reducido por MCD: ECG 2000/300 → 20/3)
+ *
+ * FUNCIONAMIENTO:
+ * - Prototipo FIR paso bajo (sinc con ventana de Blackman) de L×TAPS
+ *   coeficientes, fc = Fs/2 del lado más lento, repartido en L fases
+ * - Cada fase normalizada a ganancia DC exacta (sin rizado de nivel)
+ * - Plantilla sobre el formato de muestra (core/sample_format.h):
+ *   Q15Format → coeficientes e historial Q15, acumulador int32
+ *   FloatFormat → misma estructura en float (referencia)
+ * - Avance por contador de muestras (fase += M por salida), nunca por
+ *   micros(): la salida es bit-exacta y reproducible
+ *
+ * USO:
+ *   resampler.configure(MODEL_SAMPLE_RATE_ECG, FS_TIMER_HZ);
+ *   resampler.reset(DAC_CENTER_VALUE);
+ *   for (...) {
+ *       while (resampler.needsInput()) resampler.pushInput(modelo());
+ *       out[i] = resampler.nextOutput();
+ *   }
+ *
+ * Si L > RESAMPLER_MAX_PHASES la fase se cuantiza a la tabla (la cuenta
+ * L/M sigue siendo exacta, solo se redondea el retardo fraccional).
+ */
+
+#ifndef POLYPHASE_RESAMPLER_H
+#define POLYPHASE_RESAMPLER_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "core/sample_format.h"
+
+// ============================================================================
+// CONFIGURACIÓN
+// ============================================================================
+#define RESAMPLER_TAPS_PER_PHASE    8       // Taps por fase (retardo = 4 muestras de entrada)
+#define RESAMPLER_MAX_PHASES        64      // Fases máximas en tabla (64×8×2 = 1 KB en Q15)
+#define RESAMPLER_CUTOFF_FACTOR     0.9f    // fc = 0.9 × Nyquist del lado lento
+
+// ============================================================================
+// DISEÑO DEL PROTOTIPO (común a todos los formatos, polyphase_resampler.cpp)
+// ============================================================================
+struct PolyphaseDesign {
+    uint16_t interp;        // L
+    uint16_t decim;         // M
+    uint16_t tablePhases;   // min(L, RESAMPLER_MAX_PHASES)
+    float cutoff;           // fc relativa a Fs_proto = tablePhases × Fs_in
+};
+
+/**
+ * @brief Reduce fsOut/fsIn a L/M y calcula el corte del prototipo
+ * @return false si alguna frecuencia es 0 o L/M no cabe en 16 bits
+ */
+bool polyphaseDesign(uint32_t fsIn, uint32_t fsOut, PolyphaseDesign& design);
+
+/**
+ * @brief Taps float de la fase p, normalizados a ganancia DC 1
+ */
+void polyphaseDesignPhase(const PolyphaseDesign& design, uint16_t p,
+                          float taps[RESAMPLER_TAPS_PER_PHASE]);
+
+// ============================================================================
+// CLASE PolyphaseResamplerT
+// ============================================================================
+template <typename Format>
+class PolyphaseResamplerT {
+public:
+    typedef typename Format::sample_t sample_t;
+    typedef typename Format::coeff_t coeff_t;
+    typedef typename Format::acc_t acc_t;
+
+    PolyphaseResamplerT()
+        : interp(1)
+        , decim(1)
+        , tablePhases(1)
+        , phase(0)
+        , tablePhase(0)
+        , pendingInputs(1)
+        , historyPos(0)
+    {
+        for (uint16_t i = 0; i < RESAMPLER_MAX_PHASES * RESAMPLER_TAPS_PER_PHASE; i++) {
+            coeffs[i] = Format::coeffFromFloat(0.0f);
+        }
+        coeffs[0] = Format::coeffFromFloat(1.0f);
+        reset(DAC_CENTER_VALUE);
+    }
+
+    /**
+     * @brief Calcula L/M y la tabla de coeficientes
+     * @param fsIn Frecuencia del modelo (Hz)
+     * @param fsOut Frecuencia de salida (Hz, normalmente FS_TIMER_HZ)
+     * @return false si alguna frecuencia es 0
+     */
+    bool configure(uint32_t fsIn, uint32_t fsOut) {
+        PolyphaseDesign design;
+        if (!polyphaseDesign(fsIn, fsOut, design)) {
+            return false;
+        }
+        interp = design.interp;
+        decim = design.decim;
+        tablePhases = design.tablePhases;
+
+        for (uint16_t p = 0; p < tablePhases; p++) {
+            float taps[RESAMPLER_TAPS_PER_PHASE];
+            polyphaseDesignPhase(design, p, taps);
+            coeff_t* row = &coeffs[p * RESAMPLER_TAPS_PER_PHASE];
+            for (uint8_t k = 0; k < RESAMPLER_TAPS_PER_PHASE; k++) {
+                row[k] = Format::coeffFromFloat(taps[k]);
+            }
+            Format::fixRowGain(row, RESAMPLER_TAPS_PER_PHASE);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Llena el historial con un nivel constante y reinicia la fase
+     */
+    void reset(uint8_t fillValue) {
+        sample_t x = codeToSample(fillValue);
+        for (uint8_t i = 0; i < 2 * RESAMPLER_TAPS_PER_PHASE; i++) {
+            history[i] = x;
+        }
+        historyPos = 0;
+        phase = 0;
+        tablePhase = 0;
+        pendingInputs = 1;   // La primera salida usa la primera muestra del modelo
+    }
+
+    /**
+     * @brief true si hay que entregar una muestra de entrada antes de nextOutput()
+     */
+    inline bool needsInput() const { return pendingInputs > 0; }
+
+    /**
+     * @brief Entrega una muestra del modelo en el formato del pipeline
+     */
+    inline void pushSample(sample_t x) {
+        historyPos = (historyPos == 0) ? (RESAMPLER_TAPS_PER_PHASE - 1) : (historyPos - 1);
+        history[historyPos] = x;
+        history[historyPos + RESAMPLER_TAPS_PER_PHASE] = x;
+        pendingInputs--;
+    }
+
+    /**
+     * @brief Entrega una muestra del modelo (código DAC 0-255)
+     */
+    inline void pushInput(uint8_t code) { pushSample(codeToSample(code)); }
+
+    /**
+     * @brief Entrega una muestra como nivel DAC continuo (0-255 sin cuantizar)
+     */
+    inline void pushLevel(float level) {
+        pushSample(Format::fromFloat((level - (float)DAC_CENTER_VALUE) * (1.0f / DAC_CENTER_VALUE)));
+    }
+
+    /**
+     * @brief Calcula la siguiente muestra de salida en el formato del pipeline
+     * @note Solo válido con needsInput() == false
+     */
+    inline sample_t nextSample() {
+        const coeff_t* h = &coeffs[tablePhase * RESAMPLER_TAPS_PER_PHASE];
+        const sample_t* x = &history[historyPos];  // x[0] = más reciente
+
+        acc_t acc = Format::accZero();
+        for (uint8_t k = 0; k < RESAMPLER_TAPS_PER_PHASE; k++) {
+            acc = Format::mac(acc, h[k], x[k]);
+        }
+
+        // Avance de fase: +M por salida, una entrada nueva por cada L
+        phase += decim;
+        while (phase >= interp) {
+            phase -= interp;
+            pendingInputs++;
+        }
+        tablePhase = (tablePhases == interp) ? phase
+                                             : (uint16_t)(((uint32_t)phase * tablePhases) / interp);
+        return Format::fromAcc(acc);
+    }
+
+    /**
+     * @brief Calcula la siguiente muestra de salida (código DAC 0-255)
+     */
+    inline uint8_t nextOutput() { return Format::toCode(nextSample()); }
+
+    uint16_t getInterpolation() const { return interp; }   // L
+    uint16_t getDecimation() const { return decim; }       // M
+    uint16_t getTablePhases() const { return tablePhases; }
+
+private:
+    uint16_t interp;        // L
+    uint16_t decim;         // M
+    uint16_t tablePhases;   // min(L, RESAMPLER_MAX_PHASES)
+    uint16_t phase;         // 0..L-1
+    uint16_t tablePhase;    // Fila de la tabla para la fase actual
+    uint16_t pendingInputs; // Entradas pendientes antes de la siguiente salida
+    uint8_t historyPos;
+
+    coeff_t coeffs[RESAMPLER_MAX_PHASES * RESAMPLER_TAPS_PER_PHASE];
+    sample_t history[2 * RESAMPLER_TAPS_PER_PHASE];    // Doble copia: lectura contigua
+
+    static inline sample_t codeToSample(uint8_t code) {
+        return Format::fromFloat(((float)code - (float)DAC_CENTER_VALUE) * (1.0f / DAC_CENTER_VALUE));
+    }
+};
+
+// Remuestreador por defecto: Q15 (igual que antes de la plantilla)
+typedef PolyphaseResamplerT<Q15Format> PolyphaseResampler;
+
+#endif // POLYPHASE_RESAMPLER_H
@@ -0,0 +1,160 @@
+/**
+ * @file sample_format.h
+ * @brief Formatos de muestra (float / Q15-Q31) para el pipeline post-modelo
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ *
+ * El DAC es de 8 bits: todo lo que va después del modelo (remuestreo,
+ * filtros de salida, ganancia, recorte y mapeo a código) se escribe una vez
+ * como plantilla sobre un formato, y el formato decide la aritmética:
+ *
+ *   FloatFormat: float de precisión simple (referencia, validación en host)
+ *   Q15Format:   muestras Q15, remuestreo Q15×Q15→Q30 (int32),
+ *                biquads Q31 con coeficientes Q2.30 y acumulador int64
+ *
+ * Convención común: una muestra es la fracción de fondo de escala del DAC
+ * respecto al centro, x ∈ [-1, 1)  ↔  código = 128 + 128·x
+ *
+ * Cada formato expone:
+ *   sample_t                  muestra del pipeline
+ *   coeff_t / acc_t           coeficiente y acumulador del FIR polifásico
+ *                             (fixRowGain: ganancia DC exacta de cada fase)
+ *   wide_t / bqcoeff_t / bqacc_t   estado, coeficiente y acumulador de biquad
+ *   gain_t                    ganancia de salida
+ */
+
+#ifndef SAMPLE_FORMAT_H
+#define SAMPLE_FORMAT_H
+
+#include <Arduino.h>
+#include <math.h>
+
+// ============================================================================
+// HELPERS DE SATURACIÓN
+// ============================================================================
+static inline int16_t saturateQ15(int32_t x) {
+    if (x > 32767) return 32767;
+    if (x < -32768) return -32768;
+    return (int16_t)x;
+}
+
+static inline int32_t saturateQ31(int64_t x) {
+    if (x > 2147483647LL) return 2147483647;
+    if (x < -2147483647LL - 1) return -2147483647 - 1;
+    return (int32_t)x;
+}
+
+static inline uint8_t clampDACCode(int32_t code) {
+    if (code < 0) return 0;
+    if (code > 255) return 255;
+    return (uint8_t)code;
+}
+
+// ============================================================================
+// FORMATO FLOAT
+// ============================================================================
+struct FloatFormat {
+    typedef float sample_t;
+    typedef float coeff_t;
+    typedef float acc_t;
+    typedef float wide_t;
+    typedef float bqcoeff_t;
+    typedef float bqacc_t;
+    typedef float gain_t;
+
+    static const bool IS_FIXED_POINT = false;
+
+    // Conversión desde/hacia float (fracción de fondo de escala)
+    static inline sample_t fromFloat(float x) {
+        return fminf(fmaxf(x, -1.0f), 1.0f);
+    }
+    static inline float toFloat(sample_t x) { return x; }
+
+    // Código DAC: redondeo al más cercano y recorte a 0-255
+    static inline uint8_t toCode(sample_t x) {
+        return clampDACCode((int32_t)floorf(128.0f + x * 128.0f + 0.5f));
+    }
+
+    // FIR polifásico
+    static inline coeff_t coeffFromFloat(float c) { return c; }
+    static inline void fixRowGain(coeff_t* row, uint8_t taps) { (void)row; (void)taps; }
+    static inline acc_t accZero() { return 0.0f; }
+    static inline acc_t mac(acc_t acc, coeff_t h, sample_t x) { return acc + h * x; }
+    static inline sample_t fromAcc(acc_t acc) { return fromFloat(acc); }
+
+    // Biquads
+    static inline bqcoeff_t bqCoeffFromFloat(float c) { return c; }
+    static inline wide_t toWide(sample_t x) { return x; }
+    static inline sample_t fromWide(wide_t x) { return fromFloat(x); }
+    static inline bqacc_t bqMul(bqcoeff_t c, wide_t x) { return c * x; }
+    static inline wide_t bqFromAcc(bqacc_t acc) { return acc; }
+
+    // Ganancia de salida
+    static inline gain_t gainFromFloat(float g) { return g; }
+    static inline sample_t applyGain(sample_t x, gain_t g) { return fromFloat(x * g); }
+};
+
+// ============================================================================
+// FORMATO PUNTO FIJO (Q15 muestras, Q31 biquads)
+// ============================================================================
+struct Q15Format {
+    typedef int16_t sample_t;       // Q15
+    typedef int16_t coeff_t;        // Q15
+    typedef int32_t acc_t;          // Q30 (Σ|h| < 2 por fase: sin desborde)
+    typedef int32_t wide_t;         // Q31
+    typedef int32_t bqcoeff_t;      // Q2.30 (|a1| < 2)
+    typedef int64_t bqacc_t;        // Q61
+    typedef int32_t gain_t;         // Q12 (0 a 8×)
+
+    static const bool IS_FIXED_POINT = true;
+
+    static inline sample_t fromFloat(float x) {
+        return saturateQ15((int32_t)lroundf(x * 32768.0f));
+    }
+    static inline float toFloat(sample_t x) { return (float)x * (1.0f / 32768.0f); }
+
+    // Q15 → código: 128 + x/256 con redondeo (8 bits superiores)
+    static inline uint8_t toCode(sample_t x) {
+        return clampDACCode(128 + (((int32_t)x + 128) >> 8));
+    }
+
+    static inline coeff_t coeffFromFloat(float c) {
+        return saturateQ15((int32_t)lroundf(c * 32768.0f));
+    }
+    // Residuo de cuantización al tap mayor: suma exacta 32768 (sin escalón DC)
+    static inline void fixRowGain(coeff_t* row, uint8_t taps) {
+        int32_t sum = 0;
+        uint8_t largest = 0;
+        for (uint8_t k = 0; k < taps; k++) {
+            sum += row[k];
+            if (abs(row[k]) > abs(row[largest])) largest = k;
+        }
+        row[largest] = saturateQ15((int32_t)row[largest] + (32768 - sum));
+    }
+    static inline acc_t accZero() { return (acc_t)1 << 14; }    // Redondeo de fromAcc
+    static inline acc_t mac(acc_t acc, coeff_t h, sample_t x) {
+        return acc + (int32_t)h * x;
+    }
+    static inline sample_t fromAcc(acc_t acc) { return saturateQ15(acc >> 15); }
+
+    static inline bqcoeff_t bqCoeffFromFloat(float c) {
+        return (bqcoeff_t)llroundf(c * 1073741824.0f);
+    }
+    static inline wide_t toWide(sample_t x) { return (wide_t)x << 16; }
+    static inline sample_t fromWide(wide_t x) {
+        return saturateQ15((int32_t)(((int64_t)x + 32768) >> 16));
+    }
+    static inline bqacc_t bqMul(bqcoeff_t c, wide_t x) { return (int64_t)c * x; }
+    static inline wide_t bqFromAcc(bqacc_t acc) {
+        return saturateQ31((acc + ((int64_t)1 << 29)) >> 30);
+    }
+
+    static inline gain_t gainFromFloat(float g) {
+        return (gain_t)lroundf(fminf(fmaxf(g, 0.0f), 7.99f) * 4096.0f);
+    }
+    static inline sample_t applyGain(sample_t x, gain_t g) {
+        return saturateQ15(((int32_t)x * g + 2048) >> 12);
+    }
+};
+
+#endif // SAMPLE_FORMAT_H
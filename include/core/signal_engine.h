@@ -4,7 +4,8 @@
  * @version 1.0.0
  * @date 18 Diciembre 2025
  * 
- * Gestiona la generación de señales con buffer circular y timer ISR.
+ * Gestiona la generación de señales y su salida al DAC a través de un
+ * OutputSink (I2S/DMA por defecto, timer ISR como fallback).
  */
 
 #ifndef SIGNAL_ENGINE_H
@@ -19,22 +20,39 @@
 #include "models/ecg_model.h"
 #include "models/emg_model.h"
 #include "models/ppg_model.h"
+#include "models/playback_model.h"
+#include "hw/output_sink.h"
+#include "core/param_mailbox.h"
+#include "core/param_ramp.h"
 
 // ============================================================================
 // ESTADÍSTICAS DE PERFORMANCE
 // ============================================================================
 struct PerformanceStats {
-    uint32_t isrCount;
-    uint32_t isrMaxTime;
+    uint32_t isrCount;          // Muestras entregadas al DAC
+    uint32_t isrMaxTime;        // Peor tiempo de servicio del sink (us)
     uint32_t bufferUnderruns;
     uint16_t bufferLevel;
     uint32_t freeHeap;
+    OutputSinkType sinkType;    // Salida DAC activa
+};
+
+// ============================================================================
+// BUFFER PARA DISPLAY NEXTION (muestras ya diezmadas con NEXTION_DOWNSAMPLE_*)
+// ============================================================================
+#define DISPLAY_SAMPLE_BUFFER_SIZE 256  // Potencia de 2 (256 puntos = ~1.3 s @ 200Hz ECG)
+
+struct DisplaySample {
+    uint32_t sampleIndex;   // Índice de muestra DAC (sampleCount) del punto
+    float valueMV;          // Valor interpolado en mV
+    uint8_t wave0;          // Valor waveform canal 0 (0-255)
+    uint8_t wave1;          // Valor waveform canal 1 (solo EMG: envolvente)
 };
 
 // ============================================================================
 // BUFFER PARA WEBSOCKET (muestras sincronizadas a 100 Hz)
 // ============================================================================
-#define WS_SAMPLE_BUFFER_SIZE 128  // Buffer circular para WebSocket (128 muestras = ~640ms @ 200Hz ECG)
+#define WS_SAMPLE_BUFFER_SIZE 128  // Buffer circular para WebSocket, potencia de 2 (128 muestras = ~640ms @ 200Hz ECG)
 
 struct WSSampleData {
     float value;      // Valor en mV
@@ -63,28 +81,45 @@ private:
     EMGModel emgModel;
     PPGModel ppgModel;
     
+    // Reproducción desde flash (fuente en lugar del modelo de currentSignal.type)
+    PlaybackModel playbackModel;
+    bool playbackActive;
+    
     // Estado actual
     SignalData currentSignal;
     
     // Configuración salida DAC EMG (RAW por defecto)
     EMGDACOutput emgDacOutput;
     
+    // Rampas Tipo A: forma y duración (se adoptan por bloque en los modelos)
+    RampConfig rampConfig;
+    ParamMailbox<RampConfig> rampMailbox;
+    
     // FreeRTOS handles
     TaskHandle_t generationTaskHandle;
     SemaphoreHandle_t signalMutex;
     
-    // Timer de hardware
-    hw_timer_t* signalTimer;
+    // Salida DAC (I2S/DMA, timer ISR o simulada)
+    OutputSink* outputSink;
     
     // Métodos privados
-    void setupTimer();
-    void stopTimer();
-    void prefillBuffer();
+    bool beginSignal(SignalType type, uint8_t condition, bool playback);
     uint8_t generateSample();
+    uint8_t nextModelSample();
+    void generateModelBlock(float modelDeltaTime);
+    void pushDisplaySample(uint32_t sampleIndex, float valueMV);
+    void pushWSSample(uint32_t sampleIndex);
+    
+    /**
+     * @brief Detiene la tarea de generación y espera a que lo confirme
+     * @note Con signalMutex tomado; al volver ningún ciclo está en curso y se
+     *       puede tocar el lado productor de los rings, el pipeline y el modelo
+     */
+    void holdGeneration();
+    void releaseGeneration();
     
     // Tareas FreeRTOS
     static void generationTask(void* parameter);
-    static void IRAM_ATTR timerISR();
     
 public:
     static SignalEngine* getInstance();
@@ -98,15 +133,51 @@ public:
     bool pauseSignal();
     bool resumeSignal();
     
-    // Actualizar parámetros (Tipo A - inmediatos)
+    /**
+     * @brief Reproduce un archivo .bsr de SPIFFS en bucle
+     * @note Tipo de señal (MUX, escala, tasas de display) y Fs salen del archivo
+     */
+    bool startPlayback(const char* path);
+    bool isPlaybackActive() const { return playbackActive; }
+    
+    /**
+     * @brief Vuelve el modelo a los valores por defecto de la condición
+     * @note Con la generación detenida (handshake), sin tocar el sink, los
+     *       buffers ni el estado: en pausa o parada no sale nada por el DAC
+     */
+    bool resetModel(SignalType type, uint8_t condition);
+
+    /**
+     * @brief Un ciclo de generación: tick del modelo + relleno del buffer DAC
+     * @note Lo llama generationTask(); el build nativo lo invoca directamente
+     */
+    void processGeneration();
+
+    // Actualizar parámetros: publican una instantánea completa en el buzón
+    // del modelo (seguro desde Core 0, sin tocar campos del modelo)
+    // Tipo A - rampa desde el siguiente bloque (ver setParamRamp)
     void updateNoiseLevel(float noise);
     void updateAmplitude(float amplitude);
     
-    // Actualizar parámetros (Tipo B - diferidos)
+    /**
+     * @brief Forma y duración de las rampas Tipo A de los tres modelos
+     * @param durationMs 0 = escalón en la siguiente frontera de bloque
+     */
+    void setParamRamp(RampShape shape, uint16_t durationMs);
+    RampConfig getParamRamp() const { return rampConfig; }
+    
+    // Tipo B - siguiente latido (EMG: siguiente bloque)
     void setECGParameters(const ECGParameters& params);
     void setEMGParameters(const EMGParameters& params);
     void setPPGParameters(const PPGParameters& params);
     
+    /**
+     * @brief Selecciona e inicializa la salida DAC (solo con señal detenida)
+     * @return false si la salida no está disponible o hay señal activa
+     */
+    bool setOutputSink(OutputSinkType type);
+    OutputSinkType getOutputSinkType() const { return outputSink->getType(); }
+    
     // Configuración de salida DAC para EMG
     void setEMGDACOutput(EMGDACOutput output);
     EMGDACOutput getEMGDACOutput() const { return emgDacOutput; }
@@ -117,12 +188,17 @@ public:
     uint8_t getLastDACValue() const;
     SignalData getSignalData() const { return currentSignal; }
     PerformanceStats getStats() const;
-    bool getDisplaySample(uint32_t sampleIndex, float& outValue) const;
+    void resetStats();      // Peor tiempo del sink y contadores por etapa
+    
+    // Buffer display Nextion (ya diezmado a FDS_*)
+    bool getNextDisplaySample(DisplaySample& outSample);
+    uint16_t getDisplayBufferCount() const;
     
     // Acceso a modelos para métricas
     ECGModel& getECGModel() { return ecgModel; }
     EMGModel& getEMGModel() { return emgModel; }
     PPGModel& getPPGModel() { return ppgModel; }
+    const PlaybackModel& getPlaybackModel() const { return playbackModel; }
     
     // Buffer WebSocket sincronizado (100 Hz)
     bool getNextWSSample(WSSampleData& outSample);
@@ -0,0 +1,159 @@
+/**
+ * @file signal_recorder.h
+ * @brief Grabación a flash de la señal emitida (formato por bloques delta+varint)
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ *
+ * Captura las muestras de modelo que realmente salieron hacia el DAC
+ * (Fs_modelo, en mV) y las escribe en SPIFFS. La tarea de generación
+ * solo codifica en RAM; la escritura a flash la hace una tarea de baja
+ * prioridad con doble buffer, así que la generación nunca espera al flash.
+ *
+ * FORMATO (little-endian, bloques autocontenidos concatenados):
+ *
+ *   off  tipo   campo
+ *   0    u32    magic (RECORDER_BLOCK_MAGIC, "BSR1")
+ *   4    u8     versión (RECORDER_BLOCK_VERSION)
+ *   5    u8     señal (SignalType)
+ *   6    u8     condición (índice del enum del modelo)
+ *   7    u8     P = bytes de parámetros
+ *   8    u16    Fs del modelo (Hz)
+ *   10   u16    N muestras en el bloque
+ *   12   u32    índice de la primera muestra (desde startSignal)
+ *   16   u32    semilla del RNG del modelo
+ *   20   u16    bytes de payload
+ *   22   u16    µV por LSB
+ *   24   u8[P]  snapshot de ECG/EMG/PPGParameters
+ *   ..   payload: zigzag-varint(x0), zigzag-varint(x[i] - x[i-1]) ...
+ *
+ * Un hueco en "índice de la primera muestra" indica muestras perdidas
+ * (escritor más lento que la señal). Decodificador: tools/decode_recording.py
+ */
+
+#ifndef SIGNAL_RECORDER_H
+#define SIGNAL_RECORDER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
+#include "config.h"
+
+// ============================================================================
+// CONFIGURACIÓN
+// ============================================================================
+#define RECORDER_FILE_PATH          "/rec.bsr"
+#define RECORDER_BLOCK_MAGIC        0x31525342UL    // "BSR1"
+#define RECORDER_BLOCK_VERSION      1
+#define RECORDER_HEADER_SIZE        24
+#define RECORDER_MAX_PARAM_BYTES    32
+#define RECORDER_BLOCK_BYTES        2048            // Un bloque = una escritura a flash
+#define RECORDER_UV_PER_LSB         1
+#define RECORDER_MAX_FILE_BYTES     (512UL * 1024UL)
+#define RECORDER_WRITER_PERIOD_MS   20
+
+// ============================================================================
+// ESTRUCTURAS
+// ============================================================================
+
+/**
+ * @brief Identidad del stream grabado (cambio → se cierra el bloque en curso)
+ */
+struct RecorderStreamInfo {
+    uint8_t signalId;
+    uint8_t conditionId;
+    uint16_t sampleRateHz;
+    uint32_t seed;
+    uint8_t paramBytes;
+    uint8_t params[RECORDER_MAX_PARAM_BYTES];
+};
+
+enum class RecorderState : uint8_t {
+    IDLE = 0,
+    STARTING,       // Esperando a que el escritor abra el archivo
+    RECORDING,
+    STOPPING,       // Esperando a que se vacíen los bloques pendientes
+    ERROR           // No se pudo crear el archivo o falló una escritura
+};
+
+struct RecorderStats {
+    uint32_t bytesWritten;
+    uint32_t blocksWritten;
+    uint32_t samplesRecorded;
+    uint32_t samplesDropped;    // Ambos buffers ocupados (flash lento)
+    bool writeFailed;           // Archivo truncado: termina en ERROR, no en IDLE
+};
+
+// ============================================================================
+// CLASE SignalRecorder
+// ============================================================================
+class SignalRecorder {
+public:
+    SignalRecorder();
+
+    /**
+     * @brief Monta el sistema de archivos y crea la tarea escritora
+     */
+    bool begin();
+
+    // Control (cualquier tarea: UI, HTTP)
+    bool start();
+    void stop();
+    RecorderState getState() const { return state.load(std::memory_order_acquire); }
+    bool isRecording() const { return armed.load(std::memory_order_acquire); }
+    RecorderStats getStats() const { return stats; }
+    const char* getFilePath() const { return RECORDER_FILE_PATH; }
+    static const char* getStateName(RecorderState s);
+
+    // ========================================================================
+    // LADO GENERADOR (tarea de generación, nunca bloquea)
+    // ========================================================================
+
+    /**
+     * @brief Codifica un bloque de muestras de modelo
+     * @param info Identidad/parámetros del stream (si cambia se cierra el bloque)
+     * @param valuesMV Muestras en mV
+     * @param n Número de muestras
+     * @param firstSample Índice de la primera muestra desde startSignal
+     */
+    void pushSamples(const RecorderStreamInfo& info, const float* valuesMV,
+                     size_t n, uint32_t firstSample);
+
+    /**
+     * @brief Cierra el bloque abierto si se pidió detener (llamar cada ciclo)
+     */
+    void service();
+
+private:
+    enum : uint8_t { BUF_FREE = 0, BUF_FILLING, BUF_READY };
+
+    // Doble buffer: el generador llena uno mientras el escritor vuelca el otro
+    uint8_t blocks[2][RECORDER_BLOCK_BYTES];
+    uint16_t blockLength[2];
+    std::atomic<uint8_t> blockState[2];
+    uint8_t fillIndex;              // Buffer del generador
+    uint8_t writeIndex;             // Próximo buffer a volcar (orden de llenado)
+
+    // Bloque abierto (lado generador)
+    RecorderStreamInfo openInfo;
+    uint16_t openCount;
+    uint32_t nextSample;            // Índice esperado de la siguiente muestra
+    int32_t lastValue;              // Para la codificación delta
+
+    std::atomic<bool> armed;        // El generador graba
+    std::atomic<RecorderState> state;
+    RecorderStats stats;
+    TaskHandle_t writerTaskHandle;
+
+    bool openBlock(const RecorderStreamInfo& info, uint32_t firstSample);
+    void sealBlock();
+    static size_t writeVarint(uint8_t* dst, uint32_t value);
+
+    static void writerTask(void* parameter);
+    void writerCycle();
+};
+
+// Instancia global
+extern SignalRecorder signalRecorder;
+
+#endif // SIGNAL_RECORDER_H
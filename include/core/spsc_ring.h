@@ -0,0 +1,203 @@
+/**
+ * @file spsc_ring.h
+ * @brief Buffer circular lock-free de un productor / un consumidor (SPSC)
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ *
+ * Sustituye a los buffers circulares hechos a mano (índices volatile con
+ * módulo) en todos los caminos motor → consumidor:
+ *
+ *   Tarea generación (Core 1) ──► SPSCRing ──► ISR DAC / Nextion / WebSocket (Core 0)
+ *
+ * DISEÑO:
+ * - Capacidad N potencia de dos: índice = contador & (N-1), sin '%' por muestra
+ * - Contadores head/tail de 32 bits libres (no se envuelven a N): lleno y
+ *   vacío se distinguen sin sacrificar una celda
+ * - head y tail en líneas de caché separadas (sin false sharing entre cores)
+ * - Orden de memoria: el productor publica head con release tras escribir
+ *   los datos; el consumidor lo lee con acquire antes de leerlos (y viceversa
+ *   con tail). Sin lecturas rotas de índices entre cores.
+ * - write_n/read_n copian por bloques (máx. 2 memcpy por llamada)
+ *
+ * RESTRICCIONES:
+ * - Exactamente un productor y un consumidor concurrentes
+ * - reset() solo con ambos lados detenidos
+ * - T debe ser trivialmente copiable
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <string.h>
+
+// ============================================================================
+// CONFIGURACIÓN
+// ============================================================================
+#ifdef NATIVE_BUILD
+#define SPSC_CACHE_LINE_SIZE    64
+#else
+#define SPSC_CACHE_LINE_SIZE    32      // ESP32: línea de caché de 32 bytes
+#endif
+
+// Forzar inline: los métodos se llaman desde ISR en IRAM y no deben
+// quedar como funciones en flash
+#define SPSC_INLINE inline __attribute__((always_inline))
+
+// ============================================================================
+// PLANTILLA SPSCRing
+// ============================================================================
+template <typename T, size_t N>
+class SPSCRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SPSCRing: N debe ser potencia de dos");
+    static_assert(N <= 0x80000000UL, "SPSCRing: N demasiado grande");
+
+public:
+    SPSCRing() : head(0), tail(0) {}
+
+    static constexpr size_t capacity() { return N; }
+
+    // ========================================================================
+    // PRODUCTOR
+    // ========================================================================
+
+    /**
+     * @brief Espacio libre visto por el productor
+     */
+    SPSC_INLINE size_t space() const {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        uint32_t t = tail.load(std::memory_order_acquire);
+        return N - (size_t)(h - t);
+    }
+
+    /**
+     * @brief Encola un elemento
+     * @return false si el buffer está lleno
+     */
+    SPSC_INLINE bool push(const T& item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if ((size_t)(h - tail.load(std::memory_order_acquire)) >= N) {
+            return false;
+        }
+        buffer[h & MASK] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Encola hasta n elementos contiguos
+     * @return Elementos escritos
+     */
+    size_t write_n(const T* src, size_t n) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        size_t free = N - (size_t)(h - tail.load(std::memory_order_acquire));
+        if (n > free) n = free;
+        if (n == 0) return 0;
+
+        size_t idx = h & MASK;
+        size_t first = N - idx;
+        if (first > n) first = n;
+        memcpy(&buffer[idx], src, first * sizeof(T));
+        if (n > first) {
+            memcpy(&buffer[0], src + first, (n - first) * sizeof(T));
+        }
+        head.store(h + (uint32_t)n, std::memory_order_release);
+        return n;
+    }
+
+    // ========================================================================
+    // CONSUMIDOR
+    // ========================================================================
+
+    /**
+     * @brief Elementos disponibles vistos por el consumidor
+     */
+    SPSC_INLINE size_t available() const {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        uint32_t h = head.load(std::memory_order_acquire);
+        return (size_t)(h - t);
+    }
+
+    SPSC_INLINE bool empty() const { return available() == 0; }
+
+    /**
+     * @brief Desencola un elemento
+     * @return false si el buffer está vacío
+     */
+    SPSC_INLINE bool pop(T& item) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) == t) {
+            return false;
+        }
+        item = buffer[t & MASK];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Lee el siguiente elemento sin desencolarlo
+     */
+    SPSC_INLINE bool peek(T& item) const {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) == t) {
+            return false;
+        }
+        item = buffer[t & MASK];
+        return true;
+    }
+
+    /**
+     * @brief Desencola hasta n elementos contiguos
+     * @return Elementos leídos
+     */
+    size_t read_n(T* dst, size_t n) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        size_t avail = (size_t)(head.load(std::memory_order_acquire) - t);
+        if (n > avail) n = avail;
+        if (n == 0) return 0;
+
+        size_t idx = t & MASK;
+        size_t first = N - idx;
+        if (first > n) first = n;
+        memcpy(dst, &buffer[idx], first * sizeof(T));
+        if (n > first) {
+            memcpy(dst + first, &buffer[0], (n - first) * sizeof(T));
+        }
+        tail.store(t + (uint32_t)n, std::memory_order_release);
+        return n;
+    }
+
+    /**
+     * @brief Descarta hasta n elementos
+     * @return Elementos descartados
+     */
+    size_t skip(size_t n) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        size_t avail = (size_t)(head.load(std::memory_order_acquire) - t);
+        if (n > avail) n = avail;
+        tail.store(t + (uint32_t)n, std::memory_order_release);
+        return n;
+    }
+
+    // ========================================================================
+    // CONTROL
+    // ========================================================================
+
+    /**
+     * @brief Vacía el buffer (solo con productor y consumidor detenidos)
+     */
+    void reset() {
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_release);
+    }
+
+private:
+    static const uint32_t MASK = (uint32_t)(N - 1);
+
+    alignas(SPSC_CACHE_LINE_SIZE) std::atomic<uint32_t> head;   // Escrito solo por el productor
+    alignas(SPSC_CACHE_LINE_SIZE) std::atomic<uint32_t> tail;   // Escrito solo por el consumidor
+    alignas(SPSC_CACHE_LINE_SIZE) T buffer[N];
+};
+
+#endif // SPSC_RING_H
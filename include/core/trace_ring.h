@@ -0,0 +1,207 @@
+/**
+ * @file trace_ring.h
+ * @brief Ring de eventos con marca de tiempo y exportación Chrome trace_event
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ *
+ * Un contador de underruns dice cuántas veces faltó una muestra, no por qué.
+ * TraceRing guarda los últimos TRACE_RING_SIZE eventos de motor y
+ * comunicaciones con micros() (común a ambos cores) y el core que los emitió:
+ *
+ *   Generación (Core 1)  model_tick B/E, beat, param_applied, underrun (I2S)
+ *   WSStream (Core 0)    ws_frame
+ *   loop (Core 1)        nextion_cmd
+ *   ISR timer            underrun
+ *
+ * TraceExporter lo vuelca como JSON Chrome trace_event (chrome://tracing,
+ * Perfetto) por trozos: un hilo por core (tid = core), así se ve cómo se
+ * intercalan la tarea de generación y las de comunicación.
+ *
+ * DISEÑO:
+ * - Varios productores (tareas de ambos cores e ISR): cada evento reserva su
+ *   celda con fetch_add sobre head; sin locks ni secciones críticas
+ * - Cada celda lleva su secuencia (índice + 1, 0 mientras se escribe): el
+ *   lector descarta celdas a medio escribir o ya sobrescritas
+ * - Mientras hay un volcado en curso el ring se congela (freeze): el JSON
+ *   muestra una ventana coherente y no se pierde por sobrescritura
+ *
+ * Con TRACE_ENABLED = 0 (config.h) las macros TRACE_* no generan código y el
+ * exportador produce un trace vacío.
+ */
+
+#ifndef TRACE_RING_H
+#define TRACE_RING_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "config.h"
+
+// ============================================================================
+// CONFIGURACIÓN
+// ============================================================================
+#if TRACE_ENABLED
+#define TRACE_RING_CAPACITY     TRACE_RING_SIZE
+#else
+#define TRACE_RING_CAPACITY     2       // Sin eventos: no reservar RAM
+#endif
+
+#define TRACE_LINE_SIZE         160     // Una línea JSON por evento
+#define TRACE_CORE_COUNT        2       // Hilos del visor (tid = core)
+
+#define TRACE_INLINE inline __attribute__((always_inline))
+
+enum class TraceEventType : uint8_t {
+    UNDERRUN = 0,       // arg: underruns acumulados del sink
+    MODEL_TICK,         // B/E, arg: SignalType
+    BEAT,               // arg: número de latido
+    PARAM_APPLIED,      // arg: (SignalType << 8) | 'A' (bloque) o 'B' (latido)
+    WS_FRAME,           // arg: (id cliente << 16) | muestras
+    NEXTION_CMD,        // arg: bytes enviados
+    COUNT
+};
+
+enum class TracePhase : uint8_t {
+    INSTANT = 0,        // "i"
+    BEGIN,              // "B"
+    END                 // "E"
+};
+
+struct TraceEvent {
+    uint32_t timestamp;     // micros()
+    uint32_t arg;
+    TraceEventType type;
+    TracePhase phase;
+    uint8_t core;
+    uint8_t reserved;
+};
+
+// ============================================================================
+// CLASE TraceRing
+// ============================================================================
+class TraceRing {
+    static_assert((TRACE_RING_CAPACITY & (TRACE_RING_CAPACITY - 1)) == 0,
+                  "TraceRing: TRACE_RING_SIZE debe ser potencia de dos");
+
+public:
+    TraceRing() : head(0), frozen(0) {
+        for (uint32_t i = 0; i < TRACE_RING_CAPACITY; i++) {
+            slots[i].seq.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Registra un evento (tareas de cualquier core e ISR en IRAM)
+     */
+    TRACE_INLINE void record(TraceEventType type, TracePhase phase, uint32_t arg) {
+        if (frozen.load(std::memory_order_relaxed) != 0) return;
+
+        uint32_t idx = head.fetch_add(1, std::memory_order_relaxed);
+        Slot& s = slots[idx & (TRACE_RING_CAPACITY - 1)];
+        s.seq.store(0, std::memory_order_relaxed);              // Escribiendo
+        std::atomic_thread_fence(std::memory_order_release);
+        s.event.timestamp = micros();
+        s.event.arg = arg;
+        s.event.type = type;
+        s.event.phase = phase;
+        s.event.core = (uint8_t)xPortGetCoreID();
+        s.event.reserved = 0;
+        s.seq.store(idx + 1, std::memory_order_release);        // Publicado
+    }
+
+    /**
+     * @brief Copia el evento de índice absoluto idx
+     * @return false si la celda está a medio escribir o ya se sobrescribió
+     */
+    bool read(uint32_t idx, TraceEvent& out) const {
+        const Slot& s = slots[idx & (TRACE_RING_CAPACITY - 1)];
+        if (s.seq.load(std::memory_order_acquire) != idx + 1) return false;
+        out = s.event;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return s.seq.load(std::memory_order_relaxed) == idx + 1;
+    }
+
+    /**
+     * @brief Índice del siguiente evento (total registrado desde el arranque)
+     */
+    uint32_t getHead() const { return head.load(std::memory_order_acquire); }
+    static constexpr uint32_t capacity() { return TRACE_RING_CAPACITY; }
+
+    // Congelado por volcados anidados (serie y HTTP a la vez)
+    void freeze() { frozen.fetch_add(1, std::memory_order_acq_rel); }
+    void unfreeze() { frozen.fetch_sub(1, std::memory_order_acq_rel); }
+
+    /**
+     * @brief Descarta los eventos registrados (no con un volcado en curso)
+     */
+    void clear();
+
+    static const char* getEventName(TraceEventType type);
+    static const char* getCategory(TraceEventType type);
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> seq;
+        TraceEvent event;
+    };
+
+    Slot slots[TRACE_RING_CAPACITY];
+    std::atomic<uint32_t> head;
+    std::atomic<uint8_t> frozen;
+};
+
+extern TraceRing traceRing;
+
+// ============================================================================
+// CLASE TraceExporter - JSON Chrome trace_event POR TROZOS
+// ============================================================================
+/**
+ * @brief Genera el JSON de la ventana actual del ring sin cargarlo en RAM
+ *
+ * Congela el ring al construirse y lo libera al destruirse. read() entrega
+ * hasta maxLen bytes (una línea puede repartirse entre llamadas) y 0 al
+ * terminar: sirve tanto al chunked response HTTP como al volcado serie.
+ */
+class TraceExporter {
+public:
+    TraceExporter();
+    ~TraceExporter();
+
+    size_t read(uint8_t* buffer, size_t maxLen);
+    bool isDone() const { return stage == Stage::DONE && linePos >= lineLen; }
+
+private:
+    enum class Stage : uint8_t { HEADER, METADATA, EVENTS, FOOTER, DONE };
+
+    Stage stage;
+    uint32_t next;          // Siguiente índice absoluto a exportar
+    uint32_t end;           // head al congelar
+    uint32_t t0;            // Marca del primer evento (ts relativos, sin wrap)
+    bool hasT0;
+    uint8_t metaCore;
+    uint16_t lineLen;
+    uint16_t linePos;
+    char line[TRACE_LINE_SIZE];
+
+    bool formatNextLine();
+    void formatEvent(const TraceEvent& e);
+
+    TraceExporter(const TraceExporter&);
+    TraceExporter& operator=(const TraceExporter&);
+};
+
+// ============================================================================
+// MACROS DE TRAZA (sin código con TRACE_ENABLED = 0)
+// ============================================================================
+#if TRACE_ENABLED
+#define TRACE_INSTANT(type, arg)    traceRing.record(TraceEventType::type, TracePhase::INSTANT, (uint32_t)(arg))
+#define TRACE_BEGIN(type, arg)      traceRing.record(TraceEventType::type, TracePhase::BEGIN, (uint32_t)(arg))
+#define TRACE_END(type, arg)        traceRing.record(TraceEventType::type, TracePhase::END, (uint32_t)(arg))
+#else
+#define TRACE_INSTANT(type, arg)
+#define TRACE_BEGIN(type, arg)
+#define TRACE_END(type, arg)
+#endif
+
+#endif // TRACE_RING_H
@@ -234,6 +234,29 @@ struct SignalData {
     {}
 };
 
+// ============================================================================
+// BLOQUE DE MUESTRAS (generación por bloques)
+// ============================================================================
+// Destinos de generateBlock(): cada modelo rellena en una sola pasada las
+// salidas no nulas. Todos los arrays deben tener al menos n elementos.
+struct SampleBlock {
+    uint8_t* dac;           // Código DAC 0-255 (salida analógica)
+    float* dacLevel;        // Mismo valor sin cuantizar (0.0-255.0, dac = truncado)
+    float* valueMV;         // Valor en mV para display/WebSocket
+    uint8_t* wave0;         // Código waveform Nextion canal 0 (0-255)
+    uint8_t* wave1;         // Código waveform Nextion canal 1 (solo EMG: envolvente)
+    float* envelopeMV;      // Envolvente RMS en mV (solo EMG)
+    
+    SampleBlock() :
+        dac(nullptr),
+        dacLevel(nullptr),
+        valueMV(nullptr),
+        wave0(nullptr),
+        wave1(nullptr),
+        envelopeMV(nullptr)
+    {}
+};
+
 // ============================================================================
 // FUNCIONES DE CONVERSIÓN A STRING
 // ============================================================================
@@ -0,0 +1,77 @@
+/**
+ * @file i2s_dac_sink.h
+ * @brief Salida DAC por I2S0 + DMA (DAC interno en GPIO25)
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ *
+ * El periférico I2S0 en modo DAC_BUILT_IN lee los descriptores DMA y
+ * escribe el byte alto de cada muestra de 16 bits en el DAC1 (canal
+ * derecho = GPIO25). La CPU solo interviene una vez por bloque:
+ *
+ *   Tarea generación ──write()──► bloque de staging ──i2s_write()──► DMA ──► DAC
+ *
+ * Control de flujo: cada I2S_EVENT_TX_DONE libera un descriptor; la cola de
+ * eventos del driver indica cuántos bloques se pueden escribir sin bloquear.
+ *
+ * Cada muestra del motor se repite I2S_DAC_OVERSAMPLE veces porque el reloj
+ * I2S no puede generar frecuencias tan bajas como 2 kHz.
+ */
+
+#ifndef I2S_DAC_SINK_H
+#define I2S_DAC_SINK_H
+
+#include "output_sink.h"
+
+#ifndef NATIVE_BUILD
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+class I2SDACSink : public OutputSink {
+public:
+    I2SDACSink();
+
+    bool begin() override;
+    void start() override;
+    void stop() override;
+    void reset(uint8_t fillValue, size_t prefillSamples) override;
+    size_t availableForWrite() override;
+    size_t write(const uint8_t* samples, size_t count) override;
+    void writeIdle(uint8_t value) override;
+    uint8_t getLastValue() const override { return lastValue; }
+    OutputSinkStats getStats() const override;
+    void resetPeakStats() override;
+    OutputSinkType getType() const override { return OutputSinkType::I2S_DMA; }
+
+private:
+    static const size_t SAMPLES_PER_BLOCK = I2S_DMA_BUF_LEN / I2S_DAC_OVERSAMPLE;
+    static const uint8_t MAX_FREE_BLOCKS = I2S_DMA_BUF_COUNT - 1;
+
+    bool installed;
+    bool running;
+    QueueHandle_t eventQueue;
+
+    // Bloque en construcción: frames estéreo de 16 bits (R, L)
+    uint16_t staging[I2S_DMA_BUF_LEN * 2];
+    size_t stagedSamples;
+
+    uint8_t freeBlocks;         // Descriptores DMA libres (según TX_DONE)
+    uint8_t lastValue;
+
+    // Estadísticas
+    uint32_t samplesOut;
+    uint32_t underruns;
+    uint32_t maxWriteTime_us;
+
+    void pollEvents();
+    bool flushBlock();
+};
+
+// ============================================================================
+// INSTANCIA GLOBAL
+// ============================================================================
+extern I2SDACSink i2sSink;
+
+#endif // NATIVE_BUILD
+
+#endif // I2S_DAC_SINK_H
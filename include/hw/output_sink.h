@@ -0,0 +1,116 @@
+/**
+ * @file output_sink.h
+ * @brief Interfaz de salida de muestras DAC (OutputSink)
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ *
+ * El motor de señales produce muestras de 8 bits a FS_TIMER_HZ y las
+ * entrega por bloques a un OutputSink, que se encarga de sacarlas al DAC:
+ *
+ * - I2S_DMA:   El periférico I2S0 alimenta el DAC interno (GPIO25) por DMA.
+ *              Sin interrupción por muestra, sin jitter (ver i2s_dac_sink.h).
+ * - TIMER_ISR: Fallback: timer hardware + dacWrite() por muestra
+ *              (arquitectura original, ver timer_isr_sink.h).
+ * - SIMULATED: Build nativo: el host consume las muestras (simulated_sink.h).
+ *
+ * Contrato: un solo productor (tarea de generación) llama
+ * availableForWrite()/write(); el consumo lo hace el hardware o el host.
+ */
+
+#ifndef OUTPUT_SINK_H
+#define OUTPUT_SINK_H
+
+#include <Arduino.h>
+#include "../config.h"
+
+// ============================================================================
+// TIPOS DE SALIDA
+// ============================================================================
+enum class OutputSinkType : uint8_t {
+    TIMER_ISR = 0,      // Timer ISR @ FS_TIMER_HZ + dacWrite() (fallback)
+    I2S_DMA   = 1,      // I2S0 → DAC interno por DMA
+    SIMULATED = 2       // Build nativo (host)
+};
+
+inline const char* outputSinkTypeToString(OutputSinkType type) {
+    switch (type) {
+        case OutputSinkType::TIMER_ISR: return "TIMER_ISR";
+        case OutputSinkType::I2S_DMA:   return "I2S_DMA";
+        case OutputSinkType::SIMULATED: return "SIMULATED";
+        default:                        return "UNKNOWN";
+    }
+}
+
+// ============================================================================
+// ESTADÍSTICAS DE SALIDA
+// ============================================================================
+struct OutputSinkStats {
+    uint32_t samplesOut;        // Muestras entregadas al DAC
+    uint32_t maxServiceTime_us; // Peor tiempo de servicio (ISR o escritura DMA)
+    uint32_t underruns;         // Veces que el DAC no tuvo muestra disponible
+    uint16_t level;             // Muestras en cola pendientes de salir
+};
+
+// ============================================================================
+// INTERFAZ OutputSink
+// ============================================================================
+class OutputSink {
+public:
+    virtual ~OutputSink() {}
+
+    /**
+     * @brief Reserva recursos (driver, timer, buffers). Idempotente.
+     * @return true si la salida está lista
+     */
+    virtual bool begin() = 0;
+
+    /**
+     * @brief Inicia el consumo de muestras a FS_TIMER_HZ
+     */
+    virtual void start() = 0;
+
+    /**
+     * @brief Detiene el consumo (conserva las muestras en cola)
+     */
+    virtual void stop() = 0;
+
+    /**
+     * @brief Vacía la cola y la pre-llena con un valor constante
+     * @param fillValue Valor DAC de pre-llenado (normalmente DAC_CENTER_VALUE)
+     * @param prefillSamples Muestras a pre-llenar (latencia inicial)
+     */
+    virtual void reset(uint8_t fillValue, size_t prefillSamples) = 0;
+
+    /**
+     * @brief Muestras que se pueden escribir sin bloquear
+     */
+    virtual size_t availableForWrite() = 0;
+
+    /**
+     * @brief Encola un bloque de muestras DAC
+     * @return Muestras aceptadas
+     */
+    virtual size_t write(const uint8_t* samples, size_t count) = 0;
+
+    /**
+     * @brief Fija la salida en un valor de reposo (señal detenida)
+     */
+    virtual void writeIdle(uint8_t value) = 0;
+
+    /**
+     * @brief Último valor enviado al DAC
+     */
+    virtual uint8_t getLastValue() const = 0;
+
+    virtual OutputSinkStats getStats() const = 0;
+
+    /**
+     * @brief Reinicia el peor tiempo de servicio sin tocar la cola (cualquier core)
+     */
+    virtual void resetPeakStats() = 0;
+
+    virtual OutputSinkType getType() const = 0;
+    const char* getName() const { return outputSinkTypeToString(getType()); }
+};
+
+#endif // OUTPUT_SINK_H
@@ -0,0 +1,60 @@
+/**
+ * @file simulated_sink.h
+ * @brief Salida DAC simulada para el build nativo
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ *
+ * Sustituye al DAC en el host: las muestras quedan en un buffer circular
+ * y el programa nativo las consume con consume(), que hace el papel del
+ * timer/DMA (una llamada por cada N periodos de FS_TIMER_HZ).
+ */
+
+#ifndef SIMULATED_SINK_H
+#define SIMULATED_SINK_H
+
+#include "output_sink.h"
+#include "core/spsc_ring.h"
+
+#ifdef NATIVE_BUILD
+
+class SimulatedSink : public OutputSink {
+public:
+    SimulatedSink();
+
+    bool begin() override { return true; }
+    void start() override { running = true; }
+    void stop() override { running = false; }
+    void reset(uint8_t fillValue, size_t prefillSamples) override;
+    size_t availableForWrite() override;
+    size_t write(const uint8_t* samples, size_t count) override;
+    void writeIdle(uint8_t value) override;
+    uint8_t getLastValue() const override { return lastValue; }
+    OutputSinkStats getStats() const override;
+    void resetPeakStats() override;
+    OutputSinkType getType() const override { return OutputSinkType::SIMULATED; }
+
+    /**
+     * @brief Consume muestras como lo haría el DAC (solo si está en marcha)
+     * @param count Periodos de FS_TIMER_HZ a simular
+     * @param out Destino opcional de las muestras (nullptr = descartar)
+     * @return Periodos simulados (0 si está detenido)
+     */
+    size_t consume(size_t count, uint8_t* out = nullptr);
+
+private:
+    SPSCRing<uint8_t, SIGNAL_BUFFER_SIZE> ring;
+    bool running;
+    uint8_t lastValue;
+
+    uint32_t samplesOut;
+    uint32_t underruns;
+};
+
+// ============================================================================
+// INSTANCIA GLOBAL
+// ============================================================================
+extern SimulatedSink simulatedSink;
+
+#endif // NATIVE_BUILD
+
+#endif // SIMULATED_SINK_H
@@ -0,0 +1,44 @@
+/**
+ * @file timer_isr_sink.h
+ * @brief Salida DAC por timer ISR (fallback)
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ *
+ * Arquitectura original del motor: timer hardware a FS_TIMER_HZ, la ISR
+ * lee una muestra del buffer circular y llama a dacWrite(). Se conserva
+ * como alternativa seleccionable a I2S_DMA.
+ */
+
+#ifndef TIMER_ISR_SINK_H
+#define TIMER_ISR_SINK_H
+
+#include "output_sink.h"
+
+class TimerISRSink : public OutputSink {
+public:
+    TimerISRSink();
+
+    bool begin() override;
+    void start() override;
+    void stop() override;
+    void reset(uint8_t fillValue, size_t prefillSamples) override;
+    size_t availableForWrite() override;
+    size_t write(const uint8_t* samples, size_t count) override;
+    void writeIdle(uint8_t value) override;
+    uint8_t getLastValue() const override;
+    OutputSinkStats getStats() const override;
+    void resetPeakStats() override;
+    OutputSinkType getType() const override { return OutputSinkType::TIMER_ISR; }
+
+private:
+    hw_timer_t* timer;
+
+    static void IRAM_ATTR timerISR();
+};
+
+// ============================================================================
+// INSTANCIA GLOBAL
+// ============================================================================
+extern TimerISRSink timerSink;
+
+#endif // TIMER_ISR_SINK_H
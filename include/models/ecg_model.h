@@ -29,6 +29,10 @@
 #include <Arduino.h>
 #include "data/signal_types.h"
 #include "core/digital_filters.h"
+#include "core/fast_random.h"
+#include "core/param_mailbox.h"
+#include "core/param_ramp.h"
+#include <atomic>
 
 // ============================================================================
 // CONSTANTES DEL MODELO MCSHARRY
@@ -53,11 +57,16 @@
 #define ECG_DISPLAY_RANGE_MV    2.0f    // mV - rango total
 
 // Escalado VFib (Clayton et al. 1993 + Strohmenger 1997)
-#define VFIB_RAW_MAX            4.0f    // mV - suma máxima teórica (5×0.8)
+// RMS de la suma crece con √N: 0.8·√(5·N) mantiene el nivel de 5 osciladores
+#define VFIB_RAW_MAX            (0.8f * sqrtf(5.0f * VFIB_COMPONENTS))  // mV (5 → 4.0)
 #define VFIB_TARGET_AMPLITUDE   0.5f    // mV - amplitud objetivo (coarse VFib)
-#define VFIB_SCALE_FACTOR       (VFIB_TARGET_AMPLITUDE / VFIB_RAW_MAX)  // = 0.125
+#define VFIB_SCALE_FACTOR       (VFIB_TARGET_AMPLITUDE / VFIB_RAW_MAX)  // 5 → 0.125
 #define VFIB_SAFETY_CLAMP       0.6f    // mV - límite absoluto
 
+// Caché de plantilla de latido (z crudo indexado por fase)
+#define ECG_TEMPLATE_SIZE       512     // Puntos por latido (potencia de 2)
+#define ECG_TEMPLATE_STABLE_BEATS 2     // Latidos calibrados antes de construir
+
 // Calibración
 #define ECG_CALIBRATION_BEATS   3       // Latidos para calibrar G
 #define ECG_MIN_CALIBRATION_SAMPLES 500 // Muestras mínimas antes de calibrar
@@ -86,9 +95,26 @@ struct ECGDisplayMetrics {
 // ESTADO DEL SISTEMA DINÁMICO (x, y, z)
 // ============================================================================
 struct ECGDynamicState {
-    float x;    // Posición X en círculo unitario
-    float y;    // Posición Y en círculo unitario  
-    float z;    // Amplitud ECG (salida del modelo)
+    float x;        // Posición X en círculo unitario
+    float y;        // Posición Y en círculo unitario  
+    float z;        // Amplitud ECG (salida del modelo)
+    float theta;    // Fase directa (solo ANALYTIC_PHASE)
+};
+
+// ============================================================================
+// INTEGRADOR DEL SISTEMA DINÁMICO
+// ============================================================================
+/**
+ * (x, y) solo existen para obtener θ = atan2(y, x): con radio 1 el ciclo
+ * límite gira exactamente a ω, así que θ(t) = θ0 + ω·t es la solución.
+ *
+ * LIMIT_CYCLE:    RK4 sobre (x, y, z), sqrtf + atan2f en cada derivada
+ * ANALYTIC_PHASE: θ avanza analíticamente y RK4 integra solo z
+ *                 (dz/dt = f(θ) - z: 3 evaluaciones de f(θ) por paso)
+ */
+enum class ECGIntegrator : uint8_t {
+    LIMIT_CYCLE = 0,
+    ANALYTIC_PHASE
 };
 
 // ============================================================================
@@ -159,16 +185,35 @@ struct CycleSamples {
  * Usamos superposición de múltiples osciladores con frecuencias
  * en el rango 4-10 Hz (coarse/fine VFib) y parámetros caóticos.
  * 
+ * Banco recursivo: cada oscilador es un fasor unitario (re, im) que gira
+ * e^(jω·dt) por muestra (4 mul + 2 sumas, sin sinf). Cada
+ * VFIB_UPDATE_INTERVAL_S se sortean frecuencia y amplitud objetivo; la
+ * frecuencia se desliza en VFIB_GLIDE_STEPS escalones (se recalcula la
+ * rotación y se renormaliza el fasor) y la amplitud muestra a muestra.
+ * Todo en tiempo simulado (dt del modelo), nunca millis().
+ * 
  * Ref: Clayton RH et al. "Frequency analysis of VF." IEEE Trans Biomed Eng. 1993
  */
-#define VFIB_COMPONENTS 5  // Número de osciladores superpuestos
+#define VFIB_COMPONENTS         8       // Número de osciladores superpuestos
+#define VFIB_UPDATE_INTERVAL_S  0.2f    // s - nuevos objetivos de frecuencia/amplitud
+#define VFIB_GLIDE_STEPS        20      // Escalones de frecuencia por intervalo (10 ms)
+#define VFIB_BEAT_INTERVAL_S    0.2f    // s - incremento de beatCount (~300 BPM)
 
 struct VFibState {
-    float time;                         // Tiempo acumulado (segundos)
-    uint32_t lastUpdateMs;              // Último update de parámetros
-    float frequencies[VFIB_COMPONENTS]; // Frecuencias 4-10 Hz
-    float amplitudes[VFIB_COMPONENTS];  // Amplitudes variables
-    float phases[VFIB_COMPONENTS];      // Fases aleatorias
+    float re[VFIB_COMPONENTS];          // Fasor de cada oscilador (|z| = 1)
+    float im[VFIB_COMPONENTS];
+    float rotCos[VFIB_COMPONENTS];      // Rotación por muestra cos/sin(2π·f·dt)
+    float rotSin[VFIB_COMPONENTS];
+    float frequencies[VFIB_COMPONENTS]; // Frecuencias 4-10 Hz (actual)
+    float freqStep[VFIB_COMPONENTS];    // Hz por escalón de deslizamiento
+    float amplitudes[VFIB_COMPONENTS];  // Amplitudes variables (actual)
+    float targetAmplitudes[VFIB_COMPONENTS];
+    float ampStep[VFIB_COMPONENTS];     // mV por muestra hacia el objetivo
+    float rotationDt;                   // dt con el que se calculó la rotación
+    float updateTimer;                  // s hasta nuevos objetivos
+    float glideTimer;                   // s hasta el siguiente escalón
+    uint8_t glideStepsLeft;             // Escalones pendientes del intervalo
+    float beatTimer;                    // s hasta el siguiente incremento de beatCount
     float lastValue;                    // Último valor generado (mV)
 };
 
@@ -182,6 +227,8 @@ private:
     // =========================================================================
     ECGDynamicState state;              // Estado actual (x, y, z)
     ECGDynamicState k1, k2, k3, k4, temp;  // Para integración RK4
+    ECGIntegrator integrator;           // Integrador de la condición actual
+    ECGIntegrator conditionIntegrator[(int)ECGCondition::COUNT];  // Por condición
     
     // =========================================================================
     // PARÁMETROS DEL MODELO
@@ -265,22 +312,52 @@ private:
     ECGCondition currentCondition;      // Condición actual
     ECGParameters params;               // Parámetros del usuario
     
+    // Instantáneas publicadas desde otro core (ver pollParameters) y cambios
+    // Tipo B ya adoptados a la espera del siguiente latido (solo generación)
+    ParamMailbox<ECGParameters> paramMailbox;
+    ECGParameters pendingParams;
+    bool hasPendingParams;
+    
     // =========================================================================
     // GANANCIA WAVEFORM (para visualización en Nextion)
     // =========================================================================
     float waveformGain;                 // Factor de amplificación (0.1-2.0 = 10-200%)
+    std::atomic<float> waveformGainTarget;  // Escrito por la UI, leído por bloque
+    
+    // =========================================================================
+    // RAMPAS TIPO A (core/param_ramp.h, solo generación)
+    // =========================================================================
+    // Ruido, amplitud y ganancia waveform pasan al objetivo sin escalón:
+    // la rampa se evalúa en advanceRamps() y se interpola por muestra
+    RampConfig rampConfig;
+    ParamRamp noiseRamp;                // → noiseLevel
+    ParamRamp amplitudeRamp;            // → amplitudeGain
+    ParamRamp waveformGainRamp;         // → waveformGain
+    float amplitudeGain;                // Ganancia de salida (= qrsAmplitude)
+    bool rampsActive;
     
     // =========================================================================
-    // GENERADOR ALEATORIO (Box-Muller)
+    // GENERADOR ALEATORIO (xoshiro128** + ziggurat, semilla por modelo)
     // =========================================================================
-    bool gaussHasSpare;
-    float gaussSpare;
+    FastRandom rng;
+    uint32_t rngSeed;                   // reset() reinicia la secuencia
     
     // =========================================================================
     // MODELO VFIB ALTERNATIVO (espectral caótico)
     // =========================================================================
     VFibState vfibState;                // Estado del modelo VFIB alternativo
     
+    // =========================================================================
+    // CACHÉ DE PLANTILLA DE LATIDO
+    // =========================================================================
+    // Con condición y RR medio fijos la morfología es la misma en cada
+    // latido: se integra un latido completo offline y después z se obtiene
+    // por interpolación de fase. RK4 en vivo solo mientras cambian parámetros.
+    float beatTemplate[ECG_TEMPLATE_SIZE];  // z crudo, θ ∈ [-π, π)
+    bool templateValid;                 // ¿Síntesis por plantilla activa?
+    float templateTheta;                // Fase actual en modo plantilla
+    uint8_t templateStableBeats;        // Latidos calibrados desde el último cambio
+    
     // =========================================================================
     // FILTRADO DIGITAL (Pan-Tompkins 1985)
     // =========================================================================
@@ -290,9 +367,23 @@ private:
     // =========================================================================
     // MÉTODOS PRIVADOS - Sistema dinámico
     // =========================================================================
+    float phaseForcing(float theta) const;
     void computeDerivatives(const ECGDynamicState& s, ECGDynamicState& ds, float omega);
     void rungeKutta4Step(float dt, float omega);
-    void detectNewBeat();
+    void analyticPhaseStep(float dt, float omega);
+    void integrateStep(float dt, float omega);
+    void selectIntegrator(ECGIntegrator next);
+    float currentTheta() const;
+    void detectNewBeat(float theta, float deltaTime);
+    void applyPendingParameters();
+    void stepRamps();
+    
+    // =========================================================================
+    // MÉTODOS PRIVADOS - Plantilla de latido
+    // =========================================================================
+    void buildBeatTemplate(float deltaTime);
+    void invalidateBeatTemplate();
+    float sampleBeatTemplate(float theta) const;
     
     // =========================================================================
     // MÉTODOS PRIVADOS - HRV
@@ -314,8 +405,8 @@ private:
     // =========================================================================
     // MÉTODOS PRIVADOS - Utilidades
     // =========================================================================
-    float gaussianRandom(float mean, float std);
-    float randomFloat();
+    float gaussianRandom(float mean, float std) { return rng.gaussian(mean, std); }
+    float randomFloat() { return rng.uniform(); }
     void applyHRFactCorrection();
     void initializeWaveParams();
     void resetMetricsForCondition();
@@ -347,7 +438,8 @@ private:
     // =========================================================================
     void initVFibModel();
     float generateVFibSample(float deltaTime);
-    void updateVFibParameters();
+    void updateVFibParameters(float deltaTime);
+    void updateVFibRotation(float deltaTime);
     
 public:
     // =========================================================================
@@ -360,15 +452,46 @@ public:
     // CONFIGURACIÓN
     // =========================================================================
     void setParameters(const ECGParameters& newParams);
-    void setPendingParameters(const ECGParameters& newParams);  // Para aplicación diferida
+    
+    /**
+     * @brief Publica una instantánea completa (seguro desde cualquier core)
+     * @note Se adopta en pollParameters(): Tipo A al momento, resto al latido
+     */
+    void setPendingParameters(const ECGParameters& newParams);
+    
+    /**
+     * @brief Adopta la última instantánea publicada (frontera de bloque)
+     * @note Solo desde la tarea de generación
+     */
+    void pollParameters();
+    
+    /**
+     * @brief Evalúa las rampas Tipo A para el siguiente bloque de n muestras
+     * @note Solo desde la tarea de generación, después de pollParameters()
+     */
+    void advanceRamps(size_t n, float deltaTime);
+    void setRampConfig(const RampConfig& config) { rampConfig = config; }
     void reset();
+    void setSeed(uint32_t seed) { rngSeed = seed; rng.seed(seed); }  // Secuencia reproducible
+    uint32_t getSeed() const { return rngSeed; }
     
-    // Parámetros de aplicación inmediata (Tipo A)
-    void setNoiseLevel(float noise) { noiseLevel = noise; }
+    // Parámetros de aplicación inmediata (Tipo A, con rampa)
+    void setNoiseLevel(float noise) { noiseRamp.setTarget(noise, rampConfig); }
     void setAmplitude(float amp);
-    void setHeartRate(float hr) { hrMean = constrain(hr, 30.0f, 220.0f); }
-    void setWaveformGain(float gain) { waveformGain = constrain(gain, 0.5f, 2.0f); }
-    float getWaveformGain() const { return waveformGain; }
+    void setHeartRate(float hr) { hrMean = constrain(hr, 30.0f, 220.0f); invalidateBeatTemplate(); }
+    // Seguro desde cualquier core: la tarea de generación lo adopta por bloque
+    void setWaveformGain(float gain) {
+        waveformGainTarget.store(constrain(gain, 0.5f, 2.0f), std::memory_order_relaxed);
+    }
+    float getWaveformGain() const { return waveformGainTarget.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief Elige el integrador de una condición (VFib no usa McSharry)
+     * @note Si es la condición actual se aplica ya (θ se conserva)
+     */
+    void setIntegrator(ECGCondition condition, ECGIntegrator next);
+    ECGIntegrator getIntegrator(ECGCondition condition) const;
+    ECGIntegrator getActiveIntegrator() const { return integrator; }
     
     // =========================================================================
     // GENERACIÓN DE SEÑAL
@@ -391,6 +514,38 @@ public:
      */
     uint8_t getWaveformValue() const;
     
+    /**
+     * @brief Escalado mV → código DAC del ECG ([-0.5, 1.5] mV → 0-255)
+     * @note Público para que la reproducción use la misma escala que el modelo
+     */
+    static uint8_t mvToDACCode(float mV);
+    static float mvToDACLevel(float mV);    // Sin cuantizar (pipeline DAC)
+    
+    // =========================================================================
+    // GENERACIÓN POR BLOQUES
+    // =========================================================================
+    /**
+     * @brief Genera n muestras de una vez (equivale a n × generateSample)
+     * @param out Destino: valor ECG en mV
+     */
+    void generateBlock(float* out, size_t n, float deltaTime);
+    
+    /**
+     * @brief Genera n muestras como códigos DAC (equivale a n × getDACValue)
+     */
+    void generateBlockDAC(uint8_t* out, size_t n, float deltaTime);
+    
+    /**
+     * @brief Genera n muestras como códigos waveform Nextion
+     */
+    void generateBlockDisplay(uint8_t* out, size_t n, float deltaTime);
+    
+    /**
+     * @brief Genera n muestras rellenando todas las salidas no nulas del bloque
+     * @note valueMV = getCurrentValueMV() (sin ruido), dac incluye ruido
+     */
+    void generateBlock(const SampleBlock& out, size_t n, float deltaTime);
+    
     /**
      * @brief Indica si la calibración está completa y la señal es válida
      */
@@ -432,7 +587,11 @@ public:
     uint32_t getBeatCount() const { return beatCount; }
     const char* getConditionName() const;
     ECGCondition getCondition() const { return currentCondition; }
+    const ECGParameters& getParameters() const { return params; }
     bool isInBeat() const;
+    bool isUsingBeatTemplate() const { return templateValid; }
+    float getPhase() const { return currentTheta(); }               // θ actual (rad)
+    float getRWavePhase() const { return windows.R_center; }        // θ del pico R (rad)
     
     // Compatibilidad
     float getHRMean() const { return hrMean; }
@@ -25,14 +25,19 @@
 #include <Arduino.h>
 #include "data/signal_types.h"
 #include "core/digital_filters.h"
+#include "core/fast_random.h"
+#include "core/param_mailbox.h"
+#include "core/param_ramp.h"
+#include <atomic>
 
 // ============================================================================
 // CONSTANTES DEL MODELO - Fuglevand 1993 adaptado para sEMG
 // ============================================================================
-#define MAX_MOTOR_UNITS     100     // Número de unidades motoras en el pool
+#define MAX_MOTOR_UNITS     300     // Número de unidades motoras en el pool
 #define RMS_BUFFER_SIZE     100     // Ventana de 100ms para cálculo RMS @ 1kHz
-#define ENVELOPE_BUFFER_SIZE 30     // Ventana de 30ms para envolvente RMS @ 1kHz
+#define EMG_ENVELOPE_GAIN   3.25f   // Envolvente lineal → escala RMS (ver computeEnvelope)
 #define EMG_WAVEFORM_GAIN_DEFAULT 5.0f  // Ganancia por defecto para visualización
+#define EMG_NOISE_BLOCK_SIZE 64     // Muestras N(0,1) de ruido de fondo por bloque
 
 // Rampa de excitación (simula reclutamiento progresivo de MUs)
 #define EXCITATION_RAMP_DURATION 0.10f  // 100ms - tiempo realista de reclutamiento
@@ -52,6 +57,10 @@
 // con valor = 2/e ≈ 0.7358, pero para nuestra fórmula centrada el pico es ~0.6065
 #define MUAP_PEAK_NORM      0.6065f // Valor analítico del pico para normalización
 
+// Kernel MUAP muestreado a Fs del modelo + acumulador overlap-add
+#define MUAP_KERNEL_SIZE    16      // Muestras máx. (potencia de 2, ≥ 12 ms @ 1 kHz)
+#define MU_NOT_QUEUED       0xFFFF  // MotorUnit::queueIndex fuera de la cola de disparos
+
 // ============================================================================
 // RANGO DE SALIDA FIJO - JUSTIFICACIÓN CIENTÍFICA (PARTE 1.2)
 // ============================================================================
@@ -128,6 +137,7 @@ struct MotorUnit {
     float firingRate;           // Frecuencia de disparo actual (Hz)
     float lastFiringTime;       // Último tiempo de disparo (s)
     float nextFiringTime;       // Próximo tiempo de disparo (s)
+    uint16_t queueIndex;        // Posición en la cola de disparos (MU_NOT_QUEUED si no está)
     bool isActive;              // Si está reclutada actualmente
 };
 
@@ -165,6 +175,15 @@ struct EMGDisplayMetrics {
     const char* conditionName;  // Nombre de la condición
 };
 
+// ============================================================================
+// OBSERVADOR DE DISPAROS (etiquetas del generador de datasets)
+// ============================================================================
+/**
+ * @brief Llamado en cada disparo de MU, dentro de tick() que genera la muestra
+ * @param amplitude Amplitud del MUAP sumado (mV)
+ */
+typedef void (*EMGFiringCallback)(void* context, uint16_t unit, float amplitude);
+
 // ============================================================================
 // CLASE EMGModel
 // ============================================================================
@@ -173,6 +192,23 @@ private:
     // Pool de unidades motoras
     MotorUnit motorUnits[MAX_MOTOR_UNITS];
     
+    // Reclutamiento por eventos: umbrales crecientes con el índice, así que
+    // las MUs reclutadas son siempre el prefijo [0, recruitedCount)
+    uint16_t recruitedCount;
+    
+    // Cola de disparos: min-heap de índices de MU ordenado por nextFiringTime
+    uint16_t firingQueue[MAX_MOTOR_UNITS];
+    uint16_t firingQueueSize;
+    
+    // MUAP de amplitud unitaria muestreado a Fs del modelo; cada disparo
+    // suma A·kernel al acumulador circular (overlap-add) y cada muestra
+    // solo lee y limpia una celda: coste por disparo, no por MU del pool
+    float muapKernel[MUAP_KERNEL_SIZE];
+    uint8_t muapKernelLength;
+    float muapKernelDeltaTime;
+    float muapAccumulator[MUAP_KERNEL_SIZE];
+    uint8_t muapAccumulatorPos;
+    
     // Estado de excitación
     float currentExcitation;        // Excitación actual (puede variar)
     float baseExcitation;           // Excitación base de la condición
@@ -183,9 +219,8 @@ private:
     // Parámetros del usuario
     EMGParameters params;
     
-    // Parámetros pendientes (cambio diferido)
-    bool hasPendingParams;
-    EMGParameters pendingParams;
+    // Instantáneas publicadas desde otro core (ver pollParameters)
+    ParamMailbox<EMGParameters> paramMailbox;
     
     // Variables para condiciones especiales
     float tremorPhase;              // Fase del temblor (rad)
@@ -197,42 +232,42 @@ private:
     
     // Ganancia para waveform
     float waveformGain;
+    std::atomic<float> waveformGainTarget;  // Escrito por la UI, leído por bloque
+    
+    // Rampas Tipo A (core/param_ramp.h, solo generación): ruido, amplitud,
+    // ganancia waveform y excitación manual sin escalón en la salida
+    RampConfig rampConfig;
+    ParamRamp noiseRamp;            // → params.noiseLevel
+    ParamRamp amplitudeRamp;        // → params.amplitude
+    ParamRamp waveformGainRamp;     // → waveformGain
+    ParamRamp excitationRamp;       // → base/current/targetExcitation (sin secuencia)
+    bool rampsActive;
     
     // Buffer para cálculo de RMS (señal AC cruda - para getRMSAmplitude)
     float rmsBuffer[RMS_BUFFER_SIZE];
     int rmsBufferIndex;
     float rmsSum;
     
-    // Buffer para envolvente RMS (señal rectificada - para getProcessedSample)
-    float envelopeBuffer[ENVELOPE_BUFFER_SIZE];
-    int envelopeBufferIndex;
-    float envelopeSum;
-    
-    // Buffers de procesamiento de señal (PARTE 7.2)
-    // Butterworth 4º orden = 2 biquad sections (cada una tiene 2 estados)
-    float filterState1[2];  // Estados del primer biquad (x1, y1)
-    float filterState2[2];  // Estados del segundo biquad (x2, y2)
-    
-    // Coeficientes IIR precalculados (pasa-banda 20-450 Hz @ 1kHz)
-    // Formato: b0, b1, b2, a1, a2 para cada biquad
-    float biquadCoeffs[2][5];
-    
-    // Filtro suavizante post-bandpass (Butterworth 2º orden @ 100 Hz)
-    float smoothingCoeffs[5];          // Coeficientes suavizado
-    float smoothingState[2];           // Estados filtro suavizante
-    
-    // Filtro Butterworth 2º orden para envelope (pasa-bajos 15 Hz)
-    float envelopeCoeffs[5];           // Coeficientes: b0, b1, b2, a1, a2
-    float envelopeState[2];            // Estados: [x_prev, y_prev]
+    // Filtros de procesamiento de señal (PARTE 7.2) sobre BiquadCascade
+    BiquadCascade bandpassFilter;      // Butterworth 4º orden 20-450 Hz (2 secciones SOS)
+    BiquadCascade smoothingFilter;     // Suavizante post-bandpass @ 80 Hz (1 sección)
+    BiquadCascade envelopeFilter;      // Envelope Butterworth 2º orden @ 6 Hz (1 sección)
     float lastProcessedValue;          // Última señal procesada
+    bool processingResetPending;       // Reset de filtros antes de la próxima muestra
     
     // Sistema de caché para evitar doble generación (BUG CRÍTICO CORREGIDO)
     float cachedRawSample;             // Última muestra cruda generada
     bool sampleIsCached;               // Flag: ¿hay muestra válida en este tick?
     
-    // Estado del generador gaussiano Box-Muller (variables de instancia para reset limpio)
-    bool gaussHasSpare;
-    float gaussSpare;
+    // Generador aleatorio (xoshiro128** + ziggurat, semilla por modelo)
+    FastRandom rng;
+    uint32_t rngSeed;                  // reset() reinicia la secuencia
+    float noiseBlock[EMG_NOISE_BLOCK_SIZE];  // Ruido de fondo N(0,1) precalculado
+    uint8_t noiseBlockPos;
+    
+    // Observador de disparos por instancia (nullptr = sin coste extra)
+    EMGFiringCallback firingCallback;
+    void* firingContext;
     
     // Filtrado digital unificado (interfaz común con ECG/PPG)
     SignalFilterChain filterChain;      // Cadena de filtros HP + LP + Notch
@@ -242,41 +277,84 @@ private:
     void initializeMotorUnits();
     void resetMotorUnitsToDefault();
     void updateMotorUnitRecruitment();
+    float computeFiringRate(const MotorUnit& mu) const;
+    void fireMotorUnit(uint16_t unit);
     float generateMUAP(float timeSinceFiring, float amplitude);
-    float gaussianRandom(float mean, float std);
+    void buildMUAPKernel(float deltaTime);
+    void resetFiringQueue();
+    void firingQueuePush(uint16_t unit);
+    void firingQueueRemove(uint16_t unit);
+    void firingQueueSiftUp(uint16_t pos);
+    void firingQueueSiftDown(uint16_t pos);
+    float gaussianRandom(float mean, float std) { return rng.gaussian(mean, std); }
     void applyConditionModifiers();
     void updateRMSBuffer(float sample);
-    void updateEnvelopeBuffer(float rectifiedSample);
     float getDefaultExcitation(EMGCondition condition) const;
     
     // Procesamiento de señal (PARTE 7.3)
     void initBiquadCoefficients();      // Inicializa coeficientes Butterworth pasa-banda
     void initSmoothingCoefficients();   // Inicializa filtro suavizante 100 Hz
     void initEnvelopeCoefficients();    // Inicializa coeficientes Butterworth pasa-bajos envelope
-    float applyBiquadSection(float input, float* state, const float* coeffs);
     float applyBandpassFilter(float input);
     float applySmoothingFilter(float input);  // Nuevo: suaviza picos post-bandpass
     float applyRectification(float input);
     float applyRMSEnvelope(float input);
+    float computeEnvelope(float raw);   // Pipeline completo, una muestra
+    void processEnvelopeBlock(const float* raw, float* envelope, size_t n);
+    void tickRaw(float deltaTime);      // tick() sin envolvente
+    static uint8_t voltageToWaveformCode(float voltage);
     void resetProcessingBuffers();      // Reset buffers al cambiar condición
-    
-    // Conversión DAC
-    uint8_t voltageToDACValue(float voltage) const;
+    void applyProcessingReset();
+    void resetRamps();
+    void stepRamps();
+    void setExcitationRampTarget(float exc);
     
 public:
     EMGModel();
     
+    // Conversión DAC (escala fija ±5 mV, compartida con la reproducción)
+    static uint8_t voltageToDACValue(float voltage);
+    static float voltageToDACLevel(float voltage);      // Sin cuantizar (pipeline DAC)
+    static float envelopeToDACLevel(float envelope);    // Envolvente 0-2 mV → 0-255
+    
     // Configuración
     void setParameters(const EMGParameters& newParams);
+    
+    /**
+     * @brief Publica una instantánea completa (seguro desde cualquier core)
+     * @note Se adopta en pollParameters() al empezar el siguiente bloque
+     */
     void setPendingParameters(const EMGParameters& newParams);
-    void reset();
     
-    // Parámetros Tipo A (aplicación inmediata con validación)
+    /**
+     * @brief Adopta la última instantánea publicada (frontera de bloque)
+     * @note Solo desde la tarea de generación
+     */
+    void pollParameters();
+    
+    /**
+     * @brief Evalúa las rampas Tipo A para el siguiente bloque de n muestras
+     * @note Solo desde la tarea de generación, después de pollParameters()
+     */
+    void advanceRamps(size_t n, float deltaTime);
+    void setRampConfig(const RampConfig& config) { rampConfig = config; }
+    void reset();
+    void setSeed(uint32_t seed) { rngSeed = seed; rng.seed(seed); }  // Secuencia reproducible
+    uint32_t getSeed() const { return rngSeed; }
+    void setFiringCallback(EMGFiringCallback callback, void* context) {
+        firingCallback = callback;
+        firingContext = context;
+    }
+    
+    // Parámetros Tipo A (rampa hacia el valor validado)
     void setNoiseLevel(float noise);
     void setAmplitude(float amp);
     void setExcitationLevel(float exc);  // Aplica excitación SIN resetear secuencias
-    void setWaveformGain(float gain) { waveformGain = constrain(gain, 0.5f, 2.0f); }
-    float getWaveformGain() const { return waveformGain; }
+    // Seguro desde cualquier core: la tarea de generación lo adopta por bloque
+    void setWaveformGain(float gain) {
+        waveformGainTarget.store(constrain(gain, 0.5f, 2.0f), std::memory_order_relaxed);
+    }
+    float getWaveformGain() const { return waveformGainTarget.load(std::memory_order_relaxed); }
     
     // ✅ NUEVO: Método principal de tick (llamar 1 vez por ciclo)
     /**
@@ -306,8 +384,8 @@ public:
     // ✅ MODIFICADO: Salida PROCESADA (sin deltaTime, usa caché)
     /**
      * @brief Obtiene muestra PROCESADA cacheada
-     * Pipeline: Cruda → Filtro → Rectificación → Envolvente RMS
-     * @return Envolvente RMS en mV (0-5 mV unipolar)
+     * Pipeline: Cruda → Pasa-banda → Suavizante → Rectificación → Envolvente
+     * @return Envolvente en mV, escala RMS (0-5 mV unipolar)
      * 
      * PREREQUISITO: tick(deltaTime) debe haberse llamado antes
      */
@@ -319,6 +397,33 @@ public:
      */
     uint8_t getProcessedDACValue();
     
+    // =========================================================================
+    // GENERACIÓN POR BLOQUES (n × tick())
+    // =========================================================================
+    /**
+     * @brief Genera n muestras crudas en mV (equivale a n × tick + getRawSample)
+     */
+    void generateBlock(float* out, size_t n, float deltaTime);
+    
+    /**
+     * @brief Genera n muestras como códigos DAC de la señal cruda
+     */
+    void generateBlockDAC(uint8_t* out, size_t n, float deltaTime);
+    
+    /**
+     * @brief Genera n muestras como códigos waveform Nextion del canal 0 (cruda)
+     */
+    void generateBlockDisplay(uint8_t* out, size_t n, float deltaTime);
+    
+    /**
+     * @brief Genera n muestras rellenando todas las salidas no nulas del bloque
+     * @param envelopeDAC true: dac = envolvente (getProcessedDACValue), false: cruda
+     * @note valueMV = cruda, envelopeMV = envolvente, wave0/wave1 = Ch0/Ch1.
+     *       La envolvente se filtra por bloques de MODEL_BLOCK_SIZE
+     *       (BiquadCascade::processBlock) con el mismo estado que tick().
+     */
+    void generateBlock(const SampleBlock& out, size_t n, float deltaTime, bool envelopeDAC = false);
+    
     // ❌ DEPRECATED: Métodos antiguos (mantener compatibilidad temporal)
     float generateSample(float deltaTime);  // Usar tick() en su lugar
     uint8_t getDACValue(float deltaTime);   // Usar getRawDACValue() en su lugar
@@ -346,6 +451,7 @@ public:
     
     // Getters de parámetros
     EMGCondition getCondition() const { return params.condition; }
+    const EMGParameters& getParameters() const { return params; }
     float getNoiseLevel() const { return params.noiseLevel; }
     float getAmplitude() const { return params.amplitude; }
     float getExcitation() const { return currentExcitation; }
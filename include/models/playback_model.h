@@ -0,0 +1,150 @@
+/**
+ * @file playback_model.h
+ * @brief Reproducción de señales grabadas en flash (generador arbitrario)
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ *
+ * Fuente alternativa a los modelos ECG/EMG/PPG: lee un archivo .bsr
+ * (formato de SignalRecorder, ver signal_recorder.h) desde SPIFFS y entrega
+ * sus muestras al motor a la Fs con que se grabó. El motor las remuestrea a
+ * FS_TIMER_HZ y las pasa por el mismo camino que un modelo (escalado DAC,
+ * canal del MUX, taps de display y WebSocket).
+ *
+ * Memoria constante: dos buffers de PLAYBACK_READ_CHUNK bytes. Una tarea de
+ * baja prioridad llena por adelantado el buffer libre mientras la tarea de
+ * generación decodifica el otro; la generación nunca espera al flash (si
+ * el lector se retrasa, se repite la última muestra y se cuenta underrun).
+ *
+ * El archivo se reproduce en bucle. Los bloques con otra señal u otra Fs que
+ * la del primer bloque se saltan (la escala y el filtro son los del primero).
+ * Archivos de registros externos (p.ej. MIT-BIH): tools/encode_recording.py
+ */
+
+#ifndef PLAYBACK_MODEL_H
+#define PLAYBACK_MODEL_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
+#include "config.h"
+#include "data/signal_types.h"
+#include "core/signal_recorder.h"     // Formato .bsr
+
+// ============================================================================
+// CONFIGURACIÓN
+// ============================================================================
+#define PLAYBACK_READ_CHUNK         1024            // Bytes por lectura (×2 buffers)
+#define PLAYBACK_READER_PERIOD_MS   5               // 1 KB cada 5 ms >> 1 kHz × ~1.1 B
+#define PLAYBACK_OPEN_TIMEOUT_MS    500
+#define PLAYBACK_MAX_PATH           32
+
+// ============================================================================
+// ESTRUCTURAS
+// ============================================================================
+enum class PlaybackState : uint8_t {
+    IDLE = 0,
+    OPENING,        // Esperando a que el lector abra el archivo
+    PLAYING,
+    CLOSING,        // Esperando a que el lector cierre el archivo
+    ERROR
+};
+
+struct PlaybackStats {
+    uint32_t samplesPlayed;
+    uint32_t underruns;         // Muestras repetidas (lector sin datos)
+    uint32_t loops;             // Vueltas completas al archivo
+    uint32_t skippedBlocks;     // Bloques de otra señal/Fs o corruptos
+};
+
+// ============================================================================
+// CLASE PlaybackModel
+// ============================================================================
+class PlaybackModel {
+public:
+    PlaybackModel();
+
+    /**
+     * @brief Monta el sistema de archivos y crea la tarea lectora
+     */
+    bool begin();
+
+    // ========================================================================
+    // CONTROL (tarea de UI/HTTP, con la señal detenida)
+    // ========================================================================
+
+    /**
+     * @brief Abre un archivo .bsr y espera a tener el primer buffer leído
+     * @return false si no existe, no es .bsr o el lector no respondió a tiempo
+     */
+    bool open(const char* path);
+    void close();
+    bool isOpen() const { return state.load(std::memory_order_acquire) == PlaybackState::PLAYING; }
+
+    // Identidad del archivo (cabecera del primer bloque)
+    SignalType getSignalType() const { return signalType; }
+    uint8_t getCondition() const { return conditionId; }
+    uint16_t getSampleRate() const { return sampleRateHz; }
+    const char* getPath() const { return path; }
+
+    PlaybackState getState() const { return state.load(std::memory_order_acquire); }
+    PlaybackStats getStats() const { return stats; }
+    static const char* getStateName(PlaybackState s);
+
+    // ========================================================================
+    // LADO GENERADOR (tarea de generación, nunca bloquea)
+    // ========================================================================
+
+    /**
+     * @brief Entrega n muestras rellenando las salidas no nulas del bloque
+     * @note dac con la escala del modelo de la señal grabada,
+     *       valueMV = muestra grabada, wave0 = dac, wave1/envelopeMV = 0
+     */
+    void generateBlock(const SampleBlock& out, size_t n);
+
+private:
+    enum : uint8_t { BUF_FREE = 0, BUF_READY };
+    enum DecodeStage : uint8_t { STAGE_HEADER = 0, STAGE_SKIP, STAGE_SAMPLES };
+
+    // Doble buffer: el lector llena uno mientras el generador decodifica el otro
+    uint8_t buffers[2][PLAYBACK_READ_CHUNK];
+    uint16_t bufferLength[2];
+    std::atomic<uint8_t> bufferState[2];
+    uint8_t fillIndex;              // Próximo buffer del lector
+    uint8_t readIndex;              // Buffer del generador
+    uint16_t readPos;
+
+    // Decodificador incremental (las cabeceras y varints cruzan buffers)
+    uint8_t header[RECORDER_HEADER_SIZE];
+    uint8_t headerPos;
+    DecodeStage stage;
+    uint16_t skipBytes;
+    uint16_t samplesLeft;
+    uint16_t uvPerLsb;
+    bool firstInBlock;
+    uint32_t varint;
+    uint8_t varintShift;
+    int32_t lastValue;
+    float lastMV;
+
+    // Identidad del archivo
+    char path[PLAYBACK_MAX_PATH];
+    SignalType signalType;
+    uint8_t conditionId;
+    uint16_t sampleRateHz;
+
+    std::atomic<PlaybackState> state;
+    PlaybackStats stats;
+    TaskHandle_t readerTaskHandle;
+
+    void resetDecoder();
+    bool nextByte(uint8_t& b);
+    bool decodeSample(float& mV);
+    bool parseHeader();
+
+    static void readerTask(void* parameter);
+    void readerCycle();
+    bool readFirstHeader();
+};
+
+#endif // PLAYBACK_MODEL_H
@@ -27,6 +27,10 @@
 #include <Arduino.h>
 #include "../data/signal_types.h"
 #include "../core/digital_filters.h"
+#include "../core/fast_random.h"
+#include "../core/param_mailbox.h"
+#include "../core/param_ramp.h"
+#include <atomic>
 
 // ============================================================================
 // CONSTANTES BASE DEL MODELO PPG (Ajustadas empíricamente)
@@ -62,6 +66,9 @@
 #define PPG_SYSTOLE_MIN_MS   250.0f  // Mínimo a HR muy alto
 #define PPG_SYSTOLE_MAX_MS   350.0f  // Máximo a HR muy bajo
 
+// --- Tabla de forma de pulso (fase 0-1, interpolación lineal) ---
+#define PPG_WAVETABLE_SIZE   1024    // Puntos por ciclo (+1 de guarda)
+
 // ============================================================================
 // ESTRUCTURA PARA RANGOS DE CONDICIÓN (según tabla rangos_clinicos.md)
 // ============================================================================
@@ -87,9 +94,9 @@ private:
     float currentRR;            // Intervalo RR actual (segundos)
     uint32_t beatCount;
     
-    // Estado para generador gaussiano (Box-Muller)
-    bool gaussHasSpare;
-    float gaussSpare;
+    // Generador aleatorio (xoshiro128** + ziggurat, semilla por modelo)
+    FastRandom rng;
+    uint32_t rngSeed;           // reset() reinicia la secuencia
     
     // Parámetros de forma de onda (normalizados, NO en mV)
     float systolicAmplitude;    // Escala sistólica (base 1.0)
@@ -99,10 +106,18 @@ private:
     float dicroticDepth;        // Profundidad muesca (base 0.25)
     float dicroticWidth;        // σ muesca
     
+    // Forma normalizada [0,1] precalculada por fase; se reconstruye solo
+    // cuando cambian los parámetros de forma (condición)
+    float pulseTable[PPG_WAVETABLE_SIZE + 1];
+    bool pulseTableValid;
+    
     // Parámetros de entrada
     PPGParameters params;
     
-    // Parámetros pendientes (Tipo B)
+    // Instantáneas publicadas desde otro core (ver pollParameters)
+    ParamMailbox<PPGParameters> paramMailbox;
+    
+    // Parámetros pendientes (Tipo B, solo tarea de generación: se aplican al latido)
     bool hasPendingParams;
     PPGParameters pendingParams;
     
@@ -154,6 +169,18 @@ private:
     // DC baseline configurable
     float dcBaseline;           // Nivel DC en mV (0 = señal AC pura)
     
+    // Objetivos escritos por la UI (cualquier core), leídos por bloque
+    std::atomic<float> dcBaselineTarget;
+    std::atomic<float> waveformGainTarget;
+    
+    // Rampas Tipo A (core/param_ramp.h, solo generación)
+    RampConfig rampConfig;
+    ParamRamp noiseRamp;            // → params.noiseLevel
+    ParamRamp piRamp;               // → currentPI (amplitud AC)
+    ParamRamp dcBaselineRamp;       // → dcBaseline
+    ParamRamp waveformGainRamp;     // → params.amplification
+    bool rampsActive;
+    
     // Filtrado digital
     SignalFilterChain filterChain;      // Cadena de filtros HP + LP + Notch
     bool filteringEnabled;              // Control de filtrado
@@ -164,23 +191,49 @@ private:
     float generateDynamicPI();                  // PI dentro del rango con variabilidad
     float calculateSystoleFraction(float hr);   // f(HR) → fracción sistólica
     float generateNextRR();
-    float gaussianRandom(float mean, float std);
+    float gaussianRandom(float mean, float std) { return rng.gaussian(mean, std); }
     float computePulseShape(float phase);       // Retorna forma normalizada [0,1]
+    void rebuildPulseTable();                   // computePulseShape → pulseTable
+    float samplePulseTable(float phase) const;  // Interpolación lineal en la tabla
     float normalizePulse(float rawPulse);       // Normaliza a [0,1]
     void applyConditionModifiers();
     void detectBeatAndApplyPending();
+    void stepRamps();
     
     // Conversión
     uint8_t voltageToDACValue(float voltage);
-    uint8_t acValueToDACValue(float acValue_mV);  // Solo componente AC para DAC
     
 public:
     PPGModel();
     
+    // Conversión AC → DAC (escala fija 0-150 mV, compartida con la reproducción)
+    static uint8_t acValueToDACValue(float acValue_mV);
+    static float acValueToDACLevel(float acValue_mV);   // Sin cuantizar (pipeline DAC)
+    
     // Configuración
     void setParameters(const PPGParameters& newParams);
+    
+    /**
+     * @brief Publica una instantánea completa (seguro desde cualquier core)
+     * @note Se adopta en pollParameters(): Tipo A al momento, resto al latido
+     */
     void setPendingParameters(const PPGParameters& newParams);
+    
+    /**
+     * @brief Adopta la última instantánea publicada (frontera de bloque)
+     * @note Solo desde la tarea de generación
+     */
+    void pollParameters();
+    
+    /**
+     * @brief Evalúa las rampas Tipo A para el siguiente bloque de n muestras
+     * @note Solo desde la tarea de generación, después de pollParameters()
+     */
+    void advanceRamps(size_t n, float deltaTime);
+    void setRampConfig(const RampConfig& config) { rampConfig = config; }
     void reset();
+    void setSeed(uint32_t seed) { rngSeed = seed; rng.seed(seed); }  // Secuencia reproducible
+    uint32_t getSeed() const { return rngSeed; }
     
     // =========================================================================
     // PARAMETROS AJUSTABLES DESDE SLIDERS NEXTION
@@ -197,28 +250,35 @@ public:
     }
     
     // PI: 0.5-20% - Modula amplitud AC, no toca posicion de pico ni muesca
+    // (rampa hasta el objetivo; el siguiente latido vuelve al PI dinámico)
     void setPerfusionIndex(float pi) {
         pi = constrain(pi, 0.5f, 20.0f);
         params.perfusionIndex = pi;
-        currentPI = pi;
+        piRamp.setTarget(pi, rampConfig);
     }
     
-    // Noise: 0-1 - Ruido gaussiano proporcional a AC
+    // Noise: 0-1 - Ruido gaussiano proporcional a AC (con rampa)
     void setNoiseLevel(float noise) { 
-        params.noiseLevel = constrain(noise, 0.0f, 1.0f); 
+        noiseRamp.setTarget(constrain(noise, 0.0f, 1.0f), rampConfig);
     }
     
     // Alias para compatibilidad
     void setAmplitude(float amp) { setPerfusionIndex(amp); }
     
-    // Configuracion de baseline
-    void setDCBaseline(float dc) { dcBaseline = dc; }
-    float getDCBaselineConfig() const { return dcBaseline; }
+    // Configuracion de baseline (seguro desde cualquier core, con rampa)
+    void setDCBaseline(float dc) { dcBaselineTarget.store(dc, std::memory_order_relaxed); }
+    float getDCBaselineConfig() const { return dcBaselineTarget.load(std::memory_order_relaxed); }
     
     // Generación
     float generateSample(float deltaTime);
     uint8_t getDACValue(float deltaTime);
     
+    // Generación por bloques (n × generateSample)
+    void generateBlock(float* out, size_t n, float deltaTime);          // Señal DC+AC en mV
+    void generateBlockDAC(uint8_t* out, size_t n, float deltaTime);     // Códigos DAC (solo AC)
+    void generateBlockDisplay(uint8_t* out, size_t n, float deltaTime); // Códigos waveform Nextion
+    void generateBlock(const SampleBlock& out, size_t n, float deltaTime); // valueMV = componente AC
+    
     // Getters
     float getCurrentHeartRate() const { return currentHR; }
     float getCurrentRRInterval() const { return currentRR * 1000.0f; } // ms
@@ -230,8 +290,11 @@ public:
     float getNoiseLevel() const { return params.noiseLevel; }
     float getCurrentPI() const { return currentPI; }
     float getAmplification() const { return params.amplification; }
-    void setWaveformGain(float gain) { params.amplification = constrain(gain, 0.5f, 2.0f); }
-    float getWaveformGain() const { return params.amplification; }
+    // Seguro desde cualquier core: la tarea de generación lo adopta por bloque
+    void setWaveformGain(float gain) {
+        waveformGainTarget.store(constrain(gain, 0.5f, 2.0f), std::memory_order_relaxed);
+    }
+    float getWaveformGain() const { return waveformGainTarget.load(std::memory_order_relaxed); }
     const PPGParameters& getParameters() const { return params; }
     
     // Métricas calculadas (del modelo)
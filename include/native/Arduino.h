@@ -0,0 +1,128 @@
+/**
+ * @file Arduino.h
+ * @brief HAL de host: sustituto mínimo de Arduino-ESP32 para el entorno [env:native]
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ *
+ * Solo se incluye en el build nativo (-I include/native). Expone el
+ * subconjunto de la API Arduino que usan los modelos, los filtros y el
+ * motor de señales: tiempo (micros/millis), GPIO/DAC, timer hardware,
+ * Serial y ESP. La implementación está en src/native/hal_native.cpp.
+ *
+ * El control del host (reloj simulado, disparo del timer, semilla)
+ * se expone en hal_native.h.
+ */
+
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+
+// ============================================================================
+// CONSTANTES Y MACROS ARDUINO
+// ============================================================================
+#define PI              3.1415926535897932384626433832795
+#define HALF_PI         1.5707963267948966192313216916398
+#define TWO_PI          6.283185307179586476925286766559
+#define DEG_TO_RAD      0.017453292519943295769236907684886
+#define RAD_TO_DEG      57.295779513082320876798154814105
+
+#define HIGH            0x1
+#define LOW             0x0
+#define INPUT           0x01
+#define OUTPUT          0x03
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// Atributos de sección: sin efecto en host
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+// ============================================================================
+// TIEMPO
+// ============================================================================
+uint32_t micros();
+uint32_t millis();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+// ============================================================================
+// GPIO / DAC / ADC
+// ============================================================================
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+uint16_t analogRead(uint8_t pin);
+void dacWrite(uint8_t pin, uint8_t value);
+
+// ============================================================================
+// TIMER HARDWARE (se dispara manualmente desde hal_native.h)
+// ============================================================================
+struct hw_timer_s;
+typedef struct hw_timer_s hw_timer_t;
+
+hw_timer_t* timerBegin(uint8_t num, uint16_t divider, bool countUp);
+void timerEnd(hw_timer_t* timer);
+void timerAttachInterrupt(hw_timer_t* timer, void (*fn)(void), bool edge);
+void timerDetachInterrupt(hw_timer_t* timer);
+void timerAlarmWrite(hw_timer_t* timer, uint64_t alarmValue, bool autoreload);
+void timerAlarmEnable(hw_timer_t* timer);
+void timerAlarmDisable(hw_timer_t* timer);
+
+// ============================================================================
+// SERIAL (redirigido a stdout)
+// ============================================================================
+class HardwareSerial {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+    int available() { return 0; }
+    int read() { return -1; }
+    int availableForWrite() { return 128; }  // FIFO TX de la UART del ESP32
+    void flush() { fflush(stdout); }
+    operator bool() const { return true; }
+
+    size_t write(uint8_t c);
+    size_t write(const uint8_t* buffer, size_t size);
+
+    size_t print(const char* s);
+    size_t print(char c);
+    size_t print(int value);
+    size_t print(unsigned int value);
+    size_t print(long value);
+    size_t print(unsigned long value);
+    size_t print(double value, int digits = 2);
+
+    size_t println();
+    size_t println(const char* s);
+    size_t println(int value);
+    size_t println(unsigned int value);
+    size_t println(long value);
+    size_t println(unsigned long value);
+    size_t println(double value, int digits = 2);
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+extern HardwareSerial Serial;
+
+// ============================================================================
+// ESP (información del sistema)
+// ============================================================================
+class EspClass {
+public:
+    uint32_t getFreeHeap() { return 0; }
+    uint32_t getCpuFreqMHz() { return 240; }
+    uint32_t getCycleCount();       // CCOUNT equivalente: reloj real × getCpuFreqMHz()
+};
+
+extern EspClass ESP;
+
+#endif // NATIVE_ARDUINO_H
@@ -0,0 +1,19 @@
+/**
+ * @file esp_random.h
+ * @brief HAL de host: generador aleatorio equivalente a esp_random()
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ *
+ * En el build nativo el RNG hardware se sustituye por un xorshift32
+ * sembrable con halNativeSeedRandom() para que las corridas sean
+ * reproducibles.
+ */
+
+#ifndef NATIVE_ESP_RANDOM_H
+#define NATIVE_ESP_RANDOM_H
+
+#include <stdint.h>
+
+uint32_t esp_random(void);
+
+#endif // NATIVE_ESP_RANDOM_H
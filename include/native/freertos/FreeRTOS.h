@@ -0,0 +1,29 @@
+/**
+ * @file FreeRTOS.h
+ * @brief HAL de host: tipos y constantes base de FreeRTOS
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ *
+ * Tareas sobre std::thread y semáforos sobre std::mutex (ver hal_native.cpp).
+ * Un tick equivale a 1 ms, igual que configTICK_RATE_HZ=1000 en ESP32.
+ */
+
+#ifndef NATIVE_FREERTOS_H
+#define NATIVE_FREERTOS_H
+
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE             ((BaseType_t)0)
+#define pdTRUE              ((BaseType_t)1)
+#define pdFAIL              pdFALSE
+#define pdPASS              pdTRUE
+
+#define portMAX_DELAY       ((TickType_t)0xFFFFFFFFUL)
+#define portTICK_PERIOD_MS  ((TickType_t)1)
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+
+#endif // NATIVE_FREERTOS_H
@@ -0,0 +1,34 @@
+/**
+ * @file task.h
+ * @brief HAL de host: API de tareas FreeRTOS usada por el firmware
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ */
+
+#ifndef NATIVE_FREERTOS_TASK_H
+#define NATIVE_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+struct NativeTask;
+typedef NativeTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+/**
+ * @brief Crea una tarea como std::thread desacoplado (core y prioridad se ignoran)
+ */
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t taskCode, const char* name,
+                                   uint32_t stackDepth, void* parameter,
+                                   UBaseType_t priority, TaskHandle_t* createdTask,
+                                   BaseType_t coreId);
+
+/**
+ * @brief Core de la tarea actual: el coreId de xTaskCreatePinnedToCore, o
+ *        1 para el hilo principal (loop de Arduino en el ESP32)
+ */
+BaseType_t xPortGetCoreID();
+
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount();
+
+#endif // NATIVE_FREERTOS_TASK_H
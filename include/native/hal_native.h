@@ -0,0 +1,74 @@
+/**
+ * @file hal_native.h
+ * @brief Control del HAL de host (solo build nativo)
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ *
+ * Permite ejecutar el motor de señales de forma determinista en el PC:
+ * - Reloj simulado: micros()/millis() avanzan solo con halNativeAdvanceMicros()
+ * - Timer ISR: se dispara con halNativeFireTimer() (consume el buffer del DAC)
+ * - RNG: semilla fija para esp_random()
+ * - Serial: se puede silenciar para benchmarks
+ */
+
+#ifndef HAL_NATIVE_H
+#define HAL_NATIVE_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// RELOJ
+// ============================================================================
+
+/**
+ * @brief Activa el reloj simulado (true) o el reloj real del host (false)
+ */
+void halNativeUseSimulatedClock(bool enabled);
+
+/**
+ * @brief Avanza el reloj simulado
+ * @param us Microsegundos a avanzar
+ */
+void halNativeAdvanceMicros(uint32_t us);
+
+/**
+ * @brief Tiempo monotónico real del host en nanosegundos (para medir)
+ */
+uint64_t halNativeNanos();
+
+// ============================================================================
+// TIMER / DAC
+// ============================================================================
+
+/**
+ * @brief Ejecuta la ISR adjunta al timer habilitado
+ * @param count Número de disparos
+ * @return Disparos ejecutados (0 si no hay timer activo)
+ */
+uint32_t halNativeFireTimer(uint32_t count);
+
+/**
+ * @brief Último valor escrito con dacWrite()
+ */
+uint8_t halNativeGetLastDAC();
+
+/**
+ * @brief Total de escrituras al DAC desde el arranque
+ */
+uint32_t halNativeGetDACWrites();
+
+// ============================================================================
+// RNG / SERIAL
+// ============================================================================
+
+/**
+ * @brief Fija la semilla de esp_random() y rand()
+ */
+void halNativeSeedRandom(uint32_t seed);
+
+/**
+ * @brief Habilita/silencia la salida de Serial a stdout
+ */
+void halNativeSetSerialEnabled(bool enabled);
+
+#endif // HAL_NATIVE_H
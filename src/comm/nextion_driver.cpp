@@ -6,6 +6,8 @@
  */
 
 #include "comm/nextion_driver.h"
+#include "core/perf_counters.h"
+#include "core/trace_ring.h"
 
 // ============================================================================
 // CONSTRUCTOR
@@ -16,6 +18,18 @@ NextionDriver::NextionDriver(HardwareSerial& serialPort) : serial(serialPort) {
     currentPage = NextionPage::PORTADA;
     displayedSignal = SignalType::NONE;
     lastRxTime = 0;
+    
+    waveComponentId = WAVEFORM_COMPONENT_ID;
+    addtState = AddtState::IDLE;
+    addtDataCount = 0;
+    addtStateMs = 0;
+    addtNextChannel = 0;
+    addtFailures = 0;
+    addtEnabled = true;
+    addtLateReady = false;
+    deferredHead = 0;
+    deferredCount = 0;
+    discardWaveformBatches();
 }
 
 // ============================================================================
@@ -40,6 +54,14 @@ bool NextionDriver::begin() {
     // Limpiar buffer nuevamente después del reset
     while(serial.available()) serial.read();
     
+    // Tras el reset no hay transferencia addt pendiente
+    addtState = AddtState::IDLE;
+    addtFailures = 0;
+    addtEnabled = true;
+    addtLateReady = false;
+    deferredCount = 0;
+    discardWaveformBatches();
+    
     // Ir a página portada
     goToPage(NextionPage::PORTADA);
     delay(100);
@@ -51,11 +73,15 @@ bool NextionDriver::begin() {
 // COMANDOS BÁSICOS
 // ============================================================================
 void NextionDriver::sendCommand(const char* cmd) {
+    // Entre "addt" y 0xFE la Nextion tomaría el comando como datos del bloque
+    if (addtState != AddtState::IDLE) waitWaveformIdle();
+    
     // Serial.printf("[TX] %s\n", cmd);  // DEBUG: desactivado para Serial Plotter
     serial.print(cmd);
     serial.write(0xFF);
     serial.write(0xFF);
     serial.write(0xFF);
+    TRACE_INSTANT(NEXTION_CMD, strlen(cmd) + 3);
 }
 
 void NextionDriver::sendEndSequence() {
@@ -69,43 +95,106 @@ void NextionDriver::sendEndSequence() {
 // PROCESAR EVENTOS
 // ============================================================================
 void NextionDriver::process() {
+    // Toques que llegaron mientras sendCommand() esperaba el handshake addt
+    dispatchDeferredEvents();
+    
     // Timeout: si han pasado >200ms sin completar mensaje, limpiar buffer
     if (rxIndex > 0 && (millis() - lastRxTime) > 200) {
         rxIndex = 0;
         memset(rxBuffer, 0, sizeof(rxBuffer));
     }
     
+    readMessages(false);
+    checkWaveformTimeout();
+}
+
+/**
+ * @brief Lee los mensajes completos disponibles en la UART
+ * @param deferEvents true → encolar los toques en lugar de despacharlos
+ *
+ * El buffer se limpia antes de despachar: el callback puede enviar comandos
+ * y éstos recibir bytes (waitWaveformIdle) sobre este mismo buffer.
+ */
+void NextionDriver::readMessages(bool deferEvents) {
     while (serial.available()) {
-        uint8_t byte = serial.read();
-        lastRxTime = millis();
+        if (!receiveByte(serial.read())) continue;
         
-        if (rxIndex < sizeof(rxBuffer)) {
-            rxBuffer[rxIndex++] = byte;
-        } else {
-            // Buffer overflow, resetear completamente
-            rxIndex = 0;
-            memset(rxBuffer, 0, sizeof(rxBuffer));
-            rxBuffer[rxIndex++] = byte;
-        }
+        // Respuestas del handshake addt (0xFE / 0xFD) no son eventos de UI
+        NextionTouch touch;
+        bool isTouch = !handleTransferResponse() && parseEvent(touch);
         
-        // Verificar fin de mensaje (3 x 0xFF)
-        if (rxIndex >= 3 && 
-            rxBuffer[rxIndex-1] == 0xFF &&
-            rxBuffer[rxIndex-2] == 0xFF &&
-            rxBuffer[rxIndex-3] == 0xFF) {
-            
-            parseEvent();
-            
-            // CRÍTICO: limpiar buffer Y resetear índice
-            memset(rxBuffer, 0, sizeof(rxBuffer));
-            rxIndex = 0;
-        }
+        // CRÍTICO: limpiar buffer Y resetear índice
+        memset(rxBuffer, 0, sizeof(rxBuffer));
+        rxIndex = 0;
+        
+        if (!isTouch) continue;
+        if (deferEvents) deferEvent(touch);
+        else dispatchEvent(touch);
     }
 }
 
-void NextionDriver::parseEvent() {
+/**
+ * @brief Añade un byte al buffer de recepción
+ * @return true si completa un mensaje (termina en 3 x 0xFF)
+ */
+bool NextionDriver::receiveByte(uint8_t byte) {
+    lastRxTime = millis();
+    
+    if (rxIndex < sizeof(rxBuffer)) {
+        rxBuffer[rxIndex++] = byte;
+    } else {
+        // Buffer overflow, resetear completamente
+        rxIndex = 0;
+        memset(rxBuffer, 0, sizeof(rxBuffer));
+        rxBuffer[rxIndex++] = byte;
+    }
+    
+    // Verificar fin de mensaje (3 x 0xFF)
+    return rxIndex >= 3 &&
+           rxBuffer[rxIndex-1] == 0xFF &&
+           rxBuffer[rxIndex-2] == 0xFF &&
+           rxBuffer[rxIndex-3] == 0xFF;
+}
+
+/**
+ * @brief Procesa 0xFE (listo para datos) y 0xFD (datos recibidos) de addt
+ * @return true si el mensaje era una respuesta del handshake
+ */
+bool NextionDriver::handleTransferResponse() {
+    // Formato exacto: código + 3 x 0xFF (el buffer se limpia tras cada mensaje)
+    if (rxIndex != 4) return false;
+    uint8_t code = rxBuffer[0];
+    
+    // 0xFE tardío: la Nextion sigue esperando addtDataCount bytes y tomaría
+    // los siguientes comandos como datos. addtData no cambia hasta la próxima
+    // transferencia, así que se entrega el bloque pendiente.
+    bool lateReady = code == 0xFE && addtState == AddtState::IDLE && addtLateReady;
+    
+    if (code == 0xFE && (addtState == AddtState::WAIT_READY || lateReady)) {
+        PERF_BEGIN(sendStart);
+        serial.write(addtData, addtDataCount);
+        PERF_END(NEXTION_SEND, sendStart);
+        TRACE_INSTANT(NEXTION_CMD, addtDataCount);
+        addtState = AddtState::WAIT_DONE;
+        addtStateMs = millis();
+        addtFailures = 0;
+        addtLateReady = false;
+        return true;
+    }
+    if (code == 0xFD && addtState == AddtState::WAIT_DONE) {
+        addtState = AddtState::IDLE;
+        return true;
+    }
+    return code == 0xFE || code == 0xFD;   // 0xFD tardío tras timeout: ignorar
+}
+
+/**
+ * @brief Extrae el evento touch del mensaje en rxBuffer (sin despacharlo)
+ * @return true si es un evento de release (1)
+ */
+bool NextionDriver::parseEvent(NextionTouch& touch) {
     if (rxIndex < 4) {
-        return;
+        return false;
     }
     
     // Buscar el byte 0x65 (evento touch) en el buffer
@@ -122,16 +211,22 @@ void NextionDriver::parseEvent() {
     }
     
     if (eventStart < 0) {
-        return;
+        return false;
     }
     
-    uint8_t page = rxBuffer[eventStart + 1];
-    uint8_t component = rxBuffer[eventStart + 2];
-    uint8_t touchEvent = rxBuffer[eventStart + 3];
+    touch.page = rxBuffer[eventStart + 1];
+    touch.component = rxBuffer[eventStart + 2];
+    touch.event = rxBuffer[eventStart + 3];
     
-    if (touchEvent != 1) {
-        return;  // Solo eventos de release (1)
-    }
+    return touch.event == 1;  // Solo eventos de release (1)
+}
+
+/**
+ * @brief Traduce un toque a UIEvent y llama al callback
+ */
+void NextionDriver::dispatchEvent(const NextionTouch& touch) {
+    uint8_t page = touch.page;
+    uint8_t component = touch.component;
     
     UIEvent uiEvent = UIEvent::NONE;
     uint8_t param = 0;
@@ -436,6 +531,22 @@ void NextionDriver::parseEvent() {
         }
 }
 
+void NextionDriver::deferEvent(const NextionTouch& touch) {
+    if (deferredCount >= NEXTION_DEFERRED_EVENTS) return;   // Cola llena: se pierde el toque
+    deferredTouch[(deferredHead + deferredCount) % NEXTION_DEFERRED_EVENTS] = touch;
+    deferredCount++;
+}
+
+void NextionDriver::dispatchDeferredEvents() {
+    while (deferredCount > 0) {
+        // Sacar antes de despachar: el callback puede encolar más toques
+        NextionTouch touch = deferredTouch[deferredHead];
+        deferredHead = (deferredHead + 1) % NEXTION_DEFERRED_EVENTS;
+        deferredCount--;
+        dispatchEvent(touch);
+    }
+}
+
 // ============================================================================
 // NAVEGACIÓN
 // ============================================================================
@@ -444,6 +555,9 @@ void NextionDriver::goToPage(NextionPage page) {
     sprintf(cmd, "page %d", (int)page);
     sendCommand(cmd);
     currentPage = page;
+    
+    // Los puntos pendientes eran para el waveform de la página anterior
+    discardWaveformBatches();
 }
 
 // ============================================================================
@@ -626,6 +740,13 @@ void NextionDriver::addWaveformPoint(uint8_t componentId, uint8_t channel, uint8
 }
 
 void NextionDriver::clearWaveform(uint8_t componentId, uint8_t channel) {
+    // Los puntos pendientes pertenecen al trazo que se borra
+    if (channel < NEXTION_WAVEFORM_CHANNELS) {
+        waveBatchCount[channel] = 0;
+    } else {
+        discardWaveformBatches();   // "cle id,255" borra todos los canales
+    }
+    
     char cmd[16];
     sprintf(cmd, "cle %d,%d", componentId, channel);
     sendCommand(cmd);
@@ -635,6 +756,131 @@ void NextionDriver::sendRawCommand(const char* cmd) {
     sendCommand(cmd);
 }
 
+// ============================================================================
+// WAVEFORM POR BLOQUES (addt)
+// ============================================================================
+// "add 1,0,val"+FF FF FF son ~14 bytes UART por punto; un bloque addt de
+// NEXTION_ADDT_BATCH_SIZE puntos cuesta ~14 bytes de cabecera + 1 byte/punto.
+// Solo hay una transferencia en vuelo: la siguiente espera al 0xFD anterior
+// (control de flujo frente al buffer serie de la Nextion).
+
+/**
+ * @brief Encola un punto para el siguiente bloque addt del canal
+ * @return false si el canal está lleno (el llamador debe reintentar luego)
+ */
+bool NextionDriver::queueWaveformPoint(uint8_t componentId, uint8_t channel, uint8_t value) {
+    if (!addtEnabled) {
+        PERF_BEGIN(sendStart);
+        addWaveformPoint(componentId, channel, value);
+        PERF_END(NEXTION_SEND, sendStart);
+        return true;
+    }
+    if (channel >= NEXTION_WAVEFORM_CHANNELS) return false;
+    
+    uint16_t count = waveBatchCount[channel];
+    if (count >= NEXTION_ADDT_BUFFER_SIZE) return false;
+    
+    if (count == 0) waveBatchStartMs[channel] = millis();
+    waveComponentId = componentId;
+    waveBatch[channel][count] = value;
+    waveBatchCount[channel] = count + 1;
+    return true;
+}
+
+/**
+ * @brief Inicia la transferencia del siguiente canal listo
+ *
+ * Un canal está listo al reunir NEXTION_ADDT_BATCH_SIZE puntos o cuando su
+ * primer punto lleva NEXTION_ADDT_MAX_LATENCY_MS esperando. No bloquea: el
+ * envío de datos ocurre al recibir 0xFE en process().
+ */
+void NextionDriver::flushWaveform() {
+    checkWaveformTimeout();
+    if (addtState != AddtState::IDLE) return;
+    
+    unsigned long now = millis();
+    for (uint8_t i = 0; i < NEXTION_WAVEFORM_CHANNELS; i++) {
+        uint8_t ch = (addtNextChannel + i) % NEXTION_WAVEFORM_CHANNELS;
+        uint16_t count = waveBatchCount[ch];
+        if (count == 0) continue;
+        
+        if (count >= NEXTION_ADDT_BATCH_SIZE ||
+            now - waveBatchStartMs[ch] >= NEXTION_ADDT_MAX_LATENCY_MS) {
+            startWaveformTransfer(ch);
+            addtNextChannel = (ch + 1) % NEXTION_WAVEFORM_CHANNELS;
+            return;
+        }
+    }
+}
+
+uint16_t NextionDriver::getWaveformQueueSpace() const {
+    uint16_t maxCount = 0;
+    for (uint8_t ch = 0; ch < NEXTION_WAVEFORM_CHANNELS; ch++) {
+        if (waveBatchCount[ch] > maxCount) maxCount = waveBatchCount[ch];
+    }
+    return NEXTION_ADDT_BUFFER_SIZE - maxCount;
+}
+
+void NextionDriver::startWaveformTransfer(uint8_t channel) {
+    PERF_BEGIN(sendStart);
+    addtDataCount = waveBatchCount[channel];
+    memcpy(addtData, waveBatch[channel], addtDataCount);
+    waveBatchCount[channel] = 0;
+    
+    char cmd[24];
+    sprintf(cmd, "addt %d,%d,%d", waveComponentId, channel, addtDataCount);
+    sendCommand(cmd);
+    
+    addtState = AddtState::WAIT_READY;
+    addtStateMs = millis();
+    addtLateReady = false;
+    PERF_END(NEXTION_SEND, sendStart);
+}
+
+/**
+ * @brief Libera el handshake si la Nextion no responde a tiempo
+ *
+ * Sin 0xFE el bloque queda pendiente por si el 0xFE llega tarde; tras
+ * NEXTION_ADDT_MAX_FAILURES seguidos se asume firmware sin addt y se vuelve a
+ * "add" por punto. Sin 0xFD los datos ya se enviaron: solo se libera el estado.
+ */
+void NextionDriver::checkWaveformTimeout() {
+    if (addtState == AddtState::IDLE) return;
+    if (millis() - addtStateMs < NEXTION_ADDT_TIMEOUT_MS) return;
+    
+    if (addtState == AddtState::WAIT_READY) {
+        addtLateReady = true;
+        if (++addtFailures >= NEXTION_ADDT_MAX_FAILURES) {
+            addtEnabled = false;
+            discardWaveformBatches();
+            Serial.println("[Nextion] addt sin respuesta - usando add por punto");
+        }
+    }
+    addtState = AddtState::IDLE;
+}
+
+/**
+ * @brief Bloquea hasta terminar la transferencia addt en curso
+ *
+ * Solo atiende el handshake: los toques se difieren a process(), porque
+ * despacharlos aquí reentraría en el callback de UI desde sendCommand().
+ * Como máximo 2 x NEXTION_ADDT_TIMEOUT_MS.
+ */
+void NextionDriver::waitWaveformIdle() {
+    while (addtState != AddtState::IDLE) {
+        readMessages(true);
+        checkWaveformTimeout();
+        if (addtState != AddtState::IDLE) delay(1);
+    }
+}
+
+void NextionDriver::discardWaveformBatches() {
+    for (uint8_t ch = 0; ch < NEXTION_WAVEFORM_CHANNELS; ch++) {
+        waveBatchCount[ch] = 0;
+        waveBatchStartMs[ch] = 0;
+    }
+}
+
 // ============================================================================
 // SLIDERS
 // ============================================================================
@@ -8,6 +8,8 @@
 #include "comm/serial_handler.h"
 #include "config.h"
 #include "hw/cd4051_mux.h"
+#include "core/signal_engine.h"
+#include "core/perf_counters.h"
 
 // ============================================================================
 // CONSTRUCTOR
@@ -17,6 +19,8 @@ SerialHandler::SerialHandler(HardwareSerial& serialPort) : serial(serialPort) {
     streamingEnabled = false;
     lastStreamTime = 0;
     rxIndex = 0;
+    streamDropped = 0;
+    traceDump = nullptr;
 }
 
 // ============================================================================
@@ -30,6 +34,12 @@ void SerialHandler::begin(unsigned long baud) {
 // PROCESAR DATOS
 // ============================================================================
 void SerialHandler::process() {
+    if (traceDump) {
+        flushTraceDump();
+    } else {
+        flushStream();
+    }
+    
     while (serial.available()) {
         char c = serial.read();
         
@@ -38,6 +48,13 @@ void SerialHandler::process() {
             printHelp();
         } else if (c == 'i' || c == 'I') {
             printSystemInfo();
+        } else if (c == 'p' || c == 'P') {
+            printPerfReport();
+        } else if (c == 'z' || c == 'Z') {
+            SignalEngine::getInstance()->resetStats();
+            serial.println("[Perf] Contadores reiniciados");
+        } else if ((c == 't' || c == 'T') && !traceDump) {
+            traceDump = new TraceExporter();
         } else if (c == 'm' || c == 'M') {
             // Mostrar estado del multiplexor
             serial.println("\n--- Multiplexor CD4051 ---");
@@ -61,6 +78,8 @@ void SerialHandler::process() {
 // STREAMING
 // ============================================================================
 void SerialHandler::startStreaming() {
+    txRing.reset();
+    streamDropped = 0;
     streamingEnabled = true;
     serial.println("[Stream] Iniciado");
 }
@@ -74,10 +93,51 @@ void SerialHandler::streamSample(uint8_t dacValue, uint16_t flags) {
     if (!streamingEnabled) return;
     
     // Formato compacto: [0xBB] [sample] [flags_high] [flags_low]
-    serial.write(0xBB);
-    serial.write(dacValue);
-    serial.write((uint8_t)(flags >> 8));
-    serial.write((uint8_t)(flags & 0xFF));
+    // Paquete completo o nada: nunca se encolan paquetes partidos
+    if (txRing.space() < STREAM_PACKET_SIZE) {
+        streamDropped++;
+        return;
+    }
+    
+    uint8_t packet[STREAM_PACKET_SIZE] = {
+        STREAM_HEADER,
+        dacValue,
+        (uint8_t)(flags >> 8),
+        (uint8_t)(flags & 0xFF)
+    };
+    txRing.write_n(packet, STREAM_PACKET_SIZE);
+}
+
+void SerialHandler::flushStream() {
+    // Solo lo que cabe en el FIFO de la UART: no bloquea el loop
+    size_t pending = txRing.available();
+    if (pending == 0) return;
+    
+    size_t room = serial.availableForWrite();
+    if (pending > room) pending = room;
+    
+    uint8_t chunk[64];
+    while (pending > 0) {
+        size_t n = txRing.read_n(chunk, pending < sizeof(chunk) ? pending : sizeof(chunk));
+        if (n == 0) break;
+        serial.write(chunk, n);
+        pending -= n;
+    }
+}
+
+void SerialHandler::flushTraceDump() {
+    uint8_t chunk[64];
+    size_t room = serial.availableForWrite();
+    while (room > 0) {
+        size_t n = traceDump->read(chunk, room < sizeof(chunk) ? room : sizeof(chunk));
+        if (n == 0) break;
+        serial.write(chunk, n);
+        room -= n;
+    }
+    if (traceDump->isDone()) {
+        delete traceDump;       // Descongela el ring
+        traceDump = nullptr;
+    }
 }
 
 // ============================================================================
@@ -127,6 +187,9 @@ void SerialHandler::printHelp() {
     serial.println("  h - Esta ayuda");
     serial.println("  i - Informacion del sistema");
     serial.println("  m - Estado del multiplexor CD4051");
+    serial.println("  p - Contadores de rendimiento por etapa");
+    serial.println("  z - Reiniciar contadores de rendimiento");
+    serial.println("  t - Volcar eventos (JSON Chrome trace_event)");
     serial.println("  0 - Seleccionar CH0 (6.8k ohm)");
     serial.println("  1 - Seleccionar CH1 (directo)");
     serial.println("  2 - Seleccionar CH2 (25k ohm)");
@@ -144,6 +207,15 @@ void SerialHandler::printSystemInfo() {
     serial.println("--------------------------------\n");
 }
 
+void SerialHandler::printPerfReport() {
+    PerformanceStats stats = SignalEngine::getInstance()->getStats();
+    perfCounters.printReport(serial);
+    serial.printf("Sink %s: %lu muestras, peor servicio %lu us, %lu underruns, nivel %u\n\n",
+                  outputSinkTypeToString(stats.sinkType), (unsigned long)stats.isrCount,
+                  (unsigned long)stats.isrMaxTime, (unsigned long)stats.bufferUnderruns,
+                  (unsigned)stats.bufferLevel);
+}
+
 // ============================================================================
 // CALLBACK
 // ============================================================================
@@ -6,10 +6,27 @@
  */
 
 #include "comm/wifi_server.h"
+#include "core/signal_engine.h"
+#include "core/signal_recorder.h"
+#include "core/perf_counters.h"
+#include "core/trace_ring.h"
+#include <memory>
 
 // Instancia global
 WiFiServer_BioSim wifiServer;
 
+// Protege _clients: alta/baja en async_tcp, niveles en la tarea de streaming
+static portMUX_TYPE clientsMux = portMUX_INITIALIZER_UNLOCKED;
+
+static const char* getPlaybackResultName(PlaybackCommandResult result) {
+    switch (result) {
+        case PlaybackCommandResult::STARTED: return "started";
+        case PlaybackCommandResult::STOPPED: return "stopped";
+        case PlaybackCommandResult::FAILED:  return "failed";
+        default:                             return "none";
+    }
+}
+
 // ============================================================================
 // CONSTRUCTOR
 // ============================================================================
@@ -19,10 +36,23 @@ WiFiServer_BioSim::WiFiServer_BioSim()
     , _ws(nullptr)
     , _isActive(false)
     , _streamingEnabled(false)
+    , _streamTaskHandle(nullptr)
+    , _streamPeriodMs(WS_SEND_INTERVAL_MS)
     , _lastSendTime(0)
     , _lastMetricsTime(0)
     , _lastCleanupTime(0)
+    , _frameCount(0)
+    , _frameTimestamp(0)
+    , _streamInfoDirty(true)
+    , _playbackRequestId(0)
+    , _playbackDoneId(0)
+    , _playbackResult(PlaybackCommandResult::NONE)
 {
+    memset(&_frameInfo, 0, sizeof(_frameInfo));
+    memset(&_stats, 0, sizeof(_stats));
+    memset(_clients, 0, sizeof(_clients));
+    resetDecimators();
+    resetHistory();
 }
 
 // ============================================================================
@@ -160,17 +190,267 @@ void WiFiServer_BioSim::setupRoutes() {
     
     // API de estado
     _server->on("/api/status", HTTP_GET, [this](AsyncWebServerRequest* request) {
-        StaticJsonDocument<256> doc;
+        StaticJsonDocument<1280> doc;
         doc["device"] = "BioSignalSimulator Pro";
         doc["version"] = "1.0.0";
         doc["clients"] = _ws->count();
         doc["streaming"] = _streamingEnabled;
         
+        WSClientSlot slots[WS_MAX_TRACKED_CLIENTS];
+        uint8_t n = getClientSlots(slots);
+        JsonArray clients = doc.createNestedArray("wsClients");
+        for (uint8_t i = 0; i < n; i++) {
+            JsonObject c = clients.createNestedObject();
+            c["id"] = slots[i].id;
+            c["level"] = slots[i].level;
+            c["maxQueue"] = slots[i].maxQueue;
+            c["sent"] = slots[i].framesSent;
+            c["dropped"] = slots[i].framesDropped;
+        }
+        
+        JsonObject stream = doc.createNestedObject("stream");
+        stream["framesSent"] = _stats.framesSent;
+        stream["framesDropped"] = _stats.framesDropped;
+        stream["samplesSent"] = _stats.samplesSent;
+        stream["queueDepth"] = _stats.queueDepth;
+        stream["maxQueueDepth"] = _stats.maxQueueDepth;
+        stream["cycleUs"] = _stats.lastCycleUs;
+        
+        // Última orden de reproducción (pending: encolada, sin ejecutar aún)
+        JsonObject playback = doc.createNestedObject("playback");
+        playback["active"] = SignalEngine::getInstance()->isPlaybackActive();
+        playback["request"] = _playbackRequestId;
+        playback["done"] = _playbackDoneId;
+        playback["pending"] = _playbackRequestId != _playbackDoneId;
+        playback["result"] = getPlaybackResultName(_playbackResult);
+        
+        String response;
+        serializeJson(doc, response);
+        request->send(200, "application/json", response);
+    });
+    
+    // Grabación a flash (SignalRecorder)
+    _server->on("/api/record/start", HTTP_POST, [](AsyncWebServerRequest* request) {
+        // No truncar el archivo que se está reproduciendo
+        SignalEngine* engine = SignalEngine::getInstance();
+        if (engine->isPlaybackActive() &&
+            strcmp(engine->getPlaybackModel().getPath(), RECORDER_FILE_PATH) == 0) {
+            request->send(409, "application/json", "{\"ok\":false}");
+            return;
+        }
+        bool ok = signalRecorder.start();
+        request->send(ok ? 200 : 409, "application/json", ok ? "{\"ok\":true}" : "{\"ok\":false}");
+    });
+    
+    _server->on("/api/record/stop", HTTP_POST, [](AsyncWebServerRequest* request) {
+        signalRecorder.stop();
+        request->send(200, "application/json", "{\"ok\":true}");
+    });
+    
+    _server->on("/api/record/status", HTTP_GET, [](AsyncWebServerRequest* request) {
+        StaticJsonDocument<256> doc;
+        RecorderStats stats = signalRecorder.getStats();
+        doc["state"] = SignalRecorder::getStateName(signalRecorder.getState());
+        doc["bytes"] = stats.bytesWritten;
+        doc["blocks"] = stats.blocksWritten;
+        doc["samples"] = stats.samplesRecorded;
+        doc["dropped"] = stats.samplesDropped;
+        doc["incomplete"] = stats.writeFailed;
+        doc["maxBytes"] = RECORDER_MAX_FILE_BYTES;
+        
         String response;
         serializeJson(doc, response);
         request->send(200, "application/json", response);
     });
     
+    // Descarga por chunks: el archivo se lee por trozos, sin cargarlo en RAM
+    _server->on("/api/record/download", HTTP_GET, [](AsyncWebServerRequest* request) {
+        RecorderState recState = signalRecorder.getState();
+        if (recState != RecorderState::IDLE && recState != RecorderState::ERROR) {
+            request->send(409, "text/plain", "Grabacion en curso");
+            return;
+        }
+        // ERROR tras escritura fallida: se entrega lo grabado, marcado como incompleto
+        bool incomplete = recState == RecorderState::ERROR;
+        if (!SPIFFS.exists(RECORDER_FILE_PATH)) {
+            request->send(404, "text/plain", "Sin grabacion");
+            return;
+        }
+        
+        File file = SPIFFS.open(RECORDER_FILE_PATH, FILE_READ);
+        AsyncWebServerResponse* response = request->beginChunkedResponse("application/octet-stream",
+            [file](uint8_t* buffer, size_t maxLen, size_t index) mutable -> size_t {
+                return file.read(buffer, maxLen);
+            });
+        response->addHeader("Content-Disposition", "attachment; filename=\"rec.bsr\"");
+        if (incomplete) response->addHeader("X-Recording-Incomplete", "1");
+        request->send(response);
+    });
+    
+    // Reproducción desde flash (PlaybackModel): ?file=/ruta.bsr, por defecto la grabación
+    // Se encola para loop() y responde 202 con el id; el resultado sale en
+    // /api/status y /api/playback/status
+    _server->on("/api/playback/start", HTTP_POST, [this](AsyncWebServerRequest* request) {
+        String path = request->hasParam("file", true) ? request->getParam("file", true)->value()
+                                                       : String(RECORDER_FILE_PATH);
+        if (path.length() == 0 || path.length() >= PLAYBACK_MAX_PATH) {
+            request->send(400, "application/json", "{\"ok\":false}");
+            return;
+        }
+        // No leer el archivo que el grabador está escribiendo
+        if (path == RECORDER_FILE_PATH && signalRecorder.getState() != RecorderState::IDLE) {
+            request->send(409, "application/json", "{\"ok\":false}");
+            return;
+        }
+        PlaybackCommand cmd;
+        cmd.id = ++_playbackRequestId;
+        cmd.start = true;
+        strcpy(cmd.path, path.c_str());        // Longitud ya validada
+        _playbackMailbox.publish(cmd);
+        
+        char body[32];
+        snprintf(body, sizeof(body), "{\"ok\":true,\"id\":%lu}", (unsigned long)cmd.id);
+        request->send(202, "application/json", body);
+    });
+    
+    _server->on("/api/playback/stop", HTTP_POST, [this](AsyncWebServerRequest* request) {
+        PlaybackCommand cmd;
+        cmd.id = ++_playbackRequestId;
+        cmd.start = false;
+        cmd.path[0] = '\0';
+        _playbackMailbox.publish(cmd);
+        
+        char body[32];
+        snprintf(body, sizeof(body), "{\"ok\":true,\"id\":%lu}", (unsigned long)cmd.id);
+        request->send(202, "application/json", body);
+    });
+    
+    _server->on("/api/playback/status", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        StaticJsonDocument<384> doc;
+        SignalEngine* engine = SignalEngine::getInstance();
+        const PlaybackModel& playback = engine->getPlaybackModel();
+        PlaybackStats stats = playback.getStats();
+        doc["state"] = PlaybackModel::getStateName(playback.getState());
+        doc["active"] = engine->isPlaybackActive();
+        doc["file"] = playback.getPath();
+        doc["signal"] = signalTypeToString(playback.getSignalType());
+        doc["fs"] = playback.getSampleRate();
+        doc["samples"] = stats.samplesPlayed;
+        doc["underruns"] = stats.underruns;
+        doc["loops"] = stats.loops;
+        doc["skipped"] = stats.skippedBlocks;
+        doc["request"] = _playbackRequestId;
+        doc["done"] = _playbackDoneId;
+        doc["result"] = getPlaybackResultName(_playbackResult);
+        
+        String response;
+        serializeJson(doc, response);
+        request->send(200, "application/json", response);
+    });
+
+    // Rampas Tipo A: ?ms=0-5000 (0 = escalón) &shape=linear|exp
+    _server->on("/api/ramp", HTTP_POST, [](AsyncWebServerRequest* request) {
+        SignalEngine* engine = SignalEngine::getInstance();
+        RampConfig current = engine->getParamRamp();
+        uint16_t ms = (uint16_t)lroundf(current.duration * 1000.0f);
+        RampShape shape = current.shape;
+        if (request->hasParam("ms", true)) {
+            ms = (uint16_t)constrain(request->getParam("ms", true)->value().toInt(), 0L, 5000L);
+        }
+        if (request->hasParam("shape", true)) {
+            shape = (request->getParam("shape", true)->value() == "exp") ? RampShape::EXPONENTIAL
+                                                                        : RampShape::LINEAR;
+        }
+        engine->setParamRamp(shape, ms);
+        request->send(200, "application/json", "{\"ok\":true}");
+    });
+
+    _server->on("/api/ramp", HTTP_GET, [](AsyncWebServerRequest* request) {
+        StaticJsonDocument<128> doc;
+        RampConfig current = SignalEngine::getInstance()->getParamRamp();
+        doc["ms"] = (uint16_t)lroundf(current.duration * 1000.0f);
+        doc["shape"] = (current.shape == RampShape::EXPONENTIAL) ? "exp" : "linear";
+
+        String response;
+        serializeJson(doc, response);
+        request->send(200, "application/json", response);
+    });
+
+    // Contadores por etapa (ciclos CCOUNT), histogramas log2 y marcas de buffers.
+    // Documento en heap: ~4 KB no caben con holgura en la pila de async_tcp
+    _server->on("/api/perf", HTTP_GET, [](AsyncWebServerRequest* request) {
+        DynamicJsonDocument doc(5120);
+        SignalEngine* engine = SignalEngine::getInstance();
+        doc["enabled"] = (bool)PERF_COUNTERS_ENABLED;
+        doc["cpuMHz"] = ESP.getCpuFreqMHz();
+        doc["freeHeap"] = ESP.getFreeHeap();
+        
+        // Cubo k: ciclos < histLimits[k]; el último no tiene límite
+        JsonArray limits = doc.createNestedArray("histLimits");
+        for (uint8_t b = 0; b < PERF_HIST_BUCKETS - 1; b++) {
+            limits.add(PerfCounters::getBucketLimit(b));
+        }
+        
+        JsonObject stages = doc.createNestedObject("stages");
+        for (uint8_t i = 0; i < PERF_STAGE_COUNT; i++) {
+            PerfStageStats s = perfCounters.getStage((PerfStage)i);
+            JsonObject st = stages.createNestedObject(PerfCounters::getStageName((PerfStage)i));
+            st["count"] = s.count;
+            st["mean"] = s.count ? (uint32_t)(s.totalCycles / s.count) : 0;
+            st["min"] = s.minCycles;
+            st["max"] = s.maxCycles;
+            st["last"] = s.lastCycles;
+            JsonArray hist = st.createNestedArray("hist");
+            for (uint8_t b = 0; b < PERF_HIST_BUCKETS; b++) {
+                hist.add(s.histogram[b]);
+            }
+        }
+        
+        JsonObject buffers = doc.createNestedObject("buffers");
+        for (uint8_t i = 0; i < PERF_BUFFER_COUNT; i++) {
+            PerfWatermark w = perfCounters.getWatermark((PerfBuffer)i);
+            JsonObject bf = buffers.createNestedObject(PerfCounters::getBufferName((PerfBuffer)i));
+            bf["min"] = w.minLevel;
+            bf["max"] = w.maxLevel;
+            bf["last"] = w.lastLevel;
+            bf["capacity"] = w.capacity;
+        }
+        
+        PerformanceStats stats = engine->getStats();
+        JsonObject sink = doc.createNestedObject("sink");
+        sink["type"] = outputSinkTypeToString(stats.sinkType);
+        sink["samples"] = stats.isrCount;
+        sink["maxServiceUs"] = stats.isrMaxTime;
+        sink["underruns"] = stats.bufferUnderruns;
+        sink["level"] = stats.bufferLevel;
+        
+        String response;
+        serializeJson(doc, response);
+        request->send(200, "application/json", response);
+    });
+    
+    _server->on("/api/perf/reset", HTTP_POST, [](AsyncWebServerRequest* request) {
+        SignalEngine::getInstance()->resetStats();
+        request->send(200, "application/json", "{\"ok\":true}");
+    });
+    
+    // Ventana del ring de eventos como Chrome trace_event (chrome://tracing,
+    // Perfetto). Por chunks: el ring queda congelado hasta cerrar la respuesta
+    _server->on("/api/trace", HTTP_GET, [](AsyncWebServerRequest* request) {
+        std::shared_ptr<TraceExporter> exporter(new TraceExporter());
+        AsyncWebServerResponse* response = request->beginChunkedResponse("application/json",
+            [exporter](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+                return exporter->read(buffer, maxLen);
+            });
+        response->addHeader("Content-Disposition", "attachment; filename=\"trace.json\"");
+        request->send(response);
+    });
+    
+    _server->on("/api/trace/clear", HTTP_POST, [](AsyncWebServerRequest* request) {
+        traceRing.clear();
+        request->send(200, "application/json", "{\"ok\":true}");
+    });
+
     // 404
     _server->onNotFound([](AsyncWebServerRequest* request) {
         request->send(404, "text/plain", "Not Found");
@@ -189,6 +469,8 @@ void WiFiServer_BioSim::onWsEvent(AsyncWebSocket* server, AsyncWebSocketClient*
                          client->id(), client->remoteIP().toString().c_str());
             client->setCloseClientOnQueueFull(false); // preferimos descartar frames que cerrar conexión
             client->keepAlivePeriod(15); // ping/pong cada 15s para mantener viva la sesión
+            _streamInfoDirty = true;     // El cliente nuevo necesita nombres de señal/condición
+            registerClient(client->id());
             // Enviar mensaje de bienvenida
             {
                 StaticJsonDocument<128> doc;
@@ -203,6 +485,7 @@ void WiFiServer_BioSim::onWsEvent(AsyncWebSocket* server, AsyncWebSocketClient*
             
         case WS_EVT_DISCONNECT:
             Serial.printf("[WS] Cliente #%u desconectado\n", client->id());
+            unregisterClient(client->id());
             break;
             
         case WS_EVT_ERROR:
@@ -226,27 +509,536 @@ void WiFiServer_BioSim::onWsEvent(AsyncWebSocket* server, AsyncWebSocketClient*
     }
 }
 
+// ============================================================================
+// TAREA DE STREAMING
+// ============================================================================
+
+bool WiFiServer_BioSim::startStreamingTask(UBaseType_t priority, uint32_t periodMs) {
+    if (_streamTaskHandle != nullptr) return true;
+    if (!_isActive) return false;
+    
+    _streamPeriodMs = (periodMs > 0) ? periodMs : WS_SEND_INTERVAL_MS;
+    memset(&_stats, 0, sizeof(_stats));
+    
+    BaseType_t result = xTaskCreatePinnedToCore(
+        streamingTask,
+        "WSStream",
+        STACK_SIZE_WS,
+        this,
+        priority,
+        &_streamTaskHandle,
+        CORE_WS_STREAMING
+    );
+    
+    if (result != pdPASS) {
+        _streamTaskHandle = nullptr;
+        Serial.println("[WS] ERROR: No se pudo crear tarea de streaming");
+        return false;
+    }
+    
+    Serial.printf("[WS] Tarea de streaming en Core %d (prio %u, %lu ms)\n",
+                  CORE_WS_STREAMING, (unsigned)priority, (unsigned long)_streamPeriodMs);
+    return true;
+}
+
+void WiFiServer_BioSim::streamingTask(void* parameter) {
+    WiFiServer_BioSim* self = static_cast<WiFiServer_BioSim*>(parameter);
+    TickType_t lastWake = xTaskGetTickCount();
+    TickType_t period = pdMS_TO_TICKS(self->_streamPeriodMs);
+    if (period == 0) period = 1;
+    
+    while (true) {
+        vTaskDelayUntil(&lastWake, period);
+        self->streamCycle();
+    }
+}
+
+/**
+ * @brief Un ciclo de la tarea: vacía el ring del motor en un frame binario
+ *        y envía métricas (a su propio ritmo, WS_METRICS_INTERVAL_MS)
+ */
+void WiFiServer_BioSim::streamCycle() {
+    uint32_t cycleStart = micros();
+    SignalEngine* engine = SignalEngine::getInstance();
+    
+    if (!_isActive || !_ws || !engine) return;
+    
+    // Sin clientes se sigue consumiendo el ring y llenando el historial: el
+    // primero que se conecte recibe el backfill (solo se omite el envío)
+    if (!_streamingEnabled || engine->getState() != SignalState::RUNNING) {
+        _frameCount = 0;    // No reanudar con un frame de antes de la pausa
+        resetDecimators();
+        // En pausa el historial sigue siendo válido; tras STOP no
+        if (engine->getState() == SignalState::STOPPED) resetHistory();
+        return;
+    }
+    
+    uint16_t depth = engine->getWSBufferCount();
+    _stats.queueDepth = depth;
+    if (depth > _stats.maxQueueDepth) _stats.maxQueueDepth = depth;
+    
+    // Identidad del stream: nombres solo viajan en JSON "state" al cambiar
+    SignalType type = engine->getCurrentType();
+    WSStreamInfo info;
+    info.signalId = (uint8_t)type;
+    info.uvPerLsb = WS_FRAME_UV_PER_LSB;
+    info.hasEnvelope = false;
+    switch (type) {
+        case SignalType::ECG:
+            info.signalType = "ECG";
+            info.condition = engine->getECGModel().getConditionName();
+            info.conditionId = (uint8_t)engine->getECGModel().getCondition();
+            info.sampleRateHz = FDS_ECG;
+            break;
+        case SignalType::EMG:
+            info.signalType = "EMG";
+            info.condition = engine->getEMGModel().getConditionName();
+            info.conditionId = (uint8_t)engine->getEMGModel().getCondition();
+            info.sampleRateHz = FDS_EMG;
+            info.hasEnvelope = true;
+            break;
+        case SignalType::PPG:
+            info.signalType = "PPG";
+            info.condition = engine->getPPGModel().getConditionName();
+            info.conditionId = (uint8_t)engine->getPPGModel().getCondition();
+            info.sampleRateHz = FDS_PPG;
+            info.uvPerLsb = WS_FRAME_UV_PER_LSB_PPG;
+            break;
+        default:
+            info.signalType = "--";
+            info.condition = "--";
+            info.conditionId = 0;
+            info.sampleRateHz = FDS_ECG;
+            break;
+    }
+    
+    // Consumir TODAS las muestras disponibles: un frame por ciclo
+    // (o varios si se acumularon más de WS_FRAME_MAX_SAMPLES)
+    WSSampleData sample;
+    while (engine->getNextWSSample(sample)) {
+        pushSignalSample(info, sample.value, sample.envelope, sample.timestamp);
+    }
+    if (_frameCount > 0) sendSignalFrame();
+    
+    // Métricas a menor frecuencia (sendMetrics aplica WS_METRICS_INTERVAL_MS)
+    if (millis() - _lastMetricsTime >= WS_METRICS_INTERVAL_MS) {
+        WSSignalMetrics metrics;
+        memset(&metrics, 0, sizeof(metrics));
+        
+        switch (type) {
+            case SignalType::ECG: {
+                ECGModel& ecg = engine->getECGModel();
+                metrics.hr = (int)ecg.getCurrentHeartRate();
+                metrics.rr = (int)ecg.getCurrentRRInterval();
+                metrics.qrs = ecg.getQRSAmplitude();
+                metrics.st = ecg.getSTDeviation_mV();
+                metrics.hrv = ecg.getHRStd();
+                metrics.pr = (int)ecg.getPRInterval_ms();
+                metrics.qtc = (int)ecg.getQTcInterval_ms();
+                metrics.p = ecg.getPAmplitude_mV();
+                metrics.r = ecg.getRAmplitude_mV();
+                metrics.t = ecg.getTAmplitude_mV();
+                break;
+            }
+            case SignalType::EMG: {
+                EMGModel& emg = engine->getEMGModel();
+                metrics.rms = emg.getRMSAmplitude();
+                metrics.excitation = (int)(emg.getExcitation() * 100);
+                metrics.activeUnits = emg.getActiveMotorUnits();
+                metrics.freq = (int)emg.getFatigueMDF();
+                metrics.mvc = (int)emg.getContractionLevel();
+                metrics.raw = emg.getCurrentValueMV();
+                break;
+            }
+            case SignalType::PPG: {
+                PPGModel& ppg = engine->getPPGModel();
+                metrics.hr = (int)ppg.getCurrentHeartRate();
+                metrics.rr = (int)ppg.getCurrentRRInterval();
+                metrics.pi = ppg.getPerfusionIndex();
+                metrics.ac = ppg.getLastACValue();
+                metrics.sys = (int)ppg.getMeasuredSystoleTime();
+                metrics.dia = (int)ppg.getMeasuredDiastoleTime();
+                break;
+            }
+            default:
+                break;
+        }
+        
+        sendMetrics(metrics);
+    }
+    
+    _stats.lastCycleUs = micros() - cycleStart;
+}
+
 // ============================================================================
 // ENVÍO DE DATOS
 // ============================================================================
 
-void WiFiServer_BioSim::sendSignalData(const WSSignalData& data) {
-    if (!_isActive || !_streamingEnabled || !_ws) return;
+void WiFiServer_BioSim::pushSignalSample(const WSStreamInfo& info, float value, 
+                                          float envelope, uint32_t timestamp) {
+    if (!_isActive || !_streamingEnabled || !_ws) {
+        _frameCount = 0;    // No reanudar con un frame de antes de la pausa
+        return;
+    }
+    
+    // Cambio de señal/condición: cerrar el frame del stream anterior
+    if (info.signalId != _frameInfo.signalId || info.conditionId != _frameInfo.conditionId) {
+        if (_frameCount > 0) sendSignalFrame();
+        resetDecimators();
+        resetHistory();
+        _streamInfoDirty = true;
+    }
+    _frameInfo = info;
+    
+    if (_frameCount == 0) _frameTimestamp = timestamp;
+    _frameValues[_frameCount] = encodeSample(value, info.uvPerLsb);
+    _frameEnvelope[_frameCount] = info.hasEnvelope ? encodeSample(envelope, info.uvPerLsb) : 0;
+    _frameCount++;
+    
+    if (_frameCount >= WS_FRAME_MAX_SAMPLES) sendSignalFrame();
+}
+
+/**
+ * @brief Decima el frame acumulado y lo envía a cada cliente a su nivel
+ */
+void WiFiServer_BioSim::sendSignalFrame() {
+    uint16_t count = _frameCount;
+    _frameCount = 0;
+    _lastSendTime = millis();
     
-    // Verificar si hay clientes antes de enviar
-    uint8_t clientCount = _ws->count();
-    if (clientCount == 0) return;
+    // El historial se alimenta con o sin clientes
+    appendHistory(count);
     
-    uint32_t now = millis();
+    // Sin clientes: nada que decimar ni enviar (los grupos a medias no
+    // deben mezclarse con las muestras del próximo cliente)
+    if (!_ws || _ws->count() == 0) {
+        resetDecimators();
+        return;
+    }
     
     // Cleanup muy conservador: solo cada 10 segundos
-    if (now - _lastCleanupTime >= WS_CLEANUP_INTERVAL_MS) {
-        _lastCleanupTime = now;
+    if (_lastSendTime - _lastCleanupTime >= WS_CLEANUP_INTERVAL_MS) {
+        _lastCleanupTime = _lastSendTime;
         _ws->cleanupClients();
     }
     
-    String json = buildDataJson(data);
-    _ws->textAll(json);
+    if (_streamInfoDirty) {
+        sendStateChange(_frameInfo.signalType, _frameInfo.condition, "RUNNING");
+        _streamInfoDirty = false;
+    }
+    
+    decimateFrame(count);
+    
+    for (uint8_t i = 0; i < WS_MAX_TRACKED_CLIENTS; i++) {
+        // Trabajar sobre una copia: el slot puede liberarse/reasignarse en async_tcp
+        WSClientSlot slot;
+        portENTER_CRITICAL(&clientsMux);
+        slot = _clients[i];
+        portEXIT_CRITICAL(&clientsMux);
+        if (slot.id == 0) continue;
+        
+        AsyncWebSocketClient* client = _ws->client(slot.id);
+        if (!client || client->status() != WS_CONNECTED) continue;
+        
+        bool live = true;
+        if (slot.backfilling) {
+            // El historial ya incluye las muestras de este ciclo: el cliente
+            // pasa a frames en vivo a partir del siguiente
+            sendHistoryChunks(client, slot);
+            live = false;
+        } else {
+            updateClientLevel(slot, client->queueLen());
+        }
+        
+        // Nivel alto con grupo aún incompleto: nada que enviar este ciclo
+        if (live && _levelFrames[slot.level].count > 0) {
+            PERF_BEGIN(encodeStart);
+            size_t len = encodeFrame(slot.level, slot.sequence++);
+            PERF_END(WS_SERIALIZE, encodeStart);
+            
+            // Cola llena: el frame se pierde solo para este cliente (lo
+            // detecta por el hueco en la secuencia), la conexión se mantiene
+            if (!client->queueIsFull() && client->binary(_frameBuffer, len)) {
+                TRACE_INSTANT(WS_FRAME, (slot.id << 16) | _levelFrames[slot.level].count);
+                slot.framesSent++;
+                _stats.framesSent++;
+                _stats.samplesSent += _levelFrames[slot.level].count;
+            } else {
+                slot.framesDropped++;
+                _stats.framesDropped++;
+            }
+        }
+        
+        portENTER_CRITICAL(&clientsMux);
+        if (_clients[i].id == slot.id) _clients[i] = slot;
+        portEXIT_CRITICAL(&clientsMux);
+    }
+}
+
+/**
+ * @brief Genera _levelFrames[] a partir de las muestras del frame en curso
+ * 
+ * Nivel 0 es copia directa. En nivel L cada grupo de 2^(L+1) muestras
+ * produce su mínimo y su máximo en el orden en que ocurrieron; los grupos
+ * incompletos continúan en el siguiente frame.
+ */
+void WiFiServer_BioSim::decimateFrame(uint16_t count) {
+    const uint16_t fs = _frameInfo.sampleRateHz ? _frameInfo.sampleRateHz : 1;
+    
+    LevelFrame& full = _levelFrames[0];
+    memcpy(full.values, _frameValues, count * sizeof(int16_t));
+    memcpy(full.envelope, _frameEnvelope, count * sizeof(int16_t));
+    full.count = count;
+    full.timestamp = _frameTimestamp;
+    
+    for (uint8_t level = 1; level < WS_DECIMATION_LEVELS; level++) {
+        LevelFrame& out = _levelFrames[level];
+        Decimator& d = _decimators[level];
+        const uint8_t groupSize = (uint8_t)(2u << level);
+        out.count = 0;
+        
+        for (uint16_t i = 0; i < count; i++) {
+            int16_t v = _frameValues[i];
+            int16_t e = _frameEnvelope[i];
+            
+            if (d.filled == 0) {
+                d.vMin = d.vMax = v;
+                d.eMin = d.eMax = e;
+                d.vMinIdx = d.vMaxIdx = d.eMinIdx = d.eMaxIdx = 0;
+                d.groupTimestamp = _frameTimestamp + (uint32_t)i * 1000u / fs;
+            } else {
+                if (v < d.vMin) { d.vMin = v; d.vMinIdx = d.filled; }
+                if (v > d.vMax) { d.vMax = v; d.vMaxIdx = d.filled; }
+                if (e < d.eMin) { d.eMin = e; d.eMinIdx = d.filled; }
+                if (e > d.eMax) { d.eMax = e; d.eMaxIdx = d.filled; }
+            }
+            
+            if (++d.filled < groupSize) continue;
+            d.filled = 0;
+            
+            if (out.count == 0) out.timestamp = d.groupTimestamp;
+            bool vMinFirst = d.vMinIdx <= d.vMaxIdx;
+            bool eMinFirst = d.eMinIdx <= d.eMaxIdx;
+            out.values[out.count] = vMinFirst ? d.vMin : d.vMax;
+            out.envelope[out.count] = eMinFirst ? d.eMin : d.eMax;
+            out.count++;
+            out.values[out.count] = vMinFirst ? d.vMax : d.vMin;
+            out.envelope[out.count] = eMinFirst ? d.eMax : d.eMin;
+            out.count++;
+        }
+    }
+}
+
+void WiFiServer_BioSim::resetDecimators() {
+    memset(_decimators, 0, sizeof(_decimators));
+    for (uint8_t level = 0; level < WS_DECIMATION_LEVELS; level++) {
+        _levelFrames[level].count = 0;
+    }
+}
+
+/**
+ * @brief Serializa _levelFrames[level] en _frameBuffer
+ * @return Longitud del frame en bytes
+ */
+size_t WiFiServer_BioSim::encodeFrame(uint8_t level, uint16_t sequence) {
+    const LevelFrame& lf = _levelFrames[level];
+    uint8_t flags = (uint8_t)((level << WS_FRAME_LEVEL_SHIFT) & WS_FRAME_LEVEL_MASK);
+    if (level > 0) flags |= WS_FRAME_FLAG_MINMAX;
+    
+    return writeFrame(sequence, lf.count, lf.timestamp, _frameInfo.sampleRateHz >> level,
+                      flags, lf.values, lf.envelope);
+}
+
+/**
+ * @brief Escribe cabecera + muestras en _frameBuffer (ver FRAME BINARIO)
+ * @return Longitud del frame en bytes
+ */
+size_t WiFiServer_BioSim::writeFrame(uint16_t sequence, uint16_t count, uint32_t timestamp,
+                                     uint16_t fs, uint8_t flags,
+                                     const int16_t* values, const int16_t* envelope) {
+    if (_frameInfo.hasEnvelope) flags |= WS_FRAME_FLAG_ENVELOPE;
+    
+    uint8_t* p = _frameBuffer;
+    p[0] = WS_FRAME_MAGIC;
+    p[1] = WS_FRAME_VERSION;
+    p[2] = _frameInfo.signalId;
+    p[3] = _frameInfo.conditionId;
+    p[4] = (uint8_t)(sequence & 0xFF);
+    p[5] = (uint8_t)(sequence >> 8);
+    p[6] = (uint8_t)(count & 0xFF);
+    p[7] = (uint8_t)(count >> 8);
+    p[8] = (uint8_t)(timestamp & 0xFF);
+    p[9] = (uint8_t)((timestamp >> 8) & 0xFF);
+    p[10] = (uint8_t)((timestamp >> 16) & 0xFF);
+    p[11] = (uint8_t)(timestamp >> 24);
+    p[12] = (uint8_t)(fs & 0xFF);
+    p[13] = (uint8_t)(fs >> 8);
+    p[14] = flags;
+    p[15] = _frameInfo.uvPerLsb;
+    
+    // ESP32 es little-endian: los int16 se copian tal cual
+    size_t len = WS_FRAME_HEADER_SIZE;
+    memcpy(p + len, values, count * sizeof(int16_t));
+    len += count * sizeof(int16_t);
+    if (_frameInfo.hasEnvelope) {
+        memcpy(p + len, envelope, count * sizeof(int16_t));
+        len += count * sizeof(int16_t);
+    }
+    return len;
+}
+
+// ============================================================================
+// HISTORIAL
+// ============================================================================
+
+/**
+ * @brief Copia las muestras del frame en curso al ring de historial
+ * 
+ * Los timestamps del backfill se reconstruyen como _historyT0 + pos / fs:
+ * si el frame no continúa al anterior (muestras perdidas en el ring,
+ * reinicio de la señal) se descarta el historial para no ocultar el hueco.
+ */
+void WiFiServer_BioSim::appendHistory(uint16_t count) {
+    if (count == 0) return;
+    if (_historyTotal > 0) {
+        const uint16_t fs = _frameInfo.sampleRateHz ? _frameInfo.sampleRateHz : 1;
+        uint32_t expected = _historyT0 + (uint32_t)(((uint64_t)_historyTotal * 1000u) / fs);
+        int32_t drift = (int32_t)(_frameTimestamp - expected);
+        if (drift < 0) drift = -drift;
+        if ((uint32_t)drift > 1000u / fs + 1) resetHistory();   // Más de una muestra
+    }
+    if (_historyTotal == 0) _historyT0 = _frameTimestamp;
+    
+    for (uint16_t i = 0; i < count; i++) {
+        uint32_t idx = (_historyTotal + i) % WS_HISTORY_MAX_SAMPLES;
+        _historyValues[idx] = _frameValues[i];
+        _historyEnvelope[idx] = _frameEnvelope[i];
+    }
+    _historyTotal += count;
+}
+
+void WiFiServer_BioSim::resetHistory() {
+    _historyTotal = 0;
+    _historyT0 = 0;
+}
+
+/**
+ * @brief Envía al cliente los siguientes bloques de historial
+ * 
+ * Solo envía con la cola del cliente vacía (<= WS_CLIENT_QUEUE_LOW) para no
+ * desplazar sus frames en vivo posteriores; al alcanzar el final del ring
+ * el cliente deja de hacer backfill.
+ * @return Bloques enviados
+ */
+uint8_t WiFiServer_BioSim::sendHistoryChunks(AsyncWebSocketClient* client, WSClientSlot& slot) {
+    // Lo más antiguo que sigue en el ring (o reset por cambio de señal)
+    uint32_t oldest = (_historyTotal > WS_HISTORY_MAX_SAMPLES) ?
+                      _historyTotal - WS_HISTORY_MAX_SAMPLES : 0;
+    if (slot.historyPos < oldest || slot.historyPos > _historyTotal) {
+        slot.historyPos = (slot.historyPos > _historyTotal) ? _historyTotal : oldest;
+    }
+    
+    const uint16_t fs = _frameInfo.sampleRateHz ? _frameInfo.sampleRateHz : 1;
+    uint8_t sent = 0;
+    
+    while (slot.historyPos < _historyTotal && sent < WS_HISTORY_CHUNKS_PER_CYCLE) {
+        if (client->queueLen() > WS_CLIENT_QUEUE_LOW) break;
+        
+        // Bloque contiguo en el ring (no cruza el final del array)
+        uint32_t idx = slot.historyPos % WS_HISTORY_MAX_SAMPLES;
+        uint32_t count = _historyTotal - slot.historyPos;
+        if (count > WS_HISTORY_CHUNK_SAMPLES) count = WS_HISTORY_CHUNK_SAMPLES;
+        if (count > WS_HISTORY_MAX_SAMPLES - idx) count = WS_HISTORY_MAX_SAMPLES - idx;
+        
+        uint32_t timestamp = _historyT0 + (uint32_t)(((uint64_t)slot.historyPos * 1000u) / fs);
+        size_t len = writeFrame(slot.sequence, (uint16_t)count, timestamp, _frameInfo.sampleRateHz,
+                                WS_FRAME_FLAG_HISTORY, &_historyValues[idx], &_historyEnvelope[idx]);
+        if (!client->binary(_frameBuffer, len)) break;
+        
+        slot.sequence++;
+        slot.historyPos += count;
+        sent++;
+    }
+    
+    if (slot.historyPos >= _historyTotal) slot.backfilling = false;
+    return sent;
+}
+
+// ============================================================================
+// BACKPRESSURE POR CLIENTE
+// ============================================================================
+
+/**
+ * @brief Ajusta el nivel de decimación según la cola del cliente
+ * @param queued Mensajes pendientes en la cola del cliente
+ */
+void WiFiServer_BioSim::updateClientLevel(WSClientSlot& slot, size_t queued) {
+    if (queued > slot.maxQueue) slot.maxQueue = (uint8_t)min(queued, (size_t)255);
+    if (slot.levelAge < 0xFFFF) slot.levelAge++;
+    
+    if (queued >= WS_CLIENT_QUEUE_HIGH) {
+        slot.calmFrames = 0;
+        if (slot.level < WS_DECIMATION_LEVELS - 1 && slot.levelAge >= WS_CLIENT_HOLD_FRAMES) {
+            slot.level++;
+            slot.levelAge = 0;
+            Serial.printf("[WS] Cliente #%u lento (cola %u): nivel %u\n",
+                          slot.id, (unsigned)queued, slot.level);
+        }
+    } else if (queued <= WS_CLIENT_QUEUE_LOW) {
+        if (slot.level > 0 && ++slot.calmFrames >= WS_CLIENT_RECOVER_FRAMES) {
+            slot.level--;
+            slot.levelAge = 0;
+            slot.calmFrames = 0;
+            Serial.printf("[WS] Cliente #%u recuperado: nivel %u\n", slot.id, slot.level);
+        }
+    } else {
+        slot.calmFrames = 0;
+    }
+}
+
+void WiFiServer_BioSim::registerClient(uint32_t id) {
+    bool registered = false;
+    portENTER_CRITICAL(&clientsMux);
+    for (uint8_t i = 0; i < WS_MAX_TRACKED_CLIENTS; i++) {
+        if (_clients[i].id == 0) {
+            memset(&_clients[i], 0, sizeof(WSClientSlot));
+            _clients[i].id = id;
+            _clients[i].backfilling = true;     // Primero el historial
+            registered = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&clientsMux);
+    
+    if (!registered) {
+        Serial.printf("[WS] Cliente #%u sin slot de streaming (max %d)\n", id, WS_MAX_TRACKED_CLIENTS);
+    }
+}
+
+void WiFiServer_BioSim::unregisterClient(uint32_t id) {
+    portENTER_CRITICAL(&clientsMux);
+    for (uint8_t i = 0; i < WS_MAX_TRACKED_CLIENTS; i++) {
+        if (_clients[i].id == id) {
+            _clients[i].id = 0;
+        }
+    }
+    portEXIT_CRITICAL(&clientsMux);
+}
+
+uint8_t WiFiServer_BioSim::getClientSlots(WSClientSlot* out) {
+    uint8_t n = 0;
+    portENTER_CRITICAL(&clientsMux);
+    for (uint8_t i = 0; i < WS_MAX_TRACKED_CLIENTS; i++) {
+        if (_clients[i].id != 0) out[n++] = _clients[i];
+    }
+    portEXIT_CRITICAL(&clientsMux);
+    return n;
+}
+
+int16_t WiFiServer_BioSim::encodeSample(float mV, uint8_t uvPerLsb) {
+    float lsb = mV * 1000.0f / (float)(uvPerLsb ? uvPerLsb : 1);
+    lsb = constrain(lsb, -32768.0f, 32767.0f);
+    return (int16_t)lroundf(lsb);
 }
 
 void WiFiServer_BioSim::sendMetrics(const WSSignalMetrics& metrics) {
@@ -256,7 +1048,9 @@ void WiFiServer_BioSim::sendMetrics(const WSSignalMetrics& metrics) {
     if (now - _lastMetricsTime < WS_METRICS_INTERVAL_MS) return;
     _lastMetricsTime = now;
     
+    PERF_BEGIN(serializeStart);
     String json = buildMetricsJson(metrics);
+    PERF_END(WS_SERIALIZE, serializeStart);
     _ws->textAll(json);
 }
 
@@ -279,25 +1073,6 @@ void WiFiServer_BioSim::sendStateChange(const char* signalType, const char* cond
 // CONSTRUCCIÓN DE JSON
 // ============================================================================
 
-String WiFiServer_BioSim::buildDataJson(const WSSignalData& data) {
-    // JSON con valores float directos para mayor precisión
-    StaticJsonDocument<192> doc;
-    doc["type"] = "data";
-    doc["signal"] = data.signalType;
-    doc["condition"] = data.condition;
-    doc["state"] = data.state;
-    doc["t"] = data.timestamp;
-    doc["value"] = data.value;
-    doc["dac"] = data.dacValue;
-    if (data.envelope != 0) {
-        doc["env"] = data.envelope;
-    }
-    
-    String json;
-    serializeJson(doc, json);
-    return json;
-}
-
 String WiFiServer_BioSim::buildMetricsJson(const WSSignalMetrics& metrics) {
     StaticJsonDocument<512> doc;
     doc["type"] = "metrics";
@@ -354,9 +1129,12 @@ uint8_t WiFiServer_BioSim::getClientCount() {
 }
 
 void WiFiServer_BioSim::loop() {
-    // NO hacer cleanup aquí - ya se hace en sendSignalData() cada 3 segundos
+    // NO hacer cleanup aquí - ya se hace en sendSignalFrame() cada 10 segundos
     // Cleanup duplicado causa desconexiones erráticas
     
+    // Órdenes de reproducción de la API (mismo core que Nextion y serie)
+    processPlaybackCommand();
+    
     // Verificar que el WiFi AP sigue activo cada 10 segundos
     static uint32_t lastCheck = 0;
     if (millis() - lastCheck > 10000) {
@@ -374,6 +1152,31 @@ void WiFiServer_BioSim::loop() {
     }
 }
 
+void WiFiServer_BioSim::processPlaybackCommand() {
+    PlaybackCommand cmd;
+    if (!_playbackMailbox.take(cmd)) return;
+    
+    SignalEngine* engine = SignalEngine::getInstance();
+    PlaybackCommandResult result;
+    if (cmd.start) {
+        // El grabador pudo arrancar entre la petición y su ejecución
+        bool busy = strcmp(cmd.path, RECORDER_FILE_PATH) == 0 &&
+                    signalRecorder.getState() != RecorderState::IDLE;
+        result = (!busy && engine->startPlayback(cmd.path)) ? PlaybackCommandResult::STARTED
+                                                            : PlaybackCommandResult::FAILED;
+    } else {
+        if (engine->isPlaybackActive()) {
+            engine->stopSignal();
+        }
+        result = PlaybackCommandResult::STOPPED;
+    }
+    
+    _playbackResult = result;
+    _playbackDoneId = cmd.id;
+    Serial.printf("[WiFi] Reproducción #%lu: %s\n", (unsigned long)cmd.id,
+                  getPlaybackResultName(result));
+}
+
 void WiFiServer_BioSim::stop() {
     if (_ws) {
         _ws->closeAll();
@@ -16,6 +16,7 @@
 
 #include "core/digital_filters.h"
 #include <math.h>
+#include <string.h>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846f
@@ -63,6 +64,78 @@ void DigitalFilter::reset() {
     }
 }
 
+// ============================================================================
+// BIQUADCASCADE - IMPLEMENTACIÓN
+// ============================================================================
+
+BiquadCascade::BiquadCascade() : numSections(0) {
+    for (int k = 0; k < BIQUAD_CASCADE_MAX_SECTIONS; k++) {
+        setSection(k, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+    }
+    reset();
+}
+
+void BiquadCascade::setSection(int section, float b0, float b1, float b2, float a1, float a2) {
+    if (section < 0 || section >= BIQUAD_CASCADE_MAX_SECTIONS) return;
+    float* c = &coeffs[section * BIQUAD_COEFFS_PER_SECTION];
+    c[0] = b0;
+    c[1] = b1;
+    c[2] = b2;
+    c[3] = a1;
+    c[4] = a2;
+}
+
+void BiquadCascade::setSection(int section, const float* sectionCoeffs) {
+    setSection(section, sectionCoeffs[0], sectionCoeffs[1], sectionCoeffs[2],
+               sectionCoeffs[3], sectionCoeffs[4]);
+}
+
+void BiquadCascade::setSection(int section, const BiquadSection& biquad) {
+    setSection(section, biquad.b0, biquad.b1, biquad.b2, biquad.a1, biquad.a2);
+}
+
+void BiquadCascade::setNumSections(int n) {
+    if (n >= 0 && n <= BIQUAD_CASCADE_MAX_SECTIONS) {
+        numSections = n;
+    }
+}
+
+/**
+ * @brief Filtra un bloque completo
+ *
+ * Con esp-dsp, una sección cada vez: la primera lee de in y escribe en out,
+ * las siguientes trabajan in-place sobre out. En C, cada muestra atraviesa
+ * toda la cascada: sección a sección, cada muestra espera a la recurrencia
+ * de la anterior; por muestra, las secciones de muestras consecutivas se
+ * solapan en el pipeline (en host, más rápido que recorrer por secciones).
+ * Sin secciones activas el bloque se copia tal cual.
+ */
+void BiquadCascade::processBlock(const float* in, float* out, size_t n) {
+    if (n == 0) return;
+    
+    if (numSections == 0) {
+        if (in != out) memcpy(out, in, n * sizeof(float));
+        return;
+    }
+    
+#if BIQUAD_USE_ESP_DSP
+    const float* src = in;
+    for (int k = 0; k < numSections; k++) {
+        dsps_biquad_f32_ae32(src, out, (int)n, &coeffs[k * BIQUAD_COEFFS_PER_SECTION],
+                             &state[k * 2]);
+        src = out;
+    }
+#else
+    for (size_t i = 0; i < n; i++) out[i] = process(in[i]);
+#endif
+}
+
+void BiquadCascade::reset() {
+    for (int i = 0; i < BIQUAD_CASCADE_MAX_SECTIONS * 2; i++) {
+        state[i] = 0.0f;
+    }
+}
+
 // ============================================================================
 // NOTCHFILTER - IMPLEMENTACIÓN
 // ============================================================================
@@ -330,6 +403,7 @@ void SignalFilterChain::configureForECG(float fs, float notchFreq) {
     highpass.setEnabled(true);
     lowpass.setEnabled(true);
     notch.setEnabled(true);
+    rebuildCascade();
 }
 
 /**
@@ -350,6 +424,7 @@ void SignalFilterChain::configureForPPG(float fs, float notchFreq) {
     highpass.setEnabled(true);
     lowpass.setEnabled(true);
     notch.setEnabled(true);
+    rebuildCascade();
 }
 
 /**
@@ -371,18 +446,22 @@ void SignalFilterChain::configureForEMG(float fs, float notchFreq) {
     highpass.setEnabled(true);
     lowpass.setEnabled(true);
     notch.setEnabled(true);
+    rebuildCascade();
 }
 
 void SignalFilterChain::setHighpassCutoff(float fc) {
     highpass.configure(fc, sampleRate);
+    rebuildCascade();
 }
 
 void SignalFilterChain::setLowpassCutoff(float fc) {
     lowpass.configure(fc, sampleRate);
+    rebuildCascade();
 }
 
 void SignalFilterChain::setNotchFreq(float fc, float Q) {
     notch.configure(fc, sampleRate, Q);
+    rebuildCascade();
 }
 
 void SignalFilterChain::setSampleRate(float fs) {
@@ -391,24 +470,44 @@ void SignalFilterChain::setSampleRate(float fs) {
     highpass.configure(highpass.getCutoffFreq(), fs);
     lowpass.configure(lowpass.getCutoffFreq(), fs);
     notch.configure(notch.getCenterFreq(), fs, notch.getQFactor());
+    rebuildCascade();
 }
 
 void SignalFilterChain::enableHighpass(bool en) {
     highpass.setEnabled(en);
+    rebuildCascade();
 }
 
 void SignalFilterChain::enableLowpass(bool en) {
     lowpass.setEnabled(en);
+    rebuildCascade();
 }
 
 void SignalFilterChain::enableNotch(bool en) {
     notch.setEnabled(en);
+    rebuildCascade();
 }
 
 void SignalFilterChain::enableAll(bool en) {
     highpass.setEnabled(en);
     lowpass.setEnabled(en);
     notch.setEnabled(en);
+    rebuildCascade();
+}
+
+/**
+ * @brief Copia las secciones habilitadas a la cascada (HP → LP → Notch)
+ *
+ * Conserva el orden del pipeline; los filtros deshabilitados no ocupan
+ * sección, así que no cuestan nada en process()/processBlock().
+ */
+void SignalFilterChain::rebuildCascade() {
+    int n = 0;
+    if (highpass.isEnabled()) cascade.setSection(n++, highpass.getSection());
+    if (lowpass.isEnabled())  cascade.setSection(n++, lowpass.getSection());
+    if (notch.isEnabled())    cascade.setSection(n++, notch.getSection());
+    cascade.setNumSections(n);
+    cascade.reset();
 }
 
 /**
@@ -418,19 +517,26 @@ void SignalFilterChain::enableAll(bool en) {
  */
 float SignalFilterChain::process(float input) {
     if (!filteringEnabled) return input;
-    
-    float output = input;
-    
-    // Pipeline de filtrado
-    output = highpass.process(output);
-    output = lowpass.process(output);
-    output = notch.process(output);
-    
-    return output;
+    return cascade.process(input);
+}
+
+/**
+ * @brief Procesa un bloque a través de la cadena completa
+ * @param in Muestras de entrada
+ * @param out Muestras filtradas (puede ser el mismo buffer que in)
+ * @param n Número de muestras
+ */
+void SignalFilterChain::processBlock(const float* in, float* out, size_t n) {
+    if (!filteringEnabled) {
+        if (in != out) memcpy(out, in, n * sizeof(float));
+        return;
+    }
+    cascade.processBlock(in, out, n);
 }
 
 void SignalFilterChain::reset() {
     highpass.reset();
     lowpass.reset();
     notch.reset();
+    cascade.reset();
 }
@@ -0,0 +1,188 @@
+/**
+ * @file fast_random.cpp
+ * @brief Implementación de FastRandom (xoshiro128** + ziggurat normal)
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ */
+
+#include "core/fast_random.h"
+#include <math.h>
+
+// ============================================================================
+// TABLAS DEL ZIGGURAT (Marsaglia & Tsang 2000, 128 capas, escala 2^31)
+// ============================================================================
+// r = 3.442619855899 (borde de la última capa), v = 9.91256303526217e-3
+// kn[i] = umbral entero de aceptación directa, wn[i] = ancho de capa / 2^31,
+// fn[i] = exp(-x_i²/2). Generadas offline en doble precisión.
+static const float ZIGGURAT_R = 3.442620f;
+
+const uint32_t FastRandom::zigKn[FAST_RANDOM_ZIGGURAT_LAYERS] = {
+    0x76AD2212u, 0x00000000u, 0x600F1B53u, 0x6CE447A6u, 0x725B46A2u, 0x7560051Du,
+    0x774921EBu, 0x789A25BDu, 0x799045C3u, 0x7A4BCE5Du, 0x7ADF629Fu, 0x7B5682A6u,
+    0x7BB8A8C6u, 0x7C0AE722u, 0x7C50CCE7u, 0x7C8CEC5Bu, 0x7CC12CD6u, 0x7CEEFED2u,
+    0x7D177E0Bu, 0x7D3B8883u, 0x7D5BCE6Cu, 0x7D78DD64u, 0x7D932886u, 0x7DAB0E57u,
+    0x7DC0DD30u, 0x7DD4D688u, 0x7DE73185u, 0x7DF81CEAu, 0x7E07C0A3u, 0x7E163EFAu,
+    0x7E23B587u, 0x7E303DFDu, 0x7E3BEEC2u, 0x7E46DB77u, 0x7E51155Du, 0x7E5AABB3u,
+    0x7E63ABF7u, 0x7E6C222Cu, 0x7E741906u, 0x7E7B9A18u, 0x7E82ADFAu, 0x7E895C63u,
+    0x7E8FAC4Bu, 0x7E95A3FBu, 0x7E9B4924u, 0x7EA0A0EFu, 0x7EA5B00Du, 0x7EAA7AC3u,
+    0x7EAF04F3u, 0x7EB3522Au, 0x7EB765A5u, 0x7EBB4259u, 0x7EBEEAFDu, 0x7EC2620Au,
+    0x7EC5A9C4u, 0x7EC8C441u, 0x7ECBB365u, 0x7ECE78EDu, 0x7ED11671u, 0x7ED38D62u,
+    0x7ED5DF12u, 0x7ED80CB4u, 0x7EDA175Cu, 0x7EDC0005u, 0x7EDDC78Eu, 0x7EDF6EBFu,
+    0x7EE0F647u, 0x7EE25EBEu, 0x7EE3A8A9u, 0x7EE4D473u, 0x7EE5E276u, 0x7EE6D2F5u,
+    0x7EE7A620u, 0x7EE85C10u, 0x7EE8F4CDu, 0x7EE97047u, 0x7EE9CE59u, 0x7EEA0ECAu,
+    0x7EEA3147u, 0x7EEA3568u, 0x7EEA1AABu, 0x7EE9E071u, 0x7EE98602u, 0x7EE90A88u,
+    0x7EE86D08u, 0x7EE7AC6Au, 0x7EE6C769u, 0x7EE5BC9Cu, 0x7EE48A67u, 0x7EE32EFCu,
+    0x7EE1A857u, 0x7EDFF42Fu, 0x7EDE0FFAu, 0x7EDBF8D9u, 0x7ED9AB94u, 0x7ED7248Du,
+    0x7ED45FAEu, 0x7ED1585Cu, 0x7ECE095Fu, 0x7ECA6CCBu, 0x7EC67BE2u, 0x7EC22EEEu,
+    0x7EBD7D1Au, 0x7EB85C35u, 0x7EB2C075u, 0x7EAC9C20u, 0x7EA5DF27u, 0x7E9E769Fu,
+    0x7E964C16u, 0x7E8D44BAu, 0x7E834033u, 0x7E781728u, 0x7E6B9933u, 0x7E5D8A1Au,
+    0x7E4D9DEDu, 0x7E3B737Au, 0x7E268C2Fu, 0x7E0E3FF5u, 0x7DF1AA5Du, 0x7DCF8C72u,
+    0x7DA61A1Eu, 0x7D72A0FBu, 0x7D30E097u, 0x7CD9B4ABu, 0x7C600F1Au, 0x7BA90BDCu,
+    0x7A722176u, 0x77D664E5u,
+};
+
+const float FastRandom::zigWn[FAST_RANDOM_ZIGGURAT_LAYERS] = {
+    1.729040466e-09f, 1.268092853e-10f, 1.689751811e-10f, 1.986268788e-10f,
+    2.223243117e-10f, 2.424493661e-10f, 2.601613092e-10f, 2.761198770e-10f,
+    2.907396268e-10f, 3.042996966e-10f, 3.169979557e-10f, 3.289802042e-10f,
+    3.403573812e-10f, 3.512160285e-10f, 3.616250910e-10f, 3.716405794e-10f,
+    3.813085681e-10f, 3.906675816e-10f, 3.997501219e-10f, 4.085840000e-10f,
+    4.171930856e-10f, 4.255982233e-10f, 4.338175930e-10f, 4.418672095e-10f,
+    4.497613115e-10f, 4.575125834e-10f, 4.651324048e-10f, 4.726310454e-10f,
+    4.800177478e-10f, 4.873009773e-10f, 4.944885057e-10f, 5.015873272e-10f,
+    5.086040478e-10f, 5.155446070e-10f, 5.224146671e-10f, 5.292193350e-10f,
+    5.359634958e-10f, 5.426517014e-10f, 5.492881705e-10f, 5.558769556e-10f,
+    5.624218868e-10f, 5.689264615e-10f, 5.753941212e-10f, 5.818281967e-10f,
+    5.882316856e-10f, 5.946076964e-10f, 6.009590048e-10f, 6.072883862e-10f,
+    6.135985053e-10f, 6.198920266e-10f, 6.261713370e-10f, 6.324390456e-10f,
+    6.386973728e-10f, 6.449488166e-10f, 6.511955974e-10f, 6.574400468e-10f,
+    6.636843297e-10f, 6.699307220e-10f, 6.761814442e-10f, 6.824387166e-10f,
+    6.887046489e-10f, 6.949815168e-10f, 7.012714853e-10f, 7.075767749e-10f,
+    7.138996616e-10f, 7.202424213e-10f, 7.266072743e-10f, 7.329966079e-10f,
+    7.394128088e-10f, 7.458582640e-10f, 7.523354717e-10f, 7.588469852e-10f,
+    7.653954137e-10f, 7.719834771e-10f, 7.786139511e-10f, 7.852897221e-10f,
+    7.920137879e-10f, 7.987892015e-10f, 8.056192380e-10f, 8.125072837e-10f,
+    8.194568912e-10f, 8.264716689e-10f, 8.335555579e-10f, 8.407127217e-10f,
+    8.479473235e-10f, 8.552640263e-10f, 8.626675485e-10f, 8.701631637e-10f,
+    8.777562011e-10f, 8.854524336e-10f, 8.932581896e-10f, 9.011799640e-10f,
+    9.092249731e-10f, 9.174008220e-10f, 9.257158373e-10f, 9.341788454e-10f,
+    9.427997272e-10f, 9.515889188e-10f, 9.605578555e-10f, 9.697193049e-10f,
+    9.790869226e-10f, 9.886760299e-10f, 9.985036131e-10f, 1.008588213e-09f,
+    1.018950924e-09f, 1.029615060e-09f, 1.040606934e-09f, 1.051956633e-09f,
+    1.063698019e-09f, 1.075870171e-09f, 1.088518276e-09f, 1.101694735e-09f,
+    1.115461057e-09f, 1.129890181e-09f, 1.145069595e-09f, 1.161105212e-09f,
+    1.178127595e-09f, 1.196299504e-09f, 1.215828660e-09f, 1.236985625e-09f,
+    1.260132332e-09f, 1.285769713e-09f, 1.314620190e-09f, 1.347783996e-09f,
+    1.387063575e-09f, 1.435740304e-09f, 1.500865876e-09f, 1.603094768e-09f,
+};
+
+const float FastRandom::zigFn[FAST_RANDOM_ZIGGURAT_LAYERS] = {
+    1.000000000e+00f, 9.635996819e-01f, 9.362826943e-01f, 9.130436182e-01f,
+    8.922816515e-01f, 8.732430339e-01f, 8.555005789e-01f, 8.387836218e-01f,
+    8.229072094e-01f, 8.077383041e-01f, 7.931770086e-01f, 7.791460752e-01f,
+    7.655841708e-01f, 7.524415851e-01f, 7.396772504e-01f, 7.272568941e-01f,
+    7.151514888e-01f, 7.033361197e-01f, 6.917891502e-01f, 6.804918647e-01f,
+    6.694276929e-01f, 6.585819721e-01f, 6.479418278e-01f, 6.374954581e-01f,
+    6.272324920e-01f, 6.171433926e-01f, 6.072195172e-01f, 5.974531770e-01f,
+    5.878370404e-01f, 5.783646703e-01f, 5.690299869e-01f, 5.598273873e-01f,
+    5.507518053e-01f, 5.417983532e-01f, 5.329626799e-01f, 5.242405534e-01f,
+    5.156282187e-01f, 5.071220398e-01f, 4.987186491e-01f, 4.904148281e-01f,
+    4.822076559e-01f, 4.740943015e-01f, 4.660721421e-01f, 4.581387043e-01f,
+    4.502916336e-01f, 4.425287247e-01f, 4.348478317e-01f, 4.272469878e-01f,
+    4.197243452e-01f, 4.122780263e-01f, 4.049064219e-01f, 3.976078629e-01f,
+    3.903807998e-01f, 3.832238019e-01f, 3.761354685e-01f, 3.691144586e-01f,
+    3.621594906e-01f, 3.552693725e-01f, 3.484429717e-01f, 3.416791558e-01f,
+    3.349768519e-01f, 3.283351064e-01f, 3.217529058e-01f, 3.152293861e-01f,
+    3.087636232e-01f, 3.023548424e-01f, 2.960021496e-01f, 2.897048593e-01f,
+    2.834621966e-01f, 2.772735059e-01f, 2.711380720e-01f, 2.650552988e-01f,
+    2.590245605e-01f, 2.530452907e-01f, 2.471169531e-01f, 2.412389964e-01f,
+    2.354109436e-01f, 2.296323180e-01f, 2.239027023e-01f, 2.182216495e-01f,
+    2.125887722e-01f, 2.070037127e-01f, 2.014661133e-01f, 1.959756464e-01f,
+    1.905320436e-01f, 1.851349920e-01f, 1.797842681e-01f, 1.744796336e-01f,
+    1.692208946e-01f, 1.640078574e-01f, 1.588403732e-01f, 1.537183076e-01f,
+    1.486415714e-01f, 1.436100751e-01f, 1.386237741e-01f, 1.336826533e-01f,
+    1.287867129e-01f, 1.239359826e-01f, 1.191305444e-01f, 1.143705100e-01f,
+    1.096560210e-01f, 1.049872562e-01f, 1.003644392e-01f, 9.578784555e-02f,
+    9.125780314e-02f, 8.677466959e-02f, 8.233889937e-02f, 7.795098424e-02f,
+    7.361150533e-02f, 6.932111830e-02f, 6.508058310e-02f, 6.089077145e-02f,
+    5.675266311e-02f, 5.266740173e-02f, 4.863629490e-02f, 4.466086254e-02f,
+    4.074286669e-02f, 3.688438982e-02f, 3.308788687e-02f, 2.935631759e-02f,
+    2.569329180e-02f, 2.210330404e-02f, 1.859210245e-02f, 1.516729780e-02f,
+    1.183947828e-02f, 8.624484763e-03f, 5.548994988e-03f, 2.669629175e-03f,
+};
+
+// ============================================================================
+// CONSTRUCTOR / SEMILLA
+// ============================================================================
+FastRandom::FastRandom(uint32_t initialSeed) {
+    seed(initialSeed);
+}
+
+/**
+ * Expande la semilla de 32 bits a los 128 bits de estado con splitmix32
+ * (nunca deja el estado todo a cero).
+ */
+void FastRandom::seed(uint32_t value) {
+    seedValue = value;
+    uint32_t x = value;
+    for (int i = 0; i < 4; i++) {
+        x += 0x9E3779B9u;
+        uint32_t z = x;
+        z = (z ^ (z >> 16)) * 0x85EBCA6Bu;
+        z = (z ^ (z >> 13)) * 0xC2B2AE35u;
+        s[i] = z ^ (z >> 16);
+    }
+    if ((s[0] | s[1] | s[2] | s[3]) == 0) {
+        s[0] = 1;
+    }
+}
+
+// ============================================================================
+// NORMAL: CAMINO LENTO
+// ============================================================================
+/**
+ * Se llega aquí cuando |hz| cae fuera del rectángulo de la capa iz:
+ * - Capa 0: muestra de la cola |x| > r (método de Marsaglia)
+ * - Resto: aceptar si el punto queda bajo la curva exp(-x²/2); si no,
+ *   volver a sortear
+ */
+float FastRandom::gaussianSlow(int32_t hz, uint32_t iz) {
+    for (;;) {
+        float x = (float)hz * zigWn[iz];
+        
+        if (iz == 0) {
+            float y;
+            do {
+                x = -logf(1.0f - uniform()) * (1.0f / ZIGGURAT_R);
+                y = -logf(1.0f - uniform());
+            } while (y + y < x * x);
+            return (hz > 0) ? ZIGGURAT_R + x : -ZIGGURAT_R - x;
+        }
+        
+        if (zigFn[iz] + uniform() * (zigFn[iz - 1] - zigFn[iz]) < expf(-0.5f * x * x)) {
+            return x;
+        }
+        
+        hz = (int32_t)nextU32();
+        iz = (uint32_t)hz & (FAST_RANDOM_ZIGGURAT_LAYERS - 1);
+        uint32_t ahz = (hz < 0) ? (uint32_t)(-(int64_t)hz) : (uint32_t)hz;
+        if (ahz < zigKn[iz]) {
+            return (float)hz * zigWn[iz];
+        }
+    }
+}
+
+// ============================================================================
+// BLOQUES
+// ============================================================================
+void FastRandom::fillUniform(float* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = uniform();
+    }
+}
+
+void FastRandom::fillGaussian(float* out, size_t n, float mean, float std) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = mean + std * gaussian();
+    }
+}
@@ -0,0 +1,136 @@
+/**
+ * @file perf_counters.cpp
+ * @brief Implementación de los contadores de ciclos por etapa
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ */
+
+#include "core/perf_counters.h"
+#include <string.h>
+
+// Instancia global
+PerfCounters perfCounters;
+
+// ============================================================================
+// CONSTRUCTOR / RESET
+// ============================================================================
+PerfCounters::PerfCounters() : resetEpoch(0) {
+    for (uint8_t i = 0; i < PERF_STAGE_COUNT; i++) clearStage(stages[i], 0);
+    for (uint8_t i = 0; i < PERF_BUFFER_COUNT; i++) clearBuffer(buffers[i], 0);
+}
+
+void PerfCounters::requestReset() {
+    resetEpoch.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PerfCounters::clearStage(StageSlot& s, uint32_t epoch) {
+    memset(&s.stats, 0, sizeof(s.stats));
+    s.stats.minCycles = UINT32_MAX;
+    s.epoch = epoch;
+}
+
+void PerfCounters::clearBuffer(BufferSlot& b, uint32_t epoch) {
+    memset(&b.mark, 0, sizeof(b.mark));
+    b.mark.minLevel = UINT16_MAX;
+    b.epoch = epoch;
+}
+
+// ============================================================================
+// LECTURA
+// ============================================================================
+PerfStageStats PerfCounters::getStage(PerfStage stage) const {
+    const StageSlot& s = stages[(uint8_t)stage];
+    PerfStageStats out;
+    if (s.epoch != resetEpoch.load(std::memory_order_relaxed) || s.stats.count == 0) {
+        memset(&out, 0, sizeof(out));
+        return out;
+    }
+    out = s.stats;
+    return out;
+}
+
+PerfWatermark PerfCounters::getWatermark(PerfBuffer buffer) const {
+    const BufferSlot& b = buffers[(uint8_t)buffer];
+    PerfWatermark out;
+    if (b.epoch != resetEpoch.load(std::memory_order_relaxed) || b.mark.samples == 0) {
+        memset(&out, 0, sizeof(out));
+        out.capacity = b.mark.capacity;
+        return out;
+    }
+    out = b.mark;
+    return out;
+}
+
+uint32_t PerfCounters::getBucketLimit(uint8_t bucket) {
+    if (bucket >= PERF_HIST_BUCKETS - 1) return 0;
+    return 1u << (bucket + PERF_HIST_MIN_SHIFT);
+}
+
+const char* PerfCounters::getStageName(PerfStage stage) {
+    switch (stage) {
+        case PerfStage::MODEL_TICK:     return "model_tick";
+        case PerfStage::INTERPOLATION:  return "interpolation";
+        case PerfStage::FILTER:         return "filter";
+        case PerfStage::RING_PUSH:      return "ring_push";
+        case PerfStage::SINK_WRITE:     return "sink_write";
+        case PerfStage::NEXTION_SEND:   return "nextion_send";
+        case PerfStage::WS_SERIALIZE:   return "ws_serialize";
+        default:                        return "unknown";
+    }
+}
+
+const char* PerfCounters::getBufferName(PerfBuffer buffer) {
+    switch (buffer) {
+        case PerfBuffer::OUTPUT_SINK:   return "output_sink";
+        case PerfBuffer::DISPLAY_RING:  return "display_ring";
+        case PerfBuffer::WS_RING:       return "ws_ring";
+        default:                        return "unknown";
+    }
+}
+
+// ============================================================================
+// INFORME SERIE
+// ============================================================================
+void PerfCounters::printReport(HardwareSerial& out) const {
+    float mhz = (float)ESP.getCpuFreqMHz();
+
+    out.println("\n--- Contadores de rendimiento (ciclos) ---");
+    out.printf("CPU: %.0f MHz%s\n", mhz, PERF_COUNTERS_ENABLED ? "" : "  (PERF_COUNTERS_ENABLED=0)");
+    out.println("etapa            n          medio      min        max        max_us");
+    for (uint8_t i = 0; i < PERF_STAGE_COUNT; i++) {
+        PerfStageStats s = getStage((PerfStage)i);
+        uint32_t mean = s.count ? (uint32_t)(s.totalCycles / s.count) : 0;
+        out.printf("%-16s %-10lu %-10lu %-10lu %-10lu %.1f\n",
+                      getStageName((PerfStage)i), (unsigned long)s.count,
+                      (unsigned long)mean, (unsigned long)s.minCycles,
+                      (unsigned long)s.maxCycles, s.maxCycles / mhz);
+    }
+
+    // Histograma: solo cubos con cuentas, como "<límite:cuenta"
+    out.println("\nHistogramas (cubo < ciclos : cuenta)");
+    for (uint8_t i = 0; i < PERF_STAGE_COUNT; i++) {
+        PerfStageStats s = getStage((PerfStage)i);
+        if (s.count == 0) continue;
+        out.printf("%-16s", getStageName((PerfStage)i));
+        for (uint8_t b = 0; b < PERF_HIST_BUCKETS; b++) {
+            if (s.histogram[b] == 0) continue;
+            uint32_t limit = getBucketLimit(b);
+            if (limit) {
+                out.printf(" <%lu:%lu", (unsigned long)limit, (unsigned long)s.histogram[b]);
+            } else {
+                out.printf(" >=%lu:%lu", (unsigned long)(1u << (b + PERF_HIST_MIN_SHIFT - 1)),
+                              (unsigned long)s.histogram[b]);
+            }
+        }
+        out.println();
+    }
+
+    out.println("\nBuffers            min    max    actual capacidad");
+    for (uint8_t i = 0; i < PERF_BUFFER_COUNT; i++) {
+        PerfWatermark w = getWatermark((PerfBuffer)i);
+        out.printf("%-18s %-6u %-6u %-6u %u\n", getBufferName((PerfBuffer)i),
+                      (unsigned)w.minLevel, (unsigned)w.maxLevel,
+                      (unsigned)w.lastLevel, (unsigned)w.capacity);
+    }
+    out.println("------------------------------------------\n");
+}
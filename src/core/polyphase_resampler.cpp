@@ -0,0 +1,79 @@
+/**
+ * @file polyphase_resampler.cpp
+ * @brief Diseño del prototipo FIR del remuestreador polifásico L/M
+ * @version 1.1.0
+ * @date 20 Enero 2026
+ *
+ * El filtrado vive en la plantilla PolyphaseResamplerT (header); aquí solo
+ * el cálculo en float de L/M y de los taps, común a todos los formatos.
+ */
+
+#include "core/polyphase_resampler.h"
+#include <math.h>
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+static uint32_t gcd32(uint32_t a, uint32_t b) {
+    while (b != 0) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// ============================================================================
+// DISEÑO (L/M y corte del prototipo)
+// ============================================================================
+bool polyphaseDesign(uint32_t fsIn, uint32_t fsOut, PolyphaseDesign& design) {
+    if (fsIn == 0 || fsOut == 0) {
+        return false;
+    }
+
+    uint32_t g = gcd32(fsIn, fsOut);
+    uint32_t L = fsOut / g;
+    uint32_t M = fsIn / g;
+    if (L > 0xFFFF || M > 0xFFFF) {
+        return false;
+    }
+    design.interp = (uint16_t)L;
+    design.decim = (uint16_t)M;
+    design.tablePhases = (design.interp < RESAMPLER_MAX_PHASES) ? design.interp : RESAMPLER_MAX_PHASES;
+
+    // Prototipo a Fs_proto = tablePhases × Fs_in, longitud P×T.
+    // Corte relativo a Fs_proto: Nyquist del lado más lento (entrada o salida)
+    float ratio = (L >= M) ? 1.0f : (float)L / (float)M;
+    design.cutoff = RESAMPLER_CUTOFF_FACTOR * 0.5f * ratio / (float)design.tablePhases;
+    return true;
+}
+
+// ============================================================================
+// TAPS DE UNA FASE (sinc con ventana de Blackman)
+// ============================================================================
+void polyphaseDesignPhase(const PolyphaseDesign& design, uint16_t p,
+                          float taps[RESAMPLER_TAPS_PER_PHASE]) {
+    const uint16_t P = design.tablePhases;
+    const uint16_t T = RESAMPLER_TAPS_PER_PHASE;
+    const uint16_t N = P * T;
+    const float fc = design.cutoff;
+    const float center = (float)(N - 1) * 0.5f;
+
+    // Fase p: taps h[p + k·P] aplicados a x[n-k]
+    float sum = 0.0f;
+    for (uint16_t k = 0; k < T; k++) {
+        float n = (float)(p + k * P);
+        float t = n - center;
+        float sinc = (fabsf(t) < 1e-6f) ? 2.0f * fc
+                                        : sinf(2.0f * PI * fc * t) / (PI * t);
+        float w = 0.42f - 0.5f * cosf(2.0f * PI * (n + 0.5f) / (float)N)
+                        + 0.08f * cosf(4.0f * PI * (n + 0.5f) / (float)N);
+        taps[k] = sinc * w;
+        sum += taps[k];
+    }
+
+    // Normalizar la fase a ganancia DC 1
+    for (uint16_t k = 0; k < T; k++) {
+        taps[k] = (sum != 0.0f) ? taps[k] / sum : 0.0f;
+    }
+}
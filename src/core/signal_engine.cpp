@@ -7,7 +7,16 @@
 
 #include "core/signal_engine.h"
 #include "config.h"
+#include "core/spsc_ring.h"
+#include "core/signal_recorder.h"
+#include "core/dac_pipeline.h"
+#include "core/perf_counters.h"
+#include "core/trace_ring.h"
 #include "hw/cd4051_mux.h"
+#include "hw/timer_isr_sink.h"
+#include "hw/i2s_dac_sink.h"
+#include "hw/simulated_sink.h"
+#include <atomic>
 
 // ============================================================================
 // EXTERNA: Objeto MUX global (definido en cd4051_mux.cpp)
@@ -22,33 +31,70 @@ SignalEngine* SignalEngine::instance = nullptr;
 // ============================================================================
 // BUFFERS EN RAM RÁPIDA
 // ============================================================================
-DRAM_ATTR static uint8_t signalBuffer[SIGNAL_BUFFER_SIZE];
-DRAM_ATTR static float displayBuffer[SIGNAL_BUFFER_SIZE];
-DRAM_ATTR static volatile uint16_t bufferReadIndex = 0;
-DRAM_ATTR static volatile uint16_t bufferWriteIndex = 0;
-DRAM_ATTR static volatile uint32_t isrCount = 0;
-DRAM_ATTR static volatile uint32_t isrMaxTime = 0;
-DRAM_ATTR static volatile uint32_t bufferUnderruns = 0;
-DRAM_ATTR static volatile uint8_t lastDACValue = 128;
+// El buffer de muestras DAC vive en el OutputSink; aquí solo queda el
+// buffer de display, ya diezmado a FDS_* (productor: generación, consumidor: loop)
+static SPSCRing<DisplaySample, DISPLAY_SAMPLE_BUFFER_SIZE> displayRing;
+// El consumidor (loop) puede estar a mitad de un pop durante beginSignal():
+// igual que el ring WebSocket, el vaciado lo hace el propio consumidor
+static std::atomic<bool> displayFlushPending(false);
+static uint8_t displayDownsample = NEXTION_DOWNSAMPLE_ECG;  // Ratio según señal
+static uint8_t displayCountdown = NEXTION_DOWNSAMPLE_ECG;   // Muestras hasta el siguiente punto
 
-// Variables para timing real e interpolación
-static uint32_t lastModelTick_us = 0;          // Último tick del modelo
-static uint8_t currentModelSample = 128;       // Muestra actual del modelo
-static uint8_t previousModelSample = 128;      // Muestra anterior (para interpolación)
-static float currentModelValueMV = 0.0f;       // Último valor del modelo en mV
-static float previousModelValueMV = 0.0f;      // Valor anterior en mV
-static uint16_t interpolationCounter = 0;      // Contador para interpolación
+// Bloque de salida: la tarea de generación escribe al sink por bloques
+static uint8_t outputBlock[OUTPUT_BLOCK_SIZE];
+
+// Bloque de modelo: generateBlock() llena MODEL_BLOCK_SIZE muestras de una
+// vez (un solo switch por bloque) y el motor consume una por tick de modelo
+static uint8_t modelBlockDAC[MODEL_BLOCK_SIZE];
+static float modelBlockLevel[MODEL_BLOCK_SIZE];   // Nivel DAC sin cuantizar
+static float modelBlockMV[MODEL_BLOCK_SIZE];
+static float modelBlockEnvelope[MODEL_BLOCK_SIZE];
+static uint8_t modelBlockWave0[MODEL_BLOCK_SIZE];
+static uint8_t modelBlockWave1[MODEL_BLOCK_SIZE];
+static size_t modelBlockPos = MODEL_BLOCK_SIZE;   // Siguiente muestra (== tamaño: vacío)
+static uint32_t modelSampleCount = 0;             // Muestras de modelo desde startSignal
+
+static_assert(sizeof(ECGParameters) <= RECORDER_MAX_PARAM_BYTES, "ECGParameters no cabe en el bloque");
+static_assert(sizeof(EMGParameters) <= RECORDER_MAX_PARAM_BYTES, "EMGParameters no cabe en el bloque");
+static_assert(sizeof(PPGParameters) <= RECORDER_MAX_PARAM_BYTES, "PPGParameters no cabe en el bloque");
+
+// Muestra de modelo en curso (la que alimentan display y WebSocket)
+static uint8_t currentWave0 = 0;
+static uint8_t currentWave1 = 0;
+static float currentValueMV = 0.0f;            // Valor para WebSocket (EMG: cruda)
+static float currentEnvelopeMV = 0.0f;         // Envolvente EMG para WebSocket
+
+// Remuestreo Fs_modelo → Fs_timer (L/M polifásico, avanzado por contador
+// de muestras: el modelo avanza exactamente L/M muestras por muestra DAC).
+// Entra el nivel DAC sin cuantizar; el código de 8 bits sale del pipeline
+// (Q15 o float según DAC_PIPELINE_FIXED_POINT)
+static DACPipeline dacPipeline;
+static float modelDeltaTime = MODEL_DT_ECG;    // deltaTime del modelo activo
+static uint8_t currentModelSample = 128;       // Última muestra DAC del modelo
+static float currentModelLevel = 128.0f;       // La misma sin cuantizar (entrada del pipeline)
 
 // ============================================================================
 // BUFFER WEBSOCKET SINCRONIZADO (frecuencia dinámica según señal)
 // ============================================================================
-static WSSampleData wsBuffer[WS_SAMPLE_BUFFER_SIZE];
-static volatile uint8_t wsBufferReadIdx = 0;
-static volatile uint8_t wsBufferWriteIdx = 0;
-static uint32_t lastWSSampleTime_us = 0;
-// Intervalos según tipo de señal (igual que Nextion):
-// ECG: 200 Hz = 5000 us, EMG/PPG: 100 Hz = 10000 us
-static uint32_t wsSampleInterval_us = 5000;  // Default ECG 200 Hz
+static SPSCRing<WSSampleData, WS_SAMPLE_BUFFER_SIZE> wsRing;
+// El consumidor (tarea WebSocket, Core 0) sigue activo durante startSignal():
+// en vez de reset() se pide que descarte lo pendiente en su próximo pop
+static std::atomic<bool> wsFlushPending(false);
+// Intervalos según tipo de señal (igual que Nextion), en muestras DAC:
+// ECG: 200 Hz = 10 muestras, EMG/PPG: 100 Hz = 20 muestras @ 2 kHz
+static uint8_t wsDownsample = NEXTION_DOWNSAMPLE_ECG;
+static uint8_t wsCountdown = NEXTION_DOWNSAMPLE_ECG;
+
+// ============================================================================
+// PARADA DE LA TAREA DE GENERACIÓN (handshake)
+// ============================================================================
+// processGeneration() puede quedar suspendido a mitad de ciclo (i2s_write
+// bloquea hasta I2S_WRITE_TIMEOUT). Antes de reiniciar rings, pipeline o
+// modelo, el control pide la parada y espera el acuse, que la tarea solo da
+// al inicio de un ciclo: así ningún ciclo queda a medias
+static std::atomic<bool> generationHeld(false);
+static std::atomic<uint32_t> generationHoldSeq(0);    // Escritor: control (signalMutex)
+static std::atomic<uint32_t> generationAckSeq(0);     // Escritor: tarea de generación
 
 // NOTA: El DAC escribe a 4 kHz SIN decimación para espectro correcto
 // La decimación solo se aplica a Nextion y Serial Plotter (visualización)
@@ -61,8 +107,14 @@ SignalEngine::SignalEngine() {
     currentSignal.state = SignalState::STOPPED;
     
     signalMutex = xSemaphoreCreateMutex();
-    signalTimer = nullptr;
     generationTaskHandle = nullptr;
+    playbackActive = false;
+    
+#ifdef NATIVE_BUILD
+    outputSink = &simulatedSink;
+#else
+    outputSink = &timerSink;
+#endif
     
     // Inicializar salida DAC EMG en RAW por defecto
     emgDacOutput = EMGDACOutput::RAW;
@@ -81,8 +133,21 @@ SignalEngine* SignalEngine::getInstance() {
 bool SignalEngine::begin() {
     DEBUG_PRINTLN("[SignalEngine] Inicializando...");
     
-    // Configurar DAC
-    dacWrite(DAC_SIGNAL_PIN, DAC_CENTER_VALUE);
+    // Configurar salida DAC (I2S/DMA con fallback a timer ISR)
+#ifdef NATIVE_BUILD
+    setOutputSink(OutputSinkType::SIMULATED);
+#else
+    if (!setOutputSink((OutputSinkType)OUTPUT_SINK_DEFAULT)) {
+        Serial.println("[SignalEngine] Salida I2S/DMA no disponible, usando timer ISR");
+        setOutputSink(OutputSinkType::TIMER_ISR);
+    }
+#endif
+    outputSink->writeIdle(DAC_CENTER_VALUE);
+    
+    // Lector de reproducción (solo lee flash cuando hay un archivo abierto)
+    if (!playbackModel.begin()) {
+        Serial.println("[SignalEngine] Reproducción desde flash no disponible");
+    }
     
     // Crear tarea de generación en Core 1
     BaseType_t taskCreated = xTaskCreatePinnedToCore(
@@ -109,24 +174,41 @@ bool SignalEngine::begin() {
 // ============================================================================
 bool SignalEngine::startSignal(SignalType type, uint8_t condition) {
     Serial.printf("[SignalEngine] startSignal llamado: type=%d, condition=%d\n", (int)type, condition);
+    return beginSignal(type, condition, false);
+}
+
+bool SignalEngine::startPlayback(const char* path) {
+    Serial.printf("[SignalEngine] startPlayback llamado: %s\n", path);
     
+    // El lector se reabre con la generación detenida (no hay consumidor)
+    stopSignal();
+    if (!playbackModel.open(path)) {
+        return false;
+    }
+    return beginSignal(playbackModel.getSignalType(), playbackModel.getCondition(), true);
+}
+
+bool SignalEngine::beginSignal(SignalType type, uint8_t condition, bool playback) {
     if (xSemaphoreTake(signalMutex, portMAX_DELAY) == pdTRUE) {
-        // Detener señal actual si existe
-        if (currentSignal.state == SignalState::RUNNING) {
-            stopTimer();
+        // Detener señal actual si existe (la tarea de generación confirma la
+        // parada antes de tocar rings, pipeline y modelo)
+        holdGeneration();
+        outputSink->stop();
+        currentSignal.state = SignalState::STOPPED;
+        if (playbackActive && !playback) {
+            playbackModel.close();
         }
+        playbackActive = playback;
         
-        // Reset buffers y variables de timing
-        bufferReadIndex = 0;
-        bufferWriteIndex = 0;
-        isrCount = 0;
-        bufferUnderruns = 0;
-        lastModelTick_us = micros();
+        // Reset buffers y estado de remuestreo
         currentModelSample = DAC_CENTER_VALUE;
-        previousModelSample = DAC_CENTER_VALUE;
-        currentModelValueMV = 0.0f;
-        previousModelValueMV = 0.0f;
-        interpolationCounter = 0;
+        currentModelLevel = DAC_CENTER_VALUE;
+        modelBlockPos = MODEL_BLOCK_SIZE;
+        modelSampleCount = 0;
+        currentWave0 = 0;
+        currentWave1 = 0;
+        currentValueMV = 0.0f;
+        currentEnvelopeMV = 0.0f;
         
         // NOTA: DAC escribe a 4 kHz SIN decimación (espectro correcto)
         // La decimación solo se usa para Nextion/Serial Plotter (visualización)
@@ -136,23 +218,43 @@ bool SignalEngine::startSignal(SignalType type, uint8_t condition) {
         currentSignal.sampleCount = 0;
         currentSignal.lastUpdateTime = millis();
         
-        // Configurar intervalo WebSocket según tipo (igual que Nextion)
-        // ECG: 200 Hz = 5000 us, EMG/PPG: 100 Hz = 10000 us
+        // Configurar remuestreo y decimación WebSocket/Nextion según tipo
+        // ECG: 200 Hz, EMG/PPG: 100 Hz
         switch (type) {
             case SignalType::ECG:
-                wsSampleInterval_us = 5000;   // 200 Hz
+                dacPipeline.configure(MODEL_SAMPLE_RATE_ECG, FS_TIMER_HZ);
+                modelDeltaTime = MODEL_DT_ECG;
+                displayDownsample = NEXTION_DOWNSAMPLE_ECG;
                 break;
             case SignalType::EMG:
+                dacPipeline.configure(MODEL_SAMPLE_RATE_EMG, FS_TIMER_HZ);
+                modelDeltaTime = MODEL_DT_EMG;
+                displayDownsample = NEXTION_DOWNSAMPLE_EMG;
+                break;
             case SignalType::PPG:
-                wsSampleInterval_us = 10000;  // 100 Hz
+                dacPipeline.configure(MODEL_SAMPLE_RATE_PPG, FS_TIMER_HZ);
+                modelDeltaTime = MODEL_DT_PPG;
+                displayDownsample = NEXTION_DOWNSAMPLE_PPG;
                 break;
             default:
-                wsSampleInterval_us = 10000;
+                dacPipeline.configure(FS_TIMER_HZ, FS_TIMER_HZ);
+                modelDeltaTime = 1.0f / FS_TIMER_HZ;
+                displayDownsample = NEXTION_DOWNSAMPLE_PPG;
+        }
+        // Reproducción: la Fs es la de la grabación (el modelo no avanza)
+        if (playback) {
+            dacPipeline.configure(playbackModel.getSampleRate(), FS_TIMER_HZ);
+            modelDeltaTime = 1.0f / playbackModel.getSampleRate();
         }
-        // Reset buffer WebSocket
-        wsBufferReadIdx = 0;
-        wsBufferWriteIdx = 0;
-        lastWSSampleTime_us = micros();
+        dacPipeline.reset(DAC_CENTER_VALUE);
+        wsDownsample = displayDownsample;
+        
+        // Vaciar buffers WebSocket y display: el productor está parado y los
+        // consumidores (WSStream, loop) descartan lo pendiente en su próximo pop
+        wsFlushPending.store(true, std::memory_order_release);
+        displayFlushPending.store(true, std::memory_order_release);
+        displayCountdown = displayDownsample;
+        wsCountdown = wsDownsample;
         
         // ========================================================================
         // CONFIGURAR CANAL DE MUX SEGÚN TIPO DE SEÑAL
@@ -196,6 +298,7 @@ bool SignalEngine::startSignal(SignalType type, uint8_t condition) {
                 ECGParameters params;
                 params.condition = (ECGCondition)condition;
                 ecgModel.setParameters(params);  // Luego aplicar condición
+                currentSignal.ecg = params;      // Base de las instantáneas de la UI
                 yield();  // Alimentar watchdog
                 Serial.printf("[ECG] Condición: %d (%s)\n", 
                              condition, ecgModel.getConditionName());
@@ -211,6 +314,7 @@ bool SignalEngine::startSignal(SignalType type, uint8_t condition) {
                 EMGParameters params;
                 params.condition = (EMGCondition)condition;
                 emgModel.setParameters(params);  // Luego aplicar condición
+                currentSignal.emg = params;      // Base de las instantáneas de la UI
                 yield();  // Alimentar watchdog
                 Serial.printf("[EMG] Condición: %d (%s)\n", 
                              condition, emgModel.getConditionName());
@@ -224,22 +328,25 @@ bool SignalEngine::startSignal(SignalType type, uint8_t condition) {
                 PPGParameters params;
                 params.condition = (PPGCondition)condition;
                 ppgModel.setParameters(params);  // Luego aplicar condición
+                currentSignal.ppg = params;      // Base de las instantáneas de la UI
                 yield();  // Alimentar watchdog
                 break;
             }
             default:
+                releaseGeneration();
                 xSemaphoreGive(signalMutex);
                 return false;
         }
         
-        // Pre-llenar buffer
-        prefillBuffer();
+        // Pre-llenar buffer de salida con el nivel de reposo
+        outputSink->reset(generateSample(), SIGNAL_BUFFER_SIZE / 2);
         
-        // Iniciar timer
-        setupTimer();
+        // Iniciar salida DAC
+        outputSink->start();
         
         currentSignal.state = SignalState::RUNNING;
         
+        releaseGeneration();
         xSemaphoreGive(signalMutex);
         return true;
     }
@@ -248,19 +355,67 @@ bool SignalEngine::startSignal(SignalType type, uint8_t condition) {
 
 bool SignalEngine::stopSignal() {
     if (xSemaphoreTake(signalMutex, portMAX_DELAY) == pdTRUE) {
-        stopTimer();
+        // El lector de reproducción se cierra sin un ciclo en curso
+        holdGeneration();
+        outputSink->stop();
         currentSignal.state = SignalState::STOPPED;
         currentSignal.type = SignalType::NONE;
-        dacWrite(DAC_SIGNAL_PIN, DAC_CENTER_VALUE);
+        outputSink->writeIdle(DAC_CENTER_VALUE);
+        if (playbackActive) {
+            playbackModel.close();
+            playbackActive = false;
+        }
+        releaseGeneration();
         xSemaphoreGive(signalMutex);
         return true;
     }
     return false;
 }
 
+bool SignalEngine::resetModel(SignalType type, uint8_t condition) {
+    if (xSemaphoreTake(signalMutex, portMAX_DELAY) != pdTRUE) return false;
+    
+    // Mismo orden que beginSignal(): reset() y después la condición
+    bool ok = true;
+    holdGeneration();
+    switch (type) {
+        case SignalType::ECG: {
+            ecgModel.reset();
+            ECGParameters params;
+            params.condition = (ECGCondition)condition;
+            ecgModel.setParameters(params);
+            currentSignal.ecg = params;
+            break;
+        }
+        case SignalType::EMG: {
+            emgModel.reset();
+            EMGParameters params;
+            params.condition = (EMGCondition)condition;
+            emgModel.setParameters(params);
+            currentSignal.emg = params;
+            break;
+        }
+        case SignalType::PPG: {
+            ppgModel.reset();
+            PPGParameters params;
+            params.condition = (PPGCondition)condition;
+            ppgModel.setParameters(params);
+            currentSignal.ppg = params;
+            break;
+        }
+        default:
+            ok = false;
+            break;
+    }
+    releaseGeneration();
+    
+    xSemaphoreGive(signalMutex);
+    return ok;
+}
+
 bool SignalEngine::pauseSignal() {
     if (currentSignal.state == SignalState::RUNNING) {
-        stopTimer();
+        outputSink->stop();
         currentSignal.state = SignalState::PAUSED;
         return true;
     }
@@ -269,7 +424,7 @@ bool SignalEngine::pauseSignal() {
 
 bool SignalEngine::resumeSignal() {
     if (currentSignal.state == SignalState::PAUSED) {
-        setupTimer();
+        outputSink->start();
         currentSignal.state = SignalState::RUNNING;
         return true;
     }
@@ -277,339 +432,420 @@ bool SignalEngine::resumeSignal() {
 }
 
 // ============================================================================
-// TIMER
+// SALIDA DAC
 // ============================================================================
-void SignalEngine::setupTimer() {
-    // Timer a Fs_timer (4 kHz)
-    // Criterio: Fs_timer >= Fs_modelo_máximo (EMG=2000) con margen 2×
-    signalTimer = timerBegin(0, 80, true);  // 80 prescaler = 1 MHz
-    timerAttachInterrupt(signalTimer, &timerISR, true);
-    timerAlarmWrite(signalTimer, 1000000 / FS_TIMER_HZ, true);  // 250 us = 4 kHz
-    timerAlarmEnable(signalTimer);
-    Serial.println("[DAC] Timer ISR iniciado a 4 kHz");
-}
-
-void SignalEngine::stopTimer() {
-    if (signalTimer != nullptr) {
-        timerAlarmDisable(signalTimer);
-        timerDetachInterrupt(signalTimer);
-        timerEnd(signalTimer);
-        signalTimer = nullptr;
-        Serial.println("[DAC] Timer ISR detenido");
+bool SignalEngine::setOutputSink(OutputSinkType type) {
+    if (currentSignal.state != SignalState::STOPPED) {
+        return false;
+    }
+    
+    OutputSink* sink = nullptr;
+    switch (type) {
+        case OutputSinkType::TIMER_ISR:
+            sink = &timerSink;
+            break;
+#ifndef NATIVE_BUILD
+        case OutputSinkType::I2S_DMA:
+            sink = &i2sSink;
+            break;
+#else
+        case OutputSinkType::SIMULATED:
+            sink = &simulatedSink;
+            break;
+#endif
+        default:
+            return false;
+    }
+    
+    if (!sink->begin()) {
+        return false;
     }
+    
+    outputSink = sink;
+    Serial.printf("[SignalEngine] Salida DAC: %s\n", outputSink->getName());
+    return true;
 }
 
 // ============================================================================
-// ISR DEL TIMER (en IRAM)
-// ============================================================================
-// DAC escribe a Fs_timer (4 kHz) SIN decimación para espectro correcto
-// - ECG: fmax=150 Hz, EMG: fmax=500 Hz → 4 kHz cumple Nyquist
-// - Nextion y Serial Plotter aplican su propia decimación (son solo visualización)
-// - Filtro RC analógico completa reconstrucción de señal continua
-void IRAM_ATTR SignalEngine::timerISR() {
-    uint32_t startTime = micros();
+// TAREA DE GENERACIÓN
+// ============================================================================
+// Arquitectura:
+// 1. Cada modelo genera a su propia Fs (ECG@300, EMG@1000, PPG@100 Hz)
+// 2. El remuestreador polifásico L/M lleva las muestras a Fs_timer
+// 3. El OutputSink (I2S/DMA o timer ISR) consume el buffer a Fs_timer
+// 4. El ritmo lo marca el espacio libre del sink (contador de muestras),
+//    no micros(): modelo y DAC no derivan entre sí
+// 5. Downsampling para display/WebSocket = Fs_timer / Fds
+void SignalEngine::holdGeneration() {
+    uint32_t seq = generationHoldSeq.fetch_add(1, std::memory_order_relaxed) + 1;
+    generationHeld.store(true, std::memory_order_seq_cst);
     
-    // Leer del buffer circular y escribir DIRECTAMENTE al DAC (sin decimación)
-    if (bufferReadIndex != bufferWriteIndex) {
-        lastDACValue = signalBuffer[bufferReadIndex];
-        bufferReadIndex = (bufferReadIndex + 1) % SIGNAL_BUFFER_SIZE;
-        
-        // DAC escribe a 4 kHz - espectro frecuencial correcto
-        dacWrite(DAC_SIGNAL_PIN, lastDACValue);
-    } else {
-        bufferUnderruns++;
+    // Sin tarea (build nativo: processGeneration() en el mismo hilo) no hay
+    // ciclo en curso que esperar
+    if (generationTaskHandle == nullptr) return;
+    while (generationAckSeq.load(std::memory_order_acquire) != seq) {
+        vTaskDelay(1);
     }
+}
+
+void SignalEngine::releaseGeneration() {
+    generationHeld.store(false, std::memory_order_release);
+}
+
+void SignalEngine::generationTask(void* parameter) {
+    SignalEngine* engine = (SignalEngine*)parameter;
     
-    isrCount++;
-    
-    uint32_t elapsed = micros() - startTime;
-    if (elapsed > isrMaxTime) {
-        isrMaxTime = elapsed;
+    while (true) {
+        engine->processGeneration();
+        
+        // Pequeño delay para no saturar CPU
+        vTaskDelay(1);
     }
 }
 
 // ============================================================================
-// TAREA DE GENERACIÓN CON TIMING REAL
+// CICLO DE GENERACIÓN (tarea FreeRTOS o build nativo)
 // ============================================================================
-// Arquitectura correcta:
-// 1. Cada modelo genera a su propia Fs (ECG@750, EMG@2000, PPG@100 Hz)
-// 2. Las muestras se interpolan linealmente para llenar buffer a Fs_timer
-// 3. Timer ISR consume buffer a Fs_timer (4 kHz)
-// 4. Downsampling para display = Fs_timer / Fds
-void SignalEngine::generationTask(void* parameter) {
-    SignalEngine* engine = (SignalEngine*)parameter;
+void SignalEngine::processGeneration() {
+    // Parada pedida por beginSignal()/stopSignal(): acusar y no producir
+    if (generationHeld.load(std::memory_order_seq_cst)) {
+        generationAckSeq.store(generationHoldSeq.load(std::memory_order_relaxed),
+                               std::memory_order_release);
+        return;
+    }
     
-    // Inicializar timing
-    lastModelTick_us = micros();
-    interpolationCounter = 0;
+    // Cerrar el bloque de grabación abierto si se detuvo el grabador
+    signalRecorder.service();
     
-    while (true) {
-        if (engine->currentSignal.state == SignalState::RUNNING) {
-            uint32_t now_us = micros();
-            
-            // Obtener parámetros según tipo de señal
-            uint32_t modelTickInterval_us;
-            uint8_t upsampleRatio;
-            float modelDeltaTime;
-            
-            switch (engine->currentSignal.type) {
-                case SignalType::ECG:
-                    modelTickInterval_us = MODEL_TICK_US_ECG;
-                    upsampleRatio = UPSAMPLE_RATIO_ECG;
-                    modelDeltaTime = MODEL_DT_ECG;
-                    break;
-                case SignalType::EMG:
-                    modelTickInterval_us = MODEL_TICK_US_EMG;
-                    upsampleRatio = UPSAMPLE_RATIO_EMG;
-                    modelDeltaTime = MODEL_DT_EMG;
-                    break;
-                case SignalType::PPG:
-                    modelTickInterval_us = MODEL_TICK_US_PPG;
-                    upsampleRatio = UPSAMPLE_RATIO_PPG;
-                    modelDeltaTime = MODEL_DT_PPG;
-                    break;
-                default:
-                    modelTickInterval_us = 1000;
-                    upsampleRatio = 1;
-                    modelDeltaTime = 0.001f;
-            }
+    if (currentSignal.state == SignalState::RUNNING) {
+        // Llenar la salida con muestras remuestreadas a Fs_timer, por bloques
+        size_t available = outputSink->availableForWrite();
+        
+#if PERF_COUNTERS_ENABLED
+        // Niveles antes de rellenar: el mínimo del sink es el margen frente a underrun
+        uint16_t sinkLevel = outputSink->getStats().level;
+        PERF_WATERMARK(OUTPUT_SINK, sinkLevel, sinkLevel + available);
+        PERF_WATERMARK(DISPLAY_RING, displayRing.available(), displayRing.capacity());
+        PERF_WATERMARK(WS_RING, wsRing.available(), wsRing.capacity());
+#endif
+        
+        while (available > 0) {
+            size_t blockLen = available < OUTPUT_BLOCK_SIZE ? available : OUTPUT_BLOCK_SIZE;
+            // Ciclos por bloque de salida (el tick de modelo se mide aparte)
+            PERF_ACCUM_DECLARE(interpCycles);
+            PERF_ACCUM_DECLARE(pushCycles);
             
-            // ¿Es hora de generar nueva muestra del modelo?
-            if (now_us - lastModelTick_us >= modelTickInterval_us) {
-                lastModelTick_us = now_us;
-                
-                // Guardar muestra anterior para interpolación
-                previousModelSample = currentModelSample;
-                
-                // Generar nueva muestra del modelo con su deltaTime correcto
-                switch (engine->currentSignal.type) {
-                    case SignalType::ECG: {
-                        currentModelSample = engine->ecgModel.getDACValue(modelDeltaTime);
-                        currentModelValueMV = engine->ecgModel.getCurrentValueMV();
-                        break;
-                    }
-                    case SignalType::EMG: {
-                        // Usar tick() para actualizar secuencia + generar muestra
-                        engine->emgModel.tick(modelDeltaTime);
-                        
-                        // Seleccionar salida DAC según configuración (RAW o ENVELOPE)
-                        if (engine->emgDacOutput == EMGDACOutput::ENVELOPE) {
-                            currentModelSample = engine->emgModel.getProcessedDACValue();
-                            currentModelValueMV = engine->emgModel.getProcessedSample();
-                        } else {
-                            // Por defecto: RAW
-                            currentModelSample = engine->emgModel.getRawDACValue();
-                            currentModelValueMV = engine->emgModel.getRawSample();
-                        }
-                        break;
-                    }
-                    case SignalType::PPG: {
-                        currentModelSample = engine->ppgModel.getDACValue(modelDeltaTime);
-                        // Guardar valor AC para interpolación (evita escalones en Nextion)
-                        currentModelValueMV = engine->ppgModel.getLastACValue();
-                        break;
-                    }
-                    default:
-                        currentModelSample = DAC_CENTER_VALUE;
-                        currentModelValueMV = 0.0f;
+            for (size_t i = 0; i < blockLen; i++) {
+                // Entregar al remuestreador las muestras de modelo que pida (L/M)
+                while (dacPipeline.needsInput()) {
+                    nextModelSample();
+                    dacPipeline.pushLevel(currentModelLevel);
                 }
                 
-                // Resetear contador de interpolación
-                interpolationCounter = 0;
-            }
-            
-            // Llenar buffer con muestras interpoladas a Fs_timer
-            uint16_t readIdx = bufferReadIndex;
-            uint16_t writeIdx = bufferWriteIndex;
-            uint16_t available = (readIdx - writeIdx - 1 + SIGNAL_BUFFER_SIZE) % SIGNAL_BUFFER_SIZE;
-            
-            while (available > 0) {
-                // Interpolación lineal: sample = prev + (curr - prev) * t
-                float t = (float)interpolationCounter / (float)upsampleRatio;
-                int16_t interpolated = previousModelSample + 
-                                       (int16_t)((currentModelSample - previousModelSample) * t);
-                float interpolatedMV = previousModelValueMV + 
-                                       (currentModelValueMV - previousModelValueMV) * t;
-                
-                // Clamp a rango DAC
-                if (interpolated < 0) interpolated = 0;
-                if (interpolated > 255) interpolated = 255;
-                
-                // Guardar en buffer para DAC a 4 kHz
                 // El suavizado se logra mediante:
-                // 1. Interpolación lineal (upsampling de modelo a 4kHz)
-                // 2. Filtro RC analógico (fc=159 Hz)
-                signalBuffer[writeIdx] = (uint8_t)interpolated;
-                displayBuffer[writeIdx] = interpolatedMV;
-                writeIdx = (writeIdx + 1) % SIGNAL_BUFFER_SIZE;
-                bufferWriteIndex = writeIdx;
-                available--;
-                engine->currentSignal.sampleCount++;
+                // 1. Filtro polifásico (upsampling limitado en banda a Fs_timer)
+                // 2. Filtro RC analógico (fc según canal del MUX)
+                PERF_BEGIN(interpStart);
+                outputBlock[i] = dacPipeline.nextOutput();
+                PERF_ACCUM(interpCycles, interpStart);
                 
-                // Avanzar contador de interpolación
-                interpolationCounter++;
-                if (interpolationCounter >= upsampleRatio) {
-                    interpolationCounter = 0;
-                    previousModelValueMV = currentModelValueMV;
+                // Punto de display cada NEXTION_DOWNSAMPLE_* muestras (sin '%')
+                if (--displayCountdown == 0) {
+                    displayCountdown = displayDownsample;
+                    PERF_BEGIN(pushStart);
+                    pushDisplaySample(currentSignal.sampleCount + i + 1, currentValueMV);
+                    PERF_ACCUM(pushCycles, pushStart);
                 }
-            }
-            
-            // ================================================================
-            // LLENAR BUFFER WEBSOCKET (frecuencia igual a Nextion)
-            // ECG: 200 Hz, EMG/PPG: 100 Hz
-            // ================================================================
-            uint32_t now_ws = micros();
-            if (now_ws - lastWSSampleTime_us >= wsSampleInterval_us) {
-                lastWSSampleTime_us = now_ws;
                 
-                // Calcular siguiente índice de escritura
-                uint8_t nextWriteIdx = (wsBufferWriteIdx + 1) % WS_SAMPLE_BUFFER_SIZE;
-                
-                // Solo escribir si hay espacio (evitar sobrescribir datos no leídos)
-                if (nextWriteIdx != wsBufferReadIdx) {
-                    WSSampleData& sample = wsBuffer[wsBufferWriteIdx];
-                    sample.timestamp = millis();
-                    sample.valid = true;
-                    
-                    // Obtener valor según tipo de señal
-                    switch (engine->currentSignal.type) {
-                        case SignalType::ECG:
-                            sample.value = engine->ecgModel.getCurrentValueMV();
-                            sample.envelope = 0;
-                            break;
-                        case SignalType::EMG:
-                            sample.value = engine->emgModel.getCurrentValueMV();
-                            sample.envelope = engine->emgModel.getProcessedSample();
-                            break;
-                        case SignalType::PPG:
-                            sample.value = engine->ppgModel.getLastACValue();
-                            sample.envelope = 0;
-                            break;
-                        default:
-                            sample.value = 0;
-                            sample.envelope = 0;
-                    }
-                    
-                    wsBufferWriteIdx = nextWriteIdx;
+                // Muestra WebSocket (frecuencia igual a Nextion)
+                if (--wsCountdown == 0) {
+                    wsCountdown = wsDownsample;
+                    PERF_BEGIN(pushStart);
+                    pushWSSample(currentSignal.sampleCount + i + 1);
+                    PERF_ACCUM(pushCycles, pushStart);
                 }
             }
+            
+            // Aparte de los rings: puede esperar hasta I2S_WRITE_TIMEOUT
+            PERF_BEGIN(writeStart);
+            size_t written = outputSink->write(outputBlock, blockLen);
+            PERF_END(SINK_WRITE, writeStart);
+            PERF_RECORD(INTERPOLATION, interpCycles);
+            PERF_RECORD(RING_PUSH, pushCycles);
+            currentSignal.sampleCount += written;
+            available -= blockLen;
+            if (written < blockLen) break;
         }
-        
-        // Pequeño delay para no saturar CPU
-        vTaskDelay(1);
     }
 }
 
 // ============================================================================
-// GENERACIÓN DE MUESTRA (legacy, para compatibilidad)
+// MUESTRAS DE MODELO (consumidas desde el bloque)
 // ============================================================================
-uint8_t SignalEngine::generateSample() {
+uint8_t SignalEngine::nextModelSample() {
+    // Rellenar el bloque de modelo si se agotó
+    if (modelBlockPos >= MODEL_BLOCK_SIZE) {
+        generateModelBlock(modelDeltaTime);
+        modelBlockPos = 0;
+    }
+    
+    currentModelSample = modelBlockDAC[modelBlockPos];
+    currentModelLevel = modelBlockLevel[modelBlockPos];
+    currentValueMV = modelBlockMV[modelBlockPos];
+    currentEnvelopeMV = modelBlockEnvelope[modelBlockPos];
+    currentWave0 = modelBlockWave0[modelBlockPos];
+    currentWave1 = modelBlockWave1[modelBlockPos];
+    modelBlockPos++;
+    
     return currentModelSample;
 }
 
+void SignalEngine::pushWSSample(uint32_t sampleIndex) {
+    WSSampleData sample;
+    // Tiempo de señal (ms) derivado del contador: reproducible
+    sample.timestamp = (uint32_t)(((uint64_t)sampleIndex * 1000) / FS_TIMER_HZ);
+    sample.valid = true;
+    
+    // Valor de la muestra de modelo en curso
+    sample.value = currentValueMV;
+    sample.envelope = currentEnvelopeMV;
+    
+    // Si el buffer está lleno se descarta (no se sobrescriben datos no leídos)
+    wsRing.push(sample);
+}
+
 // ============================================================================
-// PRE-LLENADO DE BUFFER
+// GENERACIÓN DE MUESTRA (legacy, para compatibilidad)
 // ============================================================================
-void SignalEngine::prefillBuffer() {
-    for (int i = 0; i < SIGNAL_BUFFER_SIZE / 2; i++) {
-        signalBuffer[i] = generateSample();
-        displayBuffer[i] = 0.0f;
-    }
-    bufferWriteIndex = SIGNAL_BUFFER_SIZE / 2;
+uint8_t SignalEngine::generateSample() {
+    return currentModelSample;
 }
 
 // ============================================================================
 // GETTERS
 // ============================================================================
 uint8_t SignalEngine::getLastDACValue() const {
-    return lastDACValue;
+    return outputSink->getLastValue();
 }
 
 PerformanceStats SignalEngine::getStats() const {
     PerformanceStats stats;
-    stats.isrCount = isrCount;
-    stats.isrMaxTime = isrMaxTime;
-    stats.bufferUnderruns = bufferUnderruns;
-    stats.bufferLevel = (bufferWriteIndex - bufferReadIndex + SIGNAL_BUFFER_SIZE) % SIGNAL_BUFFER_SIZE;
+    OutputSinkStats sinkStats = outputSink->getStats();
+    stats.isrCount = sinkStats.samplesOut;
+    stats.isrMaxTime = sinkStats.maxServiceTime_us;
+    stats.bufferUnderruns = sinkStats.underruns;
+    stats.bufferLevel = sinkStats.level;
     stats.freeHeap = ESP.getFreeHeap();
+    stats.sinkType = outputSink->getType();
     return stats;
 }
 
-bool SignalEngine::getDisplaySample(uint32_t sampleIndex, float& outValue) const {
-    uint32_t currentCount = currentSignal.sampleCount;
-    if (sampleIndex == 0 || sampleIndex > currentCount) {
-        return false;
-    }
+void SignalEngine::resetStats() {
+    // Desde cualquier core: cada escritor limpia lo suyo (ver perf_counters.h)
+    outputSink->resetPeakStats();
+    perfCounters.requestReset();
+}
+
+void SignalEngine::generateModelBlock(float modelDeltaTime) {
+    PERF_BEGIN(tickStart);
+    TRACE_BEGIN(MODEL_TICK, currentSignal.type);
+    SampleBlock block;
+    block.dac = modelBlockDAC;
+    block.dacLevel = modelBlockLevel;
+    block.valueMV = modelBlockMV;
+    block.envelopeMV = modelBlockEnvelope;
+    block.wave0 = modelBlockWave0;
+    block.wave1 = modelBlockWave1;
     
-    uint32_t delta = currentCount - sampleIndex;
-    if (delta >= SIGNAL_BUFFER_SIZE) {
-        return false;
+    if (playbackActive) {
+        playbackModel.generateBlock(block, MODEL_BLOCK_SIZE);
+    } else {
+        // Frontera de bloque: adoptar la última instantánea publicada por la UI
+        // y evaluar las rampas Tipo A una vez para todo el bloque
+        RampConfig ramp;
+        if (rampMailbox.take(ramp)) {
+            ecgModel.setRampConfig(ramp);
+            emgModel.setRampConfig(ramp);
+            ppgModel.setRampConfig(ramp);
+        }
+        switch (currentSignal.type) {
+            case SignalType::ECG:
+                ecgModel.pollParameters();
+                ecgModel.advanceRamps(MODEL_BLOCK_SIZE, modelDeltaTime);
+                ecgModel.generateBlock(block, MODEL_BLOCK_SIZE, modelDeltaTime);
+                break;
+            case SignalType::EMG:
+                emgModel.pollParameters();
+                emgModel.advanceRamps(MODEL_BLOCK_SIZE, modelDeltaTime);
+                emgModel.generateBlock(block, MODEL_BLOCK_SIZE, modelDeltaTime,
+                                       emgDacOutput == EMGDACOutput::ENVELOPE);
+                break;
+            case SignalType::PPG:
+                ppgModel.pollParameters();
+                ppgModel.advanceRamps(MODEL_BLOCK_SIZE, modelDeltaTime);
+                ppgModel.generateBlock(block, MODEL_BLOCK_SIZE, modelDeltaTime);
+                break;
+            default:
+                memset(modelBlockDAC, DAC_CENTER_VALUE, sizeof(modelBlockDAC));
+                for (size_t i = 0; i < MODEL_BLOCK_SIZE; i++) modelBlockLevel[i] = DAC_CENTER_VALUE;
+                memset(modelBlockMV, 0, sizeof(modelBlockMV));
+                memset(modelBlockEnvelope, 0, sizeof(modelBlockEnvelope));
+                memset(modelBlockWave0, 0, sizeof(modelBlockWave0));
+                memset(modelBlockWave1, 0, sizeof(modelBlockWave1));
+        }
     }
+    PERF_END(MODEL_TICK, tickStart);
+    TRACE_END(MODEL_TICK, currentSignal.type);
     
-    int32_t idx = (int32_t)bufferWriteIndex - (int32_t)delta - 1;
-    if (idx < 0) {
-        idx += SIGNAL_BUFFER_SIZE;
+    // Grabación: muestras de modelo a Fs_modelo (EMG: señal cruda)
+    if (signalRecorder.isRecording()) {
+        RecorderStreamInfo info;
+        info.signalId = (uint8_t)currentSignal.type;
+        switch (currentSignal.type) {
+            case SignalType::ECG:
+                info.conditionId = (uint8_t)ecgModel.getCondition();
+                info.sampleRateHz = MODEL_SAMPLE_RATE_ECG;
+                info.seed = ecgModel.getSeed();
+                info.paramBytes = sizeof(ECGParameters);
+                memcpy(info.params, &ecgModel.getParameters(), sizeof(ECGParameters));
+                break;
+            case SignalType::EMG:
+                info.conditionId = (uint8_t)emgModel.getCondition();
+                info.sampleRateHz = MODEL_SAMPLE_RATE_EMG;
+                info.seed = emgModel.getSeed();
+                info.paramBytes = sizeof(EMGParameters);
+                memcpy(info.params, &emgModel.getParameters(), sizeof(EMGParameters));
+                break;
+            case SignalType::PPG:
+                info.conditionId = (uint8_t)ppgModel.getCondition();
+                info.sampleRateHz = MODEL_SAMPLE_RATE_PPG;
+                info.seed = ppgModel.getSeed();
+                info.paramBytes = sizeof(PPGParameters);
+                memcpy(info.params, &ppgModel.getParameters(), sizeof(PPGParameters));
+                break;
+            default:
+                info.conditionId = 0;
+                info.sampleRateHz = FS_TIMER_HZ;
+                info.seed = 0;
+                info.paramBytes = 0;
+                break;
+        }
+        if (playbackActive) {
+            // Regrabar una reproducción: sin semilla ni parámetros de modelo
+            info.conditionId = playbackModel.getCondition();
+            info.sampleRateHz = playbackModel.getSampleRate();
+            info.seed = 0;
+            info.paramBytes = 0;
+        }
+        signalRecorder.pushSamples(info, modelBlockMV, MODEL_BLOCK_SIZE, modelSampleCount);
     }
+    modelSampleCount += MODEL_BLOCK_SIZE;
+}
+
+void SignalEngine::pushDisplaySample(uint32_t sampleIndex, float valueMV) {
+    DisplaySample sample;
+    sample.sampleIndex = sampleIndex;
+    sample.valueMV = valueMV;
+    sample.wave0 = currentWave0;
+    sample.wave1 = currentWave1;
     
-    outValue = displayBuffer[idx];
-    return true;
+    // Si el loop no consume (display ocupado) se descarta el punto
+    displayRing.push(sample);
+}
+
+bool SignalEngine::getNextDisplaySample(DisplaySample& outSample) {
+    // Descartar puntos de la señal anterior (lado consumidor)
+    if (displayFlushPending.exchange(false, std::memory_order_acquire)) {
+        displayRing.skip(displayRing.available());
+    }
+    return displayRing.pop(outSample);
+}
+
+uint16_t SignalEngine::getDisplayBufferCount() const {
+    if (displayFlushPending.load(std::memory_order_acquire)) return 0;
+    return displayRing.available();
 }
 
 // ============================================================================
 // ACTUALIZACIÓN DE PARÁMETROS
 // ============================================================================
+// Nunca se escriben campos del modelo desde aquí (Core 0): se actualiza la
+// copia de currentSignal y se publica completa en el buzón del modelo. La
+// tarea de generación la adopta en la siguiente frontera de bloque
+// (Tipo A) o de latido (Tipo B). signalMutex serializa a los escritores.
 void SignalEngine::updateNoiseLevel(float noise) {
-    // Parámetro Tipo A: aplicación inmediata
+    // Parámetro Tipo A: rampa desde el siguiente bloque
     noise = constrain(noise, 0.0f, 1.0f);
     
+    if (xSemaphoreTake(signalMutex, portMAX_DELAY) != pdTRUE) return;
     switch (currentSignal.type) {
         case SignalType::ECG:
             currentSignal.ecg.noiseLevel = noise;
-            ecgModel.setNoiseLevel(noise);
+            ecgModel.setPendingParameters(currentSignal.ecg);
             break;
         case SignalType::EMG:
             currentSignal.emg.noiseLevel = noise;
-            emgModel.setNoiseLevel(noise);
+            emgModel.setPendingParameters(currentSignal.emg);
             break;
         case SignalType::PPG:
             currentSignal.ppg.noiseLevel = noise;
-            ppgModel.setNoiseLevel(noise);
+            ppgModel.setPendingParameters(currentSignal.ppg);
             break;
         default:
             break;
     }
+    xSemaphoreGive(signalMutex);
 }
 
 void SignalEngine::updateAmplitude(float amplitude) {
-    // Parámetro Tipo A: aplicación inmediata
+    // Parámetro Tipo A: rampa desde el siguiente bloque
+    if (xSemaphoreTake(signalMutex, portMAX_DELAY) != pdTRUE) return;
     switch (currentSignal.type) {
         case SignalType::ECG:
             currentSignal.ecg.qrsAmplitude = amplitude;
-            ecgModel.setAmplitude(amplitude);
+            ecgModel.setPendingParameters(currentSignal.ecg);
             break;
         case SignalType::EMG:
             currentSignal.emg.amplitude = amplitude;
-            emgModel.setAmplitude(amplitude);
+            emgModel.setPendingParameters(currentSignal.emg);
             break;
         case SignalType::PPG:
             currentSignal.ppg.perfusionIndex = amplitude;
-            ppgModel.setAmplitude(amplitude);
+            ppgModel.setPendingParameters(currentSignal.ppg);
             break;
         default:
             break;
     }
+    xSemaphoreGive(signalMutex);
+}
+
+void SignalEngine::setParamRamp(RampShape shape, uint16_t durationMs) {
+    if (xSemaphoreTake(signalMutex, portMAX_DELAY) != pdTRUE) return;
+    rampConfig.shape = shape;
+    rampConfig.duration = durationMs / 1000.0f;
+    rampMailbox.publish(rampConfig);
+    xSemaphoreGive(signalMutex);
 }
 
 void SignalEngine::setECGParameters(const ECGParameters& params) {
+    if (xSemaphoreTake(signalMutex, portMAX_DELAY) != pdTRUE) return;
+    currentSignal.ecg = params;
     ecgModel.setPendingParameters(params);
+    xSemaphoreGive(signalMutex);
 }
 
 void SignalEngine::setEMGParameters(const EMGParameters& params) {
+    if (xSemaphoreTake(signalMutex, portMAX_DELAY) != pdTRUE) return;
+    currentSignal.emg = params;
     emgModel.setPendingParameters(params);
+    xSemaphoreGive(signalMutex);
 }
 
 void SignalEngine::setPPGParameters(const PPGParameters& params) {
+    if (xSemaphoreTake(signalMutex, portMAX_DELAY) != pdTRUE) return;
+    currentSignal.ppg = params;
     ppgModel.setPendingParameters(params);
+    xSemaphoreGive(signalMutex);
 }
 
 // ============================================================================
@@ -625,24 +861,16 @@ void SignalEngine::setEMGDACOutput(EMGDACOutput output) {
 // BUFFER WEBSOCKET SINCRONIZADO
 // ============================================================================
 bool SignalEngine::getNextWSSample(WSSampleData& outSample) {
-    // Verificar si hay datos disponibles
-    if (wsBufferReadIdx == wsBufferWriteIdx) {
+    // Descartar muestras de la señal anterior (lado consumidor)
+    if (wsFlushPending.exchange(false, std::memory_order_acquire)) {
+        wsRing.skip(wsRing.available());
+    }
+    if (!wsRing.pop(outSample)) {
         return false;  // Buffer vacío
     }
-    
-    // Leer muestra del buffer
-    outSample = wsBuffer[wsBufferReadIdx];
-    
-    // Avanzar índice de lectura
-    wsBufferReadIdx = (wsBufferReadIdx + 1) % WS_SAMPLE_BUFFER_SIZE;
-    
     return outSample.valid;
 }
 
 uint8_t SignalEngine::getWSBufferCount() const {
-    if (wsBufferWriteIdx >= wsBufferReadIdx) {
-        return wsBufferWriteIdx - wsBufferReadIdx;
-    } else {
-        return WS_SAMPLE_BUFFER_SIZE - wsBufferReadIdx + wsBufferWriteIdx;
-    }
+    return wsRing.available();
 }
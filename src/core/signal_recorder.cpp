@@ -0,0 +1,323 @@
+/**
+ * @file signal_recorder.cpp
+ * @brief Implementación del grabador a flash (bloques delta + varint)
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ */
+
+#include "core/signal_recorder.h"
+#include <string.h>
+#include <stddef.h>
+#include <math.h>
+
+#ifndef NATIVE_BUILD
+#include <SPIFFS.h>
+#else
+#include <stdio.h>
+#endif
+
+// Instancia global
+SignalRecorder signalRecorder;
+
+// ============================================================================
+// ARCHIVO (SPIFFS en el ESP32, stdio en el build nativo)
+// ============================================================================
+#ifndef NATIVE_BUILD
+static File recordFile;
+
+static bool recordFileOpen(const char* path) {
+    recordFile = SPIFFS.open(path, FILE_WRITE);
+    return (bool)recordFile;
+}
+
+static size_t recordFileWrite(const uint8_t* data, size_t len) {
+    return recordFile.write(data, len);
+}
+
+static void recordFileClose() {
+    recordFile.close();
+}
+#else
+static FILE* recordFile = nullptr;
+
+static bool recordFileOpen(const char* path) {
+    recordFile = fopen(path + 1, "wb");     // Sin '/' inicial: directorio actual
+    return recordFile != nullptr;
+}
+
+static size_t recordFileWrite(const uint8_t* data, size_t len) {
+    return fwrite(data, 1, len, recordFile);
+}
+
+static void recordFileClose() {
+    if (recordFile) fclose(recordFile);
+    recordFile = nullptr;
+}
+#endif
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+SignalRecorder::SignalRecorder()
+    : fillIndex(0)
+    , writeIndex(0)
+    , openCount(0)
+    , nextSample(0)
+    , lastValue(0)
+    , armed(false)
+    , state(RecorderState::IDLE)
+    , writerTaskHandle(nullptr)
+{
+    blockLength[0] = blockLength[1] = 0;
+    blockState[0].store(BUF_FREE);
+    blockState[1].store(BUF_FREE);
+    memset(&openInfo, 0, sizeof(openInfo));
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool SignalRecorder::begin() {
+    if (writerTaskHandle != nullptr) return true;
+
+#ifndef NATIVE_BUILD
+    if (!SPIFFS.begin(true)) {
+        Serial.println("[Recorder] ERROR: SPIFFS no disponible");
+        return false;
+    }
+#endif
+
+    BaseType_t result = xTaskCreatePinnedToCore(
+        writerTask,
+        "Recorder",
+        STACK_SIZE_RECORDER,
+        this,
+        TASK_PRIORITY_RECORDER,
+        &writerTaskHandle,
+        CORE_RECORDER
+    );
+
+    if (result != pdPASS) {
+        writerTaskHandle = nullptr;
+        Serial.println("[Recorder] ERROR: No se pudo crear tarea escritora");
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// CONTROL
+// ============================================================================
+bool SignalRecorder::start() {
+    if (writerTaskHandle == nullptr) return false;
+
+    // Solo desde IDLE/ERROR: el escritor abre el archivo y arma al generador
+    RecorderState expected = getState();
+    if (expected != RecorderState::IDLE && expected != RecorderState::ERROR) return false;
+    return state.compare_exchange_strong(expected, RecorderState::STARTING);
+}
+
+void SignalRecorder::stop() {
+    RecorderState expected = RecorderState::RECORDING;
+    if (state.compare_exchange_strong(expected, RecorderState::STOPPING)) {
+        armed.store(false, std::memory_order_release);
+        return;
+    }
+    // Aún sin abrir el archivo: cancelar
+    expected = RecorderState::STARTING;
+    state.compare_exchange_strong(expected, RecorderState::IDLE);
+}
+
+const char* SignalRecorder::getStateName(RecorderState s) {
+    switch (s) {
+        case RecorderState::IDLE:      return "IDLE";
+        case RecorderState::STARTING:  return "STARTING";
+        case RecorderState::RECORDING: return "RECORDING";
+        case RecorderState::STOPPING:  return "STOPPING";
+        case RecorderState::ERROR:     return "ERROR";
+        default:                       return "UNKNOWN";
+    }
+}
+
+// ============================================================================
+// LADO GENERADOR
+// ============================================================================
+void SignalRecorder::pushSamples(const RecorderStreamInfo& info, const float* valuesMV,
+                                 size_t n, uint32_t firstSample) {
+    if (!armed.load(std::memory_order_acquire)) {
+        service();
+        return;
+    }
+
+    // Nuevo stream, parámetros distintos o hueco de índices: cerrar el bloque
+    if (openCount > 0 &&
+        (firstSample != nextSample ||
+         info.paramBytes != openInfo.paramBytes ||
+         memcmp(&info, &openInfo, offsetof(RecorderStreamInfo, params) + info.paramBytes) != 0)) {
+        sealBlock();
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        if (blockState[fillIndex].load(std::memory_order_acquire) != BUF_FILLING) {
+            if (!openBlock(info, firstSample + i)) {
+                stats.samplesDropped += n - i;  // Los dos buffers esperan al flash
+                break;
+            }
+        }
+
+        uint8_t* block = blocks[fillIndex];
+        int32_t value = (int32_t)lroundf(valuesMV[i] * (1000.0f / RECORDER_UV_PER_LSB));
+        int32_t delta = (openCount == 0) ? value : value - lastValue;
+        uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+
+        blockLength[fillIndex] += writeVarint(block + blockLength[fillIndex], zigzag);
+        lastValue = value;
+        openCount++;
+        stats.samplesRecorded++;
+
+        // Sin sitio para otra muestra (varint de 32 bits: hasta 5 bytes)
+        if (blockLength[fillIndex] + 5 > RECORDER_BLOCK_BYTES || openCount == 0xFFFF) {
+            sealBlock();
+        }
+    }
+    nextSample = firstSample + n;
+}
+
+void SignalRecorder::service() {
+    if (!armed.load(std::memory_order_acquire) &&
+        blockState[fillIndex].load(std::memory_order_relaxed) == BUF_FILLING) {
+        sealBlock();
+    }
+}
+
+/**
+ * @brief Abre un bloque en el buffer libre y escribe su cabecera
+ * @return false si el escritor aún no liberó el buffer
+ */
+bool SignalRecorder::openBlock(const RecorderStreamInfo& info, uint32_t firstSample) {
+    if (blockState[fillIndex].load(std::memory_order_acquire) != BUF_FREE) return false;
+
+    openInfo = info;
+    openCount = 0;
+    uint8_t* p = blocks[fillIndex];
+    uint32_t magic = RECORDER_BLOCK_MAGIC;
+
+    // Campos fijos; N y bytes de payload se completan en sealBlock()
+    memcpy(p, &magic, 4);
+    p[4] = RECORDER_BLOCK_VERSION;
+    p[5] = info.signalId;
+    p[6] = info.conditionId;
+    p[7] = info.paramBytes;
+    memcpy(p + 8, &info.sampleRateHz, 2);
+    memcpy(p + 12, &firstSample, 4);
+    memcpy(p + 16, &info.seed, 4);
+    uint16_t uvPerLsb = RECORDER_UV_PER_LSB;
+    memcpy(p + 22, &uvPerLsb, 2);
+    memcpy(p + RECORDER_HEADER_SIZE, info.params, info.paramBytes);
+
+    blockLength[fillIndex] = RECORDER_HEADER_SIZE + info.paramBytes;
+    blockState[fillIndex].store(BUF_FILLING, std::memory_order_release);
+    return true;
+}
+
+void SignalRecorder::sealBlock() {
+    if (blockState[fillIndex].load(std::memory_order_relaxed) != BUF_FILLING) return;
+
+    uint8_t* p = blocks[fillIndex];
+    uint16_t payload = blockLength[fillIndex] - RECORDER_HEADER_SIZE - openInfo.paramBytes;
+    memcpy(p + 10, &openCount, 2);
+    memcpy(p + 20, &payload, 2);
+
+    blockState[fillIndex].store(BUF_READY, std::memory_order_release);
+    fillIndex ^= 1;
+    openCount = 0;
+}
+
+size_t SignalRecorder::writeVarint(uint8_t* dst, uint32_t value) {
+    size_t len = 0;
+    while (value >= 0x80) {
+        dst[len++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    dst[len++] = (uint8_t)value;
+    return len;
+}
+
+// ============================================================================
+// TAREA ESCRITORA (baja prioridad)
+// ============================================================================
+void SignalRecorder::writerTask(void* parameter) {
+    SignalRecorder* self = static_cast<SignalRecorder*>(parameter);
+
+    while (true) {
+        self->writerCycle();
+        vTaskDelay(pdMS_TO_TICKS(RECORDER_WRITER_PERIOD_MS));
+    }
+}
+
+void SignalRecorder::writerCycle() {
+    RecorderState current = getState();
+
+    if (current == RecorderState::STARTING) {
+        // Bloques de una grabación anterior cerrados tarde: descartar
+        for (uint8_t i = 0; i < 2; i++) {
+            if (blockState[i].load(std::memory_order_acquire) == BUF_FILLING) return;
+        }
+        for (uint8_t i = 0; i < 2; i++) {
+            blockState[i].store(BUF_FREE, std::memory_order_release);
+        }
+        
+        if (!recordFileOpen(RECORDER_FILE_PATH)) {
+            Serial.println("[Recorder] ERROR: No se pudo crear " RECORDER_FILE_PATH);
+            state.store(RecorderState::ERROR, std::memory_order_release);
+            return;
+        }
+        memset(&stats, 0, sizeof(stats));
+        writeIndex = fillIndex;
+        RecorderState expected = RecorderState::STARTING;
+        if (state.compare_exchange_strong(expected, RecorderState::RECORDING)) {
+            armed.store(true, std::memory_order_release);
+            Serial.println("[Recorder] Grabando en " RECORDER_FILE_PATH);
+        } else {
+            recordFileClose();      // stop() antes de empezar
+        }
+        return;
+    }
+
+    if (current != RecorderState::RECORDING && current != RecorderState::STOPPING) return;
+
+    // Volcar los bloques cerrados en el orden en que se llenaron
+    while (blockState[writeIndex].load(std::memory_order_acquire) == BUF_READY) {
+        size_t len = blockLength[writeIndex];
+        if (stats.writeFailed) {
+            // Tras un fallo solo se liberan los bloques pendientes
+        } else if (recordFileWrite(blocks[writeIndex], len) != len) {
+            Serial.println("[Recorder] ERROR: escritura fallida (flash lleno?)");
+            stats.writeFailed = true;
+            stop();
+        } else {
+            stats.bytesWritten += len;
+            stats.blocksWritten++;
+        }
+        blockState[writeIndex].store(BUF_FREE, std::memory_order_release);
+        writeIndex ^= 1;
+
+        if (stats.bytesWritten >= RECORDER_MAX_FILE_BYTES) {
+            Serial.println("[Recorder] Tamaño máximo alcanzado");
+            stop();
+        }
+    }
+
+    // Detenido: cerrar cuando el generador haya entregado el último bloque
+    if (getState() == RecorderState::STOPPING &&
+        blockState[0].load(std::memory_order_acquire) == BUF_FREE &&
+        blockState[1].load(std::memory_order_acquire) == BUF_FREE) {
+        recordFileClose();
+        // Un archivo truncado no se presenta como grabación completa
+        state.store(stats.writeFailed ? RecorderState::ERROR : RecorderState::IDLE,
+                    std::memory_order_release);
+        Serial.printf("[Recorder] Grabación cerrada: %lu bytes, %lu muestras (%lu perdidas)%s\n",
+                      (unsigned long)stats.bytesWritten,
+                      (unsigned long)stats.samplesRecorded,
+                      (unsigned long)stats.samplesDropped,
+                      stats.writeFailed ? " INCOMPLETA" : "");
+    }
+}
@@ -0,0 +1,165 @@
+/**
+ * @file trace_ring.cpp
+ * @brief Implementación del ring de eventos y del exportador Chrome trace
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ */
+
+#include "core/trace_ring.h"
+#include "data/signal_types.h"
+#include <stdio.h>
+#include <string.h>
+
+// Instancia global (DRAM: se escribe desde la ISR del timer)
+TraceRing traceRing;
+
+// ============================================================================
+// TraceRing
+// ============================================================================
+void TraceRing::clear() {
+    for (uint32_t i = 0; i < TRACE_RING_CAPACITY; i++) {
+        slots[i].seq.store(0, std::memory_order_relaxed);
+    }
+}
+
+const char* TraceRing::getEventName(TraceEventType type) {
+    switch (type) {
+        case TraceEventType::UNDERRUN:      return "underrun";
+        case TraceEventType::MODEL_TICK:    return "model_tick";
+        case TraceEventType::BEAT:          return "beat";
+        case TraceEventType::PARAM_APPLIED: return "param_applied";
+        case TraceEventType::WS_FRAME:      return "ws_frame";
+        case TraceEventType::NEXTION_CMD:   return "nextion_cmd";
+        default:                            return "unknown";
+    }
+}
+
+const char* TraceRing::getCategory(TraceEventType type) {
+    switch (type) {
+        case TraceEventType::UNDERRUN:      return "dac";
+        case TraceEventType::MODEL_TICK:    return "engine";
+        case TraceEventType::BEAT:
+        case TraceEventType::PARAM_APPLIED: return "model";
+        default:                            return "comm";
+    }
+}
+
+// ============================================================================
+// TraceExporter
+// ============================================================================
+TraceExporter::TraceExporter()
+    : stage(Stage::HEADER), t0(0), hasT0(false), metaCore(0), lineLen(0), linePos(0) {
+    traceRing.freeze();
+    end = traceRing.getHead();
+    uint32_t span = end < TraceRing::capacity() ? end : TraceRing::capacity();
+    next = end - span;
+}
+
+TraceExporter::~TraceExporter() {
+    traceRing.unfreeze();
+}
+
+size_t TraceExporter::read(uint8_t* buffer, size_t maxLen) {
+    size_t written = 0;
+    while (written < maxLen) {
+        if (linePos >= lineLen && !formatNextLine()) break;
+
+        size_t n = lineLen - linePos;
+        if (n > maxLen - written) n = maxLen - written;
+        memcpy(buffer + written, line + linePos, n);
+        linePos += n;
+        written += n;
+    }
+    return written;
+}
+
+/**
+ * @brief Prepara la siguiente línea del JSON en line[]
+ * @return false al terminar
+ */
+bool TraceExporter::formatNextLine() {
+    lineLen = 0;
+    linePos = 0;
+
+    switch (stage) {
+        case Stage::HEADER:
+            lineLen = snprintf(line, sizeof(line), "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+            stage = Stage::METADATA;
+            return true;
+
+        case Stage::METADATA:
+            // Un hilo por core en el visor
+            lineLen = snprintf(line, sizeof(line),
+                               "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+                               "\"args\":{\"name\":\"Core %u\"}}\n",
+                               metaCore == 0 ? "" : ",", (unsigned)metaCore, (unsigned)metaCore);
+            if (++metaCore >= TRACE_CORE_COUNT) stage = Stage::EVENTS;
+            return true;
+
+        case Stage::EVENTS:
+            while (next != end) {
+                TraceEvent e;
+                bool valid = traceRing.read(next, e);
+                next++;
+                if (!valid) continue;
+                formatEvent(e);
+                return true;
+            }
+            stage = Stage::FOOTER;
+            return formatNextLine();
+
+        case Stage::FOOTER:
+            lineLen = snprintf(line, sizeof(line), "]}\n");
+            stage = Stage::DONE;
+            return true;
+
+        case Stage::DONE:
+        default:
+            return false;
+    }
+}
+
+void TraceExporter::formatEvent(const TraceEvent& e) {
+    if (!hasT0) {
+        t0 = e.timestamp;
+        hasT0 = true;
+    }
+    // Relativo al primer evento: la resta en 32 bits absorbe el wrap de micros()
+    uint32_t ts = e.timestamp - t0;
+
+    char args[64];
+    switch (e.type) {
+        case TraceEventType::UNDERRUN:
+            snprintf(args, sizeof(args), "{\"underruns\":%lu}", (unsigned long)e.arg);
+            break;
+        case TraceEventType::MODEL_TICK:
+            snprintf(args, sizeof(args), "{\"signal\":\"%s\"}",
+                     signalTypeToString((SignalType)e.arg));
+            break;
+        case TraceEventType::BEAT:
+            snprintf(args, sizeof(args), "{\"beat\":%lu}", (unsigned long)e.arg);
+            break;
+        case TraceEventType::PARAM_APPLIED:
+            snprintf(args, sizeof(args), "{\"signal\":\"%s\",\"type\":\"%c\"}",
+                     signalTypeToString((SignalType)(e.arg >> 8)), (char)(e.arg & 0xFF));
+            break;
+        case TraceEventType::WS_FRAME:
+            snprintf(args, sizeof(args), "{\"client\":%lu,\"samples\":%lu}",
+                     (unsigned long)(e.arg >> 16), (unsigned long)(e.arg & 0xFFFF));
+            break;
+        case TraceEventType::NEXTION_CMD:
+            snprintf(args, sizeof(args), "{\"bytes\":%lu}", (unsigned long)e.arg);
+            break;
+        default:
+            snprintf(args, sizeof(args), "{\"v\":%lu}", (unsigned long)e.arg);
+            break;
+    }
+
+    const char* ph = (e.phase == TracePhase::BEGIN) ? "B"
+                   : (e.phase == TracePhase::END)   ? "E" : "i\",\"s\":\"t";
+    int n = snprintf(line, sizeof(line),
+                     ",{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%s\",\"ts\":%lu,\"pid\":1,\"tid\":%u,\"args\":%s}\n",
+                     TraceRing::getEventName(e.type), TraceRing::getCategory(e.type), ph,
+                     (unsigned long)ts, (unsigned)e.core, args);
+    lineLen = (n > 0 && n < (int)sizeof(line)) ? (uint16_t)n : 0;
+}
@@ -0,0 +1,212 @@
+/**
+ * @file i2s_dac_sink.cpp
+ * @brief Implementación de la salida DAC por I2S0 + DMA
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ */
+
+#include "hw/i2s_dac_sink.h"
+#include "core/trace_ring.h"
+
+#ifndef NATIVE_BUILD
+
+#include <driver/i2s.h>
+
+#define I2S_DAC_PORT            I2S_NUM_0   // Solo I2S0 puede alimentar el DAC interno
+#define I2S_WRITE_TIMEOUT       pdMS_TO_TICKS(10)
+
+// ============================================================================
+// INSTANCIA GLOBAL
+// ============================================================================
+I2SDACSink i2sSink;
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+I2SDACSink::I2SDACSink()
+    : installed(false)
+    , running(false)
+    , eventQueue(nullptr)
+    , stagedSamples(0)
+    , freeBlocks(MAX_FREE_BLOCKS)
+    , lastValue(DAC_CENTER_VALUE)
+    , samplesOut(0)
+    , underruns(0)
+    , maxWriteTime_us(0)
+{
+}
+
+// ============================================================================
+// INICIALIZACIÓN
+// ============================================================================
+bool I2SDACSink::begin() {
+    if (installed) return true;
+
+    i2s_config_t config = {};
+    config.mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX | I2S_MODE_DAC_BUILT_IN);
+    config.sample_rate = (uint32_t)FS_TIMER_HZ * I2S_DAC_OVERSAMPLE;
+    config.bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT;
+    config.channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT;
+    config.communication_format = I2S_COMM_FORMAT_STAND_MSB;
+    config.intr_alloc_flags = 0;
+    config.dma_buf_count = I2S_DMA_BUF_COUNT;
+    config.dma_buf_len = I2S_DMA_BUF_LEN;
+    config.use_apll = false;
+    // Sin auto-clear: en underrun el DMA repite el último bloque en lugar de
+    // caer a 0 V (un escalón a 0 es peor que repetir 32 ms de señal)
+    config.tx_desc_auto_clear = false;
+
+    esp_err_t err = i2s_driver_install(I2S_DAC_PORT, &config, I2S_DMA_BUF_COUNT + 2, &eventQueue);
+    if (err != ESP_OK) {
+        Serial.printf("[I2S] ERROR: i2s_driver_install (%d)\n", err);
+        return false;
+    }
+
+    // DAC1 = canal derecho = GPIO25
+    i2s_set_dac_mode(I2S_DAC_CHANNEL_RIGHT_EN);
+    i2s_stop(I2S_DAC_PORT);
+    i2s_zero_dma_buffer(I2S_DAC_PORT);
+
+    installed = true;
+    Serial.printf("[I2S] DAC por DMA: Fs=%u Hz (x%d), %d bloques de %u muestras\n",
+                  (unsigned)(FS_TIMER_HZ * I2S_DAC_OVERSAMPLE), I2S_DAC_OVERSAMPLE,
+                  I2S_DMA_BUF_COUNT, (unsigned)SAMPLES_PER_BLOCK);
+    return true;
+}
+
+// ============================================================================
+// CONTROL
+// ============================================================================
+void I2SDACSink::start() {
+    if (!installed || running) return;
+    i2s_set_dac_mode(I2S_DAC_CHANNEL_RIGHT_EN);
+    i2s_start(I2S_DAC_PORT);
+    running = true;
+    Serial.println("[DAC] I2S/DMA iniciado");
+}
+
+void I2SDACSink::stop() {
+    if (!installed || !running) return;
+    i2s_stop(I2S_DAC_PORT);
+    running = false;
+    Serial.println("[DAC] I2S/DMA detenido");
+}
+
+void I2SDACSink::reset(uint8_t fillValue, size_t prefillSamples) {
+    if (!installed) return;
+
+    stop();
+    if (eventQueue) xQueueReset(eventQueue);
+    freeBlocks = MAX_FREE_BLOCKS;
+    stagedSamples = 0;
+    samplesOut = 0;
+    underruns = 0;
+    maxWriteTime_us = 0;
+
+    // Pre-llenar bloques completos (el DMA solo acepta bloques enteros)
+    size_t maxPrefill = (size_t)MAX_FREE_BLOCKS * SAMPLES_PER_BLOCK;
+    if (prefillSamples > maxPrefill) prefillSamples = maxPrefill;
+    size_t blocks = (prefillSamples + SAMPLES_PER_BLOCK - 1) / SAMPLES_PER_BLOCK;
+
+    uint8_t block[SAMPLES_PER_BLOCK];
+    memset(block, fillValue, sizeof(block));
+    for (size_t b = 0; b < blocks; b++) {
+        write(block, SAMPLES_PER_BLOCK);
+    }
+    lastValue = fillValue;
+}
+
+void I2SDACSink::writeIdle(uint8_t value) {
+    stop();
+    if (installed) {
+        // Liberar el DAC del I2S para escribir un nivel fijo
+        i2s_set_dac_mode(I2S_DAC_CHANNEL_DISABLE);
+    }
+    dacWrite(DAC_SIGNAL_PIN, value);
+    lastValue = value;
+}
+
+// ============================================================================
+// CONTROL DE FLUJO (eventos TX_DONE del driver)
+// ============================================================================
+void I2SDACSink::pollEvents() {
+    if (!eventQueue) return;
+
+    i2s_event_t event;
+    while (xQueueReceive(eventQueue, &event, 0) == pdTRUE) {
+        if (event.type != I2S_EVENT_TX_DONE) continue;
+
+        if (freeBlocks < MAX_FREE_BLOCKS) {
+            freeBlocks++;
+            samplesOut += SAMPLES_PER_BLOCK;
+        } else if (running) {
+            // El DMA terminó un descriptor sin datos nuevos: repite el anterior
+            underruns++;
+            TRACE_INSTANT(UNDERRUN, underruns);
+        }
+    }
+}
+
+size_t I2SDACSink::availableForWrite() {
+    if (!installed) return 0;
+    pollEvents();
+    return (size_t)freeBlocks * SAMPLES_PER_BLOCK - stagedSamples;
+}
+
+// ============================================================================
+// ESCRITURA
+// ============================================================================
+size_t I2SDACSink::write(const uint8_t* samples, size_t count) {
+    if (!installed) return 0;
+
+    size_t accepted = 0;
+    while (accepted < count && freeBlocks > 0) {
+        // Expandir muestra a I2S_DAC_OVERSAMPLE frames (R, L) con el byte alto
+        uint16_t word = (uint16_t)samples[accepted] << 8;
+        uint16_t* frame = &staging[stagedSamples * I2S_DAC_OVERSAMPLE * 2];
+        for (uint8_t k = 0; k < I2S_DAC_OVERSAMPLE * 2; k++) {
+            frame[k] = word;
+        }
+        lastValue = samples[accepted];
+        stagedSamples++;
+        accepted++;
+
+        if (stagedSamples == SAMPLES_PER_BLOCK && !flushBlock()) {
+            break;
+        }
+    }
+    return accepted;
+}
+
+bool I2SDACSink::flushBlock() {
+    size_t bytesWritten = 0;
+    uint32_t startTime = micros();
+    i2s_write(I2S_DAC_PORT, staging, sizeof(staging), &bytesWritten, I2S_WRITE_TIMEOUT);
+    uint32_t elapsed = micros() - startTime;
+    if (elapsed > maxWriteTime_us) {
+        maxWriteTime_us = elapsed;
+    }
+
+    stagedSamples = 0;
+    if (freeBlocks > 0) freeBlocks--;
+    return bytesWritten == sizeof(staging);
+}
+
+// ============================================================================
+// ESTADÍSTICAS
+// ============================================================================
+OutputSinkStats I2SDACSink::getStats() const {
+    OutputSinkStats stats;
+    stats.samplesOut = samplesOut;
+    stats.maxServiceTime_us = maxWriteTime_us;
+    stats.underruns = underruns;
+    stats.level = (uint16_t)((MAX_FREE_BLOCKS - freeBlocks) * SAMPLES_PER_BLOCK + stagedSamples);
+    return stats;
+}
+
+void I2SDACSink::resetPeakStats() {
+    // Carrera benigna con flushBlock(): como mucho se conserva un máximo viejo
+    maxWriteTime_us = 0;
+}
+
+#endif // NATIVE_BUILD
@@ -0,0 +1,84 @@
+/**
+ * @file simulated_sink.cpp
+ * @brief Implementación de la salida DAC simulada (build nativo)
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ */
+
+#include "hw/simulated_sink.h"
+#include "core/trace_ring.h"
+
+#ifdef NATIVE_BUILD
+
+// ============================================================================
+// INSTANCIA GLOBAL
+// ============================================================================
+SimulatedSink simulatedSink;
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+SimulatedSink::SimulatedSink()
+    : running(false)
+    , lastValue(DAC_CENTER_VALUE)
+    , samplesOut(0)
+    , underruns(0)
+{
+}
+
+// ============================================================================
+// BUFFER
+// ============================================================================
+void SimulatedSink::reset(uint8_t fillValue, size_t prefillSamples) {
+    ring.reset();
+    for (size_t i = 0; i < prefillSamples && ring.push(fillValue); i++) {
+    }
+    samplesOut = 0;
+    underruns = 0;
+}
+
+size_t SimulatedSink::availableForWrite() {
+    return ring.space();
+}
+
+size_t SimulatedSink::write(const uint8_t* samples, size_t count) {
+    return ring.write_n(samples, count);
+}
+
+void SimulatedSink::writeIdle(uint8_t value) {
+    lastValue = value;
+    dacWrite(DAC_SIGNAL_PIN, value);
+}
+
+size_t SimulatedSink::consume(size_t count, uint8_t* out) {
+    if (!running) return 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (ring.pop(lastValue)) {
+            samplesOut++;
+        } else {
+            underruns++;
+            TRACE_INSTANT(UNDERRUN, underruns);
+        }
+        if (out) out[i] = lastValue;
+    }
+    return count;
+}
+
+// ============================================================================
+// ESTADÍSTICAS
+// ============================================================================
+OutputSinkStats SimulatedSink::getStats() const {
+    OutputSinkStats stats;
+    stats.samplesOut = samplesOut;
+    stats.maxServiceTime_us = 0;
+    stats.underruns = underruns;
+    stats.level = ring.available();
+    return stats;
+}
+
+void SimulatedSink::resetPeakStats() {
+    // Sin tiempo de servicio que medir en el host
+}
+
+#endif // NATIVE_BUILD
@@ -0,0 +1,129 @@
+/**
+ * @file timer_isr_sink.cpp
+ * @brief Implementación de la salida DAC por timer ISR (fallback)
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ */
+
+#include "hw/timer_isr_sink.h"
+#include "core/spsc_ring.h"
+#include "core/trace_ring.h"
+
+// ============================================================================
+// INSTANCIA GLOBAL
+// ============================================================================
+TimerISRSink timerSink;
+
+// ============================================================================
+// BUFFERS EN RAM RÁPIDA (accedidos desde la ISR)
+// ============================================================================
+DRAM_ATTR static SPSCRing<uint8_t, SIGNAL_BUFFER_SIZE> signalRing;
+DRAM_ATTR static volatile uint32_t isrCount = 0;
+DRAM_ATTR static volatile uint32_t isrMaxTime = 0;
+DRAM_ATTR static volatile uint32_t bufferUnderruns = 0;
+DRAM_ATTR static volatile uint8_t lastDACValue = DAC_CENTER_VALUE;
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+TimerISRSink::TimerISRSink() : timer(nullptr) {
+}
+
+bool TimerISRSink::begin() {
+    return true;
+}
+
+// ============================================================================
+// CONTROL DEL TIMER
+// ============================================================================
+void TimerISRSink::start() {
+    if (timer != nullptr) return;
+
+    timer = timerBegin(0, 80, true);  // 80 prescaler = 1 MHz
+    timerAttachInterrupt(timer, &timerISR, true);
+    timerAlarmWrite(timer, 1000000 / FS_TIMER_HZ, true);
+    timerAlarmEnable(timer);
+    Serial.printf("[DAC] Timer ISR iniciado a %u Hz\n", FS_TIMER_HZ);
+}
+
+void TimerISRSink::stop() {
+    if (timer != nullptr) {
+        timerAlarmDisable(timer);
+        timerDetachInterrupt(timer);
+        timerEnd(timer);
+        timer = nullptr;
+        Serial.println("[DAC] Timer ISR detenido");
+    }
+}
+
+// ============================================================================
+// ISR DEL TIMER (en IRAM)
+// ============================================================================
+// DAC escribe a Fs_timer SIN decimación para espectro correcto
+// - Nextion y Serial Plotter aplican su propia decimación (son solo visualización)
+// - Filtro RC analógico completa reconstrucción de señal continua
+void IRAM_ATTR TimerISRSink::timerISR() {
+    uint32_t startTime = micros();
+
+    uint8_t value;
+    if (signalRing.pop(value)) {
+        lastDACValue = value;
+        dacWrite(DAC_SIGNAL_PIN, value);
+    } else {
+        bufferUnderruns++;
+        TRACE_INSTANT(UNDERRUN, bufferUnderruns);
+    }
+
+    isrCount++;
+
+    uint32_t elapsed = micros() - startTime;
+    if (elapsed > isrMaxTime) {
+        isrMaxTime = elapsed;
+    }
+}
+
+// ============================================================================
+// BUFFER
+// ============================================================================
+void TimerISRSink::reset(uint8_t fillValue, size_t prefillSamples) {
+    signalRing.reset();
+    for (size_t i = 0; i < prefillSamples && signalRing.push(fillValue); i++) {
+    }
+
+    isrCount = 0;
+    isrMaxTime = 0;
+    bufferUnderruns = 0;
+}
+
+size_t TimerISRSink::availableForWrite() {
+    return signalRing.space();
+}
+
+size_t TimerISRSink::write(const uint8_t* samples, size_t count) {
+    return signalRing.write_n(samples, count);
+}
+
+void TimerISRSink::writeIdle(uint8_t value) {
+    lastDACValue = value;
+    dacWrite(DAC_SIGNAL_PIN, value);
+}
+
+// ============================================================================
+// GETTERS
+// ============================================================================
+uint8_t TimerISRSink::getLastValue() const {
+    return lastDACValue;
+}
+
+OutputSinkStats TimerISRSink::getStats() const {
+    OutputSinkStats stats;
+    stats.samplesOut = isrCount - bufferUnderruns;
+    stats.maxServiceTime_us = isrMaxTime;
+    stats.underruns = bufferUnderruns;
+    stats.level = signalRing.available();
+    return stats;
+}
+
+void TimerISRSink::resetPeakStats() {
+    isrMaxTime = 0;
+}
@@ -24,6 +24,7 @@
 #include "core/signal_engine.h"
 #include "core/state_machine.h"
 #include "core/param_controller.h"
+#include "core/signal_recorder.h"
 #include "comm/nextion_driver.h"
 #include "comm/serial_handler.h"
 #include "comm/wifi_server.h"
@@ -484,13 +485,17 @@ void handleUIEvent(UIEvent event, uint8_t param) {
         // NOTA: BUTTON_BACK_POPUP eliminado - no hay popups de valores separados
         
         case UIEvent::BUTTON_APPLY_PARAMS:
-            // bt_act: Aplicar cambios de sliders - usar métodos directos para no resetear secuencias
+            // bt_act: Aplicar cambios de sliders - se publica una instantánea de
+            // parámetros; Core 1 la adopta sin resetear el modelo (ruido en el
+            // siguiente bloque, HR en el siguiente latido)
             if (stateMachine.getSelectedSignal() == SignalType::ECG) {
                 if (ecgSliderValues.modified) {
                     ECGModel& ecg = signalEngine->getECGModel();
-                    // Métodos directos - no resetea el modelo
-                    ecg.setHeartRate((float)ecgSliderValues.hr);
-                    ecg.setNoiseLevel(ecgSliderValues.noise / 100.0f);
+                    ECGParameters params = signalEngine->getSignalData().ecg;
+                    params.heartRate = (float)ecgSliderValues.hr;
+                    params.noiseLevel = ecgSliderValues.noise / 100.0f;
+                    signalEngine->setECGParameters(params);
+                    // Ganancia de visualización: solo la lee el display
                     ecg.setWaveformGain(ecgSliderValues.zoom / 100.0f);  // 50-200% → 0.5-2.0
                     nextion->updateECGScale(ecgSliderValues.zoom);
                     Serial.printf("[UI] ECG: HR=%d, Ruido=%d%%, Ganancia=%d%%\n", 
@@ -502,9 +507,11 @@ void handleUIEvent(UIEvent event, uint8_t param) {
             } else if (stateMachine.getSelectedSignal() == SignalType::EMG) {
                 if (emgSliderValues.modified) {
                     EMGModel& emg = signalEngine->getEMGModel();
-                    // Métodos directos - NO resetea secuencias de contracción
-                    emg.setExcitationLevel(emgSliderValues.exc / 100.0f);
-                    emg.setNoiseLevel(emgSliderValues.noise / 100.0f);
+                    // Misma condición: NO resetea secuencias de contracción
+                    EMGParameters params = signalEngine->getSignalData().emg;
+                    params.excitationLevel = emgSliderValues.exc / 100.0f;
+                    params.noiseLevel = emgSliderValues.noise / 100.0f;
+                    signalEngine->setEMGParameters(params);
                     emg.setWaveformGain(emgSliderValues.amp / 100.0f);  // 50-200% → 0.5-2.0
                     Serial.printf("[UI] EMG: Exc=%d%%, Ruido=%d%%, Ganancia=%d%%\n", 
                                   emgSliderValues.exc, emgSliderValues.noise, emgSliderValues.amp);
@@ -515,9 +522,10 @@ void handleUIEvent(UIEvent event, uint8_t param) {
             } else if (stateMachine.getSelectedSignal() == SignalType::PPG) {
                 if (ppgSliderValues.modified) {
                     PPGModel& ppg = signalEngine->getPPGModel();
-                    // Métodos directos
-                    ppg.setHeartRate((float)ppgSliderValues.hr);
-                    ppg.setNoiseLevel(ppgSliderValues.noise / 100.0f);
+                    PPGParameters params = signalEngine->getSignalData().ppg;
+                    params.heartRate = (float)ppgSliderValues.hr;
+                    params.noiseLevel = ppgSliderValues.noise / 100.0f;
+                    signalEngine->setPPGParameters(params);
                     ppg.setWaveformGain(ppgSliderValues.amp / 100.0f);  // 50-200% → 0.5-2.0
                     Serial.printf("[UI] PPG: HR=%d, Ruido=%d%%, Ganancia=%d%%\n", 
                                   ppgSliderValues.hr, ppgSliderValues.noise, ppgSliderValues.amp);
@@ -566,14 +574,11 @@ void handleUIEvent(UIEvent event, uint8_t param) {
             break;
         
         case UIEvent::BUTTON_RESET_PARAMS:
-            // Resetear modelo a valores por defecto de la patología
+            // Resetear modelo a valores por defecto de la patología (el motor
+            // detiene la generación mientras tanto; estado y salida no cambian)
             if (stateMachine.getSelectedSignal() == SignalType::ECG) {
                 ECGModel& ecg = signalEngine->getECGModel();
-                ECGCondition currentCond = ecg.getCondition();
-                ecg.reset();
-                ECGParameters params;
-                params.condition = currentCond;
-                ecg.setParameters(params);
+                signalEngine->resetModel(SignalType::ECG, (uint8_t)ecg.getCondition());
                 
                 ecgSliderValues.hr = (int)ecg.getHRMean();
                 ecgSliderValues.zoom = 100;  // Reset zoom a 100%
@@ -594,11 +599,7 @@ void handleUIEvent(UIEvent event, uint8_t param) {
                 Serial.println("[UI] Parámetros ECG reseteados, Zoom: 100%");
             } else if (stateMachine.getSelectedSignal() == SignalType::EMG) {
                 EMGModel& emg = signalEngine->getEMGModel();
-                EMGCondition currentCond = emg.getCondition();
-                emg.reset();
-                EMGParameters params;
-                params.condition = currentCond;
-                emg.setParameters(params);
+                signalEngine->resetModel(SignalType::EMG, (uint8_t)emg.getCondition());
                 
                 emgSliderValues.exc = (int)(emg.getCurrentExcitation() * 100);
                 emgSliderValues.amp = (int)(emg.getAmplitude() * 100);
@@ -613,11 +614,7 @@ void handleUIEvent(UIEvent event, uint8_t param) {
                 Serial.println("[UI] Parámetros EMG reseteados");
             } else if (stateMachine.getSelectedSignal() == SignalType::PPG) {
                 PPGModel& ppg = signalEngine->getPPGModel();
-                PPGCondition currentCond = ppg.getCondition();
-                ppg.reset();
-                PPGParameters params;
-                params.condition = currentCond;
-                ppg.setParameters(params);
+                signalEngine->resetModel(SignalType::PPG, (uint8_t)ppg.getCondition());
                 
                 ppgSliderValues.hr = (int)ppg.getCurrentHeartRate();
                 ppgSliderValues.pi = (int)(ppg.getPerfusionIndex() * 10);
@@ -884,9 +881,7 @@ void handleStateChange(SystemState oldState, SystemState newState) {
                 );
                 delay(100);  // Dar tiempo al sistema para estabilizarse después de cambiar señal
                 setLEDState(SignalState::RUNNING);
-                // Resetear contador de display para forzar redibujado desde cero
-                extern void resetDisplayCounters();
-                resetDisplayCounters();
+                // El buffer de display lo vacía startSignal(): redibujado desde cero
                 // Actualizar escalas de visualización según tipo de señal
                 if (stateMachine.getSelectedSignal() == SignalType::ECG) {
                     nextion->updateECGScale(ecgSliderValues.zoom);
@@ -909,16 +904,12 @@ void handleStateChange(SystemState oldState, SystemState newState) {
 // ============================================================================
 // ACTUALIZACIÓN DE DISPLAY
 // ============================================================================
-// Variable estática para tracking de muestras
-static uint32_t lastSampleCount = 0;
-
 // NOTA: Sin interpolación - envío directo 1 muestra = 1 punto Nextion
 // Escalas: ECG 350 ms/div (3.5s), EMG/PPG 700 ms/div (7.0s)
 
-// Función para resetear contadores (llamada al iniciar nueva simulación)
-void resetDisplayCounters() {
-    lastSampleCount = 0;
-}
+// Máximo de puntos enviados por llamada con "add" por punto (fallback sin addt;
+// evita bloquear el loop tras un retraso). Con addt el límite es la cola del driver.
+#define DISPLAY_MAX_POINTS_PER_UPDATE  4
 
 void updateDisplay() {
     static unsigned long lastUpdate = 0;
@@ -926,71 +917,27 @@ void updateDisplay() {
     unsigned long now = millis();
     
     // =========================================================================
-    // WAVEFORM: Arquitectura unificada con signal_engine (contador de ticks)
+    // WAVEFORM: el motor ya entrega los puntos diezmados por SPSCRing
     // Downsampling respecto a Fs_timer (2kHz) usando NEXTION_DOWNSAMPLE_*
     // ECG: 2000/200 = 10:1 → 200 Hz efectivo
     // EMG: 2000/100 = 20:1 → 100 Hz efectivo
     // PPG: 2000/100 = 20:1 → 100 Hz efectivo
     // =========================================================================
     if (signalEngine->getState() == SignalState::RUNNING) {
-        uint32_t currentSampleCount = signalEngine->getSignalData().sampleCount;
         SignalType type = signalEngine->getCurrentType();
+        DisplaySample point;
+        uint16_t maxPoints = nextion->isWaveformBatchingEnabled()
+                           ? nextion->getWaveformQueueSpace()
+                           : DISPLAY_MAX_POINTS_PER_UPDATE;
         
-        // Determinar ratio de downsampling según tipo de señal
-        uint8_t downsampleRatio;
-        switch (type) {
-            case SignalType::ECG: downsampleRatio = NEXTION_DOWNSAMPLE_ECG; break;
-            case SignalType::EMG: downsampleRatio = NEXTION_DOWNSAMPLE_EMG; break;
-            case SignalType::PPG: downsampleRatio = NEXTION_DOWNSAMPLE_PPG; break;
-            default: downsampleRatio = 10; break;
-        }
-        
-        // Enviar puntos cada vez que crucemos el múltiplo del ratio, incluso si se acumularon muestras
-        if (currentSampleCount > lastSampleCount) {
-            uint32_t samplesProcessed = currentSampleCount - lastSampleCount;
-
-            // Limitar el procesamiento para evitar bloqueos si hubo un gran retraso
-            const uint32_t maxSamples = downsampleRatio * 4;  // ≈20 ms de búfer para ECG
-            if (samplesProcessed > maxSamples) {
-                samplesProcessed = maxSamples;
-                lastSampleCount = currentSampleCount - samplesProcessed;
-            }
-
-            for (uint32_t i = 1; i <= samplesProcessed; ++i) {
-                uint32_t sampleIndex = lastSampleCount + i;
-                if (sampleIndex % downsampleRatio != 0) {
-                    continue;
-                }
-                
-                float mV_value = 0.0f;
-                bool hasSample = signalEngine->getDisplaySample(sampleIndex, mV_value);
-
-                if (type == SignalType::ECG && hasSample) {
-                    // ECG: Un solo canal - SIN interpolación (prueba directa)
-                    ECGModel& ecg = signalEngine->getECGModel();
-                    uint8_t waveValue = ecg.getWaveformValue();
-                    nextion->addWaveformPoint(WAVEFORM_COMPONENT_ID, 0, waveValue);
-                    
-                } else if (type == SignalType::EMG) {
-                    // EMG: DOS canales - SIN interpolación (prueba directa)
-                    EMGModel& emg = signalEngine->getEMGModel();
-                    uint8_t ch0_value = emg.getWaveformValue_Ch0();
-                    uint8_t ch1_value = emg.getWaveformValue_Ch1();
-                    nextion->addWaveformPoint(WAVEFORM_COMPONENT_ID, 0, ch0_value);
-                    nextion->addWaveformPoint(WAVEFORM_COMPONENT_ID, 1, ch1_value);
-                    
-                } else if (type == SignalType::PPG) {
-                    // PPG: Un solo canal - SIN interpolación (prueba directa)
-                    PPGModel& ppg = signalEngine->getPPGModel();
-                    uint8_t waveValue = ppg.getWaveformValue();
-                    nextion->addWaveformPoint(WAVEFORM_COMPONENT_ID, 0, waveValue);
-                    
-                } else {
-                    continue; // sin muestra disponible
-                }
+        for (uint16_t n = 0; n < maxPoints &&
+                             signalEngine->getNextDisplaySample(point); n++) {
+            // Sin interpolación: valor waveform capturado al generar la muestra
+            nextion->queueWaveformPoint(WAVEFORM_COMPONENT_ID, 0, point.wave0);
+            if (type == SignalType::EMG) {
+                // EMG: DOS canales (cruda + envolvente)
+                nextion->queueWaveformPoint(WAVEFORM_COMPONENT_ID, 1, point.wave1);
             }
-
-            lastSampleCount = currentSampleCount;
         }
     }
     
@@ -1111,6 +1058,10 @@ void updateDisplay() {
         }
         lastUpdate = now;
     }
+    
+    // Bloques addt listos (lleno o latencia máxima). Al final para que las
+    // métricas no esperen el handshake; el 0xFE se atiende en nextion->process()
+    nextion->flushWaveform();
 }
 
 // ============================================================================
@@ -1170,6 +1121,8 @@ void setup() {
         Serial.println("[WiFi] SSID: BioSignalSimulator_Pro");
         Serial.println("[WiFi] Pass: biosignal123");
         Serial.println("[WiFi] URL: http://192.168.4.1");
+        wifiServer.startStreamingTask();
+        signalRecorder.begin();
     } else {
         Serial.println("[WiFi] ERROR: No se pudo iniciar servidor");
     }
@@ -1274,89 +1227,8 @@ void loop() {
     // Procesar WiFi Server
     wifiServer.loop();
     
-    // Enviar datos a clientes WebSocket si hay señal activa
-    // USAR BUFFER SINCRONIZADO para evitar aliasing y pausas
-    if (wifiServer.getClientCount() > 0 && stateMachine.getState() == SystemState::SIMULATING) {
-        SignalType type = signalEngine->getCurrentType();
-        
-        // Consumir TODAS las muestras disponibles del buffer sincronizado (100 Hz)
-        WSSampleData wsSample;
-        while (signalEngine->getNextWSSample(wsSample)) {
-            WSSignalData wsData;
-            memset(&wsData, 0, sizeof(wsData));
-            
-            // Usar valores del buffer sincronizado (no del modelo directamente)
-            wsData.value = wsSample.value;
-            wsData.envelope = wsSample.envelope;
-            wsData.timestamp = wsSample.timestamp;
-            wsData.dacValue = signalEngine->getLastDACValue();
-            wsData.state = "RUNNING";
-            
-            switch (type) {
-                case SignalType::ECG:
-                    wsData.signalType = "ECG";
-                    wsData.condition = signalEngine->getECGModel().getConditionName();
-                    break;
-                case SignalType::EMG:
-                    wsData.signalType = "EMG";
-                    wsData.condition = signalEngine->getEMGModel().getConditionName();
-                    break;
-                case SignalType::PPG:
-                    wsData.signalType = "PPG";
-                    wsData.condition = signalEngine->getPPGModel().getConditionName();
-                    break;
-                default:
-                    break;
-            }
-            
-            wifiServer.sendSignalData(wsData);
-        }
-        
-        // Métricas se envían a menor frecuencia (controlado por wifi_server)
-        WSSignalMetrics wsMetrics;
-        memset(&wsMetrics, 0, sizeof(wsMetrics));
-        
-        switch (type) {
-            case SignalType::ECG: {
-                ECGModel& ecg = signalEngine->getECGModel();
-                wsMetrics.hr = (int)ecg.getCurrentHeartRate();
-                wsMetrics.rr = (int)ecg.getCurrentRRInterval();
-                wsMetrics.qrs = ecg.getQRSAmplitude();
-                wsMetrics.st = ecg.getSTDeviation_mV();
-                wsMetrics.hrv = ecg.getHRStd();
-                wsMetrics.pr = (int)ecg.getPRInterval_ms();
-                wsMetrics.qtc = (int)ecg.getQTcInterval_ms();
-                wsMetrics.p = ecg.getPAmplitude_mV();
-                wsMetrics.r = ecg.getRAmplitude_mV();
-                wsMetrics.t = ecg.getTAmplitude_mV();
-                break;
-            }
-            case SignalType::EMG: {
-                EMGModel& emg = signalEngine->getEMGModel();
-                wsMetrics.rms = emg.getRMSAmplitude();
-                wsMetrics.excitation = (int)(emg.getExcitation() * 100);
-                wsMetrics.activeUnits = emg.getActiveMotorUnits();
-                wsMetrics.freq = (int)emg.getFatigueMDF();
-                wsMetrics.mvc = (int)emg.getContractionLevel();
-                wsMetrics.raw = emg.getCurrentValueMV();
-                break;
-            }
-            case SignalType::PPG: {
-                PPGModel& ppg = signalEngine->getPPGModel();
-                wsMetrics.hr = (int)ppg.getCurrentHeartRate();
-                wsMetrics.rr = (int)ppg.getCurrentRRInterval();
-                wsMetrics.pi = ppg.getPerfusionIndex();
-                wsMetrics.ac = ppg.getLastACValue();
-                wsMetrics.sys = (int)ppg.getMeasuredSystoleTime();
-                wsMetrics.dia = (int)ppg.getMeasuredDiastoleTime();
-                break;
-            }
-            default:
-                break;
-        }
-        
-        wifiServer.sendMetrics(wsMetrics);
-    }
+    // El streaming WebSocket (muestras + métricas) corre en su propia
+    // tarea (WSStream, Core 0): ver WiFiServer_BioSim::streamCycle()
     
     // Pequeño delay para no saturar
     delay(1);
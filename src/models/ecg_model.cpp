@@ -26,13 +26,10 @@
 
 #include "models/ecg_model.h"
 #include "config.h"
+#include "core/trace_ring.h"
 #include <math.h>
 #include <stdlib.h>
 
-#ifdef ESP32
-#include <esp_random.h>
-#endif
-
 // ============================================================================
 // PARÁMETROS DEFAULT DEL MODELO MCSHARRY (del MATLAB original)
 // ============================================================================
@@ -45,6 +42,19 @@ static const float DEFAULT_BI[MCSHARRY_WAVES] = {0.25f, 0.1f, 0.1f, 0.1f, 0.4f};
 static const float Z0_INITIAL = 0.04f;
 static const float Z0_EQUILIBRIUM = 0.0f;  // Baseline de equilibrio
 
+// Integrador por defecto de cada condición (orden de ECGCondition).
+// ANALYTIC_PHASE verificado contra LIMIT_CYCLE en model_bench (host)
+static const ECGIntegrator DEFAULT_INTEGRATOR[(int)ECGCondition::COUNT] = {
+    ECGIntegrator::ANALYTIC_PHASE,  // NORMAL
+    ECGIntegrator::ANALYTIC_PHASE,  // TACHYCARDIA
+    ECGIntegrator::ANALYTIC_PHASE,  // BRADYCARDIA
+    ECGIntegrator::ANALYTIC_PHASE,  // ATRIAL_FIBRILLATION
+    ECGIntegrator::ANALYTIC_PHASE,  // VENTRICULAR_FIBRILLATION (no integra)
+    ECGIntegrator::ANALYTIC_PHASE,  // AV_BLOCK_1
+    ECGIntegrator::ANALYTIC_PHASE,  // ST_ELEVATION
+    ECGIntegrator::ANALYTIC_PHASE   // ST_DEPRESSION
+};
+
 // ============================================================================
 // CONSTRUCTOR
 // ============================================================================
@@ -52,6 +62,9 @@ ECGModel::ECGModel() {
     // Inicializar punteros a NULL
     rrProcess = nullptr;
     
+    // Semilla del generador aleatorio (reset() reinicia la secuencia)
+    rngSeed = RNG_SEED_ECG;
+    
     // Valores por defecto
     hrMean = 60.0f;
     hrStd = 1.0f;
@@ -59,6 +72,9 @@ ECGModel::ECGModel() {
     noiseLevel = 0.0f;
     
     currentCondition = ECGCondition::NORMAL;
+    for (int i = 0; i < (int)ECGCondition::COUNT; i++) {
+        conditionIntegrator[i] = DEFAULT_INTEGRATOR[i];
+    }
     
     // Reset inicializa todo
     reset();
@@ -84,12 +100,26 @@ void ECGModel::reset() {
     state.x = 1.0f;
     state.y = 0.0f;
     state.z = Z0_INITIAL;
+    state.theta = 0.0f;
+    integrator = conditionIntegrator[(int)currentCondition];
     
     // Variables de control
     lastTheta = 0.0f;
     beatCount = 0;
     sampleCount = 0;
     
+    // Generador aleatorio: misma semilla → misma secuencia tras cada reset
+    rng.seed(rngSeed);
+    
+    // Descartar cambios pendientes y lo publicado antes del reset
+    hasPendingParams = false;
+    paramMailbox.discard();
+    
+    // Plantilla de latido: se reconstruye tras calibrar
+    templateValid = false;
+    templateTheta = 0.0f;
+    templateStableBeats = 0;
+    
     // Inicializar parámetros de onda PQRST
     initializeWaveParams();
     
@@ -139,12 +169,16 @@ void ECGModel::reset() {
     currentBaseline_mV = 0.0f;
     stOffset_mV = 0.0f;  // Sin desplazamiento ST por defecto
     
-    // Generador aleatorio
-    gaussHasSpare = false;
-    gaussSpare = 0.0f;
-    
     // Ganancia waveform (default 100%)
     waveformGain = 1.0f;
+    waveformGainTarget.store(waveformGain, std::memory_order_relaxed);
+    waveformGainRamp.reset(waveformGain);
+    
+    // Rampas Tipo A en reposo en los valores actuales
+    amplitudeGain = 1.0f;
+    amplitudeRamp.reset(amplitudeGain);
+    noiseRamp.reset(noiseLevel);
+    rampsActive = false;
     
     // Inicializar filtrado digital (deshabilitado por defecto)
     filterChain.configureForECG(ECG_SFECG, 60.0f);  // 500 Hz, notch 60 Hz
@@ -209,35 +243,99 @@ void ECGModel::applyHRFactCorrection() {
 }
 
 // ============================================================================
-// SET PENDING PARAMETERS (para aplicación diferida - compatibilidad)
+// SET PENDING PARAMETERS (instantánea entre cores, aplicación diferida)
 // ============================================================================
 void ECGModel::setPendingParameters(const ECGParameters& newParams) {
-    setParameters(newParams);
+    paramMailbox.publish(newParams);
+}
+
+void ECGModel::pollParameters() {
+    ECGParameters next;
+    if (!paramMailbox.take(next)) {
+        return;
+    }
+    TRACE_INSTANT(PARAM_APPLIED, ((uint32_t)SignalType::ECG << 8) | 'A');
+    
+    // Tipo A: rampa desde el siguiente bloque (no cambian la morfología)
+    if (next.noiseLevel != params.noiseLevel) {
+        params.noiseLevel = next.noiseLevel;
+        setNoiseLevel(next.noiseLevel);
+    }
+    if (next.qrsAmplitude != params.qrsAmplitude) {
+        setAmplitude(next.qrsAmplitude);
+    }
+    
+    // Tipo B: condición, HR u ondas → siguiente latido (sin cortar el actual)
+    if (next.condition != params.condition || next.heartRate != params.heartRate ||
+        next.pWaveAmplitude != params.pWaveAmplitude ||
+        next.tWaveAmplitude != params.tWaveAmplitude || next.stShift != params.stShift) {
+        pendingParams = next;
+        hasPendingParams = true;
+    }
+}
+
+void ECGModel::applyPendingParameters() {
+    if (!hasPendingParams) return;
+    hasPendingParams = false;
+    TRACE_INSTANT(PARAM_APPLIED, ((uint32_t)SignalType::ECG << 8) | 'B');
+    
+    // Solo cambia HR: mismo camino que el slider (no recalibra)
+    if (pendingParams.condition == params.condition &&
+        pendingParams.pWaveAmplitude == params.pWaveAmplitude &&
+        pendingParams.tWaveAmplitude == params.tWaveAmplitude &&
+        pendingParams.stShift == params.stShift && pendingParams.heartRate > 0) {
+        params.heartRate = pendingParams.heartRate;
+        setHeartRate(pendingParams.heartRate);
+        return;
+    }
+    setParameters(pendingParams);
 }
 
 // ============================================================================
-// SET AMPLITUDE (parámetro Tipo A - inmediato)
+// SET AMPLITUDE (parámetro Tipo A - con rampa)
 // ============================================================================
+/**
+ * Ganancia de salida sobre el ECG calibrado. Escalar ai[] no servía: z - z0
+ * es lineal en ai y la recalibración por pico R devolvía la misma amplitud
+ * tras un tramo con ganancia provisional (escalón en la salida).
+ */
 void ECGModel::setAmplitude(float amp) {
-    if (params.qrsAmplitude > 0.01f) {
-        float factor = amp / params.qrsAmplitude;
+    if (amp > 0.01f) {
         params.qrsAmplitude = amp;
-        for (int i = 0; i < MCSHARRY_WAVES; i++) {
-            waveParams.ai[i] = baseParams.ai[i] * factor;
-        }
-        // Reiniciar calibración
-        isCalibrated = false;
-        calibrationPeakCount = 0;
-        calibrationBeatCount = 0;
+        amplitudeRamp.setTarget(amp, rampConfig);
     }
 }
 
+// ============================================================================
+// RAMPAS TIPO A (una evaluación por bloque, interpolación por muestra)
+// ============================================================================
+void ECGModel::advanceRamps(size_t n, float deltaTime) {
+    waveformGainRamp.setTarget(waveformGainTarget.load(std::memory_order_relaxed), rampConfig);
+    
+    // Valor al inicio del bloque (escalón de duración 0 ya aplicado)
+    float blockTime = (float)n * deltaTime;
+    if (noiseRamp.beginBlock(n, blockTime)) noiseLevel = noiseRamp.getValue();
+    if (amplitudeRamp.beginBlock(n, blockTime)) amplitudeGain = amplitudeRamp.getValue();
+    if (waveformGainRamp.beginBlock(n, blockTime)) waveformGain = waveformGainRamp.getValue();
+    rampsActive = noiseRamp.isActive() || amplitudeRamp.isActive() || waveformGainRamp.isActive();
+}
+
+void ECGModel::stepRamps() {
+    if (noiseRamp.isActive()) noiseLevel = noiseRamp.next();
+    if (amplitudeRamp.isActive()) amplitudeGain = amplitudeRamp.next();
+    if (waveformGainRamp.isActive()) waveformGain = waveformGainRamp.next();
+}
+
 // ============================================================================
 // SET PARAMETERS
 // ============================================================================
 void ECGModel::setParameters(const ECGParameters& newParams) {
+    // Morfología o RR cambian: volver a RK4 en vivo hasta estabilizar
+    invalidateBeatTemplate();
+    
     params = newParams;
     currentCondition = newParams.condition;
+    selectIntegrator(getIntegrator(currentCondition));
     
     // Aplicar morfología según condición
     switch (currentCondition) {
@@ -275,8 +373,11 @@ void ECGModel::setParameters(const ECGParameters& newParams) {
         hrMean = newParams.heartRate;
     }
     
-    // Aplicar nivel de ruido
+    // Aplicar nivel de ruido y ganancia de salida (sin rampa: reconfiguración)
     noiseLevel = newParams.noiseLevel;
+    noiseRamp.reset(noiseLevel);
+    amplitudeGain = (newParams.qrsAmplitude > 0.01f) ? newParams.qrsAmplitude : 1.0f;
+    amplitudeRamp.reset(amplitudeGain);
     
     // ✅ CRÍTICO: Solo recalcular hrfact si NO es AVB1
     //    (AVB1 ya lo hizo internamente con orden correcto)
@@ -363,7 +464,8 @@ void ECGModel::setVFibMorphology() {
     initVFibModel();
     
     // Generar valor inicial para evitar lectura de 0 antes del primer sample
-    float initialVfib = generateVFibSample(0.001f);
+    // (dt = 0: valor en la fase inicial, sin avanzar el banco)
+    float initialVfib = generateVFibSample(0.0f);
     state.z = initialVfib;  // Para getCurrentValueMV()
     vfibState.lastValue = initialVfib;  // Ya normalizado, no necesita escalado
     
@@ -447,23 +549,9 @@ void ECGModel::setSTDepressionMorphology() {
 // CÁLCULO DE DERIVADAS (ecuaciones del modelo McSharry)
 // ============================================================================
 /**
- * Calcula las derivadas del sistema dinámico:
- * dx/dt = α·x - ω·y
- * dy/dt = α·y + ω·x  
- * dz/dt = -Σ(ai·Δθi·exp(-Δθi²/2bi²)) - (z - z0)
+ * Término de forzado de z por fase: f(θ) = -Σ(ai·Δθi·exp(-Δθi²/2bi²))
  */
-void ECGModel::computeDerivatives(const ECGDynamicState& s, ECGDynamicState& ds, float omega) {
-    // Factor de atracción al círculo unitario
-    float alpha = 1.0f - sqrtf(s.x * s.x + s.y * s.y);
-    
-    // Derivadas de posición (movimiento circular)
-    ds.x = alpha * s.x - omega * s.y;
-    ds.y = alpha * s.y + omega * s.x;
-    
-    // Ángulo actual en el ciclo cardíaco
-    float theta = atan2f(s.y, s.x);
-    
-    // Derivada de z (forma de onda ECG)
+float ECGModel::phaseForcing(float theta) const {
     float zDot = 0.0f;
     
     for (int i = 0; i < MCSHARRY_WAVES; i++) {
@@ -478,10 +566,28 @@ void ECGModel::computeDerivatives(const ECGDynamicState& s, ECGDynamicState& ds,
         zDot -= waveParams.ai[i] * dTheta * expf(-0.5f * dTheta * dTheta / biSq);
     }
     
-    // Restauración a línea base (z0 = 0)
-    zDot -= (s.z - Z0_EQUILIBRIUM);
+    return zDot;
+}
+
+/**
+ * Calcula las derivadas del sistema dinámico:
+ * dx/dt = α·x - ω·y
+ * dy/dt = α·y + ω·x  
+ * dz/dt = -Σ(ai·Δθi·exp(-Δθi²/2bi²)) - (z - z0)
+ */
+void ECGModel::computeDerivatives(const ECGDynamicState& s, ECGDynamicState& ds, float omega) {
+    // Factor de atracción al círculo unitario
+    float alpha = 1.0f - sqrtf(s.x * s.x + s.y * s.y);
+    
+    // Derivadas de posición (movimiento circular)
+    ds.x = alpha * s.x - omega * s.y;
+    ds.y = alpha * s.y + omega * s.x;
+    
+    // Ángulo actual en el ciclo cardíaco
+    float theta = atan2f(s.y, s.x);
     
-    ds.z = zDot;
+    // Derivada de z (forma de onda ECG) con restauración a línea base (z0 = 0)
+    ds.z = phaseForcing(theta) - (s.z - Z0_EQUILIBRIUM);
 }
 
 // ============================================================================
@@ -515,15 +621,81 @@ void ECGModel::rungeKutta4Step(float dt, float omega) {
     state.z += dt * (k1.z + 2.0f * k2.z + 2.0f * k3.z + k4.z) / 6.0f;
 }
 
+// ============================================================================
+// INTEGRACIÓN POR FASE ANALÍTICA
+// ============================================================================
+/**
+ * θ(t) = θ0 + ω·t es exacta; RK4 solo sobre dz/dt = f(θ(t)) - (z - z0).
+ * k2 y k3 comparten θ(t + dt/2): f(θ) se evalúa 3 veces en vez de 4,
+ * sin sqrtf ni atan2f.
+ */
+void ECGModel::analyticPhaseStep(float dt, float omega) {
+    float f0 = phaseForcing(state.theta);
+    float fMid = phaseForcing(state.theta + 0.5f * omega * dt);  // Δθ se normaliza en f
+    state.theta += omega * dt;
+    if (state.theta >= PI) state.theta -= 2.0f * PI;
+    float f1 = phaseForcing(state.theta);
+    
+    float z = state.z - Z0_EQUILIBRIUM;
+    float z1 = f0 - z;
+    float z2 = fMid - (z + 0.5f * dt * z1);
+    float z3 = fMid - (z + 0.5f * dt * z2);
+    float z4 = f1 - (z + dt * z3);
+    state.z += dt * (z1 + 2.0f * z2 + 2.0f * z3 + z4) / 6.0f;
+}
+
+void ECGModel::integrateStep(float dt, float omega) {
+    if (integrator == ECGIntegrator::ANALYTIC_PHASE) {
+        analyticPhaseStep(dt, omega);
+    } else {
+        rungeKutta4Step(dt, omega);
+    }
+}
+
+/**
+ * Cambia de integrador conservando la fase: (x, y) ↔ θ
+ */
+void ECGModel::selectIntegrator(ECGIntegrator next) {
+    if (next == integrator) return;
+    if (next == ECGIntegrator::ANALYTIC_PHASE) {
+        state.theta = atan2f(state.y, state.x);
+    } else {
+        state.x = cosf(state.theta);
+        state.y = sinf(state.theta);
+    }
+    integrator = next;
+}
+
+void ECGModel::setIntegrator(ECGCondition condition, ECGIntegrator next) {
+    if ((int)condition >= (int)ECGCondition::COUNT) return;
+    conditionIntegrator[(int)condition] = next;
+    if (condition == currentCondition) {
+        // La plantilla se integró con el anterior: reconstruir con el nuevo
+        invalidateBeatTemplate();
+        selectIntegrator(next);
+    }
+}
+
+ECGIntegrator ECGModel::getIntegrator(ECGCondition condition) const {
+    if ((int)condition >= (int)ECGCondition::COUNT) return ECGIntegrator::LIMIT_CYCLE;
+    return conditionIntegrator[(int)condition];
+}
+
+float ECGModel::currentTheta() const {
+    if (templateValid) return templateTheta;
+    if (integrator == ECGIntegrator::ANALYTIC_PHASE) return state.theta;
+    return atan2f(state.y, state.x);
+}
+
 // ============================================================================
 // DETECCIÓN DE NUEVO LATIDO
 // ============================================================================
-void ECGModel::detectNewBeat() {
-    float theta = atan2f(state.y, state.x);
-    
+void ECGModel::detectNewBeat(float theta, float deltaTime) {
+
     // Detectar cruce por cero (θ pasa de negativo a positivo)
     if (lastTheta < 0 && theta >= 0) {
         beatCount++;
+        TRACE_INSTANT(BEAT, beatCount);
         
         // =====================================================================
         // FASE DE CALIBRACIÓN: Almacenar picos R crudos
@@ -704,13 +876,108 @@ void ECGModel::detectNewBeat() {
         currentCycleTime = 0.0f;
         currentCycleSamples = 0;
         
+        // Frontera de latido: adoptar cambios Tipo B pendientes
+        applyPendingParameters();
+        
         // Generar nuevo RR con variabilidad
         currentRR = generateNextRR();
+        
+        // Parámetros estables y calibrado: construir plantilla del latido
+        if (!templateValid && isCalibrated) {
+            if (++templateStableBeats >= ECG_TEMPLATE_STABLE_BEATS) {
+                buildBeatTemplate(deltaTime);
+                templateTheta = theta;
+            }
+        }
     }
     
     lastTheta = theta;
 }
 
+// ============================================================================
+// PLANTILLA DE LATIDO
+// ============================================================================
+/**
+ * Integra offline un latido al RR medio (60/hrMean) con el mismo integrador
+ * y el mismo paso que la generación en vivo (misma morfología que ha visto la
+ * calibración); z se remuestrea por fase a ECG_TEMPLATE_SIZE puntos
+ * equiespaciados en θ ∈ [-π, π).
+ *
+ * z es lineal con relajación unitaria (dz/dt = f(θ) - z), así que el latido
+ * registrado desde z(0) difiere del régimen periódico en (z(0) - zp)·e^(-t).
+ * Con z(RR) se despeja zp = (z(RR) - z(0)·e^(-RR)) / (1 - e^(-RR)) y se
+ * corrige la tabla sin integrar latidos de asentamiento.
+ */
+void ECGModel::buildBeatTemplate(float deltaTime) {
+    const float rr = 60.0f / hrMean;
+    const float omega = 2.0f * PI / rr;
+    const float stepPhase = omega * deltaTime;          // rad por paso
+    const float tablePhase = 2.0f * PI / (float)ECG_TEMPLATE_SIZE;
+    
+    // Estado de trabajo sobre el círculo unitario desde θ = -π
+    ECGDynamicState saved = state;
+    state.x = -1.0f;
+    state.y = 0.0f;
+    state.theta = -PI;
+    
+    // Interpolar z entre pasos en las fases de la tabla (y en θ = π para z(RR))
+    const float zStart = state.z;
+    float zEnd = zStart;
+    float phaseA = 0.0f;
+    float zA = zStart;
+    int j = 0;
+    while (j <= ECG_TEMPLATE_SIZE) {
+        integrateStep(deltaTime, omega);
+        float phaseB = phaseA + stepPhase;
+        float zB = state.z;
+        while (j <= ECG_TEMPLATE_SIZE && (float)j * tablePhase <= phaseB) {
+            float f = ((float)j * tablePhase - phaseA) / stepPhase;
+            float z = zA + (zB - zA) * f;
+            if (j < ECG_TEMPLATE_SIZE) {
+                beatTemplate[j] = z;
+            } else {
+                zEnd = z;
+            }
+            j++;
+        }
+        phaseA = phaseB;
+        zA = zB;
+    }
+    
+    // Proyectar al régimen periódico: restar el transitorio (z(0) - zp)·e^(-t)
+    const float decayRR = expf(-rr);
+    const float zPeriodic = (zEnd - zStart * decayRR) / (1.0f - decayRR);
+    const float transient = zStart - zPeriodic;
+    const float tableStep = rr / (float)ECG_TEMPLATE_SIZE;
+    for (int k = 0; k < ECG_TEMPLATE_SIZE; k++) {
+        beatTemplate[k] -= transient * expf(-(float)k * tableStep);
+    }
+    
+    state = saved;
+    templateValid = true;
+}
+
+void ECGModel::invalidateBeatTemplate() {
+    if (templateValid) {
+        // Dejar (x, y) y θ coherentes con la fase para continuar con RK4
+        state.x = cosf(templateTheta);
+        state.y = sinf(templateTheta);
+        state.theta = templateTheta;
+    }
+    templateValid = false;
+    templateStableBeats = 0;
+}
+
+float ECGModel::sampleBeatTemplate(float theta) const {
+    // θ ∈ [-π, π) → posición fraccional en la tabla
+    float pos = (theta + PI) * ((float)ECG_TEMPLATE_SIZE / (2.0f * PI));
+    int i0 = (int)pos;
+    float frac = pos - (float)i0;
+    i0 &= (ECG_TEMPLATE_SIZE - 1);
+    int i1 = (i0 + 1) & (ECG_TEMPLATE_SIZE - 1);
+    return beatTemplate[i0] + (beatTemplate[i1] - beatTemplate[i0]) * frac;
+}
+
 // ============================================================================
 // GENERACIÓN DE PRÓXIMO RR (con variabilidad HRV)
 // ============================================================================
@@ -819,6 +1086,10 @@ float ECGModel::applyScaling(float zRaw) const {
 float ECGModel::generateSample(float deltaTime) {
     sampleCount++;
     
+    if (rampsActive) {
+        stepRamps();
+    }
+    
     // =========================================================================
     // VFIB: Usar modelo espectral alternativo (no McSharry)
     // =========================================================================
@@ -830,8 +1101,8 @@ float ECGModel::generateSample(float deltaTime) {
         state.z = vfibMV;
         
         // generateVFibSample() ya retorna valor normalizado en rango clínico
-        // No necesita escalado adicional
-        float ecgMV = vfibMV;
+        // Solo la ganancia de salida del usuario
+        float ecgMV = vfibMV * amplitudeGain;
         
         // Añadir ruido si está configurado (proporcional al rango)
         if (noiseLevel > 0.0f) {
@@ -843,14 +1114,14 @@ float ECGModel::generateSample(float deltaTime) {
         vfibState.lastValue = ecgMV;
         
         // Actualizar métricas - solo incrementar beatCount periódicamente
-        // (cada ~200ms = ~300 BPM, no en cada muestra)
-        static uint32_t lastVFibBeatMs = 0;
-        uint32_t now = millis();
-        if (now - lastVFibBeatMs > 200) {
+        // (cada ~200ms = ~300 BPM en tiempo simulado, no en cada muestra)
+        vfibState.beatTimer -= deltaTime;
+        if (vfibState.beatTimer <= 0.0f) {
             beatCount++;
-            lastVFibBeatMs = now;
+            vfibState.beatTimer += VFIB_BEAT_INTERVAL_S;
+            applyPendingParameters();
         }
-        measuredRR_ms = 200.0f;
+        measuredRR_ms = VFIB_BEAT_INTERVAL_S * 1000.0f;
         
         return ecgMV;
     }
@@ -859,14 +1130,23 @@ float ECGModel::generateSample(float deltaTime) {
     // Modelo McSharry normal para otras condiciones
     // =========================================================================
     
-    // Velocidad angular ω = 2π/RR
-    float omega = 2.0f * PI / currentRR;
-    
-    // Integrar ecuaciones con RK4
-    rungeKutta4Step(deltaTime, omega);
-    
-    // Calcular theta actual (posición angular en el ciclo)
-    float theta = atan2f(state.y, state.x);
+    float theta;
+    if (templateValid) {
+        // Plantilla: avanzar fase con el RR actual (HRV) e interpolar z
+        templateTheta += deltaTime * (2.0f * PI) / currentRR;
+        if (templateTheta >= PI) templateTheta -= 2.0f * PI;
+        theta = templateTheta;
+        state.z = sampleBeatTemplate(theta);
+    } else {
+        // Velocidad angular ω = 2π/RR
+        float omega = 2.0f * PI / currentRR;
+        
+        // Integrar ecuaciones (RK4 del ciclo límite o fase analítica)
+        integrateStep(deltaTime, omega);
+        
+        // Theta actual (posición angular en el ciclo)
+        theta = currentTheta();
+    }
     
     // Actualizar tracking del ciclo actual (valores crudos para calibración)
     if (state.z > currentCycleZMax) currentCycleZMax = state.z;
@@ -888,6 +1168,9 @@ float ECGModel::generateSample(float deltaTime) {
         ecgMV -= currentBaseline_mV;
     }
     
+    // Ganancia de salida (amplitud Tipo A, con rampa)
+    ecgMV *= amplitudeGain;
+    
     // ✅ APLICAR DESPLAZAMIENTO ST (STEMI/Isquemia)
     // Aplicar offset desde el final de S hasta el final de T (incluye ST + T)
     // Esto eleva/deprime visualmente tanto el segmento ST como la onda T
@@ -914,7 +1197,7 @@ float ECGModel::generateSample(float deltaTime) {
     }
     
     // Detectar nuevo latido (después de almacenar la muestra)
-    detectNewBeat();
+    detectNewBeat(theta, deltaTime);
     
     // Añadir ruido si está configurado
     // noiseLevel está en rango 0.0-0.10 (0-10%)
@@ -931,14 +1214,34 @@ float ECGModel::generateSample(float deltaTime) {
 // ============================================================================
 // VALOR DAC (0-255)
 // ============================================================================
-uint8_t ECGModel::getDACValue(float deltaTime) {
-    float mV = generateSample(deltaTime);
-    
-    // Mapear [-0.5, 1.5] mV → [0, 255]
+// Mapear [-0.5, 1.5] mV → [0, 255] (nivel continuo; el código lo trunca)
+static inline float ecgMVToDACLevel(float mV) {
     float normalized = (mV - ECG_DISPLAY_MIN_MV) / ECG_DISPLAY_RANGE_MV;
     normalized = fmaxf(0.0f, fminf(1.0f, normalized));
-    
-    return (uint8_t)(normalized * 255.0f);
+    return normalized * 255.0f;
+}
+
+static inline uint8_t ecgMVToDACCode(float mV) {
+    return (uint8_t)ecgMVToDACLevel(mV);
+}
+
+// Ganancia de waveform (10-200%) respecto al centro visual (0.5 mV)
+// y mapeo [-0.5, 1.5] mV → [0, 255]; fuera de rango se clampea
+static inline uint8_t ecgMVToWaveformCode(float mV, float gain) {
+    const float CENTER_MV = 0.5f;  // Centro visual del ECG
+    return ecgMVToDACCode(CENTER_MV + (mV - CENTER_MV) * gain);
+}
+
+uint8_t ECGModel::mvToDACCode(float mV) {
+    return ecgMVToDACCode(mV);
+}
+
+float ECGModel::mvToDACLevel(float mV) {
+    return ecgMVToDACLevel(mV);
+}
+
+uint8_t ECGModel::getDACValue(float deltaTime) {
+    return ecgMVToDACCode(generateSample(deltaTime));
 }
 
 // ============================================================================
@@ -946,19 +1249,44 @@ uint8_t ECGModel::getDACValue(float deltaTime) {
 // ============================================================================
 uint8_t ECGModel::getWaveformValue() const {
     // Usar último valor generado (ya en mV)
-    float mV = getCurrentValueMV();
-    
-    // Aplicar ganancia de waveform (10-200%)
-    // La ganancia se aplica respecto al centro del rango (0.5 mV = baseline típico)
-    const float CENTER_MV = 0.5f;  // Centro visual del ECG
-    float amplified = CENTER_MV + (mV - CENTER_MV) * waveformGain;
-    
-    // Mapear [-0.5, 1.5] mV → [0, 255] (rango completo)
-    // Si amplificación excede rango, se clampea automáticamente
-    float normalized = (amplified - ECG_DISPLAY_MIN_MV) / ECG_DISPLAY_RANGE_MV;
-    normalized = fmaxf(0.0f, fminf(1.0f, normalized));
-    
-    return (uint8_t)(normalized * 255.0f);
+    return ecgMVToWaveformCode(getCurrentValueMV(), waveformGain);
+}
+
+// ============================================================================
+// GENERACIÓN POR BLOQUES
+// ============================================================================
+void ECGModel::generateBlock(float* out, size_t n, float deltaTime) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = generateSample(deltaTime);
+    }
+}
+
+void ECGModel::generateBlockDAC(uint8_t* out, size_t n, float deltaTime) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = ecgMVToDACCode(generateSample(deltaTime));
+    }
+}
+
+void ECGModel::generateBlockDisplay(uint8_t* out, size_t n, float deltaTime) {
+    for (size_t i = 0; i < n; i++) {
+        generateSample(deltaTime);
+        out[i] = ecgMVToWaveformCode(getCurrentValueMV(), waveformGain);
+    }
+}
+
+void ECGModel::generateBlock(const SampleBlock& out, size_t n, float deltaTime) {
+    for (size_t i = 0; i < n; i++) {
+        float mV = generateSample(deltaTime);
+        float currentMV = getCurrentValueMV();
+        float level = ecgMVToDACLevel(mV);
+        
+        if (out.dac)        out.dac[i] = (uint8_t)level;
+        if (out.dacLevel)   out.dacLevel[i] = level;
+        if (out.valueMV)    out.valueMV[i] = currentMV;
+        if (out.wave0)      out.wave0[i] = ecgMVToWaveformCode(currentMV, waveformGain);
+        if (out.wave1)      out.wave1[i] = 0;
+        if (out.envelopeMV) out.envelopeMV[i] = 0.0f;
+    }
 }
 
 // ============================================================================
@@ -986,12 +1314,12 @@ float ECGModel::getCurrentValueMV() const {
         return vfibState.lastValue;
     }
     
-    // Aplicar corrección de baseline para consistencia con generateSample()
-    return applyScaling(state.z) - currentBaseline_mV;
+    // Aplicar corrección de baseline y ganancia para consistencia con generateSample()
+    return (applyScaling(state.z) - currentBaseline_mV) * amplitudeGain;
 }
 
 bool ECGModel::isInBeat() const {
-    float theta = atan2f(state.y, state.x);
+    float theta = currentTheta();
     return (theta > -0.15f && theta < 0.15f);
 }
 
@@ -1087,37 +1415,6 @@ ECGDisplayMetrics ECGModel::getDisplayMetrics() const {
     return metrics;
 }
 
-// ============================================================================
-// GENERADOR ALEATORIO GAUSSIANO (Box-Muller)
-// ============================================================================
-float ECGModel::gaussianRandom(float mean, float std) {
-    if (gaussHasSpare) {
-        gaussHasSpare = false;
-        return mean + std * gaussSpare;
-    }
-    
-    float u, v, s;
-    do {
-        u = randomFloat() * 2.0f - 1.0f;
-        v = randomFloat() * 2.0f - 1.0f;
-        s = u * u + v * v;
-    } while (s >= 1.0f || s == 0.0f);
-    
-    s = sqrtf(-2.0f * logf(s) / s);
-    gaussSpare = v * s;
-    gaussHasSpare = true;
-    
-    return mean + std * u * s;
-}
-
-float ECGModel::randomFloat() {
-#ifdef ESP32
-    return (float)(esp_random()) / (float)UINT32_MAX;
-#else
-    return (float)rand() / (float)RAND_MAX;
-#endif
-}
-
 // ============================================================================
 // MODELO VFIB ALTERNATIVO (Superposición espectral caótica)
 // ============================================================================
@@ -1129,22 +1426,35 @@ float ECGModel::randomFloat() {
  * osciladores con parámetros que varían en el tiempo.
  */
 void ECGModel::initVFibModel() {
-    vfibState.time = 0.0f;
-    vfibState.lastUpdateMs = millis();
     vfibState.lastValue = 0.0f;
-    
-    // Inicializar componentes frecuenciales
+    vfibState.rotationDt = 0.0f;
+    vfibState.updateTimer = VFIB_UPDATE_INTERVAL_S;
+    vfibState.glideTimer = VFIB_UPDATE_INTERVAL_S / VFIB_GLIDE_STEPS;
+    vfibState.glideStepsLeft = 0;
+    vfibState.beatTimer = 0.0f;
+    
+    // Inicializar componentes frecuenciales: una banda de 6/N Hz por oscilador
+    const float band = 6.0f / (float)VFIB_COMPONENTS;
     for (int k = 0; k < VFIB_COMPONENTS; k++) {
         // Frecuencias en rango VFib real: 4-10 Hz
         // Coarse VFib: 4-6 Hz (mejor pronóstico)
         // Fine VFib: 6-10 Hz (peor pronóstico)
-        vfibState.frequencies[k] = 4.0f + (float)k * 1.2f + randomFloat() * 0.8f;
+        vfibState.frequencies[k] = 4.0f + ((float)k + randomFloat() * 0.67f) * band;
+        vfibState.freqStep[k] = 0.0f;
         
         // Amplitudes más altas para visualización clara
         vfibState.amplitudes[k] = 0.18f + randomFloat() * 0.22f;
+        vfibState.targetAmplitudes[k] = vfibState.amplitudes[k];
+        vfibState.ampStep[k] = 0.0f;
+        
+        // Fases aleatorias: fasor unitario de partida
+        float phase = randomFloat() * 2.0f * PI;
+        vfibState.re[k] = cosf(phase);
+        vfibState.im[k] = sinf(phase);
         
-        // Fases aleatorias
-        vfibState.phases[k] = randomFloat() * 2.0f * PI;
+        // Sin rotación hasta conocer dt (primera muestra)
+        vfibState.rotCos[k] = 1.0f;
+        vfibState.rotSin[k] = 0.0f;
     }
 }
 
@@ -1155,33 +1465,53 @@ void ECGModel::initVFibModel() {
  * con normalización fisiológica según Strohmenger 1997 (coarse VFib).
  */
 float ECGModel::generateVFibSample(float deltaTime) {
-    // Actualizar tiempo acumulado
-    vfibState.time += deltaTime;
+    // Rotación por muestra ligada a dt (se recalcula si cambia)
+    if (deltaTime != vfibState.rotationDt) {
+        updateVFibRotation(deltaTime);
+    }
+    
+    // Nuevos objetivos caóticos cada 200ms (tiempo simulado)
+    vfibState.updateTimer -= deltaTime;
+    if (vfibState.updateTimer <= 0.0f) {
+        vfibState.updateTimer += VFIB_UPDATE_INTERVAL_S;
+        updateVFibParameters(deltaTime);
+    }
     
-    // Actualizar parámetros caóticos cada 200ms
-    if (millis() - vfibState.lastUpdateMs > 200) {
-        updateVFibParameters();
-        vfibState.lastUpdateMs = millis();
+    // Deslizamiento de frecuencia por escalones (sin saltos de fase)
+    if (vfibState.glideStepsLeft > 0) {
+        vfibState.glideTimer -= deltaTime;
+        if (vfibState.glideTimer <= 0.0f) {
+            vfibState.glideTimer += VFIB_UPDATE_INTERVAL_S / VFIB_GLIDE_STEPS;
+            vfibState.glideStepsLeft--;
+            for (int i = 0; i < VFIB_COMPONENTS; i++) {
+                vfibState.frequencies[i] += vfibState.freqStep[i];
+            }
+            updateVFibRotation(deltaTime);
+        }
     }
     
     // =========================================================================
     // SUPERPOSICIÓN ESPECTRAL (Clayton et al. 1993)
     // =========================================================================
     // VFib = suma de múltiples osciladores en rango 4-10 Hz con fases caóticas
+    // Cada fasor gira e^(jω·dt): z ← z·(cos + j·sin), salida = A·Im(z)
     float rawValue = 0.0f;
     
     for (int i = 0; i < VFIB_COMPONENTS; i++) {
-        float phase = 2.0f * PI * vfibState.frequencies[i] * vfibState.time 
-                      + vfibState.phases[i];
-        rawValue += vfibState.amplitudes[i] * sinf(phase);
+        float re = vfibState.re[i];
+        float im = vfibState.im[i];
+        vfibState.re[i] = re * vfibState.rotCos[i] - im * vfibState.rotSin[i];
+        vfibState.im[i] = re * vfibState.rotSin[i] + im * vfibState.rotCos[i];
+        rawValue += vfibState.amplitudes[i] * vfibState.im[i];
+        vfibState.amplitudes[i] += vfibState.ampStep[i];
     }
     
     // =========================================================================
     // NORMALIZACIÓN FISIOLÓGICA AGRESIVA
     // =========================================================================
-    // Problema: rawValue puede estar en [-4.0, +4.0] mV (suma de 5×0.8 mV)
+    // Problema: rawValue puede llegar a ±N×0.8 mV (suma de N osciladores)
     // Solución: Escalar a rango clínico de coarse VFib: [-0.5, +0.5] mV
-    float normalizedValue = rawValue * VFIB_SCALE_FACTOR;  // × 0.125
+    float normalizedValue = rawValue * VFIB_SCALE_FACTOR;
     
     // =========================================================================
     // CLAMP ESTRICTO AL RANGO CLÍNICO
@@ -1201,30 +1531,53 @@ float ECGModel::generateVFibSample(float deltaTime) {
 }
 
 /**
- * @brief Actualiza parámetros de VFib para mantener caos
+ * @brief Sortea nuevos objetivos de VFib para mantener caos
  * 
  * Modelo espectral caótico basado en Clayton 1993 + Strohmenger 1997.
  * VFib tiene componentes espectrales en 4-10 Hz con amplitudes variables.
+ * Frecuencia y amplitud se deslizan hacia el objetivo durante el siguiente
+ * intervalo; la fase es continua (el fasor no se reinicia).
  */
-void ECGModel::updateVFibParameters() {
+void ECGModel::updateVFibParameters(float deltaTime) {
+    const float ampFraction = deltaTime / VFIB_UPDATE_INTERVAL_S;   // Por muestra
+    
     for (int i = 0; i < VFIB_COMPONENTS; i++) {
         // Frecuencias en rango fisiológico de VFib (4-10 Hz)
-        vfibState.frequencies[i] = 4.0f + randomFloat() * 6.0f;  // 4-10 Hz
+        float targetFreq = 4.0f + randomFloat() * 6.0f;  // 4-10 Hz
+        vfibState.freqStep[i] = (targetFreq - vfibState.frequencies[i]) / VFIB_GLIDE_STEPS;
         
         // =====================================================================
-        // AMPLITUDES INDIVIDUALES - AJUSTE CRÍTICO
-        // Ahora: 0.2-0.8 mV → suma hasta 4.0 mV, pero se normaliza después ✅
-        // ¿Por qué aumentamos los valores crudos?
-        // - El VFIB_SCALE_FACTOR (0.24) reducirá todo después
-        // - Queremos mantener la variabilidad caótica entre componentes
-        // - Amplitudes más altas = mejor contraste entre componentes
-        vfibState.amplitudes[i] = 0.2f + randomFloat() * 0.6f;  // 0.2-0.8 mV
-        
-        // Fases aleatorias para desorganización temporal
-        vfibState.phases[i] = randomFloat() * 2.0f * PI;
+        // AMPLITUDES INDIVIDUALES: 0.2-0.8 mV crudos, VFIB_SCALE_FACTOR
+        // normaliza la suma después; valores altos = mejor contraste
+        // =====================================================================
+        vfibState.targetAmplitudes[i] = 0.2f + randomFloat() * 0.6f;  // 0.2-0.8 mV
+        vfibState.ampStep[i] = (vfibState.targetAmplitudes[i] - vfibState.amplitudes[i]) * ampFraction;
     }
     
-    vfibState.lastUpdateMs = millis();
+    vfibState.glideStepsLeft = VFIB_GLIDE_STEPS;
+    vfibState.glideTimer = VFIB_UPDATE_INTERVAL_S / VFIB_GLIDE_STEPS;
+}
+
+/**
+ * @brief Recalcula la rotación por muestra y renormaliza los fasores
+ * 
+ * La recursión acumula error de módulo; la corrección de primer orden
+ * g = (3 - |z|²)/2 lo devuelve a 1 sin sqrtf (cada escalón, ~10 ms).
+ */
+void ECGModel::updateVFibRotation(float deltaTime) {
+    vfibState.rotationDt = deltaTime;
+    
+    for (int i = 0; i < VFIB_COMPONENTS; i++) {
+        float w = 2.0f * PI * vfibState.frequencies[i] * deltaTime;
+        vfibState.rotCos[i] = cosf(w);
+        vfibState.rotSin[i] = sinf(w);
+        
+        float re = vfibState.re[i];
+        float im = vfibState.im[i];
+        float g = 1.5f - 0.5f * (re * re + im * im);
+        vfibState.re[i] = re * g;
+        vfibState.im[i] = im * g;
+    }
 }
 
 // ============================================================================
@@ -42,8 +42,9 @@
 #include "models/emg_model.h"
 #include "data/emg_sequences.h"
 #include "config.h"
+#include "core/trace_ring.h"
+#include "core/perf_counters.h"
 #include <math.h>
-#include <esp_random.h>
 
 // ============================================================================
 // CONSTANTES DEL MODELO (basadas en literatura)
@@ -73,7 +74,9 @@ static const float TREMOR_FREQUENCY = 5.0f;          // Hz - frecuencia del temb
 // CONSTRUCTOR
 // ============================================================================
 EMGModel::EMGModel() {
-    hasPendingParams = false;
+    rngSeed = RNG_SEED_EMG;
+    firingCallback = nullptr;
+    firingContext = nullptr;
     forceVariabilityPhase = 0.0f;
     
     // Inicializar sistema de secuencias
@@ -84,10 +87,6 @@ EMGModel::EMGModel() {
     currentSequence.numEvents = 0;
     currentSequence.loop = false;
     
-    // Inicializar estados filtro suavizante
-    smoothingState[0] = 0.0f;
-    smoothingState[1] = 0.0f;
-    
     // Inicializar coeficientes de filtros
     initBiquadCoefficients();
     initSmoothingCoefficients();
@@ -109,6 +108,8 @@ void EMGModel::reset() {
     forceVariabilityPhase = 0.0f;
     lastSampleValue = 0.0f;
     waveformGain = EMG_WAVEFORM_GAIN_DEFAULT;
+    waveformGainTarget.store(waveformGain, std::memory_order_relaxed);
+    waveformGainRamp.reset(waveformGain);
     
     // Inicializar estado de fatiga
     fatigueState.isActive = false;
@@ -125,22 +126,15 @@ void EMGModel::reset() {
         rmsBuffer[i] = 0.0f;
     }
     
-    // Inicializar buffer envolvente (señal rectificada)
-    envelopeBufferIndex = 0;
-    envelopeSum = 0.0f;
-    for (int i = 0; i < ENVELOPE_BUFFER_SIZE; i++) {
-        envelopeBuffer[i] = 0.0f;
-    }
-    
     // Inicializar coeficientes biquad Butterworth 4º orden
     initBiquadCoefficients();
     
     // Inicializar buffers de procesamiento (PARTE 8)
     resetProcessingBuffers();
     
-    // Reset generador gaussiano Box-Muller
-    gaussHasSpare = false;
-    gaussSpare = 0.0f;
+    // Generador aleatorio: misma semilla → misma secuencia tras cada reset
+    rng.seed(rngSeed);
+    noiseBlockPos = EMG_NOISE_BLOCK_SIZE;  // Bloque de ruido vacío
     
     // Reset sistema de caché (BUG CRÍTICO CORREGIDO)
     cachedRawSample = 0.0f;
@@ -154,6 +148,18 @@ void EMGModel::reset() {
     filterChain.reset();
     filteringEnabled = false;  // Deshabilitado - usuario activa si necesita
     
+    // Descartar lo publicado antes del reset
+    paramMailbox.discard();
+    resetRamps();
+    
+    // Kernel MUAP (se construye en la primera muestra con el deltaTime real)
+    muapKernelLength = 0;
+    muapKernelDeltaTime = 0.0f;
+    muapAccumulatorPos = 0;
+    for (int i = 0; i < MUAP_KERNEL_SIZE; i++) {
+        muapAccumulator[i] = 0.0f;
+    }
+    
     initializeMotorUnits();
 }
 
@@ -172,13 +178,13 @@ void EMGModel::reset() {
  * Parámetros:
  *   - RTE = 0.35 (última MU se recluta al 35% MVC)
  *   - RR = 30 (rango exponencial)
- *   - Pool: 100 MUs (vs 120 en paper original, escalado proporcionalmente)
+ *   - Pool: 300 MUs (vs 120 en paper original, escalado proporcionalmente)
  * Resultado:
  *   - Primera MU: threshold ≈ 1.2% MVC → NO activa en REST (0.5%)
  *   - Última MU: threshold = 35% MVC → Totalmente reclutado en HIGH (80%)
  */
 void EMGModel::initializeMotorUnits() {
-    // Parámetros de Fuglevand 1993 (ajustados para 100 MUs vs 120 del paper original)
+    // Parámetros de Fuglevand 1993 (ajustados para 300 MUs vs 120 del paper original)
     const float RR = 30.0f;  // Recruitment Range (rango exponencial)
     const float RTE = 0.35f; // Recruitment Threshold Excitation (35% MVC para última MU)
     
@@ -188,7 +194,7 @@ void EMGModel::initializeMotorUnits() {
         // Umbral exponencial EXACTO de Fuglevand 1993:
         // threshold_i = RTE × (e^(ln(RR)×i/n) / e^(ln(RR)))
         // Simplificado: RTE × (RR^(i/n) / RR) = RTE × RR^((i/n) - 1)
-        // Primera MU (i=0): ~1.2% MVC, Última MU (i=99): 35% MVC
+        // Primera MU (i=0): ~1.2% MVC, Última MU (i=N-1): 35% MVC
         motorUnits[i].threshold = RTE * expf(logf(RR) * (normalizedIndex - 1.0f));
         
         // Amplitud EXPONENCIAL según Fuglevand 1993
@@ -208,6 +214,8 @@ void EMGModel::initializeMotorUnits() {
         motorUnits[i].nextFiringTime = gaussianRandom(0.0f, 0.1f);
         motorUnits[i].isActive = false;
     }
+    
+    resetFiringQueue();
 }
 
 // ============================================================================
@@ -230,7 +238,7 @@ void EMGModel::resetMotorUnitsToDefault() {
         // Restaurar umbral con FÓRMULA EXACTA de Fuglevand 1993
         // threshold_i = RTE × RR^((i/n) - 1)
         // Primera MU (i=0): ~1.2% MVC → NO activa en REST (0.5%)
-        // Última MU (i=99): 35% MVC
+        // Última MU (i=N-1): 35% MVC
         motorUnits[i].threshold = RTE * expf(logf(RR) * (normalizedIndex - 1.0f));
         
         // Restaurar amplitud desde base guardada
@@ -239,6 +247,9 @@ void EMGModel::resetMotorUnitsToDefault() {
         // Resetear estado
         motorUnits[i].isActive = false;
     }
+    
+    // Los MUAPs en curso siguen en el acumulador; solo se vacía la cola
+    resetFiringQueue();
 }
 
 // ============================================================================
@@ -281,11 +292,32 @@ void EMGModel::setParameters(const EMGParameters& newParams) {
     
     // Guardar excitación base (será modulada por variabilidad)
     baseExcitation = currentExcitation;
+    
+    // Reconfiguración completa: sin rampa desde los valores anteriores
+    resetRamps();
 }
 
 void EMGModel::setPendingParameters(const EMGParameters& newParams) {
-    pendingParams = newParams;
-    hasPendingParams = true;
+    paramMailbox.publish(newParams);
+}
+
+void EMGModel::pollParameters() {
+    EMGParameters next;
+    if (!paramMailbox.take(next)) {
+        return;
+    }
+    TRACE_INSTANT(PARAM_APPLIED, ((uint32_t)SignalType::EMG << 8) | 'A');
+    
+    // Cambio de condición: reconfigurar (reinicia secuencias)
+    if (next.condition != params.condition) {
+        setParameters(next);
+        return;
+    }
+    
+    // Misma condición: solo los campos cambiados, sin resetear secuencias
+    if (next.excitationLevel != params.excitationLevel) setExcitationLevel(next.excitationLevel);
+    if (next.amplitude != params.amplitude) setAmplitude(next.amplitude);
+    if (next.noiseLevel != params.noiseLevel) setNoiseLevel(next.noiseLevel);
 }
 
 // ============================================================================
@@ -381,48 +413,168 @@ void EMGModel::applyConditionModifiers() {
 // ACTUALIZACIÓN DE RECLUTAMIENTO
 // ============================================================================
 /**
- * @brief Actualiza el estado de reclutamiento de todas las MUs
+ * @brief Actualiza el reclutamiento moviendo la frontera del pool activo
+ * 
+ * Los umbrales crecen con el índice (Henneman), así que las MUs reclutadas
+ * son siempre el prefijo [0, recruitedCount). Solo se tocan las MUs que
+ * cruzan su umbral en esta muestra: O(cambios), no O(pool).
+ * Las recién reclutadas entran en la cola de disparos; las que salen se
+ * retiran (su MUAP en curso termina en el acumulador).
+ */
+void EMGModel::updateMotorUnitRecruitment() {
+    // Reclutar (pequeñas primero)
+    while (recruitedCount < MAX_MOTOR_UNITS &&
+           currentExcitation >= motorUnits[recruitedCount].threshold) {
+        MotorUnit& mu = motorUnits[recruitedCount];
+        mu.isActive = true;
+        mu.firingRate = computeFiringRate(mu);
+        // Recién reclutada: programar primer disparo
+        mu.nextFiringTime = accumulatedTime + gaussianRandom(0.05f, 0.02f);
+        firingQueuePush(recruitedCount);
+        recruitedCount++;
+    }
+    
+    // Desreclutar (grandes primero)
+    while (recruitedCount > 0 &&
+           currentExcitation < motorUnits[recruitedCount - 1].threshold) {
+        recruitedCount--;
+        motorUnits[recruitedCount].isActive = false;
+        firingQueueRemove(recruitedCount);
+    }
+}
+
+/**
+ * @brief Frecuencia de disparo de una MU reclutada (De Luca 2010)
  * 
- * Según De Luca 2010, la relación entre excitación y frecuencia de disparo es:
  *   FR = FR_min + gain × (excitation - threshold)
  * 
  * donde:
  *   - FR_min = 6-8 Hz (frecuencia al reclutamiento)
  *   - gain = ~40 Hz por unidad de excitación
  *   - FR_max = 50 Hz (puede llegar a 60 transitoriamente)
+ * 
+ * Solo se evalúa al reclutar y al disparar (es lo único que usa el ISI).
  */
-void EMGModel::updateMotorUnitRecruitment() {
+float EMGModel::computeFiringRate(const MotorUnit& mu) const {
+    float excitationAboveThreshold = currentExcitation - mu.threshold;
+    float rate = FIRING_RATE_MIN + excitationAboveThreshold * FIRING_RATE_GAIN;
+    
+    // TREMOR: Frecuencia FIJA 4.5 Hz (característica de Parkinson)
+    if (params.condition == EMGCondition::TREMOR) {
+        rate = 4.5f;  // Hz constante
+    }
+    
+    // Aplicar decay de fatiga a frecuencia de disparo
+    if (fatigueState.isActive) {
+        rate *= fatigueState.firingRateDecay;
+    }
+    
+    // Limitar a rango fisiológico (6-50 Hz, hasta 60 en picos)
+    return constrain(rate, FIRING_RATE_MIN, FIRING_RATE_MAX);
+}
+
+/**
+ * @brief Dispara la MU en la cima de la cola: reprograma y suma su MUAP
+ */
+void EMGModel::fireMotorUnit(uint16_t unit) {
+    MotorUnit& mu = motorUnits[unit];
+    mu.lastFiringTime = accumulatedTime;
+    mu.firingRate = computeFiringRate(mu);
+    
+    float isi = 1.0f / mu.firingRate;
+    isi *= (1.0f + gaussianRandom(0.0f, ISI_VARIABILITY_CV));
+    isi = constrain(isi, 0.015f, 0.2f);
+    mu.nextFiringTime = accumulatedTime + isi;
+    firingQueueSiftDown(mu.queueIndex);
+    
+    // Overlap-add: el kernel empieza en la muestra actual
+    const uint8_t mask = MUAP_KERNEL_SIZE - 1;
+    for (uint8_t k = 0; k < muapKernelLength; k++) {
+        muapAccumulator[(muapAccumulatorPos + k) & mask] += mu.amplitude * muapKernel[k];
+    }
+    
+    if (firingCallback) firingCallback(firingContext, unit, mu.amplitude);
+}
+
+// ============================================================================
+// COLA DE DISPAROS (min-heap por nextFiringTime)
+// ============================================================================
+void EMGModel::resetFiringQueue() {
     for (int i = 0; i < MAX_MOTOR_UNITS; i++) {
-        // Verificar si la MU debe activarse según su umbral
-        if (currentExcitation >= motorUnits[i].threshold) {
-            if (!motorUnits[i].isActive) {
-                // Recién reclutada: programar primer disparo
-                motorUnits[i].isActive = true;
-                motorUnits[i].nextFiringTime = accumulatedTime + gaussianRandom(0.05f, 0.02f);
-            }
-            
-            // Calcular frecuencia de disparo (De Luca 2010)
-            float excitationAboveThreshold = currentExcitation - motorUnits[i].threshold;
-            motorUnits[i].firingRate = FIRING_RATE_MIN + excitationAboveThreshold * FIRING_RATE_GAIN;
-            
-            // TREMOR: Frecuencia FIJA 4.5 Hz (característica de Parkinson)
-            if (params.condition == EMGCondition::TREMOR) {
-                motorUnits[i].firingRate = 4.5f;  // Hz constante
-            }
-            
-            // Aplicar decay de fatiga a frecuencia de disparo
-            if (fatigueState.isActive) {
-                motorUnits[i].firingRate *= fatigueState.firingRateDecay;
-            }
-            
-            // Limitar a rango fisiológico (6-50 Hz, hasta 60 en picos)
-            motorUnits[i].firingRate = constrain(motorUnits[i].firingRate, 
-                                                  FIRING_RATE_MIN, 
-                                                  FIRING_RATE_MAX);
-        } else {
-            motorUnits[i].isActive = false;
+        motorUnits[i].queueIndex = MU_NOT_QUEUED;
+    }
+    firingQueueSize = 0;
+    recruitedCount = 0;
+}
+
+void EMGModel::firingQueuePush(uint16_t unit) {
+    if (motorUnits[unit].queueIndex != MU_NOT_QUEUED) {
+        return;
+    }
+    uint16_t pos = firingQueueSize++;
+    firingQueue[pos] = unit;
+    motorUnits[unit].queueIndex = pos;
+    firingQueueSiftUp(pos);
+}
+
+void EMGModel::firingQueueRemove(uint16_t unit) {
+    uint16_t pos = motorUnits[unit].queueIndex;
+    if (pos == MU_NOT_QUEUED) {
+        return;
+    }
+    motorUnits[unit].queueIndex = MU_NOT_QUEUED;
+    firingQueueSize--;
+    if (pos == firingQueueSize) {
+        return;
+    }
+    
+    // Mover el último a la posición liberada y restaurar el orden
+    uint16_t moved = firingQueue[firingQueueSize];
+    firingQueue[pos] = moved;
+    motorUnits[moved].queueIndex = pos;
+    firingQueueSiftUp(pos);
+    firingQueueSiftDown(motorUnits[moved].queueIndex);
+}
+
+void EMGModel::firingQueueSiftUp(uint16_t pos) {
+    uint16_t unit = firingQueue[pos];
+    float key = motorUnits[unit].nextFiringTime;
+    while (pos > 0) {
+        uint16_t parent = (pos - 1) / 2;
+        uint16_t parentUnit = firingQueue[parent];
+        if (motorUnits[parentUnit].nextFiringTime <= key) {
+            break;
         }
+        firingQueue[pos] = parentUnit;
+        motorUnits[parentUnit].queueIndex = pos;
+        pos = parent;
     }
+    firingQueue[pos] = unit;
+    motorUnits[unit].queueIndex = pos;
+}
+
+void EMGModel::firingQueueSiftDown(uint16_t pos) {
+    uint16_t unit = firingQueue[pos];
+    float key = motorUnits[unit].nextFiringTime;
+    while (true) {
+        uint16_t child = 2 * pos + 1;
+        if (child >= firingQueueSize) {
+            break;
+        }
+        if (child + 1 < firingQueueSize &&
+            motorUnits[firingQueue[child + 1]].nextFiringTime < motorUnits[firingQueue[child]].nextFiringTime) {
+            child++;
+        }
+        uint16_t childUnit = firingQueue[child];
+        if (key <= motorUnits[childUnit].nextFiringTime) {
+            break;
+        }
+        firingQueue[pos] = childUnit;
+        motorUnits[childUnit].queueIndex = pos;
+        pos = child;
+    }
+    firingQueue[pos] = unit;
+    motorUnits[unit].queueIndex = pos;
 }
 
 // ============================================================================
@@ -471,6 +623,24 @@ float EMGModel::generateMUAP(float timeSinceFiring, float amplitude) {
     return -amplitude * wavelet / MUAP_PEAK_NORM;
 }
 
+/**
+ * @brief Muestrea el MUAP de amplitud unitaria a pasos de deltaTime
+ * 
+ * El disparo ocurre en un instante de muestra, así que timeSinceFiring
+ * siempre es k·deltaTime: la tabla reproduce generateMUAP() exactamente.
+ * Si MUAP_DURATION/deltaTime > MUAP_KERNEL_SIZE la cola se trunca.
+ */
+void EMGModel::buildMUAPKernel(float deltaTime) {
+    int length = (int)ceilf(MUAP_DURATION / (deltaTime * 1000.0f) - 1e-3f);
+    length = constrain(length, 1, MUAP_KERNEL_SIZE);
+    
+    for (int k = 0; k < MUAP_KERNEL_SIZE; k++) {
+        muapKernel[k] = (k < length) ? generateMUAP((float)k * deltaTime, 1.0f) : 0.0f;
+    }
+    muapKernelLength = (uint8_t)length;
+    muapKernelDeltaTime = deltaTime;
+}
+
 
 // ============================================================================
 // GENERACIÓN DE MUESTRA
@@ -491,10 +661,8 @@ float EMGModel::generateMUAP(float timeSinceFiring, float amplitude) {
 float EMGModel::generateSample(float deltaTime) {
     accumulatedTime += deltaTime;
     
-    // Aplicar parámetros pendientes si hay
-    if (hasPendingParams) {
-        setParameters(pendingParams);
-        hasPendingParams = false;
+    if (rampsActive) {
+        stepRamps();
     }
     
     // =========================================================================
@@ -595,35 +763,23 @@ float EMGModel::generateSample(float deltaTime) {
     updateMotorUnitRecruitment();
     
     // =========================================================================
-    // GENERAR SEÑAL: SUMAR MUAPs DE TODAS LAS MUs ACTIVAS
+    // GENERAR SEÑAL: DISPAROS PENDIENTES + OVERLAP-ADD DE MUAPs
     // =========================================================================
-    float signal = 0.0f;
-    
-    // Todas las condiciones sEMG usan duración estándar
-    const float muapDuration = MUAP_DURATION;
+    // Solo se visitan las MUs cuyo disparo vence en esta muestra (cima del
+    // heap); los MUAPs en curso ya están sumados en el acumulador.
+    if (deltaTime != muapKernelDeltaTime) {
+        buildMUAPKernel(deltaTime);
+    }
     
-    for (int i = 0; i < MAX_MOTOR_UNITS; i++) {
-        if (motorUnits[i].isActive || 
-            (accumulatedTime - motorUnits[i].lastFiringTime) < (muapDuration / 1000.0f)) {
-            
-            // Verificar si es tiempo de disparar
-            if (motorUnits[i].isActive && accumulatedTime >= motorUnits[i].nextFiringTime) {
-                motorUnits[i].lastFiringTime = accumulatedTime;
-                
-                float isi = 1.0f / motorUnits[i].firingRate;
-                isi *= (1.0f + gaussianRandom(0.0f, ISI_VARIABILITY_CV));
-                isi = constrain(isi, 0.015f, 0.2f);
-                motorUnits[i].nextFiringTime = accumulatedTime + isi;
-            }
-            
-            // Añadir contribución del MUAP (todas las condiciones usan MUAP estándar)
-            float timeSinceFiring = accumulatedTime - motorUnits[i].lastFiringTime;
-            if (timeSinceFiring >= 0 && timeSinceFiring < (muapDuration / 1000.0f)) {
-                signal += generateMUAP(timeSinceFiring, motorUnits[i].amplitude);
-            }
-        }
+    while (firingQueueSize > 0 &&
+           accumulatedTime >= motorUnits[firingQueue[0]].nextFiringTime) {
+        fireMotorUnit(firingQueue[0]);
     }
     
+    float signal = muapAccumulator[muapAccumulatorPos];
+    muapAccumulator[muapAccumulatorPos] = 0.0f;
+    muapAccumulatorPos = (muapAccumulatorPos + 1) & (MUAP_KERNEL_SIZE - 1);
+    
     // =========================================================================
     // APLICAR DESCENSO DE RMS POR FATIGA PERIFÉRICA (PARTE 5)
     // =========================================================================
@@ -646,7 +802,7 @@ float EMGModel::generateSample(float deltaTime) {
     // y crean picos masivos (3-4 mV) que no reflejan la fuerza real.
     // Solución: Normalizar por √(activeMUs) cuando hay muchas MUs activas.
     // Esto simula que en EMG real hay cancelación de fase entre MUAPs.
-    int activeMUs = getActiveMotorUnits();
+    int activeMUs = recruitedCount;
     if (activeMUs > 40) {
         signal *= sqrtf(40.0f / (float)activeMUs);
     }
@@ -659,7 +815,12 @@ float EMGModel::generateSample(float deltaTime) {
     
     // Ruido de fondo (interferencia, ruido de electrodo)
     // 10% ruido = 0.5 mV sigma (proporcional al rango EMG ±5 mV)
-    signal += gaussianRandom(0.0f, params.noiseLevel * 5.0f);
+    // N(0,1) por bloques con fillGaussian: una llamada cada 64 muestras
+    if (noiseBlockPos >= EMG_NOISE_BLOCK_SIZE) {
+        rng.fillGaussian(noiseBlock, EMG_NOISE_BLOCK_SIZE, 0.0f, 1.0f);
+        noiseBlockPos = 0;
+    }
+    signal += params.noiseLevel * 5.0f * noiseBlock[noiseBlockPos++];
     
     // =========================================================================
     // CLAMP FISIOLÓGICO DE SEÑAL CRUDA (SATURACIÓN DE AMPLIFICADOR)
@@ -683,7 +844,7 @@ float EMGModel::generateSample(float deltaTime) {
  * @param sample Muestra de señal cruda bipolar (±mV)
  * 
  * Este RMS es para medir amplitud total de la señal AC (getRMSAmplitude).
- * NO es para envolvente visual - para eso usar updateEnvelopeBuffer.
+ * NO es para envolvente visual - para eso usar computeEnvelope().
  */
 void EMGModel::updateRMSBuffer(float sample) {
     // Restar el valor antiguo de la suma
@@ -697,82 +858,21 @@ void EMGModel::updateRMSBuffer(float sample) {
     rmsBufferIndex = (rmsBufferIndex + 1) % RMS_BUFFER_SIZE;
 }
 
-/**
- * @brief Actualiza buffer para envolvente RMS (señal RECTIFICADA)
- * @param rectifiedSample Muestra rectificada |x| (solo positiva)
- * 
- * Este RMS es para envolvente visual (getProcessedSample).
- * Ventana de 30ms según recomendaciones SENIAM/De Luca.
- * 
- * La envolvente RMS SIEMPRE es <= que los picos de la rectificada,
- * porque promedia la energía en la ventana.
- */
-void EMGModel::updateEnvelopeBuffer(float rectifiedSample) {
-    // Restar el valor antiguo de la suma
-    envelopeSum -= envelopeBuffer[envelopeBufferIndex] * envelopeBuffer[envelopeBufferIndex];
-    
-    // Añadir nuevo valor rectificado
-    envelopeBuffer[envelopeBufferIndex] = rectifiedSample;
-    envelopeSum += rectifiedSample * rectifiedSample;
-    
-    // Avanzar índice circular
-    envelopeBufferIndex = (envelopeBufferIndex + 1) % ENVELOPE_BUFFER_SIZE;
-}
-
 uint8_t EMGModel::getDACValue(float deltaTime) {
     float voltage = generateSample(deltaTime);
     return voltageToDACValue(voltage);
 }
 
-// ============================================================================
-// HELPERS
-// ============================================================================
-
-/**
- * @brief Genera número aleatorio con distribución Gaussiana
- * 
- * Implementa el algoritmo Box-Muller para transformar números uniformes
- * en distribución normal. Usa variables de instancia en lugar de static
- * para permitir reset limpio del modelo y evitar problemas de thread-safety.
- * 
- * @param mean Media de la distribución
- * @param std Desviación estándar
- * @return Valor aleatorio con distribución N(mean, std)
- */
-float EMGModel::gaussianRandom(float mean, float std) {
-    if (gaussHasSpare) {
-        gaussHasSpare = false;
-        return mean + std * gaussSpare;
-    }
-    
-    float u, v, s;
-    do {
-        u = (esp_random() / (float)UINT32_MAX) * 2.0f - 1.0f;
-        v = (esp_random() / (float)UINT32_MAX) * 2.0f - 1.0f;
-        s = u * u + v * v;
-    } while (s >= 1.0f || s == 0.0f);
-    
-    s = sqrtf(-2.0f * logf(s) / s);
-    gaussSpare = v * s;
-    gaussHasSpare = true;
-    
-    return mean + std * u * s;
-}
-
 // ============================================================================
 // GETTERS PARA VISUALIZACIÓN
 // ============================================================================
 
 /**
  * @brief Obtiene número de unidades motoras activas
- * @return Cantidad de MUs actualmente reclutadas (0-100)
+ * @return Cantidad de MUs actualmente reclutadas (0-MAX_MOTOR_UNITS)
  */
 int EMGModel::getActiveMotorUnits() const {
-    int count = 0;
-    for (int i = 0; i < MAX_MOTOR_UNITS; i++) {
-        if (motorUnits[i].isActive) count++;
-    }
-    return count;
+    return recruitedCount;
 }
 
 /**
@@ -799,11 +899,9 @@ float EMGModel::getMeanFiringRate() const {
     float sumRate = 0.0f;
     int activeCount = 0;
     
-    for (int i = 0; i < MAX_MOTOR_UNITS; i++) {
-        if (motorUnits[i].isActive) {
-            sumRate += motorUnits[i].firingRate;
-            activeCount++;
-        }
+    for (int i = 0; i < recruitedCount; i++) {
+        sumRate += motorUnits[i].firingRate;
+        activeCount++;
     }
     
     if (activeCount == 0) return 0.0f;
@@ -903,7 +1001,7 @@ EMGDisplayMetrics EMGModel::getDisplayMetrics() const {
  *   - +5 mV → DAC 255
  *   - -5 mV → DAC 0
  */
-uint8_t EMGModel::voltageToDACValue(float voltage) const {
+float EMGModel::voltageToDACLevel(float voltage) {
     // Limitar al rango fijo
     voltage = constrain(voltage, EMG_OUTPUT_MIN_MV, EMG_OUTPUT_MAX_MV);
     
@@ -912,10 +1010,11 @@ uint8_t EMGModel::voltageToDACValue(float voltage) const {
     float normalized = voltage / EMG_OUTPUT_MAX_MV;
     
     // Escalar a 0-255 con centro en 128
-    int dacValue = (int)(128.0f + normalized * 127.0f);
-    
-    // Clamp por seguridad
-    return (uint8_t)constrain(dacValue, 0, 255);
+    return 128.0f + normalized * 127.0f;
+}
+
+uint8_t EMGModel::voltageToDACValue(float voltage) {
+    return (uint8_t)voltageToDACLevel(voltage);
 }
 
 // ============================================================================
@@ -925,26 +1024,20 @@ uint8_t EMGModel::voltageToDACValue(float voltage) const {
 /**
  * @brief Inicializa coeficientes Butterworth 4º orden (20-450 Hz @ 1kHz)
  * 
- * Diseño: Butterworth bandpass 4º orden = 2 biquad SOS en cascada
- * Calculado con scipy.signal.butter(4, [20, 450], 'bandpass', fs=1000, output='sos')
+ * Diseño: pasa-altos Butterworth 2º orden @ 20 Hz + pasa-bajos Butterworth
+ * 2º orden @ 450 Hz, 2 biquad SOS en cascada con ganancia unidad en banda.
+ * Calculado con scipy.signal.butter(2, 20, 'highpass', fs=1000) y
+ * scipy.signal.butter(2, 450, 'lowpass', fs=1000)
  * 
  * IMPORTANTE: Coeficientes precalculados para evitar cálculo en runtime
  */
 void EMGModel::initBiquadCoefficients() {
-    // SOS Section 1 (pasa-altos dominante)
-    // b0, b1, b2, a1, a2
-    biquadCoeffs[0][0] = 0.94595947f;   // b0
-    biquadCoeffs[0][1] = -1.89191895f;  // b1
-    biquadCoeffs[0][2] = 0.94595947f;   // b2
-    biquadCoeffs[0][3] = -1.88903313f;  // a1
-    biquadCoeffs[0][4] = 0.89480810f;   // a2
-    
-    // SOS Section 2 (pasa-bajos dominante)
-    biquadCoeffs[1][0] = 1.0f;          // b0
-    biquadCoeffs[1][1] = 2.0f;          // b1
-    biquadCoeffs[1][2] = 1.0f;          // b2
-    biquadCoeffs[1][3] = -1.60104076f;  // a1
-    biquadCoeffs[1][4] = 0.64135154f;   // a2
+    // SOS Section 1 (pasa-altos 20 Hz): b0, b1, b2, a1, a2
+    bandpassFilter.setSection(0, 0.91496914f, -1.82993829f, 0.91496914f, -1.82269493f, 0.83718165f);
+    
+    // SOS Section 2 (pasa-bajos 450 Hz)
+    bandpassFilter.setSection(1, 0.80059240f, 1.60118481f, 0.80059240f, 1.56101808f, 0.64135154f);
+    bandpassFilter.setNumSections(2);
 }
 
 /**
@@ -959,11 +1052,8 @@ void EMGModel::initBiquadCoefficients() {
  */
 void EMGModel::initSmoothingCoefficients() {
     // Butterworth 2º orden pasa-bajos @ 80 Hz
-    smoothingCoeffs[0] = 0.04491857f;   // b0
-    smoothingCoeffs[1] = 0.08983715f;   // b1
-    smoothingCoeffs[2] = 0.04491857f;   // b2
-    smoothingCoeffs[3] = -1.25761817f;  // a1
-    smoothingCoeffs[4] = 0.43729246f;   // a2
+    smoothingFilter.setSection(0, 0.04491857f, 0.08983715f, 0.04491857f, -1.25761817f, 0.43729246f);
+    smoothingFilter.setNumSections(1);
 }
 
 /**
@@ -981,30 +1071,8 @@ void EMGModel::initSmoothingCoefficients() {
  */
 void EMGModel::initEnvelopeCoefficients() {
     // Butterworth 2º orden pasa-bajos @ 6 Hz (ESTÁNDAR SENIAM)
-    envelopeCoeffs[0] = 0.00033717f;   // b0
-    envelopeCoeffs[1] = 0.00067434f;   // b1
-    envelopeCoeffs[2] = 0.00033717f;   // b2
-    envelopeCoeffs[3] = -1.94669378f;  // a1
-    envelopeCoeffs[4] = 0.94804245f;   // a2
-}
-
-/**
- * @brief Aplica una sección biquad IIR (Direct Form II Transposed)
- * @param input Muestra de entrada
- * @param state Array de 2 estados [w1, w2]
- * @param coeffs Array de 5 coeficientes [b0, b1, b2, a1, a2]
- * @return Muestra filtrada
- * 
- * Estructura Direct Form II Transposed (más estable numéricamente):
- *   y[n] = b0*x[n] + w1[n-1]
- *   w1[n] = b1*x[n] - a1*y[n] + w2[n-1]
- *   w2[n] = b2*x[n] - a2*y[n]
- */
-float EMGModel::applyBiquadSection(float input, float* state, const float* coeffs) {
-    float output = coeffs[0] * input + state[0];
-    state[0] = coeffs[1] * input - coeffs[3] * output + state[1];
-    state[1] = coeffs[2] * input - coeffs[4] * output;
-    return output;
+    envelopeFilter.setSection(0, 0.00033717f, 0.00067434f, 0.00033717f, -1.94669378f, 0.94804245f);
+    envelopeFilter.setNumSections(1);
 }
 
 /**
@@ -1016,44 +1084,37 @@ float EMGModel::applyBiquadSection(float input, float* state, const float* coeff
  * Atenuación: -24 dB/octava fuera de banda (característica Butterworth 4º orden)
  */
 float EMGModel::applyBandpassFilter(float input) {
-    // Aplicar primera sección biquad
-    float stage1 = applyBiquadSection(input, filterState1, biquadCoeffs[0]);
-    
-    // Aplicar segunda sección biquad
-    float output = applyBiquadSection(stage1, filterState2, biquadCoeffs[1]);
-    
-    return output;
+    return bandpassFilter.process(input);
 }
 
 /**
  * @brief Resetea todos los buffers de procesamiento
  * 
- * Llamado al cambiar de condición para evitar transitorios.
+ * Llamado al cambiar de condición para evitar transitorios. Puede ocurrir a
+ * mitad de un bloque (dentro de generateSample): los filtros se reinician
+ * justo antes de filtrar la siguiente muestra, así tick() y generateBlock()
+ * reinician en la misma muestra.
  */
 void EMGModel::resetProcessingBuffers() {
-    // Reset estados biquad (filtro pasa-banda 20-450 Hz)
-    filterState1[0] = 0.0f;
-    filterState1[1] = 0.0f;
-    filterState2[0] = 0.0f;
-    filterState2[1] = 0.0f;
-    
-    // Reset estados filtro suavizante (100 Hz)
-    smoothingState[0] = 0.0f;
-    smoothingState[1] = 0.0f;
-    
-    // Reset estados filtro Butterworth envelope (15 Hz)
-    envelopeState[0] = 0.0f;
-    envelopeState[1] = 0.0f;
+    processingResetPending = true;
     lastProcessedValue = 0.0f;
 }
 
+void EMGModel::applyProcessingReset() {
+    // Reset estados biquad (pasa-banda 20-450 Hz, suavizante, envelope)
+    bandpassFilter.reset();
+    smoothingFilter.reset();
+    envelopeFilter.reset();
+    processingResetPending = false;
+}
+
 /**
  * @brief Aplica filtro suavizante post-bandpass @ 100 Hz
  * @param input Señal filtrada por bandpass
  * @return Señal suavizada (picos reducidos)
  */
 float EMGModel::applySmoothingFilter(float input) {
-    return applyBiquadSection(input, smoothingState, smoothingCoeffs);
+    return smoothingFilter.process(input);
 }
 
 /**
@@ -1073,7 +1134,46 @@ float EMGModel::applyRectification(float input) {
  * - Filtro puro Butterworth como indica la literatura
  */
 float EMGModel::applyRMSEnvelope(float input) {
-    return applyBiquadSection(input, envelopeState, envelopeCoeffs);
+    return envelopeFilter.process(input);
+}
+
+/**
+ * @brief Envolvente de una muestra cruda (pipeline completo)
+ * 
+ * Raw → Bandpass(20-450) → Suavizante(80) → |x| → Envelope(6 Hz) × EMG_ENVELOPE_GAIN
+ * 
+ * La envolvente lineal es el valor medio rectificado de la señal suavizada;
+ * EMG_ENVELOPE_GAIN la lleva a la escala RMS de la señal cruda (medido: RMS
+ * cruda / envolvente lineal = 3.2-3.3 en todas las condiciones), de modo que
+ * EMG_RMS_MAX_MV y las escalas de Nextion siguen valiendo.
+ */
+float EMGModel::computeEnvelope(float raw) {
+    float conditioned = applySmoothingFilter(applyBandpassFilter(raw));
+    float envelope = applyRMSEnvelope(applyRectification(conditioned)) * EMG_ENVELOPE_GAIN;
+    return (envelope > 0.0f) ? envelope : 0.0f;   // Sobreoscilación del 6 Hz
+}
+
+/**
+ * @brief Mismo pipeline que computeEnvelope() sobre un bloque
+ * @param raw Muestras crudas en mV
+ * @param envelope Envolvente en mV (puede ser el mismo buffer que raw)
+ * 
+ * Cada cascada recorre el bloque completo con processBlock() (esp-dsp en el
+ * ESP32) y comparte estado con el camino por muestra.
+ */
+void EMGModel::processEnvelopeBlock(const float* raw, float* envelope, size_t n) {
+    if (n == 0) return;
+    PERF_BEGIN(filterStart);
+    bandpassFilter.processBlock(raw, envelope, n);
+    smoothingFilter.processBlock(envelope, envelope, n);
+    for (size_t i = 0; i < n; i++) envelope[i] = fabsf(envelope[i]);
+    envelopeFilter.processBlock(envelope, envelope, n);
+    for (size_t i = 0; i < n; i++) {
+        float value = envelope[i] * EMG_ENVELOPE_GAIN;
+        envelope[i] = (value > 0.0f) ? value : 0.0f;
+    }
+    lastProcessedValue = envelope[n - 1];
+    PERF_END(FILTER, filterStart);
 }
 
 // ============================================================================
@@ -1094,20 +1194,26 @@ float EMGModel::applyRMSEnvelope(float input) {
  * - Desperdicio de CPU
  */
 void EMGModel::tick(float deltaTime) {
+    tickRaw(deltaTime);
+    if (processingResetPending) applyProcessingReset();
+    
+    // Actualizar envelope en cada tick para que esté sincronizado con el waveform
+    // Esto hace que lastProcessedValue esté siempre actualizado para getWaveformValue_Ch1()
+    lastProcessedValue = computeEnvelope(cachedRawSample);
+}
+
+/**
+ * @brief Avanza el modelo una muestra sin calcular la envolvente
+ * 
+ * generateBlock() filtra la envolvente después, por bloques.
+ */
+void EMGModel::tickRaw(float deltaTime) {
     // Actualizar secuencia si está activa
     updateSequence(deltaTime);
     
     // Generar UNA sola muestra cruda del modelo
     cachedRawSample = generateSample(deltaTime);
     sampleIsCached = true;
-    
-    // Actualizar envelope en cada tick para que esté sincronizado con el waveform
-    // Esto hace que lastProcessedValue esté siempre actualizado para getWaveformValue_Ch1()
-    float rectified = fabsf(cachedRawSample);
-    updateEnvelopeBuffer(rectified);
-    float envelopeRMS = (envelopeSum > 0.0f) ? sqrtf(envelopeSum / (float)ENVELOPE_BUFFER_SIZE) : 0.0f;
-    const float alpha = 0.02f;
-    lastProcessedValue = lastProcessedValue * (1.0f - alpha) + envelopeRMS * alpha;
 }
 
 // ============================================================================
@@ -1139,18 +1245,18 @@ uint8_t EMGModel::getRawDACValue() const {
 }
 
 /**
- * @brief Obtiene señal PROCESADA - ENVOLVENTE RMS SOBRE SEÑAL RECTIFICADA
+ * @brief Obtiene señal PROCESADA - ENVOLVENTE LINEAL SOBRE SEÑAL RECTIFICADA
  * 
- * Pipeline CORRECTO según SENIAM / De Luca (1997) / Merletti (2004):
+ * Pipeline según SENIAM / De Luca (1997) / Merletti (2004):
  * 
- *   Raw (±mV) → |Rectificación| → RMS ventana 30ms → EMA suavizado
- *       ↓              ↓                  ↓                ↓
- *    Bipolar     Unipolar (+)    Promedio energía    Transiciones suaves
+ *   Raw (±mV) → Pasa-banda 20-450 → Suavizante 80 Hz → |Rectificación| → LPF 6 Hz
+ *       ↓              ↓                  ↓                  ↓              ↓
+ *    Bipolar     Sin deriva DC      Picos acotados      Unipolar (+)   Envolvente
  * 
  * CONCEPTOS CLAVE:
  * - Rectificación: convierte señal en positiva para medir energía
- * - RMS ventana 30ms: promedia picos de MUAPs en ventana (SIEMPRE <= picos máximos)
- * - EMA alpha=0.02: suaviza para visualización (constante tiempo ~50ms)
+ * - LPF 6 Hz (Butterworth 2º orden): promedia los MUAPs (~170 ms)
+ * - EMG_ENVELOPE_GAIN: escala el valor medio rectificado a la escala RMS
  * 
  * RELACIÓN rectificada vs envolvente:
  * - Rectificada: picos rápidos, amplitud instantánea variable
@@ -1183,11 +1289,74 @@ float EMGModel::getProcessedSample() {
  * - Nextion: usa escala 0-5mV (compartida con RAW para superposición)
  * - DAC real: usa escala 0-2mV (EMG_RMS_MAX_MV) para máxima resolución
  */
-uint8_t EMGModel::getProcessedDACValue() {
-    float envelope = getProcessedSample();
+float EMGModel::envelopeToDACLevel(float envelope) {
     envelope = constrain(envelope, 0.0f, EMG_RMS_MAX_MV);  // 0-2 mV (rango real envelope)
-    int dacValue = (int)((envelope / EMG_RMS_MAX_MV) * 255.0f);  // Full scale DAC
-    return (uint8_t)constrain(dacValue, 0, 255);
+    return (envelope / EMG_RMS_MAX_MV) * 255.0f;           // Full scale DAC
+}
+
+uint8_t EMGModel::getProcessedDACValue() {
+    return (uint8_t)envelopeToDACLevel(getProcessedSample());
+}
+
+// ============================================================================
+// GENERACIÓN POR BLOQUES
+// ============================================================================
+void EMGModel::generateBlock(float* out, size_t n, float deltaTime) {
+    for (size_t i = 0; i < n; i++) {
+        tick(deltaTime);
+        out[i] = cachedRawSample;
+    }
+}
+
+void EMGModel::generateBlockDAC(uint8_t* out, size_t n, float deltaTime) {
+    for (size_t i = 0; i < n; i++) {
+        tick(deltaTime);
+        out[i] = voltageToDACValue(cachedRawSample);
+    }
+}
+
+void EMGModel::generateBlockDisplay(uint8_t* out, size_t n, float deltaTime) {
+    for (size_t i = 0; i < n; i++) {
+        tick(deltaTime);
+        out[i] = getWaveformValue_Ch0();
+    }
+}
+
+void EMGModel::generateBlock(const SampleBlock& out, size_t n, float deltaTime, bool envelopeDAC) {
+    float raw[MODEL_BLOCK_SIZE];
+    float envelope[MODEL_BLOCK_SIZE];
+    
+    for (size_t start = 0; start < n; start += MODEL_BLOCK_SIZE) {
+        size_t count = (n - start < MODEL_BLOCK_SIZE) ? n - start : MODEL_BLOCK_SIZE;
+        
+        // Señal cruda muestra a muestra; la envolvente, por tramos entre
+        // reinicios de filtros (normalmente el bloque entero)
+        size_t segment = 0;
+        for (size_t i = 0; i < count; i++) {
+            tickRaw(deltaTime);
+            raw[i] = cachedRawSample;
+            if (processingResetPending) {
+                processEnvelopeBlock(&raw[segment], &envelope[segment], i - segment);
+                applyProcessingReset();
+                segment = i;
+            }
+        }
+        processEnvelopeBlock(&raw[segment], &envelope[segment], count - segment);
+        
+        for (size_t i = 0; i < count; i++) {
+            size_t k = start + i;
+            if (out.dac || out.dacLevel) {
+                float level = envelopeDAC ? envelopeToDACLevel(envelope[i])
+                                          : voltageToDACLevel(raw[i]);
+                if (out.dac)      out.dac[k] = (uint8_t)level;
+                if (out.dacLevel) out.dacLevel[k] = level;
+            }
+            if (out.valueMV)    out.valueMV[k] = raw[i];
+            if (out.envelopeMV) out.envelopeMV[k] = envelope[i];
+            if (out.wave0)      out.wave0[k] = voltageToWaveformCode(raw[i]);
+            if (out.wave1)      out.wave1[k] = voltageToWaveformCode(envelope[i]);
+        }
+    }
 }
 
 // ============================================================================
@@ -1336,18 +1505,7 @@ void EMGModel::updateSequence(float deltaTime) {
  */
 uint8_t EMGModel::getWaveformValue_Ch0() const {
     // Usar muestra cruda cacheada (ya en mV)
-    float voltage = cachedRawSample;
-    
-    // Limitar a rango fijo ±5mV
-    voltage = constrain(voltage, EMG_OUTPUT_MIN_MV, EMG_OUTPUT_MAX_MV);
-    
-    // Normalizar: -5mV → 0.0, 0mV → 0.5, +5mV → 1.0
-    float normalized = (voltage - EMG_OUTPUT_MIN_MV) / (EMG_OUTPUT_MAX_MV - EMG_OUTPUT_MIN_MV);
-    
-    // Mapear a 0-255 (rango completo)
-    uint8_t y = (uint8_t)(normalized * 255.0f);
-    
-    return y;
+    return voltageToWaveformCode(cachedRawSample);
 }
 
 /**
@@ -1364,20 +1522,22 @@ uint8_t EMGModel::getWaveformValue_Ch0() const {
  * Ventaja: El estudiante ve el envelope proporcional al raw.
  */
 uint8_t EMGModel::getWaveformValue_Ch1() const {
-    // Usar envelope procesada (RMS con EMA)
-    float voltage = lastProcessedValue;
-    
-    // El envelope es positivo (0 a ~2-4 mV dependiendo de condición)
-    // Usar MISMA ESCALA que el raw (-5 a +5 mV) para mapeo proporcional
-    voltage = constrain(voltage, 0.0f, EMG_OUTPUT_MAX_MV);  // Clamp a 0-5mV
+    // Usar envelope procesada (siempre >= 0, ver computeEnvelope)
+    return voltageToWaveformCode(lastProcessedValue);
+}
+
+/**
+ * @brief Código waveform de un valor en mV (escala fija ±5 mV, común a Ch0/Ch1)
+ */
+uint8_t EMGModel::voltageToWaveformCode(float voltage) {
+    // Limitar a rango fijo ±5mV
+    voltage = constrain(voltage, EMG_OUTPUT_MIN_MV, EMG_OUTPUT_MAX_MV);
     
-    // Normalizar usando escala del raw: -5mV → 0.0, 0mV → 0.5, +5mV → 1.0
+    // Normalizar: -5mV → 0.0, 0mV → 0.5, +5mV → 1.0
     float normalized = (voltage - EMG_OUTPUT_MIN_MV) / (EMG_OUTPUT_MAX_MV - EMG_OUTPUT_MIN_MV);
     
     // Mapear a 0-255 (rango completo)
-    uint8_t y = (uint8_t)(normalized * 255.0f);
-    
-    return y;
+    return (uint8_t)(normalized * 255.0f);
 }
 
 // ============================================================================
@@ -1429,7 +1589,7 @@ float EMGModel::clampExcitationForCondition(float excitation) const {
  * Límite: 0-10% para mantener señal interpretable
  */
 void EMGModel::setNoiseLevel(float noise) {
-    params.noiseLevel = constrain(noise, 0.0f, 0.10f);  // 0-10% máximo
+    noiseRamp.setTarget(constrain(noise, 0.0f, 0.10f), rampConfig);  // 0-10% máximo
 }
 
 /**
@@ -1439,7 +1599,7 @@ void EMGModel::setNoiseLevel(float noise) {
  * Simula variabilidad de impedancia electrodo/piel sin alterar morfología
  */
 void EMGModel::setAmplitude(float amp) {
-    params.amplitude = constrain(amp, 0.5f, 2.0f);  // ±100% rango seguro
+    amplitudeRamp.setTarget(constrain(amp, 0.5f, 2.0f), rampConfig);  // ±100% rango seguro
 }
 
 void EMGModel::setExcitationLevel(float exc) {
@@ -1453,17 +1613,63 @@ void EMGModel::setExcitationLevel(float exc) {
             // Usuario quiere control manual - detener secuencia
             sequenceActive = false;
             params.excitationLevel = exc;
-            currentExcitation = exc;
-            targetExcitation = exc;
+            setExcitationRampTarget(exc);
             Serial.printf("[EMG] Secuencia detenida - excitación manual %.0f%%\n", exc * 100);
         }
         return;
     }
     
-    // Sin secuencia activa - aplicar directamente
+    // Sin secuencia activa - rampa desde la excitación base actual
     params.excitationLevel = exc;
-    currentExcitation = exc;
-    targetExcitation = exc;
+    setExcitationRampTarget(exc);
+}
+
+// ============================================================================
+// RAMPAS TIPO A (una evaluación por bloque, interpolación por muestra)
+// ============================================================================
+void EMGModel::setExcitationRampTarget(float exc) {
+    // La secuencia o la condición pudieron mover la excitación desde la
+    // última rampa: partir siempre del valor en curso
+    if (!excitationRamp.isActive()) {
+        excitationRamp.reset(baseExcitation);
+    }
+    excitationRamp.setTarget(exc, rampConfig);
+    excitationRampTime = EXCITATION_RAMP_DURATION;  // Sin rampa de secuencia en paralelo
+}
+
+void EMGModel::resetRamps() {
+    noiseRamp.reset(params.noiseLevel);
+    amplitudeRamp.reset(params.amplitude);
+    excitationRamp.reset(baseExcitation);
+    rampsActive = waveformGainRamp.isActive();
+}
+
+void EMGModel::advanceRamps(size_t n, float deltaTime) {
+    waveformGainRamp.setTarget(waveformGainTarget.load(std::memory_order_relaxed), rampConfig);
+    
+    // Valor al inicio del bloque (escalón de duración 0 ya aplicado)
+    float blockTime = (float)n * deltaTime;
+    if (noiseRamp.beginBlock(n, blockTime)) params.noiseLevel = noiseRamp.getValue();
+    if (amplitudeRamp.beginBlock(n, blockTime)) params.amplitude = amplitudeRamp.getValue();
+    if (waveformGainRamp.beginBlock(n, blockTime)) waveformGain = waveformGainRamp.getValue();
+    if (excitationRamp.beginBlock(n, blockTime)) {
+        baseExcitation = excitationRamp.getValue();
+        currentExcitation = baseExcitation;
+        targetExcitation = baseExcitation;
+    }
+    rampsActive = noiseRamp.isActive() || amplitudeRamp.isActive() ||
+                  waveformGainRamp.isActive() || excitationRamp.isActive();
+}
+
+void EMGModel::stepRamps() {
+    if (noiseRamp.isActive()) params.noiseLevel = noiseRamp.next();
+    if (amplitudeRamp.isActive()) params.amplitude = amplitudeRamp.next();
+    if (waveformGainRamp.isActive()) waveformGain = waveformGainRamp.next();
+    if (excitationRamp.isActive()) {
+        baseExcitation = excitationRamp.next();
+        currentExcitation = baseExcitation;
+        targetExcitation = baseExcitation;
+    }
 }
 
 // ============================================================================
@@ -0,0 +1,394 @@
+/**
+ * @file playback_model.cpp
+ * @brief Implementación de la reproducción de archivos .bsr desde flash
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ */
+
+#include "models/playback_model.h"
+#include "models/ecg_model.h"
+#include "models/emg_model.h"
+#include "models/ppg_model.h"
+#include <string.h>
+
+#ifndef NATIVE_BUILD
+#include <SPIFFS.h>
+#else
+#include <stdio.h>
+#endif
+
+// ============================================================================
+// ARCHIVO (SPIFFS en el ESP32, stdio en el build nativo)
+// ============================================================================
+#ifndef NATIVE_BUILD
+static File playbackFile;
+
+static bool playbackFileOpen(const char* path) {
+    playbackFile = SPIFFS.open(path, FILE_READ);
+    return (bool)playbackFile;
+}
+
+static size_t playbackFileRead(uint8_t* data, size_t len) {
+    return playbackFile.read(data, len);
+}
+
+static bool playbackFileRewind() {
+    return playbackFile.seek(0);
+}
+
+static void playbackFileClose() {
+    if (playbackFile) playbackFile.close();
+}
+#else
+static FILE* playbackFile = nullptr;
+
+static bool playbackFileOpen(const char* path) {
+    playbackFile = fopen(path + 1, "rb");   // Sin '/' inicial: directorio actual
+    return playbackFile != nullptr;
+}
+
+static size_t playbackFileRead(uint8_t* data, size_t len) {
+    return fread(data, 1, len, playbackFile);
+}
+
+static bool playbackFileRewind() {
+    return fseek(playbackFile, 0, SEEK_SET) == 0;
+}
+
+static void playbackFileClose() {
+    if (playbackFile) fclose(playbackFile);
+    playbackFile = nullptr;
+}
+#endif
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+PlaybackModel::PlaybackModel()
+    : fillIndex(0)
+    , readIndex(0)
+    , readPos(0)
+    , signalType(SignalType::NONE)
+    , conditionId(0)
+    , sampleRateHz(0)
+    , state(PlaybackState::IDLE)
+    , readerTaskHandle(nullptr)
+{
+    bufferLength[0] = bufferLength[1] = 0;
+    bufferState[0].store(BUF_FREE);
+    bufferState[1].store(BUF_FREE);
+    path[0] = '\0';
+    memset(&stats, 0, sizeof(stats));
+    resetDecoder();
+}
+
+bool PlaybackModel::begin() {
+    if (readerTaskHandle != nullptr) return true;
+
+#ifndef NATIVE_BUILD
+    if (!SPIFFS.begin(true)) {
+        Serial.println("[Playback] ERROR: SPIFFS no disponible");
+        return false;
+    }
+#endif
+
+    BaseType_t result = xTaskCreatePinnedToCore(
+        readerTask,
+        "Playback",
+        STACK_SIZE_PLAYBACK,
+        this,
+        TASK_PRIORITY_PLAYBACK,
+        &readerTaskHandle,
+        CORE_PLAYBACK
+    );
+
+    if (result != pdPASS) {
+        readerTaskHandle = nullptr;
+        Serial.println("[Playback] ERROR: No se pudo crear tarea lectora");
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// CONTROL
+// ============================================================================
+bool PlaybackModel::open(const char* newPath) {
+    if (readerTaskHandle == nullptr || newPath == nullptr) return false;
+    if (strlen(newPath) >= PLAYBACK_MAX_PATH) return false;
+
+    close();
+
+    // El generador no consume mientras tanto (señal detenida)
+    strcpy(path, newPath);
+    resetDecoder();
+    readIndex = 0;
+    readPos = 0;
+    state.store(PlaybackState::OPENING, std::memory_order_release);
+
+    // Esperar a que el lector valide la cabecera y llene el primer buffer
+    uint32_t startMs = millis();
+    while (millis() - startMs < PLAYBACK_OPEN_TIMEOUT_MS) {
+        PlaybackState current = getState();
+        if (current == PlaybackState::ERROR) return false;
+        if (current == PlaybackState::PLAYING &&
+            bufferState[0].load(std::memory_order_acquire) == BUF_READY) {
+            Serial.printf("[Playback] %s: %s @ %u Hz (condición %u)\n",
+                          path, signalTypeToString(signalType),
+                          sampleRateHz, conditionId);
+            return true;
+        }
+        vTaskDelay(pdMS_TO_TICKS(PLAYBACK_READER_PERIOD_MS));
+    }
+
+    Serial.println("[Playback] ERROR: el lector no respondió");
+    close();
+    return false;
+}
+
+void PlaybackModel::close() {
+    PlaybackState current = getState();
+    if (current == PlaybackState::IDLE) return;
+    if (current == PlaybackState::ERROR) {
+        state.store(PlaybackState::IDLE, std::memory_order_release);
+        return;
+    }
+
+    state.store(PlaybackState::CLOSING, std::memory_order_release);
+    uint32_t startMs = millis();
+    while (getState() == PlaybackState::CLOSING &&
+           millis() - startMs < PLAYBACK_OPEN_TIMEOUT_MS) {
+        vTaskDelay(pdMS_TO_TICKS(PLAYBACK_READER_PERIOD_MS));
+    }
+}
+
+const char* PlaybackModel::getStateName(PlaybackState s) {
+    switch (s) {
+        case PlaybackState::IDLE:    return "IDLE";
+        case PlaybackState::OPENING: return "OPENING";
+        case PlaybackState::PLAYING: return "PLAYING";
+        case PlaybackState::CLOSING: return "CLOSING";
+        case PlaybackState::ERROR:   return "ERROR";
+        default:                     return "UNKNOWN";
+    }
+}
+
+// ============================================================================
+// LADO GENERADOR
+// ============================================================================
+void PlaybackModel::generateBlock(const SampleBlock& out, size_t n) {
+    // Misma escala DAC que el modelo que produjo la grabación
+    float (*toLevel)(float);
+    switch (signalType) {
+        case SignalType::EMG: toLevel = EMGModel::voltageToDACLevel; break;
+        case SignalType::PPG: toLevel = PPGModel::acValueToDACLevel; break;
+        default:              toLevel = ECGModel::mvToDACLevel; break;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        if (decodeSample(lastMV)) {
+            stats.samplesPlayed++;
+        } else {
+            stats.underruns++;      // Se repite la última muestra
+        }
+
+        float level = toLevel(lastMV);
+        uint8_t code = (uint8_t)level;
+        if (out.dac)        out.dac[i] = code;
+        if (out.dacLevel)   out.dacLevel[i] = level;
+        if (out.valueMV)    out.valueMV[i] = lastMV;
+        if (out.wave0)      out.wave0[i] = code;
+        if (out.wave1)      out.wave1[i] = 0;
+        if (out.envelopeMV) out.envelopeMV[i] = 0.0f;
+    }
+}
+
+void PlaybackModel::resetDecoder() {
+    headerPos = 0;
+    stage = STAGE_HEADER;
+    skipBytes = 0;
+    samplesLeft = 0;
+    uvPerLsb = RECORDER_UV_PER_LSB;
+    firstInBlock = true;
+    varint = 0;
+    varintShift = 0;
+    lastValue = 0;
+    lastMV = 0.0f;
+}
+
+/**
+ * @brief Siguiente byte del stream
+ * @return false si el lector aún no entregó el buffer (underrun)
+ */
+bool PlaybackModel::nextByte(uint8_t& b) {
+    // Un buffer READY pertenece al generador hasta que lo libera
+    if (readPos == 0 &&
+        bufferState[readIndex].load(std::memory_order_acquire) != BUF_READY) {
+        return false;
+    }
+
+    b = buffers[readIndex][readPos++];
+    if (readPos >= bufferLength[readIndex]) {
+        readPos = 0;
+        bufferState[readIndex].store(BUF_FREE, std::memory_order_release);
+        readIndex ^= 1;
+    }
+    return true;
+}
+
+/**
+ * @brief Valida la cabecera acumulada y prepara la lectura del bloque
+ * @return false si no empieza con el magic (se resincroniza byte a byte)
+ */
+bool PlaybackModel::parseHeader() {
+    uint32_t magic;
+    uint16_t fs, count, payload;
+    memcpy(&magic, header, 4);
+    if (magic != RECORDER_BLOCK_MAGIC || header[4] != RECORDER_BLOCK_VERSION) return false;
+
+    memcpy(&fs, header + 8, 2);
+    memcpy(&count, header + 10, 2);
+    memcpy(&payload, header + 20, 2);
+    memcpy(&uvPerLsb, header + 22, 2);
+
+    skipBytes = header[7];          // Snapshot de parámetros: no se usa
+    samplesLeft = count;
+    firstInBlock = true;
+
+    // Otra señal u otra Fs: escala/remuestreo no válidos, saltar el bloque
+    if (header[5] != (uint8_t)signalType || fs != sampleRateHz) {
+        skipBytes += payload;
+        samplesLeft = 0;
+        stats.skippedBlocks++;
+    }
+    return true;
+}
+
+bool PlaybackModel::decodeSample(float& mV) {
+    uint8_t b;
+    while (nextByte(b)) {
+        switch (stage) {
+            case STAGE_HEADER:
+                header[headerPos++] = b;
+                if (headerPos < RECORDER_HEADER_SIZE) break;
+                if (!parseHeader()) {
+                    memmove(header, header + 1, RECORDER_HEADER_SIZE - 1);
+                    headerPos = RECORDER_HEADER_SIZE - 1;
+                    break;
+                }
+                headerPos = 0;
+                stage = (skipBytes > 0) ? STAGE_SKIP
+                      : (samplesLeft > 0) ? STAGE_SAMPLES : STAGE_HEADER;
+                break;
+
+            case STAGE_SKIP:
+                if (--skipBytes == 0) {
+                    stage = (samplesLeft > 0) ? STAGE_SAMPLES : STAGE_HEADER;
+                }
+                break;
+
+            case STAGE_SAMPLES: {
+                varint |= (uint32_t)(b & 0x7F) << varintShift;
+                if (b & 0x80) {
+                    varintShift += 7;
+                    if (varintShift > 28) {     // Varint de más de 5 bytes: corrupto
+                        varint = 0;
+                        varintShift = 0;
+                        stage = STAGE_HEADER;
+                        stats.skippedBlocks++;
+                    }
+                    break;
+                }
+
+                int32_t delta = (int32_t)(varint >> 1) ^ -(int32_t)(varint & 1);
+                lastValue = firstInBlock ? delta : lastValue + delta;
+                firstInBlock = false;
+                varint = 0;
+                varintShift = 0;
+                if (--samplesLeft == 0) stage = STAGE_HEADER;
+
+                mV = (float)lastValue * (float)uvPerLsb * 0.001f;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// ============================================================================
+// TAREA LECTORA (baja prioridad)
+// ============================================================================
+void PlaybackModel::readerTask(void* parameter) {
+    PlaybackModel* self = static_cast<PlaybackModel*>(parameter);
+
+    while (true) {
+        self->readerCycle();
+        vTaskDelay(pdMS_TO_TICKS(PLAYBACK_READER_PERIOD_MS));
+    }
+}
+
+/**
+ * @brief Lee y valida la cabecera del primer bloque (identidad del archivo)
+ */
+bool PlaybackModel::readFirstHeader() {
+    uint8_t first[RECORDER_HEADER_SIZE];
+    if (playbackFileRead(first, RECORDER_HEADER_SIZE) != RECORDER_HEADER_SIZE) return false;
+
+    uint32_t magic;
+    uint16_t fs;
+    memcpy(&magic, first, 4);
+    memcpy(&fs, first + 8, 2);
+    if (magic != RECORDER_BLOCK_MAGIC || first[4] != RECORDER_BLOCK_VERSION) return false;
+    if (first[5] < (uint8_t)SignalType::ECG || first[5] > (uint8_t)SignalType::PPG) return false;
+    if (fs == 0 || fs > FS_TIMER_HZ) return false;
+
+    signalType = (SignalType)first[5];
+    conditionId = first[6];
+    sampleRateHz = fs;
+    return playbackFileRewind();
+}
+
+void PlaybackModel::readerCycle() {
+    PlaybackState current = getState();
+
+    if (current == PlaybackState::OPENING) {
+        playbackFileClose();
+        if (!playbackFileOpen(path) || !readFirstHeader()) {
+            Serial.printf("[Playback] ERROR: %s no es una grabación válida\n", path);
+            playbackFileClose();
+            state.store(PlaybackState::ERROR, std::memory_order_release);
+            return;
+        }
+        memset(&stats, 0, sizeof(stats));
+        bufferState[0].store(BUF_FREE, std::memory_order_relaxed);
+        bufferState[1].store(BUF_FREE, std::memory_order_relaxed);
+        fillIndex = 0;
+        PlaybackState expected = PlaybackState::OPENING;
+        if (!state.compare_exchange_strong(expected, PlaybackState::PLAYING)) return;
+    } else if (current == PlaybackState::CLOSING) {
+        playbackFileClose();
+        state.store(PlaybackState::IDLE, std::memory_order_release);
+        return;
+    } else if (current != PlaybackState::PLAYING) {
+        return;
+    }
+
+    // Leer por adelantado en el orden en que el generador consume
+    while (bufferState[fillIndex].load(std::memory_order_acquire) == BUF_FREE) {
+        size_t len = playbackFileRead(buffers[fillIndex], PLAYBACK_READ_CHUNK);
+        if (len == 0) {
+            // Fin de archivo: volver al principio (reproducción en bucle)
+            if (!playbackFileRewind() ||
+                (len = playbackFileRead(buffers[fillIndex], PLAYBACK_READ_CHUNK)) == 0) {
+                Serial.println("[Playback] ERROR: lectura fallida");
+                playbackFileClose();
+                state.store(PlaybackState::ERROR, std::memory_order_release);
+                return;
+            }
+            stats.loops++;
+        }
+        bufferLength[fillIndex] = (uint16_t)len;
+        bufferState[fillIndex].store(BUF_READY, std::memory_order_release);
+        fillIndex ^= 1;
+    }
+}
@@ -18,14 +18,15 @@
 
 #include "models/ppg_model.h"
 #include "config.h"
+#include "core/trace_ring.h"
 #include <math.h>
-#include <esp_random.h>
 
 // ============================================================================
 // CONSTRUCTOR
 // ============================================================================
 PPGModel::PPGModel() {
     hasPendingParams = false;
+    rngSeed = RNG_SEED_PPG;
     reset();
 }
 
@@ -38,9 +39,8 @@ void PPGModel::reset() {
     motionNoise = 0.0f;
     baselineWander = 0.0f;
     
-    // Reset generador gaussiano
-    gaussHasSpare = false;
-    gaussSpare = 0.0f;
+    // Generador aleatorio: misma semilla → misma secuencia tras cada reset
+    rng.seed(rngSeed);
     
     // Valores iniciales (se actualizan con initConditionRanges)
     currentHR = 75.0f;
@@ -60,6 +60,7 @@ void PPGModel::reset() {
     diastolicWidth = PPG_DIASTOLIC_WIDTH;           // 0.10
     dicroticDepth = PPG_BASE_DICROTIC_DEPTH;        // 0.25
     dicroticWidth = PPG_NOTCH_WIDTH;                // 0.02
+    rebuildPulseTable();
     
     // Calcular tiempos de fase iniciales
     systoleFraction = calculateSystoleFraction(currentHR);
@@ -92,6 +93,19 @@ void PPGModel::reset() {
     filterChain.configureForPPG(250.0f, 60.0f);  // 250 Hz, notch 60 Hz
     filterChain.reset();
     filteringEnabled = false;  // Deshabilitado - usuario activa si necesita
+    
+    // Descartar cambios pendientes y lo publicado antes del reset
+    hasPendingParams = false;
+    paramMailbox.discard();
+    
+    // Rampas en reposo en los valores actuales
+    dcBaselineTarget.store(dcBaseline, std::memory_order_relaxed);
+    waveformGainTarget.store(params.amplification, std::memory_order_relaxed);
+    dcBaselineRamp.reset(dcBaseline);
+    waveformGainRamp.reset(params.amplification);
+    noiseRamp.reset(params.noiseLevel);
+    piRamp.reset(currentPI);
+    rampsActive = false;
 }
 
 // ============================================================================
@@ -208,11 +222,60 @@ void PPGModel::setParameters(const PPGParameters& newParams) {
     measuredRRInterval_ms = currentRR * 1000.0f;
     measuredSystoleTime_ms = systoleTime;
     measuredDiastoleTime_ms = diastoleTime;
+    
+    // Reconfiguración completa: sin rampa desde los valores anteriores
+    waveformGainTarget.store(params.amplification, std::memory_order_relaxed);
+    waveformGainRamp.reset(params.amplification);
+    noiseRamp.reset(params.noiseLevel);
+    piRamp.reset(currentPI);
 }
 
 void PPGModel::setPendingParameters(const PPGParameters& newParams) {
-    pendingParams = newParams;
-    hasPendingParams = true;
+    paramMailbox.publish(newParams);
+}
+
+// ============================================================================
+// RAMPAS TIPO A (una evaluación por bloque, interpolación por muestra)
+// ============================================================================
+void PPGModel::advanceRamps(size_t n, float deltaTime) {
+    dcBaselineRamp.setTarget(dcBaselineTarget.load(std::memory_order_relaxed), rampConfig);
+    waveformGainRamp.setTarget(waveformGainTarget.load(std::memory_order_relaxed), rampConfig);
+    
+    // Valor al inicio del bloque (escalón de duración 0 ya aplicado)
+    float blockTime = (float)n * deltaTime;
+    if (noiseRamp.beginBlock(n, blockTime)) params.noiseLevel = noiseRamp.getValue();
+    if (piRamp.beginBlock(n, blockTime)) currentPI = piRamp.getValue();
+    if (dcBaselineRamp.beginBlock(n, blockTime)) dcBaseline = dcBaselineRamp.getValue();
+    if (waveformGainRamp.beginBlock(n, blockTime)) params.amplification = waveformGainRamp.getValue();
+    rampsActive = noiseRamp.isActive() || piRamp.isActive() ||
+                  dcBaselineRamp.isActive() || waveformGainRamp.isActive();
+}
+
+void PPGModel::stepRamps() {
+    if (noiseRamp.isActive()) params.noiseLevel = noiseRamp.next();
+    if (piRamp.isActive()) currentPI = piRamp.next();
+    if (dcBaselineRamp.isActive()) dcBaseline = dcBaselineRamp.next();
+    if (waveformGainRamp.isActive()) params.amplification = waveformGainRamp.next();
+}
+
+void PPGModel::pollParameters() {
+    PPGParameters next;
+    if (!paramMailbox.take(next)) {
+        return;
+    }
+    TRACE_INSTANT(PARAM_APPLIED, ((uint32_t)SignalType::PPG << 8) | 'A');
+    
+    // Tipo A: rampa desde el siguiente bloque (no cambian la forma del pulso)
+    if (next.noiseLevel != params.noiseLevel) setNoiseLevel(next.noiseLevel);
+    if (next.perfusionIndex != params.perfusionIndex) setPerfusionIndex(next.perfusionIndex);
+    
+    // Tipo B: condición, HR o muesca → siguiente latido (la amplificación es
+    // la ganancia de waveform: setWaveformGain, con rampa)
+    if (next.condition != params.condition || next.heartRate != params.heartRate ||
+        next.dicroticNotch != params.dicroticNotch) {
+        pendingParams = next;
+        hasPendingParams = true;
+    }
 }
 
 // ============================================================================
@@ -221,6 +284,11 @@ void PPGModel::setPendingParameters(const PPGParameters& newParams) {
 // PI controla amplitud AC; forma y muesca según tabla clínica
 // ============================================================================
 void PPGModel::applyConditionModifiers() {
+    const float prevSystolicAmplitude = systolicAmplitude;
+    const float prevDiastolicAmplitude = diastolicAmplitude;
+    const float prevDicroticDepth = dicroticDepth;
+    const float prevSystolicWidth = systolicWidth;
+    
     // Amplitudes según condición (base Allen, ajustadas por patología)
     systolicAmplitude = condRanges.systolicAmpl;
     diastolicAmplitude = condRanges.diastolicAmpl;
@@ -233,6 +301,15 @@ void PPGModel::applyConditionModifiers() {
     diastolicWidth = PPG_DIASTOLIC_WIDTH;
     dicroticWidth = PPG_NOTCH_WIDTH;
     
+    // Reconstruir la tabla solo si cambió la forma
+    if (!pulseTableValid ||
+        systolicAmplitude != prevSystolicAmplitude ||
+        diastolicAmplitude != prevDiastolicAmplitude ||
+        dicroticDepth != prevDicroticDepth ||
+        systolicWidth != prevSystolicWidth) {
+        rebuildPulseTable();
+    }
+    
     motionNoise = 0.0f;
 }
 
@@ -243,7 +320,7 @@ void PPGModel::applyConditionModifiers() {
 float PPGModel::generateDynamicHR() {
     // Valor medio aleatorio dentro del rango de la condición
     float hrRange = condRanges.hrMax - condRanges.hrMin;
-    float hrBase = condRanges.hrMin + (esp_random() / (float)UINT32_MAX) * hrRange;
+    float hrBase = condRanges.hrMin + rng.uniform() * hrRange;
     
     // Variabilidad gaussiana (sigma = mean * CV)
     float sigma = hrBase * condRanges.hrCV;
@@ -264,7 +341,7 @@ float PPGModel::generateDynamicHR() {
 float PPGModel::generateDynamicPI() {
     // Valor medio aleatorio dentro del rango de la condición
     float piRange = condRanges.piMax - condRanges.piMin;
-    float piBase = condRanges.piMin + (esp_random() / (float)UINT32_MAX) * piRange;
+    float piBase = condRanges.piMin + rng.uniform() * piRange;
     
     // Variabilidad gaussiana (sigma = mean * CV)
     float sigma = piBase * condRanges.piCV;
@@ -321,7 +398,7 @@ float PPGModel::generateNextRR() {
     
     // Para arritmia: latidos ectópicos ocasionales
     if (params.condition == PPGCondition::ARRHYTHMIA) {
-        if (esp_random() % 100 < 15) {
+        if (rng.below(100) < 15) {
             rrMean *= 0.7f;  // Latido prematuro
         }
     }
@@ -342,9 +419,11 @@ float PPGModel::generateNextRR() {
 // Retorna forma NORMALIZADA [0, 1]
 // ============================================================================
 float PPGModel::computePulseShape(float phase) {
-    // Normalizar fase a 0-1
-    phase = fmodf(phase, 1.0f);
-    if (phase < 0) phase += 1.0f;
+    // Normalizar fase a 0-1 (1.0 exacto se conserva: punto de guarda de la tabla)
+    if (phase < 0.0f || phase > 1.0f) {
+        phase = fmodf(phase, 1.0f);
+        if (phase < 0) phase += 1.0f;
+    }
     
     // Pico sistólico (gaussiana principal)
     float systolic = systolicAmplitude * 
@@ -367,6 +446,31 @@ float PPGModel::computePulseShape(float phase) {
     return pulse;
 }
 
+// ============================================================================
+// TABLA DE FORMA DEL PULSO
+// ============================================================================
+/**
+ * Evalúa computePulseShape() en PPG_WAVETABLE_SIZE + 1 fases equiespaciadas
+ * (la última es fase 1.0 para interpolar el tramo final sin envolver).
+ * Coste: 3 expf × 1025 una vez por cambio de forma, no por muestra.
+ */
+void PPGModel::rebuildPulseTable() {
+    const float step = 1.0f / (float)PPG_WAVETABLE_SIZE;
+    for (int i = 0; i <= PPG_WAVETABLE_SIZE; i++) {
+        pulseTable[i] = computePulseShape((float)i * step);
+    }
+    pulseTableValid = true;
+}
+
+float PPGModel::samplePulseTable(float phase) const {
+    float pos = phase * (float)PPG_WAVETABLE_SIZE;
+    int i = (int)pos;
+    if (i < 0) i = 0;
+    if (i >= PPG_WAVETABLE_SIZE) i = PPG_WAVETABLE_SIZE - 1;
+    float frac = pos - (float)i;
+    return pulseTable[i] + (pulseTable[i + 1] - pulseTable[i]) * frac;
+}
+
 // ============================================================================
 // NORMALIZACIÓN DEL PULSO A [0, 1]
 // ============================================================================
@@ -387,18 +491,27 @@ float PPGModel::normalizePulse(float rawPulse) {
 // ============================================================================
 void PPGModel::detectBeatAndApplyPending() {
     beatCount++;
+    TRACE_INSTANT(BEAT, beatCount);
     
     // Aplicar parámetros pendientes
+    // Solo HR (slider): setHeartRate conserva la forma de la condición
     if (hasPendingParams) {
-        setParameters(pendingParams);
+        TRACE_INSTANT(PARAM_APPLIED, ((uint32_t)SignalType::PPG << 8) | 'B');
+        if (pendingParams.condition == params.condition &&
+            pendingParams.dicroticNotch == params.dicroticNotch) {
+            setHeartRate(pendingParams.heartRate);
+        } else {
+            setParameters(pendingParams);
+        }
         hasPendingParams = false;
     }
     
     // Generar nuevo RR (incluye actualización de HR dinámico)
     currentRR = generateNextRR();
     
-    // Actualizar PI dinámico
+    // Actualizar PI dinámico (el pulso está en el valle: sin escalón)
     currentPI = generateDynamicPI();
+    piRamp.reset(currentPI);
     
     // Actualizar métricas medidas basadas en el modelo (para display inmediato)
     // Esto asegura que RR y otras métricas estén disponibles desde el primer latido
@@ -410,6 +523,10 @@ void PPGModel::detectBeatAndApplyPending() {
 // Flujo: pulseShape[0,1] → AC = PI * scale → signal = DC + pulse * AC
 // ============================================================================
 float PPGModel::generateSample(float deltaTime) {
+    if (rampsActive) {
+        stepRamps();
+    }
+    
     // Avanzar fase dentro del ciclo cardíaco
     phaseInCycle += deltaTime / currentRR;
     
@@ -419,8 +536,8 @@ float PPGModel::generateSample(float deltaTime) {
         detectBeatAndApplyPending();
     }
     
-    // 1. Calcular forma del pulso NORMALIZADA [0, 1]
-    float pulse = computePulseShape(phaseInCycle);
+    // 1. Forma del pulso NORMALIZADA [0, 1] (tabla precalculada)
+    float pulse = samplePulseTable(phaseInCycle);
     
     // 2. Calcular amplitud AC basada ÚNICAMENTE en PI dinámico
     // AC = PI * AC_SCALE_PER_PI (mV)
@@ -547,6 +664,44 @@ uint8_t PPGModel::getDACValue(float deltaTime) {
     return acValueToDACValue(lastACValue);
 }
 
+// ============================================================================
+// GENERACIÓN POR BLOQUES
+// ============================================================================
+void PPGModel::generateBlock(float* out, size_t n, float deltaTime) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = generateSample(deltaTime);
+    }
+}
+
+void PPGModel::generateBlockDAC(uint8_t* out, size_t n, float deltaTime) {
+    for (size_t i = 0; i < n; i++) {
+        generateSample(deltaTime);
+        out[i] = acValueToDACValue(lastACValue);
+    }
+}
+
+void PPGModel::generateBlockDisplay(uint8_t* out, size_t n, float deltaTime) {
+    for (size_t i = 0; i < n; i++) {
+        generateSample(deltaTime);
+        out[i] = getWaveformValue();
+    }
+}
+
+void PPGModel::generateBlock(const SampleBlock& out, size_t n, float deltaTime) {
+    for (size_t i = 0; i < n; i++) {
+        generateSample(deltaTime);
+        
+        float level = acValueToDACLevel(lastACValue);
+        
+        if (out.dac)        out.dac[i] = (uint8_t)level;
+        if (out.dacLevel)   out.dacLevel[i] = level;
+        if (out.valueMV)    out.valueMV[i] = lastACValue;
+        if (out.wave0)      out.wave0[i] = getWaveformValue();
+        if (out.wave1)      out.wave1[i] = 0;
+        if (out.envelopeMV) out.envelopeMV[i] = 0.0f;
+    }
+}
+
 uint8_t PPGModel::voltageToDACValue(float voltage) {
     // Mantener para compatibilidad - mapea señal completa DC+AC
     float rangeMin = dcBaseline - 200.0f;
@@ -562,7 +717,7 @@ uint8_t PPGModel::voltageToDACValue(float voltage) {
     return (uint8_t)(normalized * 255.0f);
 }
 
-uint8_t PPGModel::acValueToDACValue(float acValue_mV) {
+float PPGModel::acValueToDACLevel(float acValue_mV) {
     // Mapeo de componente AC pura a DAC 8-bit
     // Fórmula: PI = (AC / DC) × 100%  →  AC = PI × DC / 100
     // Con DC = 1500 mV:  AC = PI × 15 mV
@@ -576,7 +731,11 @@ uint8_t PPGModel::acValueToDACValue(float acValue_mV) {
     
     float normalized = acValue_mV / AC_MAX_MV;
     normalized = constrain(normalized, 0.0f, 1.0f);
-    return (uint8_t)(normalized * 255.0f);
+    return normalized * 255.0f;
+}
+
+uint8_t PPGModel::acValueToDACValue(float acValue_mV) {
+    return (uint8_t)acValueToDACLevel(acValue_mV);
 }
 
 // ============================================================================
@@ -604,26 +763,6 @@ float PPGModel::getDiastoleTime() const {
 // HELPERS
 // ============================================================================
 
-float PPGModel::gaussianRandom(float mean, float std) {
-    if (gaussHasSpare) {
-        gaussHasSpare = false;
-        return mean + std * gaussSpare;
-    }
-    
-    float u, v, s;
-    do {
-        u = (esp_random() / (float)UINT32_MAX) * 2.0f - 1.0f;
-        v = (esp_random() / (float)UINT32_MAX) * 2.0f - 1.0f;
-        s = u * u + v * v;
-    } while (s >= 1.0f || s == 0.0f);
-    
-    s = sqrtf(-2.0f * logf(s) / s);
-    gaussSpare = v * s;
-    gaussHasSpare = true;
-    
-    return mean + std * u * s;
-}
-
 bool PPGModel::isInSystole() const {
     return (phaseInCycle < systoleFraction);
 }
@@ -0,0 +1,640 @@
+/**
+ * @file dataset_gen.cpp
+ * @brief Generador offline de datasets sintéticos etiquetados (host, multihilo)
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ *
+ * Usar: pio run -e native_dataset && .pio/build/native_dataset/program [opciones]
+ *
+ * Ejecuta los mismos ECGModel / EMGModel / PPGModel del firmware, sin motor ni
+ * DAC, tan rápido como da el host. Cada trabajo es una combinación
+ *
+ *   señal × condición × valor de barrido × ruido × semilla
+ *
+ * y escribe dos CSV en el directorio de salida:
+ *
+ *   <señal>_c<cond>_<barrido>_n<ruido>_s<semilla>.csv      sample,t_s,mV
+ *   <señal>_c<cond>_<barrido>_n<ruido>_s<semilla>.ann.csv  sample,t_s,label,id,value
+ *
+ * Etiquetas:
+ * - ECG: "R" en la muestra donde la fase θ cruza el centro de la onda R
+ *        (ECGModel::getRWavePhase(); id = número de latido, value = mV). El
+ *        latido se cuenta en θ = 0, que en BAV1 cae ~150 ms antes del pico R
+ *        (PR prolongado desplaza Q-R-S-T): por eso la etiqueta no usa el
+ *        contador. En Fib. Ventricular no hay onda R: "F" marca los
+ *        pseudo-latidos del contador (cada VFIB_BEAT_INTERVAL_S)
+ * - PPG: "onset" al inicio de cada ciclo (detectBeatAndApplyPending)
+ * - EMG: "mu" en cada disparo de unidad motora (id = MU, value = amplitud mV),
+ *        vía EMGModel::setFiringCallback()
+ *
+ * manifest.csv resume todos los trabajos (condición, parámetros, muestras,
+ * etiquetas y fichero).
+ *
+ * HILOS: cada trabajador toma el siguiente trabajo de un índice atómico y crea
+ * su propio modelo; no hay estado mutable compartido entre modelos (semilla
+ * propia, sin micros() ni esp_random()), así que la salida es idéntica con
+ * cualquier --threads y el rendimiento escala con los cores. Compilar con
+ * TRACE_ENABLED = 0 y PERF_COUNTERS_ENABLED = 0 (entorno native_dataset): el
+ * ring de trazas y los contadores son globales.
+ *
+ * Opciones:
+ *   --signal ecg|emg|ppg|all       Señales a generar (por defecto all)
+ *   --conditions 0,2,5|all         Índices de condición (por defecto all)
+ *   --seconds S                    Segundos de señal por trabajo (60)
+ *   --seeds N                      Semillas por combinación (1)
+ *   --seed-base B                  Primera semilla (1000)
+ *   --hr a:b:paso | a,b,...        Barrido de FC para ECG/PPG (BPM)
+ *   --excitation a:b:paso | a,...  Barrido de excitación EMG (0-1)
+ *   --noise a:b:paso | a,...       Barrido de nivel de ruido (0-1)
+ *   --threads N                    Hilos (por defecto hardware_concurrency)
+ *   --out DIR                      Directorio de salida (dataset)
+ *   --check                        Verifica que cada "R" de los trabajos sin
+ *                                  ruido esté a ±2 muestras del máximo local
+ */
+
+#include <Arduino.h>
+#include "hal_native.h"
+#include "config.h"
+#include "data/signal_types.h"
+#include "models/ecg_model.h"
+#include "models/emg_model.h"
+#include "models/ppg_model.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if TRACE_ENABLED || PERF_COUNTERS_ENABLED
+#warning "dataset_gen: trazas/contadores globales activos, compilar con TRACE_ENABLED=0 y PERF_COUNTERS_ENABLED=0"
+#endif
+
+// ============================================================================
+// CONFIGURACIÓN
+// ============================================================================
+static const float DATASET_DEFAULT_SECONDS = 60.0f;
+static const uint32_t DATASET_DEFAULT_SEED_BASE = 1000;
+static const size_t DATASET_FILE_BUFFER = 1 << 16;     // Buffer stdio por fichero
+static const float DATASET_CHECK_WINDOW_S = 0.1f;       // Búsqueda del máximo local (±)
+static const uint32_t DATASET_CHECK_TOLERANCE = 2;      // Muestras entre "R" y el máximo
+
+struct DatasetOptions {
+    bool signals[3];                    // ECG, EMG, PPG
+    std::vector<uint8_t> conditions;    // Vacío = todas
+    float seconds;
+    uint32_t seeds;
+    uint32_t seedBase;
+    std::vector<float> heartRates;      // Vacío = FC de la condición
+    std::vector<float> excitations;     // Vacío = excitación por defecto
+    std::vector<float> noiseLevels;     // Vacío = sin ruido
+    uint32_t threads;
+    std::string outDir;
+    bool check;                         // Verificar la posición de las etiquetas R
+};
+
+struct DatasetJob {
+    SignalType signal;
+    uint8_t condition;
+    bool hasSweep;          // false = valor por defecto de la condición
+    float sweepValue;       // FC (ECG/PPG) o excitación (EMG)
+    float noiseLevel;
+    uint32_t seed;
+
+    // Resultado (solo lo escribe el hilo que ejecuta el trabajo)
+    uint32_t samples;
+    uint32_t labels;
+    int32_t labelError;     // Máx. |R - máximo local| en muestras; -1 = sin verificar
+    bool ok;
+    std::string file;
+};
+
+// ============================================================================
+// PARSEO DE OPCIONES
+// ============================================================================
+/**
+ * @brief Lee "a:b:paso" (rango inclusivo) o "a,b,c" (lista)
+ */
+static bool parseSweep(const char* text, std::vector<float>& out) {
+    out.clear();
+    float a, b, step;
+    if (sscanf(text, "%f:%f:%f", &a, &b, &step) == 3) {
+        if (step <= 0.0f || b < a) return false;
+        uint32_t n = (uint32_t)floorf((b - a) / step + 1e-4f) + 1;
+        for (uint32_t i = 0; i < n; i++) out.push_back(a + i * step);
+        return true;
+    }
+
+    std::string s(text);
+    size_t pos = 0;
+    while (pos <= s.size()) {
+        size_t comma = s.find(',', pos);
+        if (comma == std::string::npos) comma = s.size();
+        std::string item = s.substr(pos, comma - pos);
+        char* end;
+        float v = strtof(item.c_str(), &end);
+        if (item.empty() || *end != '\0') return false;
+        out.push_back(v);
+        pos = comma + 1;
+    }
+    return !out.empty();
+}
+
+static bool parseConditions(const char* text, std::vector<uint8_t>& out) {
+    out.clear();
+    if (strcmp(text, "all") == 0) return true;
+    std::vector<float> values;
+    if (!parseSweep(text, values)) return false;
+    for (float v : values) {
+        if (v < 0.0f || v > 255.0f) return false;
+        out.push_back((uint8_t)v);
+    }
+    return true;
+}
+
+static void printUsage(const char* program) {
+    printf("Uso: %s [--signal ecg|emg|ppg|all] [--conditions 0,2|all] [--seconds S]\n"
+           "          [--seeds N] [--seed-base B] [--hr a:b:paso] [--excitation a:b:paso]\n"
+           "          [--noise a,b,...] [--threads N] [--out DIR] [--check]\n", program);
+}
+
+static bool parseOptions(int argc, char** argv, DatasetOptions& opt) {
+    opt.signals[0] = opt.signals[1] = opt.signals[2] = true;
+    opt.seconds = DATASET_DEFAULT_SECONDS;
+    opt.seeds = 1;
+    opt.seedBase = DATASET_DEFAULT_SEED_BASE;
+    opt.threads = std::thread::hardware_concurrency();
+    if (opt.threads == 0) opt.threads = 1;
+    opt.outDir = "dataset";
+    opt.check = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* val = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) return false;
+        if (strcmp(arg, "--check") == 0) {
+            opt.check = true;
+            continue;
+        }
+        if (!val) {
+            fprintf(stderr, "Falta valor para %s\n", arg);
+            return false;
+        }
+        i++;
+
+        if (strcmp(arg, "--signal") == 0) {
+            bool all = strcmp(val, "all") == 0;
+            opt.signals[0] = all || strcmp(val, "ecg") == 0;
+            opt.signals[1] = all || strcmp(val, "emg") == 0;
+            opt.signals[2] = all || strcmp(val, "ppg") == 0;
+            if (!opt.signals[0] && !opt.signals[1] && !opt.signals[2]) {
+                fprintf(stderr, "Señal desconocida: %s\n", val);
+                return false;
+            }
+        } else if (strcmp(arg, "--conditions") == 0) {
+            if (!parseConditions(val, opt.conditions)) {
+                fprintf(stderr, "Condiciones inválidas: %s\n", val);
+                return false;
+            }
+        } else if (strcmp(arg, "--seconds") == 0) {
+            opt.seconds = (float)atof(val);
+            if (opt.seconds <= 0.0f) opt.seconds = DATASET_DEFAULT_SECONDS;
+        } else if (strcmp(arg, "--seeds") == 0) {
+            opt.seeds = (uint32_t)atoi(val);
+            if (opt.seeds == 0) opt.seeds = 1;
+        } else if (strcmp(arg, "--seed-base") == 0) {
+            opt.seedBase = (uint32_t)strtoul(val, nullptr, 0);
+        } else if (strcmp(arg, "--threads") == 0) {
+            opt.threads = (uint32_t)atoi(val);
+            if (opt.threads == 0) opt.threads = 1;
+        } else if (strcmp(arg, "--hr") == 0 || strcmp(arg, "--excitation") == 0 ||
+                   strcmp(arg, "--noise") == 0) {
+            std::vector<float>& dst = (arg[2] == 'h') ? opt.heartRates
+                                    : (arg[2] == 'e') ? opt.excitations : opt.noiseLevels;
+            if (!parseSweep(val, dst)) {
+                fprintf(stderr, "Barrido inválido para %s: %s\n", arg, val);
+                return false;
+            }
+        } else if (strcmp(arg, "--out") == 0) {
+            opt.outDir = val;
+        } else {
+            fprintf(stderr, "Opción desconocida: %s\n", arg);
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// LISTA DE TRABAJOS
+// ============================================================================
+static uint8_t getConditionCount(SignalType signal) {
+    switch (signal) {
+        case SignalType::ECG: return (uint8_t)ECGCondition::COUNT;
+        case SignalType::EMG: return (uint8_t)EMGCondition::COUNT;
+        case SignalType::PPG: return (uint8_t)PPGCondition::COUNT;
+        default:              return 0;
+    }
+}
+
+static const char* getConditionName(SignalType signal, uint8_t condition) {
+    switch (signal) {
+        case SignalType::ECG: return ecgConditionToString((ECGCondition)condition);
+        case SignalType::EMG: return emgConditionToString((EMGCondition)condition);
+        case SignalType::PPG: return ppgConditionToString((PPGCondition)condition);
+        default:              return "NONE";
+    }
+}
+
+static void buildJobs(const DatasetOptions& opt, std::vector<DatasetJob>& jobs) {
+    static const SignalType SIGNALS[3] = { SignalType::ECG, SignalType::EMG, SignalType::PPG };
+
+    for (uint8_t s = 0; s < 3; s++) {
+        if (!opt.signals[s]) continue;
+        SignalType signal = SIGNALS[s];
+        uint8_t conditionCount = getConditionCount(signal);
+
+        std::vector<uint8_t> conditions = opt.conditions;
+        if (conditions.empty()) {
+            for (uint8_t c = 0; c < conditionCount; c++) conditions.push_back(c);
+        }
+
+        // Sin barrido: un único valor "por defecto" (no NAN: -ffast-math anula isnan)
+        std::vector<float> sweep = (signal == SignalType::EMG) ? opt.excitations : opt.heartRates;
+        bool hasSweep = !sweep.empty();
+        if (!hasSweep) sweep.push_back(0.0f);
+        std::vector<float> noise = opt.noiseLevels;
+        if (noise.empty()) noise.push_back(0.0f);
+
+        for (uint8_t c : conditions) {
+            if (c >= conditionCount) continue;
+            for (float v : sweep) {
+                for (float n : noise) {
+                    for (uint32_t k = 0; k < opt.seeds; k++) {
+                        DatasetJob job;
+                        job.signal = signal;
+                        job.condition = c;
+                        job.hasSweep = hasSweep;
+                        job.sweepValue = v;
+                        job.noiseLevel = n;
+                        job.seed = opt.seedBase + k;
+                        job.samples = 0;
+                        job.labels = 0;
+                        job.labelError = -1;
+                        job.ok = false;
+                        jobs.push_back(job);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// ============================================================================
+// SALIDA POR TRABAJO
+// ============================================================================
+/**
+ * @brief Par de ficheros (muestras + anotaciones) de un trabajo
+ * @note Propiedad exclusiva del hilo que ejecuta el trabajo
+ */
+struct JobWriter {
+    FILE* data;
+    FILE* ann;
+    float sampleRate;
+    uint32_t sample;        // Índice de la muestra en generación
+    uint32_t labels;
+
+    JobWriter() : data(nullptr), ann(nullptr), sampleRate(1.0f), sample(0), labels(0) {}
+    ~JobWriter() {
+        if (data) fclose(data);
+        if (ann) fclose(ann);
+    }
+
+    bool open(const std::string& basePath, float fs) {
+        sampleRate = fs;
+        data = fopen((basePath + ".csv").c_str(), "w");
+        ann = fopen((basePath + ".ann.csv").c_str(), "w");
+        if (!data || !ann) return false;
+        setvbuf(data, nullptr, _IOFBF, DATASET_FILE_BUFFER);
+        setvbuf(ann, nullptr, _IOFBF, DATASET_FILE_BUFFER);
+        fprintf(data, "sample,t_s,mV\n");
+        fprintf(ann, "sample,t_s,label,id,value\n");
+        return true;
+    }
+
+    void writeSample(float mV) {
+        fprintf(data, "%lu,%.5f,%.5f\n", (unsigned long)sample, sample / sampleRate, mV);
+    }
+
+    void writeLabel(const char* label, uint32_t id, float value) {
+        fprintf(ann, "%lu,%.5f,%s,%lu,%.5f\n", (unsigned long)sample, sample / sampleRate,
+                label, (unsigned long)id, value);
+        labels++;
+    }
+
+    bool close() {
+        bool ok = (fclose(data) == 0) & (fclose(ann) == 0);
+        data = ann = nullptr;
+        return ok;
+    }
+};
+
+static void onEMGFiring(void* context, uint16_t unit, float amplitude) {
+    static_cast<JobWriter*>(context)->writeLabel("mu", unit, amplitude);
+}
+
+static std::string makeBasePath(const std::string& dir, const DatasetJob& job) {
+    char sweep[24];
+    if (!job.hasSweep) {
+        snprintf(sweep, sizeof(sweep), "def");
+    } else if (job.signal == SignalType::EMG) {
+        snprintf(sweep, sizeof(sweep), "ex%.2f", job.sweepValue);
+    } else {
+        snprintf(sweep, sizeof(sweep), "hr%.0f", job.sweepValue);
+    }
+
+    char name[96];
+    snprintf(name, sizeof(name), "%s_c%u_%s_n%.2f_s%lu", signalTypeToString(job.signal),
+             (unsigned)job.condition, sweep, job.noiseLevel, (unsigned long)job.seed);
+    for (char* p = name; *p; p++) *p = (char)tolower(*p);
+    return dir + "/" + name;
+}
+
+// ============================================================================
+// EJECUCIÓN DE UN TRABAJO (modelo propio, misma secuencia que SignalEngine)
+// ============================================================================
+static uint32_t getSampleCount(SignalType signal, float seconds) {
+    switch (signal) {
+        case SignalType::ECG: return (uint32_t)(seconds * MODEL_SAMPLE_RATE_ECG);
+        case SignalType::EMG: return (uint32_t)(seconds * MODEL_SAMPLE_RATE_EMG);
+        case SignalType::PPG: return (uint32_t)(seconds * MODEL_SAMPLE_RATE_PPG);
+        default:              return 0;
+    }
+}
+
+/**
+ * @brief true si θ pasó por target entre dos muestras (con salto ±π)
+ */
+static bool crossesPhase(float from, float to, float target) {
+    float a = from - target;
+    float b = to - target;
+    if (a > PI) a -= 2.0f * PI;
+    if (a <= -PI) a += 2.0f * PI;
+    if (b > PI) b -= 2.0f * PI;
+    if (b <= -PI) b += 2.0f * PI;
+    return a < 0.0f && b >= 0.0f;
+}
+
+/**
+ * @brief Máxima distancia (muestras) entre cada etiqueta y el máximo local
+ *        de la señal en ±window
+ */
+static int32_t measurePeakLabelError(const std::vector<float>& trace,
+                                     const std::vector<uint32_t>& peaks, uint32_t window) {
+    int32_t worst = 0;
+    for (uint32_t s : peaks) {
+        // Latidos al borde del registro: la ventana quedaría truncada
+        if (s < window || s + window >= trace.size()) continue;
+        uint32_t best = s;
+        for (uint32_t i = s - window; i <= s + window; i++) {
+            if (trace[i] > trace[best]) best = i;
+        }
+        int32_t error = (int32_t)best - (int32_t)s;
+        if (error < 0) error = -error;
+        if (error > worst) worst = error;
+    }
+    return worst;
+}
+
+static void runECGJob(DatasetJob& job, JobWriter& out, uint32_t samples, bool check) {
+    std::unique_ptr<ECGModel> model(new ECGModel());
+    model->setSeed(job.seed);
+    model->reset();
+    ECGParameters params;
+    params.condition = (ECGCondition)job.condition;
+    if (job.hasSweep) params.heartRate = job.sweepValue;
+    params.noiseLevel = job.noiseLevel;
+    model->setParameters(params);
+
+    // Con ruido el máximo local no es el pico R: solo se verifican trabajos limpios
+    bool vfib = params.condition == ECGCondition::VENTRICULAR_FIBRILLATION;
+    bool verify = check && !vfib && job.noiseLevel <= 0.0f;
+    std::vector<float> trace;
+    std::vector<uint32_t> peaks;
+    if (verify) trace.reserve(samples);
+
+    uint32_t lastBeat = model->getBeatCount();
+    float lastPhase = model->getPhase();
+    for (out.sample = 0; out.sample < samples; out.sample++) {
+        float mV = model->generateSample(MODEL_DT_ECG);
+        out.writeSample(mV);
+        if (verify) trace.push_back(mV);
+
+        if (vfib) {
+            uint32_t beat = model->getBeatCount();
+            if (beat != lastBeat) {
+                out.writeLabel("F", beat, mV);
+                lastBeat = beat;
+            }
+            continue;
+        }
+
+        float phase = model->getPhase();
+        if (crossesPhase(lastPhase, phase, model->getRWavePhase())) {
+            out.writeLabel("R", model->getBeatCount(), mV);
+            if (verify) peaks.push_back(out.sample);
+        }
+        lastPhase = phase;
+    }
+
+    if (verify) {
+        uint32_t window = (uint32_t)(DATASET_CHECK_WINDOW_S * MODEL_SAMPLE_RATE_ECG);
+        job.labelError = measurePeakLabelError(trace, peaks, window);
+    }
+}
+
+static void runEMGJob(DatasetJob& job, JobWriter& out, uint32_t samples) {
+    std::unique_ptr<EMGModel> model(new EMGModel());
+    model->setSeed(job.seed);
+    model->reset();
+    EMGParameters params;
+    params.condition = (EMGCondition)job.condition;
+    if (job.hasSweep) params.excitationLevel = job.sweepValue;
+    params.noiseLevel = job.noiseLevel;
+    model->setParameters(params);
+    model->setFiringCallback(onEMGFiring, &out);
+
+    for (out.sample = 0; out.sample < samples; out.sample++) {
+        model->tick(MODEL_DT_EMG);
+        out.writeSample(model->getRawSample());
+    }
+    model->setFiringCallback(nullptr, nullptr);
+}
+
+static void runPPGJob(DatasetJob& job, JobWriter& out, uint32_t samples) {
+    std::unique_ptr<PPGModel> model(new PPGModel());
+    model->setSeed(job.seed);
+    model->reset();
+    PPGParameters params;
+    params.condition = (PPGCondition)job.condition;
+    if (job.hasSweep) params.heartRate = job.sweepValue;
+    params.noiseLevel = job.noiseLevel;
+    model->setParameters(params);
+
+    uint32_t lastBeat = model->getBeatCount();
+    for (out.sample = 0; out.sample < samples; out.sample++) {
+        float mV = model->generateSample(MODEL_DT_PPG);
+        out.writeSample(mV);
+        uint32_t beat = model->getBeatCount();
+        if (beat != lastBeat) {
+            out.writeLabel("onset", beat, mV);
+            lastBeat = beat;
+        }
+    }
+}
+
+static void runJob(DatasetJob& job, const DatasetOptions& opt) {
+    uint32_t samples = getSampleCount(job.signal, opt.seconds);
+    std::string basePath = makeBasePath(opt.outDir, job);
+    job.file = basePath.substr(opt.outDir.size() + 1) + ".csv";
+
+    float fs = (job.signal == SignalType::ECG) ? MODEL_SAMPLE_RATE_ECG
+             : (job.signal == SignalType::EMG) ? MODEL_SAMPLE_RATE_EMG : MODEL_SAMPLE_RATE_PPG;
+    JobWriter out;
+    if (!out.open(basePath, fs)) {
+        fprintf(stderr, "No se pudo crear %s.csv: %s\n", basePath.c_str(), strerror(errno));
+        return;
+    }
+
+    switch (job.signal) {
+        case SignalType::ECG: runECGJob(job, out, samples, opt.check); break;
+        case SignalType::EMG: runEMGJob(job, out, samples); break;
+        case SignalType::PPG: runPPGJob(job, out, samples); break;
+        default: break;
+    }
+
+    job.samples = samples;
+    job.labels = out.labels;
+    job.ok = out.close();
+}
+
+// ============================================================================
+// MANIFIESTO
+// ============================================================================
+static bool writeManifest(const DatasetOptions& opt, const std::vector<DatasetJob>& jobs) {
+    std::string path = opt.outDir + "/manifest.csv";
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f) return false;
+
+    fprintf(f, "file,signal,condition,condition_name,fs_hz,sweep,sweep_value,noise,seed,samples,labels\n");
+    for (const DatasetJob& job : jobs) {
+        if (!job.ok) continue;
+        uint32_t fs = getSampleCount(job.signal, 1.0f);
+        const char* sweepName = (job.signal == SignalType::EMG) ? "excitation" : "heart_rate";
+        char sweepValue[16] = "";
+        if (job.hasSweep) snprintf(sweepValue, sizeof(sweepValue), "%.3f", job.sweepValue);
+        fprintf(f, "%s,%s,%u,\"%s\",%lu,%s,%s,%.3f,%lu,%lu,%lu\n",
+                job.file.c_str(), signalTypeToString(job.signal), (unsigned)job.condition,
+                getConditionName(job.signal, job.condition), (unsigned long)fs, sweepName,
+                sweepValue, job.noiseLevel, (unsigned long)job.seed,
+                (unsigned long)job.samples, (unsigned long)job.labels);
+    }
+    return fclose(f) == 0;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main(int argc, char** argv) {
+    DatasetOptions opt;
+    if (!parseOptions(argc, argv, opt)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Los modelos solo imprimen diagnóstico por Serial: no mezclarlo con el informe
+    halNativeSetSerialEnabled(false);
+
+    if (mkdir(opt.outDir.c_str(), 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "No se pudo crear %s: %s\n", opt.outDir.c_str(), strerror(errno));
+        return 1;
+    }
+
+    std::vector<DatasetJob> jobs;
+    buildJobs(opt, jobs);
+    if (jobs.empty()) {
+        fprintf(stderr, "Sin trabajos: revisar --signal / --conditions\n");
+        return 1;
+    }
+
+    uint32_t threadCount = opt.threads;
+    if (threadCount > jobs.size()) threadCount = (uint32_t)jobs.size();
+
+    printf("BioSignalSimulator Pro - generador de datasets (%zu trabajos, %.1f s por trabajo, %u hilos)\n",
+           jobs.size(), opt.seconds, threadCount);
+
+    // Único estado compartido: el índice del siguiente trabajo
+    std::atomic<size_t> nextJob(0);
+    auto worker = [&]() {
+        for (;;) {
+            size_t i = nextJob.fetch_add(1, std::memory_order_relaxed);
+            if (i >= jobs.size()) break;
+            runJob(jobs[i], opt);
+        }
+    };
+
+    uint64_t t0 = halNativeNanos();
+    std::vector<std::thread> pool;
+    for (uint32_t t = 0; t < threadCount; t++) pool.emplace_back(worker);
+    for (std::thread& th : pool) th.join();
+    uint64_t elapsedNs = halNativeNanos() - t0;
+
+    uint64_t totalSamples = 0;
+    uint64_t totalLabels = 0;
+    double signalSeconds = 0.0;
+    uint32_t failed = 0;
+    uint32_t checked = 0;
+    uint32_t misplaced = 0;
+    for (const DatasetJob& job : jobs) {
+        if (!job.ok) {
+            failed++;
+            continue;
+        }
+        if (job.labelError >= 0) {
+            checked++;
+            if ((uint32_t)job.labelError > DATASET_CHECK_TOLERANCE) {
+                misplaced++;
+                fprintf(stderr, "R desplazada %ld muestras: %s (%s)\n", (long)job.labelError,
+                        job.file.c_str(), getConditionName(job.signal, job.condition));
+            }
+        }
+        totalSamples += job.samples;
+        totalLabels += job.labels;
+        signalSeconds += (double)job.samples / getSampleCount(job.signal, 1.0f);
+    }
+
+    if (!writeManifest(opt, jobs)) {
+        fprintf(stderr, "No se pudo escribir %s/manifest.csv\n", opt.outDir.c_str());
+        failed++;
+    }
+
+    double seconds = elapsedNs / 1e9;
+    printf("%-24s %14s %14s %12s %14s\n", "Salida", "muestras", "etiquetas", "tiempo s", "muestras/s");
+    printf("%-24s %14llu %14llu %12.2f %14.0f\n", opt.outDir.c_str(),
+           (unsigned long long)totalSamples, (unsigned long long)totalLabels, seconds,
+           seconds > 0.0 ? totalSamples / seconds : 0.0);
+    printf("Señal generada: %.1f s (x%.0f tiempo real)%s\n", signalSeconds,
+           seconds > 0.0 ? signalSeconds / seconds : 0.0, failed ? "  CON ERRORES" : "");
+    if (opt.check) {
+        printf("Verificación R: %u trabajos, %u fuera de ±%u muestras\n",
+               checked, misplaced, DATASET_CHECK_TOLERANCE);
+    }
+
+    return (failed || misplaced) ? 1 : 0;
+}
@@ -0,0 +1,324 @@
+/**
+ * @file hal_native.cpp
+ * @brief Implementación del HAL de host para el entorno [env:native]
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ *
+ * Sustituye Arduino-ESP32, esp_random y FreeRTOS por equivalentes de la
+ * biblioteca estándar para compilar modelos, filtros y motor en el PC.
+ */
+
+#include <Arduino.h>
+#include <esp_random.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include "hal_native.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+// ============================================================================
+// INSTANCIAS GLOBALES
+// ============================================================================
+HardwareSerial Serial;
+EspClass ESP;
+
+// ============================================================================
+// ESTADO DEL HAL
+// ============================================================================
+static bool simulatedClock = false;
+static std::atomic<uint64_t> simTime_us(0);
+static const std::chrono::steady_clock::time_point bootTime = std::chrono::steady_clock::now();
+
+static volatile uint8_t lastDAC = 128;
+static uint32_t dacWrites = 0;
+
+static uint32_t rngState = 0x9E3779B9u;
+static bool serialEnabled = true;
+
+struct hw_timer_s {
+    void (*isr)(void);
+    uint64_t alarmValue;
+    bool enabled;
+    bool inUse;
+};
+
+static hw_timer_s timers[4];
+
+// ============================================================================
+// TIEMPO
+// ============================================================================
+static uint64_t hostMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - bootTime).count();
+}
+
+uint32_t micros() {
+    return simulatedClock ? (uint32_t)simTime_us.load() : (uint32_t)hostMicros();
+}
+
+uint32_t millis() {
+    return simulatedClock ? (uint32_t)(simTime_us.load() / 1000) : (uint32_t)(hostMicros() / 1000);
+}
+
+void delay(uint32_t ms) {
+    if (simulatedClock) {
+        simTime_us += (uint64_t)ms * 1000;
+    } else {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    }
+}
+
+void delayMicroseconds(uint32_t us) {
+    if (simulatedClock) {
+        simTime_us += us;
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    }
+}
+
+void yield() {
+    if (!simulatedClock) {
+        std::this_thread::yield();
+    }
+}
+
+void halNativeUseSimulatedClock(bool enabled) {
+    if (enabled && !simulatedClock) {
+        simTime_us = hostMicros();
+    }
+    simulatedClock = enabled;
+}
+
+void halNativeAdvanceMicros(uint32_t us) {
+    simTime_us += us;
+}
+
+uint64_t halNativeNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Ciclos de un ESP32 a getCpuFreqMHz() en el tiempo real transcurrido
+// (no el reloj simulado): perf_counters mide igual en host y en placa
+uint32_t EspClass::getCycleCount() {
+    return (uint32_t)(halNativeNanos() * getCpuFreqMHz() / 1000);
+}
+
+// ============================================================================
+// GPIO / DAC / ADC
+// ============================================================================
+void pinMode(uint8_t pin, uint8_t mode) { (void)pin; (void)mode; }
+void digitalWrite(uint8_t pin, uint8_t value) { (void)pin; (void)value; }
+int digitalRead(uint8_t pin) { (void)pin; return LOW; }
+
+uint16_t analogRead(uint8_t pin) {
+    (void)pin;
+    // Loopback ideal: DAC 8 bits → ADC 12 bits
+    return (uint16_t)lastDAC << 4;
+}
+
+void dacWrite(uint8_t pin, uint8_t value) {
+    (void)pin;
+    lastDAC = value;
+    dacWrites++;
+}
+
+uint8_t halNativeGetLastDAC() {
+    return lastDAC;
+}
+
+uint32_t halNativeGetDACWrites() {
+    return dacWrites;
+}
+
+// ============================================================================
+// TIMER HARDWARE
+// ============================================================================
+hw_timer_t* timerBegin(uint8_t num, uint16_t divider, bool countUp) {
+    (void)divider;
+    (void)countUp;
+    if (num >= 4) return nullptr;
+    timers[num].isr = nullptr;
+    timers[num].alarmValue = 0;
+    timers[num].enabled = false;
+    timers[num].inUse = true;
+    return &timers[num];
+}
+
+void timerEnd(hw_timer_t* timer) {
+    if (timer) {
+        timer->enabled = false;
+        timer->inUse = false;
+    }
+}
+
+void timerAttachInterrupt(hw_timer_t* timer, void (*fn)(void), bool edge) {
+    (void)edge;
+    if (timer) timer->isr = fn;
+}
+
+void timerDetachInterrupt(hw_timer_t* timer) {
+    if (timer) timer->isr = nullptr;
+}
+
+void timerAlarmWrite(hw_timer_t* timer, uint64_t alarmValue, bool autoreload) {
+    (void)autoreload;
+    if (timer) timer->alarmValue = alarmValue;
+}
+
+void timerAlarmEnable(hw_timer_t* timer) {
+    if (timer) timer->enabled = true;
+}
+
+void timerAlarmDisable(hw_timer_t* timer) {
+    if (timer) timer->enabled = false;
+}
+
+uint32_t halNativeFireTimer(uint32_t count) {
+    for (hw_timer_s& t : timers) {
+        if (t.inUse && t.enabled && t.isr) {
+            for (uint32_t i = 0; i < count; i++) {
+                t.isr();
+            }
+            return count;
+        }
+    }
+    return 0;
+}
+
+// ============================================================================
+// RNG
+// ============================================================================
+uint32_t esp_random(void) {
+    // xorshift32
+    uint32_t x = rngState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rngState = x;
+    return x;
+}
+
+void halNativeSeedRandom(uint32_t seed) {
+    rngState = seed ? seed : 0x9E3779B9u;
+    srand(seed);
+}
+
+// ============================================================================
+// SERIAL
+// ============================================================================
+void halNativeSetSerialEnabled(bool enabled) {
+    serialEnabled = enabled;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    if (!serialEnabled) return 1;
+    return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    if (!serialEnabled) return size;
+    return fwrite(buffer, 1, size, stdout);
+}
+
+size_t HardwareSerial::print(const char* s) {
+    if (!serialEnabled) return strlen(s);
+    return fputs(s, stdout) >= 0 ? strlen(s) : 0;
+}
+
+size_t HardwareSerial::print(char c) { return write((uint8_t)c); }
+size_t HardwareSerial::print(int value) { return printf("%d", value); }
+size_t HardwareSerial::print(unsigned int value) { return printf("%u", value); }
+size_t HardwareSerial::print(long value) { return printf("%ld", value); }
+size_t HardwareSerial::print(unsigned long value) { return printf("%lu", value); }
+size_t HardwareSerial::print(double value, int digits) { return printf("%.*f", digits, value); }
+
+size_t HardwareSerial::println() { return print("\r\n"); }
+size_t HardwareSerial::println(const char* s) { return print(s) + println(); }
+size_t HardwareSerial::println(int value) { return print(value) + println(); }
+size_t HardwareSerial::println(unsigned int value) { return print(value) + println(); }
+size_t HardwareSerial::println(long value) { return print(value) + println(); }
+size_t HardwareSerial::println(unsigned long value) { return print(value) + println(); }
+size_t HardwareSerial::println(double value, int digits) { return print(value, digits) + println(); }
+
+size_t HardwareSerial::printf(const char* format, ...) {
+    if (!serialEnabled) return 0;
+    va_list args;
+    va_start(args, format);
+    int n = vfprintf(stdout, format, args);
+    va_end(args);
+    return n > 0 ? (size_t)n : 0;
+}
+
+// ============================================================================
+// FREERTOS: TAREAS
+// ============================================================================
+struct NativeTask {
+    std::thread thread;
+};
+
+// Core "asignado" al hilo; el principal hace de loop de Arduino (Core 1)
+static thread_local BaseType_t nativeCoreId = 1;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t taskCode, const char* name,
+                                   uint32_t stackDepth, void* parameter,
+                                   UBaseType_t priority, TaskHandle_t* createdTask,
+                                   BaseType_t coreId) {
+    (void)name;
+    (void)stackDepth;
+    (void)priority;
+    NativeTask* task = new NativeTask();
+    task->thread = std::thread([taskCode, parameter, coreId]() {
+        nativeCoreId = coreId;
+        taskCode(parameter);
+    });
+    task->thread.detach();
+    if (createdTask) *createdTask = task;
+    return pdPASS;
+}
+
+BaseType_t xPortGetCoreID() {
+    return nativeCoreId;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    delay(ticks * portTICK_PERIOD_MS);
+}
+
+TickType_t xTaskGetTickCount() {
+    return millis() / portTICK_PERIOD_MS;
+}
+
+// ============================================================================
+// FREERTOS: SEMÁFOROS
+// ============================================================================
+struct NativeSemaphore {
+    std::timed_mutex mutex;
+};
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return new NativeSemaphore();
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+    if (!semaphore) return pdFALSE;
+    if (ticksToWait == portMAX_DELAY) {
+        semaphore->mutex.lock();
+        return pdTRUE;
+    }
+    return semaphore->mutex.try_lock_for(std::chrono::milliseconds(ticksToWait)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    if (!semaphore) return pdFALSE;
+    semaphore->mutex.unlock();
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    delete semaphore;
+}
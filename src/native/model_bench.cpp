@@ -0,0 +1,437 @@
+/**
+ * @file model_bench.cpp
+ * @brief Benchmark de host: costo por muestra de modelos, filtros y motor
+ * @version 1.0.0
+ * @date 20 Enero 2026
+ *
+ * Usar: pio run -e native && .pio/build/native/program [segundos]
+ *
+ * Para cada condición de ECG, EMG y PPG mide:
+ * - Modelo:  ns por muestra del modelo y muestras/s (m/s) a Fs_modelo
+ * - Motor:   ns por muestra DAC (Fs_timer) a través de processGeneration()
+ *            con reloj simulado y SimulatedSink consumiendo como el DAC
+ * - Margen:  muestras/s del motor respecto a FS_TIMER_HZ (×tiempo real)
+ *
+ * Además mide SignalFilterChain (HP→LP→Notch) para cada tipo de señal,
+ * muestra a muestra y por bloques de MODEL_BLOCK_SIZE (processBlock).
+ *
+ * Integrador ECG: compara ANALYTIC_PHASE con LIMIT_CYCLE en cada condición
+ * (ns por muestra mientras integra en vivo y error máximo/RMS en mV). Un
+ * latido detectado una muestra antes (θ ≈ 0 en el borde) cuenta como >10 uV.
+ *
+ * Pipeline DAC: valida DACPipelineT<Q15Format> contra DACPipelineT<FloatFormat>
+ * con los mismos niveles de modelo (SNR en dB respecto a la salida float).
+ *
+ * Con PERF_COUNTERS_ENABLED imprime además los contadores por etapa del
+ * motor acumulados en todas las condiciones (mismo informe que el comando 'p').
+ */
+
+#include <Arduino.h>
+#include <esp_random.h>
+#include "hal_native.h"
+#include "config.h"
+#include "data/signal_types.h"
+#include "core/signal_engine.h"
+#include "core/digital_filters.h"
+#include "core/dac_pipeline.h"
+#include "core/perf_counters.h"
+#include "models/ecg_model.h"
+#include "models/emg_model.h"
+#include "models/ppg_model.h"
+#include "hw/simulated_sink.h"
+#include <math.h>
+#include <vector>
+
+// ============================================================================
+// CONFIGURACIÓN
+// ============================================================================
+static const float BENCH_DEFAULT_SECONDS = 10.0f;  // Segundos de señal simulada por condición
+static const uint32_t BENCH_SEED = 12345;
+
+static float benchSeconds = BENCH_DEFAULT_SECONDS;
+static volatile float benchSink = 0.0f;             // Evita que el compilador elimine el trabajo
+
+// ============================================================================
+// REPORTE
+// ============================================================================
+static void printHeader(const char* title) {
+    printf("\n%s\n", title);
+    printf("%-8s %-24s %12s %14s %12s %14s %10s\n",
+           "Senal", "Condicion", "modelo ns", "modelo m/s", "motor ns", "motor m/s", "x RT");
+}
+
+static void printFilterHeader(const char* title) {
+    printf("\n%s\n", title);
+    printf("%-8s %-24s %12s %14s\n", "Senal", "Etapa", "ns/muestra", "muestras/s");
+}
+
+static void printRow(const char* signal, const char* condition,
+                     uint64_t modelNs, uint32_t modelSamples,
+                     uint64_t engineNs, uint32_t engineSamples) {
+    double modelNsPerSample = modelSamples ? (double)modelNs / modelSamples : 0.0;
+    double engineNsPerSample = engineSamples ? (double)engineNs / engineSamples : 0.0;
+    double modelRate = modelNs ? modelSamples * 1e9 / modelNs : 0.0;
+    double engineRate = engineNs ? engineSamples * 1e9 / engineNs : 0.0;
+    printf("%-8s %-24s %12.1f %14.0f %12.1f %14.0f %10.1f\n",
+           signal, condition, modelNsPerSample, modelRate,
+           engineNsPerSample, engineRate, engineRate / FS_TIMER_HZ);
+}
+
+// ============================================================================
+// BENCHMARK DE MODELO (generateBlockDAC directo, sin motor)
+// ============================================================================
+static uint64_t benchECGModel(uint8_t condition, uint32_t samples) {
+    static ECGModel model;
+    model.reset();
+    ECGParameters params;
+    params.condition = (ECGCondition)condition;
+    model.setParameters(params);
+
+    uint8_t block[MODEL_BLOCK_SIZE];
+    uint64_t t0 = halNativeNanos();
+    for (uint32_t i = 0; i < samples; i += MODEL_BLOCK_SIZE) {
+        halNativeAdvanceMicros(MODEL_TICK_US_ECG * MODEL_BLOCK_SIZE);
+        model.generateBlockDAC(block, MODEL_BLOCK_SIZE, MODEL_DT_ECG);
+        benchSink = benchSink + block[MODEL_BLOCK_SIZE - 1];
+    }
+    return halNativeNanos() - t0;
+}
+
+static uint64_t benchEMGModel(uint8_t condition, uint32_t samples) {
+    static EMGModel model;
+    model.reset();
+    EMGParameters params;
+    params.condition = (EMGCondition)condition;
+    model.setParameters(params);
+
+    uint8_t block[MODEL_BLOCK_SIZE];
+    uint64_t t0 = halNativeNanos();
+    for (uint32_t i = 0; i < samples; i += MODEL_BLOCK_SIZE) {
+        halNativeAdvanceMicros(MODEL_TICK_US_EMG * MODEL_BLOCK_SIZE);
+        model.generateBlockDAC(block, MODEL_BLOCK_SIZE, MODEL_DT_EMG);
+        benchSink = benchSink + block[MODEL_BLOCK_SIZE - 1];
+    }
+    return halNativeNanos() - t0;
+}
+
+static uint64_t benchPPGModel(uint8_t condition, uint32_t samples) {
+    static PPGModel model;
+    model.reset();
+    PPGParameters params;
+    params.condition = (PPGCondition)condition;
+    model.setParameters(params);
+
+    uint8_t block[MODEL_BLOCK_SIZE];
+    uint64_t t0 = halNativeNanos();
+    for (uint32_t i = 0; i < samples; i += MODEL_BLOCK_SIZE) {
+        halNativeAdvanceMicros(MODEL_TICK_US_PPG * MODEL_BLOCK_SIZE);
+        model.generateBlockDAC(block, MODEL_BLOCK_SIZE, MODEL_DT_PPG);
+        benchSink = benchSink + block[MODEL_BLOCK_SIZE - 1];
+    }
+    return halNativeNanos() - t0;
+}
+
+// ============================================================================
+// BENCHMARK DEL MOTOR (processGeneration + SimulatedSink)
+// ============================================================================
+/**
+ * @brief Ejecuta el motor completo durante benchSeconds de tiempo simulado
+ * @param samplesOut Muestras DAC consumidas por la ISR
+ * @return Tiempo de host en ns
+ */
+static uint64_t benchEngine(SignalType type, uint8_t condition, uint32_t& samplesOut) {
+    SignalEngine* engine = SignalEngine::getInstance();
+    engine->startSignal(type, condition);
+
+    // Paso de 1 ms: el sink consume FS_TIMER_HZ/1000 muestras y el motor repone
+    const uint32_t stepUs = 1000;
+    const uint32_t samplesPerStep = FS_TIMER_HZ / 1000;
+    const uint32_t steps = (uint32_t)(benchSeconds * 1000.0f);
+
+    samplesOut = 0;
+    uint64_t t0 = halNativeNanos();
+    for (uint32_t i = 0; i < steps; i++) {
+        halNativeAdvanceMicros(stepUs);
+        samplesOut += simulatedSink.consume(samplesPerStep);
+        engine->processGeneration();
+    }
+    uint64_t elapsed = halNativeNanos() - t0;
+
+    engine->stopSignal();
+    return elapsed;
+}
+
+// ============================================================================
+// BENCHMARK DE FILTROS
+// ============================================================================
+static void benchFilterChain(const char* name, SignalFilterChain::SignalType type, float fs) {
+    SignalFilterChain chain;
+    switch (type) {
+        case SignalFilterChain::SignalType::ECG: chain.configureForECG(fs); break;
+        case SignalFilterChain::SignalType::EMG: chain.configureForEMG(fs); break;
+        case SignalFilterChain::SignalType::PPG: chain.configureForPPG(fs); break;
+    }
+
+    // Entrada precalculada: el tiempo medido es solo el del filtro
+    const uint32_t samples = (uint32_t)(benchSeconds * fs) / MODEL_BLOCK_SIZE * MODEL_BLOCK_SIZE;
+    std::vector<float> input(samples);
+    for (uint32_t i = 0; i < samples; i++) {
+        input[i] = sinf(2.0f * (float)PI * 10.0f * i / fs) + 0.1f * (float)(esp_random() & 0xFF) / 255.0f;
+    }
+
+    uint64_t t0 = halNativeNanos();
+    for (uint32_t i = 0; i < samples; i++) {
+        benchSink = benchSink + chain.process(input[i]);
+    }
+    uint64_t elapsed = halNativeNanos() - t0;
+
+    printf("%-8s %-24s %12.1f %14.0f\n", name, "SignalFilterChain",
+           (double)elapsed / samples, samples * 1e9 / elapsed);
+
+    // Misma señal por bloques
+    chain.reset();
+    float block[MODEL_BLOCK_SIZE];
+    t0 = halNativeNanos();
+    for (uint32_t i = 0; i < samples; i += MODEL_BLOCK_SIZE) {
+        chain.processBlock(&input[i], block, MODEL_BLOCK_SIZE);
+        benchSink = benchSink + block[MODEL_BLOCK_SIZE - 1];
+    }
+    elapsed = halNativeNanos() - t0;
+
+    printf("%-8s %-24s %12.1f %14.0f\n", name, "SignalFilterChain block",
+           (double)elapsed / samples, samples * 1e9 / elapsed);
+}
+
+// ============================================================================
+// INTEGRADOR ECG: FASE ANALÍTICA vs CICLO LÍMITE
+// ============================================================================
+/**
+ * @brief Ejecuta ambos integradores en paralelo sobre la misma condición
+ *
+ * El tiempo solo cuenta muestras con RK4 en vivo (antes de la plantilla),
+ * que es donde difieren; la plantilla se construye con el mismo integrador.
+ */
+static void benchECGIntegrator(uint8_t condition) {
+    static ECGModel reference;
+    static ECGModel analytic;
+    ECGParameters params;
+    params.condition = (ECGCondition)condition;
+    reference.setIntegrator(params.condition, ECGIntegrator::LIMIT_CYCLE);
+    analytic.setIntegrator(params.condition, ECGIntegrator::ANALYTIC_PHASE);
+    reference.reset();
+    analytic.reset();
+    reference.setParameters(params);
+    analytic.setParameters(params);
+
+    const uint32_t samples = (uint32_t)(benchSeconds * MODEL_SAMPLE_RATE_ECG);
+    uint64_t refNs = 0, anaNs = 0;
+    uint32_t liveSamples = 0, outliers = 0;
+    double maxErr = 0.0, sumSq = 0.0;
+    for (uint32_t i = 0; i < samples; i++) {
+        bool live = !reference.isUsingBeatTemplate() || !analytic.isUsingBeatTemplate();
+        uint64_t t0 = halNativeNanos();
+        float a = reference.generateSample(MODEL_DT_ECG);
+        uint64_t t1 = halNativeNanos();
+        float b = analytic.generateSample(MODEL_DT_ECG);
+        uint64_t t2 = halNativeNanos();
+        if (live) {
+            refNs += t1 - t0;
+            anaNs += t2 - t1;
+            liveSamples++;
+        }
+        double err = fabs((double)a - b);
+        if (err > maxErr) maxErr = err;
+        if (err > 0.01) outliers++;
+        sumSq += err * err;
+    }
+
+    printf("%-24s %10u %12.1f %12.1f %12.2e %12.2e %8u %7s\n",
+           ecgConditionToString((ECGCondition)condition), liveSamples,
+           liveSamples ? (double)refNs / liveSamples : 0.0,
+           liveSamples ? (double)anaNs / liveSamples : 0.0,
+           maxErr, sqrt(sumSq / samples), outliers,
+           reference.getBeatCount() == analytic.getBeatCount() ? "si" : "NO");
+}
+
+// ============================================================================
+// PIPELINE DAC: PUNTO FIJO vs FLOAT
+// ============================================================================
+/**
+ * @brief Niveles DAC sin cuantizar de benchSeconds de señal del modelo
+ */
+template <typename Model>
+static std::vector<float> modelLevels(Model& model, uint32_t fs) {
+    model.reset();
+    std::vector<float> levels((uint32_t)(benchSeconds * fs) / MODEL_BLOCK_SIZE * MODEL_BLOCK_SIZE);
+    SampleBlock block;
+    for (size_t i = 0; i < levels.size(); i += MODEL_BLOCK_SIZE) {
+        halNativeAdvanceMicros(MODEL_BLOCK_SIZE * 1000000UL / fs);
+        block.dacLevel = &levels[i];
+        model.generateBlock(block, MODEL_BLOCK_SIZE, 1.0f / fs);
+    }
+    return levels;
+}
+
+/**
+ * @brief Pasa los niveles por el pipeline a FS_TIMER_HZ
+ * @param out Salida antes de cuantizar (fracción de fondo de escala)
+ * @param codes Salida cuantizada (códigos DAC)
+ * @param lowpass true: biquad paso bajo de salida (prueba de la etapa Q31)
+ * @return ns por muestra de salida
+ */
+template <typename Format>
+static double runPipeline(const std::vector<float>& levels, uint32_t fs, bool lowpass,
+                          std::vector<float>& out, std::vector<uint8_t>& codes) {
+    static DACPipelineT<Format> pipeline;
+    pipeline.configure(fs, FS_TIMER_HZ);
+    pipeline.reset(DAC_CENTER_VALUE);
+    BiquadCascadeT<Format>& filter = pipeline.getOutputFilter();
+    if (lowpass) {
+        // Butterworth 2º orden (RBJ, Q = 1/√2) a 150 Hz: polos cerca de z = 1,
+        // el caso exigente para los coeficientes Q2.30
+        const float w0 = 2.0f * (float)M_PI * 150.0f / FS_TIMER_HZ;
+        const float alpha = sinf(w0) / (2.0f * 0.70710678f);
+        const float a0 = 1.0f + alpha;
+        const float b1 = (1.0f - cosf(w0)) / a0;
+        filter.setSection(0, 0.5f * b1, b1, 0.5f * b1,
+                          -2.0f * cosf(w0) / a0, (1.0f - alpha) / a0);
+        filter.setNumSections(1);
+    } else {
+        filter.setNumSections(0);
+    }
+
+    const size_t n = (size_t)((uint64_t)levels.size() * FS_TIMER_HZ / fs);
+    out.resize(n);
+    codes.resize(n);
+    size_t in = 0;
+    uint64_t t0 = halNativeNanos();
+    for (size_t i = 0; i < n; i++) {
+        while (pipeline.needsInput()) {
+            pipeline.pushLevel(levels[in < levels.size() - 1 ? in++ : in]);
+        }
+        typename Format::sample_t y = pipeline.nextSample();
+        codes[i] = Format::toCode(y);
+        out[i] = Format::toFloat(y);
+    }
+    return (double)(halNativeNanos() - t0) / n;
+}
+
+/**
+ * @brief SNR (dB) de test respecto a ref, sin la componente DC de ref
+ */
+static double snrDB(const std::vector<float>& ref, const std::vector<float>& test) {
+    double mean = 0.0;
+    for (float r : ref) mean += r;
+    mean /= ref.size();
+    double signal = 0.0, noise = 0.0;
+    for (size_t i = 0; i < ref.size(); i++) {
+        signal += (ref[i] - mean) * (ref[i] - mean);
+        noise += (double)(test[i] - ref[i]) * (test[i] - ref[i]);
+    }
+    return noise > 0.0 ? 10.0 * log10(signal / noise) : 999.0;
+}
+
+static std::vector<float> codesToFraction(const std::vector<uint8_t>& codes) {
+    std::vector<float> out(codes.size());
+    for (size_t i = 0; i < codes.size(); i++) {
+        out[i] = ((float)codes[i] - DAC_CENTER_VALUE) / DAC_CENTER_VALUE;
+    }
+    return out;
+}
+
+template <typename Model>
+static void benchDACPipeline(const char* name, Model& model, uint32_t fs) {
+    std::vector<float> levels = modelLevels(model, fs);
+
+    for (int lowpass = 0; lowpass <= 1; lowpass++) {
+        std::vector<float> refOut, fixOut;
+        std::vector<uint8_t> refCodes, fixCodes;
+        double floatNs = runPipeline<FloatFormat>(levels, fs, lowpass, refOut, refCodes);
+        double fixedNs = runPipeline<Q15Format>(levels, fs, lowpass, fixOut, fixCodes);
+
+        // Q15 antes de cuantizar, y códigos de 8 bits de ambos (cota: float cuantizado)
+        printf("%-8s %-14s %10.1f %10.1f %12.1f %12.1f %12.1f\n",
+               name, lowpass ? "FIR + LP Q31" : "FIR Q15", floatNs, fixedNs,
+               snrDB(refOut, fixOut),
+               snrDB(refOut, codesToFraction(fixCodes)),
+               snrDB(refOut, codesToFraction(refCodes)));
+    }
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        benchSeconds = (float)atof(argv[1]);
+        if (benchSeconds <= 0.0f) benchSeconds = BENCH_DEFAULT_SECONDS;
+    }
+
+    halNativeUseSimulatedClock(true);
+    halNativeSeedRandom(BENCH_SEED);
+    halNativeSetSerialEnabled(false);
+    SignalEngine::getInstance()->setOutputSink(OutputSinkType::SIMULATED);
+
+    printf("BioSignalSimulator Pro - benchmark nativo (%.1f s simulados por condición, Fs_timer=%u Hz)\n",
+           benchSeconds, FS_TIMER_HZ);
+
+    printHeader("MODELOS + MOTOR");
+
+    for (uint8_t c = 0; c < (uint8_t)ECGCondition::COUNT; c++) {
+        uint32_t samples = (uint32_t)(benchSeconds * MODEL_SAMPLE_RATE_ECG);
+        uint64_t modelNs = benchECGModel(c, samples);
+        uint32_t engineSamples;
+        uint64_t engineNs = benchEngine(SignalType::ECG, c, engineSamples);
+        printRow("ECG", ecgConditionToString((ECGCondition)c), modelNs, samples, engineNs, engineSamples);
+    }
+
+    for (uint8_t c = 0; c < (uint8_t)EMGCondition::COUNT; c++) {
+        uint32_t samples = (uint32_t)(benchSeconds * MODEL_SAMPLE_RATE_EMG);
+        uint64_t modelNs = benchEMGModel(c, samples);
+        uint32_t engineSamples;
+        uint64_t engineNs = benchEngine(SignalType::EMG, c, engineSamples);
+        printRow("EMG", emgConditionToString((EMGCondition)c), modelNs, samples, engineNs, engineSamples);
+    }
+
+    for (uint8_t c = 0; c < (uint8_t)PPGCondition::COUNT; c++) {
+        uint32_t samples = (uint32_t)(benchSeconds * MODEL_SAMPLE_RATE_PPG);
+        uint64_t modelNs = benchPPGModel(c, samples);
+        uint32_t engineSamples;
+        uint64_t engineNs = benchEngine(SignalType::PPG, c, engineSamples);
+        printRow("PPG", ppgConditionToString((PPGCondition)c), modelNs, samples, engineNs, engineSamples);
+    }
+
+#if PERF_COUNTERS_ENABLED
+    halNativeSetSerialEnabled(true);
+    perfCounters.printReport(Serial);
+    halNativeSetSerialEnabled(false);
+#endif
+
+    printFilterHeader("FILTROS");
+    benchFilterChain("ECG", SignalFilterChain::SignalType::ECG, MODEL_SAMPLE_RATE_ECG);
+    benchFilterChain("EMG", SignalFilterChain::SignalType::EMG, MODEL_SAMPLE_RATE_EMG);
+    benchFilterChain("PPG", SignalFilterChain::SignalType::PPG, MODEL_SAMPLE_RATE_PPG);
+
+    printf("\nINTEGRADOR ECG (ANALYTIC_PHASE vs LIMIT_CYCLE, error en mV)\n");
+    printf("%-24s %10s %12s %12s %12s %12s %8s %7s\n",
+           "Condicion", "En vivo", "ciclo ns", "fase ns", "Error max", "Error RMS", ">10 uV", "Latidos");
+    for (uint8_t c = 0; c < (uint8_t)ECGCondition::COUNT; c++) {
+        if ((ECGCondition)c == ECGCondition::VENTRICULAR_FIBRILLATION) continue;   // No integra
+        benchECGIntegrator(c);
+    }
+
+    printf("\nPIPELINE DAC (SNR en dB respecto a DACPipelineT<FloatFormat>)\n");
+    printf("%-8s %-14s %10s %10s %12s %12s %12s\n",
+           "Senal", "Etapas", "float ns", "Q15 ns", "SNR Q15", "SNR Q15 8b", "SNR float 8b");
+    static ECGModel ecg;
+    static EMGModel emg;
+    static PPGModel ppg;
+    EMGParameters emgParams;
+    emgParams.condition = EMGCondition::MODERATE_CONTRACTION;   // REST es casi plana
+    emg.setParameters(emgParams);
+    benchDACPipeline("ECG", ecg, MODEL_SAMPLE_RATE_ECG);
+    benchDACPipeline("EMG", emg, MODEL_SAMPLE_RATE_EMG);
+    benchDACPipeline("PPG", ppg, MODEL_SAMPLE_RATE_PPG);
+
+    return 0;
+}
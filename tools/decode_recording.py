@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Decodificador de grabaciones - BioSignalSimulator Pro
+=====================================================
+
+Convierte un archivo .bsr descargado de /api/record/download (grabador
+SignalRecorder, ver include/core/signal_recorder.h) a CSV.
+
+FORMATO:
+--------
+Bloques autocontenidos concatenados. Cabecera de 24 bytes (little-endian):
+magic "BSR1", versión, señal, condición, bytes de parámetros, Fs, N,
+índice de la primera muestra, semilla, bytes de payload, µV/LSB; después
+el snapshot de parámetros y N enteros zigzag-varint (primero absoluto,
+luego diferencias).
+
+USO:
+----
+    python decode_recording.py rec.bsr -o rec.csv
+    python decode_recording.py rec.bsr --info
+
+Autor: BioSignalSimulator Pro Team
+Fecha: Enero 2026
+"""
+
+import struct
+import sys
+
+HEADER = struct.Struct("<IBBBBHHIIHH")
+MAGIC = 0x31525342
+SIGNALS = {0: "NONE", 1: "ECG", 2: "EMG", 3: "PPG"}
+
+# Layout de ECG/EMG/PPGParameters (signal_types.h): floats + enum de condición
+PARAM_FIELDS = {
+    1: ("heartRate", "pWaveAmplitude", "qrsAmplitude", "tWaveAmplitude",
+        "stShift", "noiseLevel"),
+    2: ("excitationLevel", "amplitude", "noiseLevel"),
+    3: ("heartRate", "perfusionIndex", "dicroticNotch", "noiseLevel",
+        "amplification"),
+}
+
+
+def read_varint(data: bytes, pos: int):
+    result = 0
+    shift = 0
+    while True:
+        b = data[pos]
+        pos += 1
+        result |= (b & 0x7F) << shift
+        if b < 0x80:
+            return result, pos
+        shift += 7
+
+
+def decode_params(signal: int, raw: bytes) -> dict:
+    names = PARAM_FIELDS.get(signal, ())
+    if len(raw) < 4 * len(names):
+        return {}
+    values = struct.unpack_from("<%df" % len(names), raw)
+    return dict(zip(names, values))
+
+
+def decode_blocks(data: bytes):
+    """Genera (cabecera, parámetros, muestras en mV) por bloque."""
+    pos = 0
+    while pos + HEADER.size <= len(data):
+        (magic, version, signal, condition, param_bytes, fs, count,
+         first, seed, payload_bytes, uv_per_lsb) = HEADER.unpack_from(data, pos)
+        if magic != MAGIC:
+            raise ValueError("magic inválido en offset %d" % pos)
+        pos += HEADER.size
+        params = decode_params(signal, data[pos:pos + param_bytes])
+        pos += param_bytes
+
+        end = pos + payload_bytes
+        samples = []
+        value = 0
+        for i in range(count):
+            z, pos = read_varint(data, pos)
+            delta = (z >> 1) ^ -(z & 1)
+            value = delta if i == 0 else value + delta
+            samples.append(value * uv_per_lsb / 1000.0)
+        pos = end
+
+        header = {
+            "version": version, "signal": SIGNALS.get(signal, str(signal)),
+            "condition": condition, "fs": fs, "count": count,
+            "first": first, "seed": seed,
+        }
+        yield header, params, samples
+
+
+def main():
+    import argparse
+
+    parser = argparse.ArgumentParser(description="Decodifica grabaciones .bsr a CSV")
+    parser.add_argument("input", help="Archivo .bsr")
+    parser.add_argument("-o", "--output", help="CSV de salida (por defecto stdout)")
+    parser.add_argument("--info", action="store_true", help="Solo listar bloques")
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as f:
+        data = f.read()
+
+    out = None
+    if not args.info:
+        out = open(args.output, "w") if args.output else sys.stdout
+        out.write("t_s,signal,condition,value_mV\n")
+
+    expected = None
+    for header, params, samples in decode_blocks(data):
+        if args.info:
+            gap = ""
+            if expected is not None and header["first"] != expected:
+                gap = "  (hueco: %d muestras)" % (header["first"] - expected)
+            print("%s cond=%d fs=%d n=%d first=%d seed=0x%08X %s%s" % (
+                header["signal"], header["condition"], header["fs"], header["count"],
+                header["first"], header["seed"], params, gap))
+        else:
+            for i, v in enumerate(samples):
+                t = (header["first"] + i) / header["fs"]
+                out.write("%.6f,%s,%d,%.3f\n" % (t, header["signal"], header["condition"], v))
+        expected = header["first"] + header["count"]
+
+    if out is not None and out is not sys.stdout:
+        out.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Codificador de grabaciones - BioSignalSimulator Pro
+===================================================
+
+Convierte una columna de un CSV (p.ej. un registro MIT-BIH exportado con
+rdsamp/wfdb) a un archivo .bsr reproducible por PlaybackModel
+(ver include/models/playback_model.h). Es el formato inverso de
+decode_recording.py.
+
+La señal debe venir en mV y en la escala del modelo correspondiente
+(ECG: -0.5..1.5 mV, EMG: ±5 mV, PPG: componente AC 0..150 mV), a una Fs
+de como mucho 2000 Hz (FS_TIMER_HZ). Subir el archivo a SPIFFS (data/ +
+uploadfs) y reproducirlo con POST /api/playback/start?file=/nombre.bsr
+
+USO:
+----
+    python encode_recording.py 100.csv -o /data/mitbih100.bsr --signal ECG --fs 360 --column 1
+    python encode_recording.py ppg.csv -o /data/ppg.bsr --signal PPG --fs 100 --scale 1000
+
+Autor: BioSignalSimulator Pro Team
+Fecha: Enero 2026
+"""
+
+import csv
+import struct
+
+from decode_recording import HEADER, MAGIC, SIGNALS
+
+VERSION = 1
+BLOCK_BYTES = 2048      # RECORDER_BLOCK_BYTES: un bloque = una lectura de flash
+UV_PER_LSB = 1
+MAX_FS = 2000           # FS_TIMER_HZ
+
+
+def write_varint(value: int) -> bytes:
+    out = bytearray()
+    while value >= 0x80:
+        out.append((value & 0x7F) | 0x80)
+        value >>= 7
+    out.append(value)
+    return bytes(out)
+
+
+def encode_blocks(samples_mv, signal: int, condition: int, fs: int) -> bytes:
+    """Parte la señal en bloques delta+varint de como mucho BLOCK_BYTES."""
+    data = bytearray()
+    first = 0
+    while first < len(samples_mv):
+        payload = bytearray()
+        value = 0
+        count = 0
+        while first + count < len(samples_mv) and count < 0xFFFF:
+            x = int(round(samples_mv[first + count] * 1000.0 / UV_PER_LSB))
+            delta = x if count == 0 else x - value
+            z = ((delta << 1) ^ (delta >> 31)) & 0xFFFFFFFF
+            encoded = write_varint(z)
+            if HEADER.size + len(payload) + len(encoded) > BLOCK_BYTES:
+                break
+            payload += encoded
+            value = x
+            count += 1
+
+        data += HEADER.pack(MAGIC, VERSION, signal, condition, 0, fs, count,
+                            first, 0, len(payload), UV_PER_LSB)
+        data += payload
+        first += count
+    return bytes(data)
+
+
+def main():
+    import argparse
+
+    names = {v: k for k, v in SIGNALS.items() if k != 0}
+    parser = argparse.ArgumentParser(description="Codifica un CSV a grabación .bsr")
+    parser.add_argument("input", help="CSV de entrada")
+    parser.add_argument("-o", "--output", required=True, help="Archivo .bsr de salida")
+    parser.add_argument("--signal", required=True, choices=sorted(names), help="Tipo de señal")
+    parser.add_argument("--fs", required=True, type=int, help="Frecuencia de muestreo (Hz)")
+    parser.add_argument("--column", type=int, default=0, help="Columna con la señal")
+    parser.add_argument("--condition", type=int, default=0, help="Condición a reportar")
+    parser.add_argument("--scale", type=float, default=1.0, help="Factor a mV (p.ej. 1000 si viene en V)")
+    args = parser.parse_args()
+
+    if not 0 < args.fs <= MAX_FS:
+        parser.error("Fs debe estar entre 1 y %d Hz" % MAX_FS)
+
+    samples = []
+    with open(args.input, newline="") as f:
+        for row in csv.reader(f):
+            try:
+                samples.append(float(row[args.column]) * args.scale)
+            except (ValueError, IndexError):
+                continue    # Cabeceras, unidades o filas incompletas
+
+    data = encode_blocks(samples, names[args.signal], args.condition, args.fs)
+    with open(args.output, "wb") as f:
+        f.write(data)
+
+    print("%d muestras (%.1f s) -> %d bytes (%.2f B/muestra)" % (
+        len(samples), len(samples) / args.fs, len(data),
+        len(data) / max(1, len(samples))))
+
+
+if __name__ == "__main__":
+    main()